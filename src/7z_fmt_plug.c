@@ -32,13 +32,18 @@ john_register_one(&fmt_sevenzip);
 #include "sha2.h"
 #include "crc32.h"
 #include "unicode.h"
+#include "sse-intrinsics.h"
 #include "memdbg.h"
 
 #define FORMAT_LABEL		"7z"
 #define FORMAT_NAME		"7-Zip"
 #define FORMAT_TAG		"$7z$"
 #define TAG_LENGTH		4
+#ifdef MMX_COEF_SHA256
+#define ALGORITHM_NAME		"SHA256 AES " SHA256_ALGORITHM_NAME
+#else
 #define ALGORITHM_NAME		"SHA256 AES 32/" ARCH_BITS_STR
+#endif
 #define BENCHMARK_COMMENT	" (512K iterations)"
 #define BENCHMARK_LENGTH	-1
 #define BINARY_SIZE		0
@@ -46,11 +51,38 @@ john_register_one(&fmt_sevenzip);
 #define PLAINTEXT_LENGTH	125
 #define SALT_SIZE		sizeof(struct custom_salt)
 #define SALT_ALIGN		4
+#ifdef MMX_COEF_SHA256
+#define NBKEYS			MMX_COEF_SHA256
+#define MIN_KEYS_PER_CRYPT	NBKEYS
+#define MAX_KEYS_PER_CRYPT	NBKEYS
+#define GETPOS(i, index)	( (index&(MMX_COEF_SHA256-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF_SHA256 + (3-((i)&3)) )
+#define GETOUTPOS(i, index)	( (index&(MMX_COEF_SHA256-1)) + (i)*MMX_COEF_SHA256 )
+/* One SHA-256 block for all lanes, and room for the longest 64-record chunk */
+#define KDF_BLOCK_SIZE		(SHA256_BUF_SIZ * 4 * NBKEYS)
+#define KDF_BUF_SIZE		((2 * PLAINTEXT_LENGTH + 8) * KDF_BLOCK_SIZE)
+#else
 #define MIN_KEYS_PER_CRYPT	1
 #define MAX_KEYS_PER_CRYPT	1
+#endif
 #define OMP_SCALE               1 // tuned on core i7
 
 #define BIG_ENOUGH 		(8192 * 32)
+#define DECRYPT_CHUNK		4096	/* multiple of the AES block size */
+
+#define MIN(a, b)		(((a) > (b)) ? (b) : (a))
+#define MAX(a, b)		(((a) > (b)) ? (a) : (b))
+
+//#define SEVENZIP_REJECT_STATS
+
+#ifdef SEVENZIP_REJECT_STATS
+/* Candidates rejected by each stage of sevenzip_decrypt(), racy under OMP */
+static struct {
+	unsigned long long padding, crc;
+} rejected;
+#define REJECTED(stage)	rejected.stage++
+#else
+#define REJECTED(stage)
+#endif
 
 static struct fmt_tests sevenzip_tests[] = {
 	/* CRC checks passes for these hashes */
@@ -65,6 +97,13 @@ static struct fmt_tests sevenzip_tests[] = {
 
 static char (*saved_key)[PLAINTEXT_LENGTH + 1];
 static int *cracked;
+#ifdef MMX_COEF_SHA256
+static UTF16 (*saved_utf16)[PLAINTEXT_LENGTH + 1];
+static int *saved_utf16_len;
+static unsigned char (*master)[32];
+static int *kdf_order, *kdf_group;
+static unsigned char *kdf_buf;
+#endif
 
 static struct custom_salt {
 	int NumCyclesPower;
@@ -82,21 +121,40 @@ static struct custom_salt {
 static void init(struct fmt_main *self)
 {
 	CRC32_t crc;
-#if defined (_OPENMP)
 	int omp_t = 1;
-
+#if defined (_OPENMP)
 	omp_t = omp_get_max_threads();
 	self->params.min_keys_per_crypt *= omp_t;
-	omp_t *= OMP_SCALE;
-	self->params.max_keys_per_crypt *= omp_t;
+	self->params.max_keys_per_crypt *= omp_t * OMP_SCALE;
 #endif
 	saved_key = mem_calloc_tiny(sizeof(*saved_key) *
 			self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
 	cracked = mem_calloc_tiny(sizeof(*cracked) *
 			self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
+#ifdef MMX_COEF_SHA256
+	saved_utf16 = mem_calloc_tiny(sizeof(*saved_utf16) *
+			self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
+	saved_utf16_len = mem_calloc_tiny(sizeof(*saved_utf16_len) *
+			self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
+	master = mem_calloc_tiny(sizeof(*master) *
+			self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
+	kdf_order = mem_calloc_tiny(sizeof(*kdf_order) *
+			self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
+	kdf_group = mem_calloc_tiny(sizeof(*kdf_group) *
+			(self->params.max_keys_per_crypt + 1), MEM_ALIGN_WORD);
+	kdf_buf = mem_alloc_tiny(KDF_BUF_SIZE * omp_t, MEM_ALIGN_SIMD);
+#endif
 	CRC32_Init(&crc);
 }
 
+#ifdef SEVENZIP_REJECT_STATS
+static void done(void)
+{
+	fprintf(stderr, "7z rejects: padding %llu, crc %llu\n",
+	        rejected.padding, rejected.crc);
+}
+#endif
+
 static int valid(char *ciphertext, struct fmt_main *self)
 {
 	char *ctcopy, *keeptr, *p;
@@ -221,13 +279,15 @@ static int validFolder(unsigned char *data)
 	return 0;
 }
 
+/*
+ * Staged verification: the padding check needs only the last block(s), so
+ * decrypt those first and reject most wrong keys right there.  Only the
+ * survivors get the full CBC decrypt, streamed through a small buffer
+ * straight into the CRC.
+ */
 static int sevenzip_decrypt(unsigned char *derived_key, unsigned char *data)
 {
-#ifdef _MSC_VER
-	unsigned char *out;
-#else
-	unsigned char out[cur_salt->length];
-#endif
+	unsigned char out[DECRYPT_CHUNK];
 	AES_KEY akey;
 	unsigned char iv[16];
 	union {
@@ -237,74 +297,74 @@ static int sevenzip_decrypt(unsigned char *derived_key, unsigned char *data)
 	unsigned char *crc_out = _crc_out.crcc;
 	unsigned int ccrc;
 	CRC32_t crc;
-	int i;
-	int nbytes, margin;
-
-#ifdef _MSC_VER
-	out = malloc(cur_salt->length);
-#endif
-	memcpy(iv, cur_salt->iv, 16);
+	int i, n, pos, size, margin, folder = 0;
 
 	if(AES_set_decrypt_key(derived_key, 256, &akey) < 0) {
 		fprintf(stderr, "AES_set_decrypt_key failed in crypt!\n");
 	}
-	AES_cbc_encrypt(cur_salt->data, out, cur_salt->length, &akey, iv, AES_DECRYPT);
 
 	/* various verifications tests */
 
 	// test 0, padding check, bad hack :-(
-	margin = nbytes = cur_salt->length - cur_salt->unpacksize;
-	i = cur_salt->length - 1;
-	while (nbytes > 0) {
-		if (out[i] != 0) {
-#ifdef _MSC_VER
-			free(out);
-#endif
-			return -1;
-		}
-		nbytes--;
-		i--;
+	margin = cur_salt->length - cur_salt->unpacksize;
+	for (pos = margin > 0 ? cur_salt->unpacksize & ~15 : cur_salt->length;
+	     pos < cur_salt->length; pos += n) {
+		n = MIN(cur_salt->length - pos, DECRYPT_CHUNK);
+		memcpy(iv, pos ? &data[pos - 16] : cur_salt->iv, 16);
+		AES_cbc_encrypt(&data[pos], out, n, &akey, iv, AES_DECRYPT);
+		for (i = MAX(cur_salt->unpacksize - pos, 0); i < n; i++)
+			if (out[i] != 0) {
+				REJECTED(padding);
+				return -1;
+			}
 	}
 	if (margin > 7) {
 		// printf("valid padding test ;-)\n");
-		// print_hex(out, cur_salt->length);
-#ifdef _MSC_VER
-			free(out);
-#endif
 		return 0;
 	}
 
 	// test 1, CRC test
+	size = MIN(cur_salt->unpacksize, cur_salt->length);
+	memcpy(iv, cur_salt->iv, 16);
 	CRC32_Init(&crc);
-	CRC32_Update(&crc, out, cur_salt->unpacksize);
+	for (pos = 0; pos < size; pos += n) {
+		n = MIN(size - pos, DECRYPT_CHUNK);
+		AES_cbc_encrypt(&data[pos], out, (n + 15) & ~15, &akey, iv,
+		                AES_DECRYPT);
+		CRC32_Update(&crc, out, n);
+		// XXX test 2, "well-formed folder" test
+		if (!pos)
+			folder = validFolder(out);
+	}
 	CRC32_Final(crc_out, crc);
 	ccrc =  _crc_out.crci; // computed CRC
 #if !ARCH_LITTLE_ENDIAN
 	ccrc = JOHNSWAP(ccrc);
 #endif
-	if (ccrc == cur_salt->crc) {
-#ifdef _MSC_VER
-		free(out);
-#endif
+	if (ccrc == cur_salt->crc)
 		return 0;  // XXX don't be too eager!
-	}
 
-	// XXX test 2, "well-formed folder" test
-	if (validFolder(out)) {
+	if (folder) {
 		printf("validFolder check ;-)\n");
-#ifdef _MSC_VER
-		free(out);
-#endif
 		return 0;
 	}
 
-#ifdef _MSC_VER
-	free(out);
-#endif
+	REJECTED(crc);
 	return -1;
 }
 
+/* Convert password to utf-16-le format (--encoding aware), return bytes */
+static int sevenzip_utf16(UTF8 *password, UTF16 *buffer)
+{
+	int len;
 
+	len = enc_to_utf16(buffer, PLAINTEXT_LENGTH, password, strlen((char*)password));
+	if (len <= 0) {
+		password[-len] = 0; // match truncation
+		len = strlen16(buffer);
+	}
+	return len * 2;
+}
 
 void sevenzip_kdf(UTF8 *password, unsigned char *master)
 {
@@ -318,13 +378,7 @@ void sevenzip_kdf(UTF8 *password, unsigned char *master)
 #endif
 	SHA256_CTX sha;
 
-	/* Convert password to utf-16-le format (--encoding aware) */
-	len = enc_to_utf16(buffer, PLAINTEXT_LENGTH, password, strlen((char*)password));
-	if (len <= 0) {
-		password[-len] = 0; // match truncation
-		len = strlen16(buffer);
-	}
-	len *= 2;
+	len = sevenzip_utf16(password, buffer);
 
 	/* kdf */
         SHA256_Init(&sha);
@@ -343,10 +397,159 @@ void sevenzip_kdf(UTF8 *password, unsigned char *master)
 	SHA256_Final(master, &sha);
 }
 
+#ifdef MMX_COEF_SHA256
+/*
+ * The key derivation hashes 2^NumCyclesPower records of the UTF-16 password
+ * and an 8-byte little-endian counter.  With all NBKEYS passwords of one
+ * length, 64 records fill exactly len + 8 blocks in every lane, and only
+ * the counter bytes differ between such 64-record chunks.  So we lay one
+ * chunk out in the kernel's interleaved format once, then just patch the
+ * counters before hashing each chunk.  Needs at least 64 rounds.
+ *
+ * idx[] holds n <= NBKEYS indices of keys with the same length.  Unused
+ * lanes repeat the last key.
+ */
+static void sevenzip_kdf_simd(const int *idx, int n, unsigned char *buf)
+{
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 state[8 * NBKEYS];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char pad[KDF_BLOCK_SIZE];
+	unsigned int lane[NBKEYS], ctr[64];
+	unsigned int len = saved_utf16_len[idx[0]];
+	unsigned int rlen = len + 8;
+	unsigned int rounds = 1U << cur_salt->NumCyclesPower;
+	unsigned long long bits = (unsigned long long)rounds * rlen * 8;
+	unsigned int i, r, b, x, q;
+
+#define KDF_POS(p, x)	(((p) >> 6) * KDF_BLOCK_SIZE + GETPOS((p) & 63, x))
+
+	for (x = 0; x < NBKEYS; x++) {
+		unsigned char *key =
+			(unsigned char*)saved_utf16[idx[x < n ? x : n - 1]];
+
+		lane[x] = GETPOS(0, x) - GETPOS(0, 0);
+		for (r = 0; r < 64; r++) {
+			unsigned int p = r * rlen;
+
+			for (q = 0; q < len; q++, p++)
+				buf[KDF_POS(p, x)] = key[q];
+			for (q = 0; q < 8; q++, p++)
+				buf[KDF_POS(p, x)] = 0;
+		}
+	}
+	/* Counter bytes of each record, lane 0; other lanes add lane[x] */
+	for (r = 0; r < 64; r++)
+		ctr[r] = KDF_POS(r * rlen + len, 0);
+
+	for (x = 0; x < NBKEYS; x++) {
+		state[GETOUTPOS(0, x)] = 0x6a09e667;
+		state[GETOUTPOS(1, x)] = 0xbb67ae85;
+		state[GETOUTPOS(2, x)] = 0x3c6ef372;
+		state[GETOUTPOS(3, x)] = 0xa54ff53a;
+		state[GETOUTPOS(4, x)] = 0x510e527f;
+		state[GETOUTPOS(5, x)] = 0x9b05688c;
+		state[GETOUTPOS(6, x)] = 0x1f83d9ab;
+		state[GETOUTPOS(7, x)] = 0x5be0cd19;
+	}
+
+	for (i = 0; i < rounds; i += 64) {
+		/* Byte 0 changes every chunk, bytes 1..3 every 4th */
+		for (r = 0; r < 64; r++) {
+			unsigned char *p = &buf[ctr[r]];
+
+			for (x = 0; x < NBKEYS; x++)
+				p[lane[x]] = (unsigned char)(i + r);
+			if (i & 0xff)
+				continue;
+			for (x = 0; x < NBKEYS; x++)
+			for (q = 1; q < 4; q++)
+				buf[KDF_POS(r * rlen + len + q, x)] =
+					(unsigned char)(i >> (8 * q));
+		}
+		for (b = 0; b < rlen; b++)
+			SSESHA256body((__m128i*)&buf[b * KDF_BLOCK_SIZE], state,
+			              state, SSEi_MIXED_IN|SSEi_RELOAD);
+	}
+
+	/* rounds * rlen is a whole number of blocks: one more for padding */
+	memset(pad, 0, KDF_BLOCK_SIZE);
+	for (x = 0; x < NBKEYS; x++) {
+		pad[GETPOS(0, x)] = 0x80;
+		((ARCH_WORD_32*)pad)[GETPOS(56, x) >> 2] = bits >> 32;
+		((ARCH_WORD_32*)pad)[GETPOS(60, x) >> 2] = bits;
+	}
+	SSESHA256body((__m128i*)pad, state, state, SSEi_MIXED_IN|SSEi_RELOAD);
+
+	for (x = 0; x < n; x++)
+	for (i = 0; i < 8; i++) {
+#if ARCH_LITTLE_ENDIAN
+		ARCH_WORD_32 w = JOHNSWAP(state[GETOUTPOS(i, x)]);
+#else
+		ARCH_WORD_32 w = state[GETOUTPOS(i, x)];
+#endif
+
+		memcpy(&master[idx[x]][4 * i], &w, 4);
+	}
+#undef KDF_POS
+}
+#endif
+
 static int crypt_all(int *pcount, struct db_salt *salt)
 {
 	int count = *pcount;
 	int index = 0;
+#ifdef MMX_COEF_SHA256
+	unsigned int start[2 * PLAINTEXT_LENGTH + 2] = { 0 };
+	int ngroups = 0, g;
+
+	for (index = 0; index < count; index++)
+		saved_utf16_len[index] = sevenzip_utf16(
+			(UTF8*)saved_key[index], saved_utf16[index]);
+
+	/* All lanes of a kernel call need the same length */
+	for (index = 0; index < count; index++)
+		start[saved_utf16_len[index] + 1]++;
+	for (index = 1; index <= 2 * PLAINTEXT_LENGTH; index++)
+		start[index] += start[index - 1];
+	for (index = 0; index < count; index++)
+		kdf_order[start[saved_utf16_len[index]]++] = index;
+
+	for (index = 0; index < count; ) {
+		int len = saved_utf16_len[kdf_order[index]];
+		int end = MIN(count, index + NBKEYS);
+
+		kdf_group[ngroups++] = index;
+		while (index < end && saved_utf16_len[kdf_order[index]] == len)
+			index++;
+	}
+	kdf_group[ngroups] = count;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (g = 0; g < ngroups; g++) {
+#ifdef _OPENMP
+		int t = omp_get_thread_num();
+#else
+		int t = 0;
+#endif
+		int k;
+
+		if (cur_salt->NumCyclesPower < 6) {
+			for (k = kdf_group[g]; k < kdf_group[g + 1]; k++)
+				sevenzip_kdf((UTF8*)saved_key[kdf_order[k]],
+				             master[kdf_order[k]]);
+		} else
+			sevenzip_kdf_simd(&kdf_order[kdf_group[g]],
+			                  kdf_group[g + 1] - kdf_group[g],
+			                  &kdf_buf[t * KDF_BUF_SIZE]);
+	}
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (index = 0; index < count; index++)
+		cracked[index] = !sevenzip_decrypt(master[index], cur_salt->data);
+#else
 #ifdef _OPENMP
 #pragma omp parallel for
 	for (index = 0; index < count; index += MAX_KEYS_PER_CRYPT)
@@ -362,6 +565,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 		else
 			cracked[index] = 0;
 	}
+#endif
 	return count;
 }
 
@@ -433,7 +637,11 @@ struct fmt_main fmt_sevenzip = {
 		sevenzip_tests
 	}, {
 		init,
+#ifdef SEVENZIP_REJECT_STATS
+		done,
+#else
 		fmt_default_done,
+#endif
 		fmt_default_reset,
 		fmt_default_prepare,
 		valid,
@@ -16,6 +16,10 @@
 #include "BF_std.h"
 #include "common.h"
 #include "formats.h"
+#if BF_GATHER
+#include "params.h"
+#include "config.h"
+#endif
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -52,9 +56,23 @@ struct fmt_main fmt_BF;
 static void init(struct fmt_main *self)
 {
 #ifdef _OPENMP
-	int n = BF_Nmin * omp_get_max_threads(), max;
-	if (n < BF_Nmin)
-		n = BF_Nmin;
+	int nmin = BF_Nmin, n, max;
+#if BF_GATHER
+	char *opt = cfg_get_param(SECTION_OPTIONS, NULL, "BcryptGather");
+
+	if (!opt || !strcasecmp(opt, "auto"))
+		BF_std_gather = BF_std_gather_faster();
+	else
+		BF_std_gather =
+		    cfg_get_bool(SECTION_OPTIONS, NULL, "BcryptGather", 0);
+	if (BF_std_gather) {
+		nmin = BF_GATHER_N;
+		fmt_BF.params.algorithm_name = BF_GATHER_ALGORITHM_NAME;
+	}
+#endif
+	n = nmin * omp_get_max_threads();
+	if (n < nmin)
+		n = nmin;
 	if (n > BF_N)
 		n = BF_N;
 	fmt_BF.params.min_keys_per_crypt = n;
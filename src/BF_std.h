@@ -37,6 +37,19 @@
 #define BF_N				BF_Nmin
 #endif
 
+/*
+ * Experimental: BF_GATHER_N instances in the lanes of AVX2 vectors, with
+ * the S-box lookups done by gathers.  Whether this beats the interleaved
+ * scalar code depends on the CPU's gathers, so it's picked at runtime.
+ */
+#if BF_mt > 1 && defined(__AVX2__)
+#define BF_GATHER			1
+#define BF_GATHER_N			8
+#define BF_GATHER_ALGORITHM_NAME	"Blowfish 256/256 AVX2 8x gather"
+#else
+#define BF_GATHER			0
+#endif
+
 /*
  * BF_std_crypt() output buffer.
  */
@@ -61,6 +74,20 @@ extern void BF_std_set_key(char *key, int index, int sign_extension_bug);
  */
 extern void BF_std_crypt(BF_salt *salt, int n);
 
+#if BF_GATHER
+/*
+ * Non-zero to have BF_std_crypt() use the gather-based code, which wants
+ * n to be a multiple of BF_GATHER_N.
+ */
+extern int BF_std_gather;
+
+/*
+ * Times both code paths on this CPU, returns non-zero if the gather-based
+ * one is faster.
+ */
+extern int BF_std_gather_faster(void);
+#endif
+
 #if BF_mt == 1
 /*
  * Calculates the rest of BF_out, for exact comparison.
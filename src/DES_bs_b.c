@@ -321,6 +321,59 @@ typedef struct {
 	(dst).f = vec_sel((a).f, (b).f, (vector bool int)(c).f); \
 	(dst).g = vec_sel((a).g, (b).g, (vector bool int)(c).g)
 
+#elif defined(__AVX512F__) && DES_BS_DEPTH == 512 && !defined(DES_BS_NO_AVX512)
+#include <immintrin.h>
+
+typedef __m512i vtype;
+
+#define vst(dst, ofs, src) \
+	_mm512_store_si512((vtype *)((DES_bs_vector *)&(dst) + (ofs)), (src))
+
+#define vxorf(a, b) \
+	_mm512_xor_si512((a), (b))
+
+#define vnot(dst, a) \
+	(dst) = _mm512_ternarylogic_epi64((a), (a), (a), 0x55)
+#define vand(dst, a, b) \
+	(dst) = _mm512_and_si512((a), (b))
+#define vor(dst, a, b) \
+	(dst) = _mm512_or_si512((a), (b))
+#define vandn(dst, a, b) \
+	(dst) = _mm512_andnot_si512((b), (a))
+#define vsel(dst, a, b, c) \
+	(dst) = _mm512_ternarylogic_epi64((a), (b), (c), 0xD8)
+#define vlut3(dst, a, b, c, lut) \
+	(dst) = _mm512_ternarylogic_epi64((a), (b), (c), (lut))
+
+#define vshl(dst, src, shift) \
+	(dst) = _mm512_slli_epi64((src), (shift))
+#define vshr(dst, src, shift) \
+	(dst) = _mm512_srli_epi64((src), (shift))
+
+#elif defined(__AVX2__) && DES_BS_DEPTH == 256 && !defined(DES_BS_NO_AVX256)
+#include <immintrin.h>
+
+/* With AVX2, the integer ops are full width and shifts are one instruction */
+typedef __m256i vtype;
+
+#define vst(dst, ofs, src) \
+	_mm256_store_si256((vtype *)((DES_bs_vector *)&(dst) + (ofs)), (src))
+
+#define vxorf(a, b) \
+	_mm256_xor_si256((a), (b))
+
+#define vand(dst, a, b) \
+	(dst) = _mm256_and_si256((a), (b))
+#define vor(dst, a, b) \
+	(dst) = _mm256_or_si256((a), (b))
+#define vandn(dst, a, b) \
+	(dst) = _mm256_andnot_si256((b), (a))
+
+#define vshl(dst, src, shift) \
+	(dst) = _mm256_slli_epi64((src), (shift))
+#define vshr(dst, src, shift) \
+	(dst) = _mm256_srli_epi64((src), (shift))
+
 #elif defined(__AVX__) && DES_BS_DEPTH == 256 && !defined(DES_BS_NO_AVX256)
 #include <immintrin.h>
 
@@ -1284,7 +1337,9 @@ void DES_bs_set_salt(ARCH_WORD salt)
 #if !DES_BS_ASM
 
 /* Include the S-boxes here so that the compiler can inline them */
-#if DES_BS == 3
+#if DES_BS == 4
+#include "sboxes-t.c"
+#elif DES_BS == 3
 #include "sboxes-s.c"
 #elif DES_BS == 2
 #include "sboxes.c"
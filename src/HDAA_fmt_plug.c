@@ -66,8 +66,8 @@ static unsigned int omp_t = 1;
 #define NBKEYS					(MMX_COEF * MD5_SSE_PARA)
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&60)*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*64*MMX_COEF )
-#define GETOUTPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&0x1c)*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*16*MMX_COEF )
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&60)*MMX_COEF + ((i)&3) + (index/MMX_COEF)*64*MMX_COEF )
+#define GETOUTPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&0x1c)*MMX_COEF + ((i)&3) + (index/MMX_COEF)*16*MMX_COEF )
 #else
 #define MIN_KEYS_PER_CRYPT		1
 #define MAX_KEYS_PER_CRYPT		1
@@ -385,8 +385,8 @@ static inline void bin2ascii(uint32_t *conv, uint32_t *source)
 static inline void crypt_done(unsigned const int *source, unsigned int *dest, int index)
 {
 	unsigned int i;
-	unsigned const int *s = &source[(index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*4*MMX_COEF];
-	unsigned int *d = &dest[(index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*4*MMX_COEF];
+	unsigned const int *s = &source[(index&(MMX_COEF-1)) + (index/MMX_COEF)*4*MMX_COEF];
+	unsigned int *d = &dest[(index&(MMX_COEF-1)) + (index/MMX_COEF)*4*MMX_COEF];
 
 	for (i = 0; i < BINARY_SIZE / 4; i++) {
 		*d = *s;
@@ -437,7 +437,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 			for (; i < (((len+8)>>6)+1)*64; i += 4)
 				*(ARCH_WORD_32*)&saved_key[i>>6][GETPOS(i, ti)] = 0;
 
-			((unsigned int *)saved_key[(len+8)>>6])[14*MMX_COEF + (ti&3) + (ti>>2)*16*MMX_COEF] = len << 3;
+			((unsigned int *)saved_key[(len+8)>>6])[14*MMX_COEF + (ti&(MMX_COEF-1)) + (ti/MMX_COEF)*16*MMX_COEF] = len << 3;
 		}
 
 		SSEmd5body(&saved_key[0][thread*64*NBKEYS], &crypt_key[thread*4*NBKEYS], NULL, SSEi_MIXED_IN);
@@ -470,7 +470,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 			for (; i <= crypt_len[index]; i += 4)
 				*(ARCH_WORD_32*)&saved_key[i>>6][GETPOS(i, ti)] = 0;
 
-			((unsigned int *)saved_key[(len+8)>>6])[14*MMX_COEF + (ti&3) + (ti>>2)*16*MMX_COEF] = len << 3;
+			((unsigned int *)saved_key[(len+8)>>6])[14*MMX_COEF + (ti&(MMX_COEF-1)) + (ti/MMX_COEF)*16*MMX_COEF] = len << 3;
 			crypt_len[index] = len;
 			if (len > longest)
 				longest = len;
@@ -63,8 +63,8 @@ static unsigned int omp_t = 1;
 #define NBKEYS					(MMX_COEF * MD5_SSE_PARA)
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&60)*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*64*MMX_COEF )
-#define GETOUTPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&12)*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*16*MMX_COEF )
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&60)*MMX_COEF + ((i)&3) + (index/MMX_COEF)*64*MMX_COEF )
+#define GETOUTPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&12)*MMX_COEF + ((i)&3) + (index/MMX_COEF)*16*MMX_COEF )
 #else
 #define NBKEYS                  1
 #define MIN_KEYS_PER_CRYPT		1
@@ -156,7 +156,7 @@ static void init(struct fmt_main *self)
 	empty_key = mem_calloc_tiny(64 * NBKEYS, MEM_ALIGN_SIMD);
 	for (i = 0; i < NBKEYS; ++i) {
 		empty_key[GETPOS(0, i)] = 0x80;
-		((unsigned int*)empty_key)[14*MMX_COEF + (i&3) + (i>>2)*16*MMX_COEF] = (2 * MD5_HEX_SIZE)<<3;
+		((unsigned int*)empty_key)[14*MMX_COEF + (i&(MMX_COEF-1)) + (i/MMX_COEF)*16*MMX_COEF] = (2 * MD5_HEX_SIZE)<<3;
 	}
 #else
 	crypt_key = mem_calloc_tiny(sizeof(*crypt_key) * self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
@@ -117,8 +117,8 @@ static int get_hash_0(int index)
 {
 #ifdef MD5_SSE_PARA
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((MD5_word *)sout)[x+y*MMX_COEF*4] & 0xF;
 #else
 	init_t();
@@ -130,8 +130,8 @@ static int get_hash_1(int index)
 {
 #ifdef MD5_SSE_PARA
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((MD5_word *)sout)[x+y*MMX_COEF*4] & 0xFF;
 #else
 	init_t();
@@ -143,8 +143,8 @@ static int get_hash_2(int index)
 {
 #ifdef MD5_SSE_PARA
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((MD5_word *)sout)[x+y*MMX_COEF*4] & 0xFFF;
 #else
 	init_t();
@@ -156,8 +156,8 @@ static int get_hash_3(int index)
 {
 #ifdef MD5_SSE_PARA
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((MD5_word *)sout)[x+y*MMX_COEF*4] & 0xFFFF;
 #else
 	init_t();
@@ -169,8 +169,8 @@ static int get_hash_4(int index)
 {
 #ifdef MD5_SSE_PARA
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((MD5_word *)sout)[x+y*MMX_COEF*4] & 0xFFFFF;
 #else
 	init_t();
@@ -182,8 +182,8 @@ static int get_hash_5(int index)
 {
 #ifdef MD5_SSE_PARA
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((MD5_word *)sout)[x+y*MMX_COEF*4] & 0xFFFFFF;
 #else
 	init_t();
@@ -195,8 +195,8 @@ static int get_hash_6(int index)
 {
 #ifdef MD5_SSE_PARA
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((MD5_word *)sout)[x+y*MMX_COEF*4] & 0x7FFFFFF;
 #else
 	init_t();
@@ -291,16 +291,16 @@ static int cmp_one(void *binary, int index)
 {
 #ifdef MD5_SSE_PARA
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 
 	if( ((unsigned int *)binary)[0] != ((unsigned int *)sout)[x+y*MMX_COEF*4] )
 		return 0;
-	if( ((unsigned int *)binary)[1] != ((unsigned int *)sout)[x+y*MMX_COEF*4+4] )
+	if( ((unsigned int *)binary)[1] != ((unsigned int *)sout)[x+y*MMX_COEF*4+MMX_COEF] )
 		return 0;
-	if( ((unsigned int *)binary)[2] != ((unsigned int *)sout)[x+y*MMX_COEF*4+8] )
+	if( ((unsigned int *)binary)[2] != ((unsigned int *)sout)[x+y*MMX_COEF*4+2*MMX_COEF] )
 		return 0;
-	if( ((unsigned int *)binary)[3] != ((unsigned int *)sout)[x+y*MMX_COEF*4+12] )
+	if( ((unsigned int *)binary)[3] != ((unsigned int *)sout)[x+y*MMX_COEF*4+3*MMX_COEF] )
 		return 0;
 	return 1;
 #else
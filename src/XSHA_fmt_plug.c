@@ -53,7 +53,7 @@ static unsigned int omp_t = 1;
 
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
 
 #else
 
@@ -163,50 +163,50 @@ static void *salt(char *ciphertext)
 static int get_hash_0(int index)
 {
 	unsigned int x,y;
-        x = index&3;
-        y = index/4;
+        x = index&(MMX_COEF-1);
+        y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*5] & 0xf;
 }
 static int get_hash_1(int index)
 {
 	unsigned int x,y;
-        x = index&3;
-        y = index/4;
+        x = index&(MMX_COEF-1);
+        y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*5] & 0xff;
 }
 static int get_hash_2(int index)
 {
 	unsigned int x,y;
-        x = index&3;
-        y = index/4;
+        x = index&(MMX_COEF-1);
+        y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*5] & 0xfff;
 }
 static int get_hash_3(int index)
 {
 	unsigned int x,y;
-        x = index&3;
-        y = index/4;
+        x = index&(MMX_COEF-1);
+        y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*5] & 0xffff;
 }
 static int get_hash_4(int index)
 {
 	unsigned int x,y;
-        x = index&3;
-        y = index/4;
+        x = index&(MMX_COEF-1);
+        y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*5] & 0xfffff;
 }
 static int get_hash_5(int index)
 {
 	unsigned int x,y;
-        x = index&3;
-        y = index/4;
+        x = index&(MMX_COEF-1);
+        y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*5] & 0xffffff;
 }
 static int get_hash_6(int index)
 {
 	unsigned int x,y;
-        x = index&3;
-        y = index/4;
+        x = index&(MMX_COEF-1);
+        y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*5] & 0x7ffffff;
 }
 #else
@@ -265,7 +265,7 @@ static void set_key(char *key, int index)
 {
 #ifdef MMX_COEF
 	const ARCH_WORD_32 *wkey = (ARCH_WORD_32*)key;
-	ARCH_WORD_32 *keybuffer = &saved_key[(index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF + MMX_COEF];
+	ARCH_WORD_32 *keybuffer = &saved_key[(index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF + MMX_COEF];
 	ARCH_WORD_32 *keybuf_word = keybuffer;
 	unsigned int len;
 	ARCH_WORD_32 temp;
@@ -318,7 +318,7 @@ static char *get_key(int index)
 	unsigned int i,s;
 	static char out[PLAINTEXT_LENGTH + 1];
 
-	s = ((unsigned int *)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF] >> 3;
+	s = ((unsigned int *)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] >> 3;
 
 	for(i = 0; i < (s - SALT_SIZE); i++)
 		out[i] = ((char*)saved_key)[ GETPOS((i + SALT_SIZE), index) ];
@@ -344,7 +344,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 		unsigned int *out = &crypt_key[i*NBKEYS*BINARY_SIZE/4];
 		unsigned int j;
 		for (j=0; j < NBKEYS; j++)
-			in[(j&(MMX_COEF-1)) + (j>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF] = cur_salt;
+			in[(j&(MMX_COEF-1)) + (j/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = cur_salt;
 		SSESHA1body(in, out, NULL, SSEi_MIXED_IN);
 #if defined(_OPENMP)
 	}
@@ -401,8 +401,8 @@ static int cmp_one(void *binary, int index)
 {
 #ifdef MMX_COEF
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 
 	if( ((ARCH_WORD_32 *)binary)[0] != ((ARCH_WORD_32 *)crypt_key)[x+y*MMX_COEF*5] )
 		return 0;
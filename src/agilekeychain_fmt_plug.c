@@ -27,7 +27,8 @@ john_register_one(&fmt_agile_keychain);
 #include "params.h"
 #include "johnswap.h"
 #include "options.h"
-#include "pbkdf2_hmac_sha1.h"
+#include "sse-intrinsics.h"
+#include "pbkdf2_hmac.h"
 #include <openssl/aes.h>
 #ifdef _OPENMP
 #include <omp.h>
@@ -49,13 +50,8 @@ john_register_one(&fmt_agile_keychain);
 #define SALT_ALIGN		sizeof(int)
 #define PLAINTEXT_LENGTH	125
 #define SALT_SIZE		sizeof(struct custom_salt)
-#ifdef MMX_COEF
-#define MIN_KEYS_PER_CRYPT  SSE_GROUP_SZ_SHA1
-#define MAX_KEYS_PER_CRYPT  SSE_GROUP_SZ_SHA1
-#else
-#define MIN_KEYS_PER_CRYPT	1
-#define MAX_KEYS_PER_CRYPT	1
-#endif
+#define MIN_KEYS_PER_CRYPT	PBKDF2_SHA1_BATCH
+#define MAX_KEYS_PER_CRYPT	PBKDF2_SHA1_BATCH
 
 #define SALTLEN 8
 #define IVLEN 8
@@ -209,46 +205,34 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 {
 	int count = *pcount;
 	int index = 0;
+
 #ifdef _OPENMP
 #pragma omp parallel for
-	for (index = 0; index < count; index += MAX_KEYS_PER_CRYPT)
 #endif
+	for (index = 0; index < count; index += MAX_KEYS_PER_CRYPT)
 	{
-#ifdef MMX_COEF
 		unsigned char master[MAX_KEYS_PER_CRYPT][32];
+		const unsigned char *pin[MAX_KEYS_PER_CRYPT];
+		unsigned char *pout[MAX_KEYS_PER_CRYPT];
 		int lens[MAX_KEYS_PER_CRYPT], i;
-		unsigned char *pin[MAX_KEYS_PER_CRYPT], *pout[MAX_KEYS_PER_CRYPT];
+
 		for (i = 0; i < MAX_KEYS_PER_CRYPT; ++i) {
 			lens[i] = strlen(saved_key[i+index]);
 			pin[i] = (unsigned char*)saved_key[i+index];
 			pout[i] = master[i];
 		}
-		pbkdf2_sha1_sse((const unsigned char **)pin, lens, cur_salt->salt[0], cur_salt->saltlen[0], cur_salt->iterations[0], pout, 16, 0);
+		pbkdf2_sha1_batch(pin, lens, MAX_KEYS_PER_CRYPT, cur_salt->salt[0], cur_salt->saltlen[0], cur_salt->iterations[0], pout, 16, 0);
 		for (i = 0; i < MAX_KEYS_PER_CRYPT; ++i) {
+#if !ARCH_LITTLE_ENDIAN
+			int j;
+			for (j = 0; j < 32/sizeof(ARCH_WORD_32); ++j)
+				((ARCH_WORD_32*)master[i])[j] = JOHNSWAP(((ARCH_WORD_32*)master[i])[j]);
+#endif
 			if(akcdecrypt(master[i], cur_salt->ct[0]) == 0)
 				cracked[i+index] = 1;
 			else
 				cracked[i+index] = 0;
 		}
-#else
-		unsigned char master[32];
-		pbkdf2_sha1((unsigned char *)saved_key[index],
-		       strlen(saved_key[index]),
-		       cur_salt->salt[0], cur_salt->saltlen[0],
-		       cur_salt->iterations[0], master, 16, 0);
-#if !ARCH_LITTLE_ENDIAN
-		{
-			int i;
-			for (i = 0; i < 32/sizeof(ARCH_WORD_32); ++i) {
-				((ARCH_WORD_32*)master)[i] = JOHNSWAP(((ARCH_WORD_32*)master)[i]);
-			}
-		}
-#endif
-		if(akcdecrypt(master, cur_salt->ct[0]) == 0)
-			cracked[index] = 1;
-		else
-			cracked[index] = 0;
-#endif
 	}
 	return count;
 }
@@ -560,9 +560,11 @@ AGAIN:
 		/* FIXME: Kludge for thin dynamics, and OpenCL formats */
 		/* c3_fmt also added, since it is a somewhat dynamic   */
 		/* format and needs init called to change the name     */
+		/* and bcrypt, which may pick its gather-based code    */
 		if ((format->params.flags & FMT_DYNAMIC) ||
 		    strstr(format->params.label, "-opencl") ||
-			strcmp(format->params.label, "crypt")==0 )
+			strcmp(format->params.label, "crypt")==0 ||
+			strcmp(format->params.label, "bcrypt")==0 )
 			fmt_init(format);
 
 #ifdef _OPENMP
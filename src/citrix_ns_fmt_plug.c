@@ -79,7 +79,7 @@ john_register_one(&fmt_ctrxns);
 #ifdef MMX_COEF
 #define MIN_KEYS_PER_CRYPT              NBKEYS
 #define MAX_KEYS_PER_CRYPT              NBKEYS
-#define GETPOS(i, index)                ((index & (MMX_COEF - 1)) * 4 + ((i) & (0xffffffff - 3)) * MMX_COEF + (((i) & 3) ^ 3) + (index >> (MMX_COEF >> 1)) * SHA_BUF_SIZ * MMX_COEF * 4) //for endianity conversion
+#define GETPOS(i, index)                ((index & (MMX_COEF - 1)) * 4 + ((i) & (0xffffffff - 3)) * MMX_COEF + (((i) & 3) ^ 3) + (index / MMX_COEF) * SHA_BUF_SIZ * MMX_COEF * 4) //for endianity conversion
 #else
 #define MIN_KEYS_PER_CRYPT              1
 #define MAX_KEYS_PER_CRYPT              1
@@ -211,7 +211,7 @@ key_cleaning:
 
 	len += 1; /* Trailing null is included */
 
-	((unsigned int*)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF] = len << 3;
+	((unsigned int*)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = len << 3;
 #else
 	strnzcpy(saved_plain[index], key, PLAINTEXT_LENGTH + 1);
 #endif
@@ -223,7 +223,7 @@ static char *get_key(int index)
 	unsigned int i, s;
 	static char out[PLAINTEXT_LENGTH + 1];
 
-	s = (((unsigned int*)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF] >> 3) - SALT_SIZE - 1;
+	s = (((unsigned int*)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] >> 3) - SALT_SIZE - 1;
 	for(i = 0; i < s; i++)
 		out[i] = ((char*)saved_key)[GETPOS(SALT_SIZE + i, index)];
 	out[i] = 0;
@@ -289,8 +289,8 @@ static int cmp_one(void *binary, int index)
 {
 #ifdef MMX_COEF
 	unsigned int x, y;
-	x = index & 3;
-	y = index / 4;
+	x = index & (MMX_COEF-1);
+	y = index / MMX_COEF;
 
 	if(((ARCH_WORD_32*)binary)[0] != ((ARCH_WORD_32*)crypt_key)[x + y * MMX_COEF*5])
 		return 0;
@@ -340,7 +340,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 }
 
 #ifdef MMX_COEF
-#define HASH_IDX ((index&3)+(index/4)*MMX_COEF*5)
+#define HASH_IDX ((index&(MMX_COEF-1))+(index/MMX_COEF)*MMX_COEF*5)
 static int get_hash_0(int index) { return ((ARCH_WORD_32*)crypt_key)[HASH_IDX] & 0xf; }
 static int get_hash_1(int index) { return ((ARCH_WORD_32*)crypt_key)[HASH_IDX] & 0xff; }
 static int get_hash_2(int index) { return ((ARCH_WORD_32*)crypt_key)[HASH_IDX] & 0xfff; }
@@ -32,7 +32,8 @@ john_register_one(&fmt_cloud_keychain);
 #include "johnswap.h"
 #include "stdint.h"
 #include "sha2.h"
-#include "pbkdf2_hmac_sha512.h"
+#include "sse-intrinsics.h"
+#include "pbkdf2_hmac.h"
 #ifdef _OPENMP
 #include <omp.h>
 #define OMP_SCALE               1
@@ -54,13 +55,8 @@ john_register_one(&fmt_cloud_keychain);
 #define PLAINTEXT_LENGTH	125
 #define SALT_SIZE		sizeof(struct custom_salt)
 #define SALT_ALIGN		4
-#ifdef MMX_COEF_SHA512
-#define MIN_KEYS_PER_CRYPT	SSE_GROUP_SZ_SHA512
-#define MAX_KEYS_PER_CRYPT	SSE_GROUP_SZ_SHA512
-#else
-#define MIN_KEYS_PER_CRYPT	1
-#define MAX_KEYS_PER_CRYPT	1
-#endif
+#define MIN_KEYS_PER_CRYPT	PBKDF2_SHA512_BATCH
+#define MAX_KEYS_PER_CRYPT	PBKDF2_SHA512_BATCH
 
 #define SALTLEN 32
 #define IVLEN 16
@@ -311,36 +307,25 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 #endif
 	for (index = 0; index < count; index += MAX_KEYS_PER_CRYPT)
 	{
-#ifdef SSE_GROUP_SZ_SHA512
-		int lens[SSE_GROUP_SZ_SHA512], i;
-		unsigned char *pin[SSE_GROUP_SZ_SHA512];
-		uint64_t key[SSE_GROUP_SZ_SHA512][8];
-		union {
-			ARCH_WORD_32 *pout[SSE_GROUP_SZ_SHA512];
-			unsigned char *poutc;
-		} x;
-		for (i = 0; i < SSE_GROUP_SZ_SHA512; ++i) {
+		uint64_t key[MAX_KEYS_PER_CRYPT][8];
+		const unsigned char *pin[MAX_KEYS_PER_CRYPT];
+		unsigned char *pout[MAX_KEYS_PER_CRYPT];
+		int lens[MAX_KEYS_PER_CRYPT], i;
+
+		for (i = 0; i < MAX_KEYS_PER_CRYPT; ++i) {
 			lens[i] = strlen(saved_key[index+i]);
 			pin[i] = (unsigned char*)saved_key[index+i];
-			x.pout[i] = (ARCH_WORD_32*)(key[i]);
+			pout[i] = (unsigned char*)(key[i]);
 		}
-		pbkdf2_sha512_sse((const unsigned char **)pin, lens, cur_salt->salt, cur_salt->saltlen, cur_salt->iterations, &(x.poutc), HASH_LENGTH, 0);
-		for (i = 0; i < SSE_GROUP_SZ_SHA512; ++i)
-			cracked[index+i] = ckcdecrypt((unsigned char*)(key[i]));
-#else
-		uint64_t key[8];
-		pbkdf2_sha512((const unsigned char*)(saved_key[index]), strlen(saved_key[index]),
-			cur_salt->salt, cur_salt->saltlen,
-			cur_salt->iterations, (unsigned char*)key, HASH_LENGTH, 0);
+		pbkdf2_sha512_batch(pin, lens, MAX_KEYS_PER_CRYPT, cur_salt->salt, cur_salt->saltlen, cur_salt->iterations, pout, HASH_LENGTH, 0);
+		for (i = 0; i < MAX_KEYS_PER_CRYPT; ++i) {
 #if ARCH_LITTLE_ENDIAN==0
-		{
 			int j;
 			for (j = 0; j < 8; ++j)
-				key[j] = JOHNSWAP64(key[j]);
-		}
-#endif
-		cracked[index] = ckcdecrypt((unsigned char*)key);
+				key[i][j] = JOHNSWAP64(key[i][j]);
 #endif
+			cracked[index+i] = ckcdecrypt((unsigned char*)(key[i]));
+		}
 	}
 	return count;
 }
@@ -841,6 +841,29 @@ int crk_process_key(char *key)
 	return ext_abort;
 }
 
+int crk_process_key_run(char *key, int pos, char *chars, int count)
+{
+	if (!crk_db->loaded) {
+		while (count--) {
+			key[pos] = *chars++;
+			if (crk_process_key(key))
+				return 1;
+		}
+		return 0;
+	}
+
+	while (count--) {
+		key[pos] = *chars++;
+		crk_methods.set_key(key, crk_key_index++);
+
+		if (crk_key_index >= crk_params.max_keys_per_crypt)
+		if (crk_salt_loop())
+			return 1;
+	}
+
+	return 0;
+}
+
 /* This function is used by single.c only */
 int crk_process_salt(struct db_salt *salt)
 {
@@ -33,6 +33,15 @@ extern void crk_init(struct db_main *db, void (*fix_state)(void),
  */
 extern int crk_process_key(char *key);
 
+/*
+ * Like crk_process_key(), for a run of keys that only differ in key[pos].
+ * Each of the count characters in chars is put there in turn. This saves
+ * a call per key for modes such as incremental, where the last character
+ * is the innermost loop. There is no external filter, the caller must
+ * use crk_process_key() if one is active.
+ */
+extern int crk_process_key_run(char *key, int pos, char *chars, int count);
+
 /*
  * Resets the guessed keys buffer and processes all the buffered keys for
  * this salt. The return value is the same as for crk_process_key().
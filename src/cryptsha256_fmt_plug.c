@@ -102,16 +102,6 @@ john_register_one(&fmt_cryptsha256);
 #include "johnswap.h"
 #include "sse-intrinsics.h"
 
-#ifdef MMX_COEF_SHA256
-// there are problems with SSE OMP builds.  Until found, simply do not allow OMP.
-//#undef _OPENMP
-//#undef FMT_OMP
-//#define FMT_OMP 0
-// Well, I tried by turning of OMP, but the run still failed.  So, I will simply
-// leave OMP on, but turn off SSE in an OMP build, until I get this figured out.
-//#undef MMX_COEF_SHA256
-#endif
-
 #ifdef _OPENMP
 #define OMP_SCALE			8
 #include <omp.h>
@@ -138,7 +128,6 @@ john_register_one(&fmt_cryptsha256);
 // then let the threads go on ALL data, without caring about the length, since each thread will only
 // be working on passwords in a single MMX buffer that all match, at any given moment.
 //
-#undef MMX_COEF_SHA256
 #ifdef MMX_COEF_SHA256
 #ifdef _OPENMP
 #define MMX_COEF_SCALE      (128/MMX_COEF_SHA256)
@@ -227,7 +216,7 @@ static int max_crypts;
 
 /* these 2 values are used in setup of the cryptloopstruct, AND to do our SHA256_Init() calls, in the inner loop */
 static const unsigned char padding[128] = { 0x80, 0 /* 0,0,0,0.... */ };
-#ifndef JTR_INC_COMMON_CRYPTO_SHA2
+#if !defined(JTR_INC_COMMON_CRYPTO_SHA2) && !defined(MMX_COEF_SHA256)
 static const ARCH_WORD_32 ctx_init[8] =
 	{0x6A09E667,0xBB67AE85,0x3C6EF372,0xA54FF53A,0x510E527F,0x9B05688C,0x1F83D9AB,0x5BE0CD19};
 #endif
@@ -298,8 +287,11 @@ static void LoadCryptStruct(cryptloopstruct *crypt_struct, int index, int idx, c
 	cryptloopstruct *pstr = crypt_struct;
 #ifdef MMX_COEF_SHA256
 	// in SSE mode, we FORCE every buffer to be 2 blocks, even if it COULD fit into 1.
-	// Then we simply use the 2 block SSE code.
+	// Then we simply use the 2 block SSE code.  Each 'type' holds MMX_COEF_SHA256
+	// 2 block lanes back to back (the SSEi_2BUF_INPUT layout), so skip to ours.
 	unsigned char *next_cp;
+
+	cp += idx*2*64;
 #endif
 
 	len_pc   = plen + BINARY_SIZE;
@@ -500,7 +492,7 @@ static void LoadCryptStruct(cryptloopstruct *crypt_struct, int index, int idx, c
 	pstr->cptr[idx][20] = cp + off_pc;
 	memcpy(cp, p_bytes, plen); cp += (plen+BINARY_SIZE);
 	if (!idx) pstr->datlen[21] = dlen_pc;
-	memcpy(cp, padding, tot_psc-2-len_pc);
+	memcpy(cp, padding, tot_pc-2-len_pc);
 	pstr->bufs[idx][21][tot_pc-2] = (len_pc<<3)>>8;
 	pstr->bufs[idx][21][tot_pc-1] = (len_pc<<3)&0xFF;
 
@@ -590,6 +582,17 @@ static void LoadCryptStruct(cryptloopstruct *crypt_struct, int index, int idx, c
 	if (!idx) pstr->datlen[41] = dlen_ppsc;
 }
 
+#ifdef MMX_COEF_SHA256
+// bit n is set if buffer type n (pc, ppsc, ppc, psc) needs 2 blocks
+static int block_sig(unsigned plen)
+{
+	return (plen + BINARY_SIZE > 55) |
+		((2*plen + cur_salt->len + BINARY_SIZE > 55) << 1) |
+		((2*plen + BINARY_SIZE > 55) << 2) |
+		((plen + cur_salt->len + BINARY_SIZE > 55) << 3);
+}
+#endif
+
 static int crypt_all(int *pcount, struct db_salt *salt)
 {
 	int count = *pcount;
@@ -604,23 +607,23 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 //	}
 
 #ifdef MMX_COEF_SHA256
-	// group based upon size splits.
-	MixOrder = mem_alloc(sizeof(int)*(count+5*MMX_COEF_SHA256));
+	// group based upon size splits.  Which of the 4 buffer types need a second
+	// block depends on the salt length too, so rather than fixed password length
+	// ranges we group on that 4 bit 'block signature' of each password.
+	MixOrder = mem_alloc(sizeof(int)*(count+16*MMX_COEF_SHA256));
 	{
-		const int lens[6] = {0,4,8,12,24,36};
 		int j;
 		tot_todo = 0;
 		saved_key_length[count] = 0; // point all 'tail' MMX buffer elements to this location.
-		for (j = 0; j < 5; ++j) {
+		for (j = 0; j < 16; ++j) {
 			for (index = 0; index < count; ++index) {
-				if (saved_key_length[index] >= lens[j] && saved_key_length[index] < lens[j+1])
+				if (block_sig(saved_key_length[index]) == j)
 					MixOrder[tot_todo++] = index;
 			}
 			while (tot_todo & (MMX_COEF_SHA256-1))
 				MixOrder[tot_todo++] = count;
 		}
 	}
-	printf ("tot_todo=%d count+5*MMX_COEF_SHA256=%d\n", tot_todo, count+5*MMX_COEF_SHA256);
 #else
 	// no need to mix. just run them one after the next, in any order.
 	MixOrder = mem_alloc(sizeof(int)*count);
@@ -647,9 +650,9 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 		char *cp;
 		char p_bytes[PLAINTEXT_LENGTH+1];
 		char s_bytes[PLAINTEXT_LENGTH+1];
-		JTR_ALIGN(16) cryptloopstruct crypt_struct;
+		JTR_ALIGN(MEM_ALIGN_SIMD) cryptloopstruct crypt_struct;
 #ifdef MMX_COEF_SHA256
-		JTR_ALIGN(16) ARCH_WORD_32 sse_out[64];
+		JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 sse_out[8*MMX_COEF_SHA256];
 #endif
 
 		for (idx = 0; idx < MAX_KEYS_PER_CRYPT; ++idx)
@@ -765,7 +768,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 				for (k = 0; k < MMX_COEF_SHA256; ++k) {
 					ARCH_WORD_32 *o = (ARCH_WORD_32 *)crypt_struct.cptr[k][idx];
 					for (j = 0; j < 8; ++j)
-						*o++ = JOHNSWAP(sse_out[(j<<(MMX_COEF_SHA256>>1))+k]);
+						*o++ = JOHNSWAP(sse_out[(j*MMX_COEF_SHA256)+k]);
 				}
 			}
 			if (++idx == 42)
@@ -776,7 +779,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 			for (k = 0; k < MMX_COEF_SHA256; ++k) {
 				ARCH_WORD_32 *o = (ARCH_WORD_32 *)crypt_out[MixOrder[index+k]];
 				for (j = 0; j < 8; ++j)
-					*o++ = JOHNSWAP(sse_out[(j<<(MMX_COEF_SHA256>>1))+k]);
+					*o++ = JOHNSWAP(sse_out[(j*MMX_COEF_SHA256)+k]);
 			}
 		}
 #else
@@ -27,6 +27,8 @@ john_register_one(&fmt_cryptsha512);
 #include "params.h"
 #include "common.h"
 #include "formats.h"
+#include "johnswap.h"
+#include "sse-intrinsics.h"
 // these MUST be defined prior to loading cryptsha512_valid.h
 #define BINARY_SIZE			64
 #define SALT_LENGTH			16
@@ -36,7 +38,9 @@ john_register_one(&fmt_cryptsha512);
 
 #define FORMAT_LABEL			"sha512crypt"
 
-#if ARCH_BITS >= 64
+#ifdef MMX_COEF_SHA512
+#define ALGORITHM_NAME			SHA512_ALGORITHM_NAME
+#elif ARCH_BITS >= 64
 #define ALGORITHM_NAME			"64/" ARCH_BITS_STR " " SHA2_LIB
 #else
 #define ALGORITHM_NAME			"32/" ARCH_BITS_STR " " SHA2_LIB
@@ -44,12 +48,32 @@ john_register_one(&fmt_cryptsha512);
 
 #define PLAINTEXT_LENGTH		125
 
+#ifdef MMX_COEF_SHA512
+// 79 character input is the MAX password for which all inner loop buffers fit
+// into 2 SHA512 blocks: 2*79 + 16 salt + 64 crypt, plus 1 for 0x80 and 16 byte
+// bit length is 255.  Longer ones are rare enough to be run the scalar way.
+#define SIMD_PLAINTEXT_LENGTH		79
+// Like sha256crypt, we need to group passwords on how many blocks they need,
+// so we want a good number of them per crypt_all() call even without OMP.
+#ifdef _OPENMP
+#define MMX_COEF_SCALE			(128/MMX_COEF_SHA512)
+#else
+#define MMX_COEF_SCALE			(256/MMX_COEF_SHA512)
+#endif
+#else
+#define MMX_COEF_SCALE			1
+#endif
+
 #define BINARY_ALIGN			4
 #define SALT_SIZE			sizeof(struct saltstruct)
 #define SALT_ALIGN			4
 
 #define MIN_KEYS_PER_CRYPT		1
+#ifdef MMX_COEF_SHA512
+#define MAX_KEYS_PER_CRYPT		MMX_COEF_SHA512
+#else
 #define MAX_KEYS_PER_CRYPT		1
+#endif
 
 static struct fmt_tests tests[] = {
 	{"$6$LKO/Ute40T3FNF95$6S/6T2YuOIHY0N3XpLKABJ3soYcXD9mB7uVbtEZDj/LNscVhZoZ9DEH.sBciDrMsHOWOoASbNLTypH/5X26gN0", "U*U*U*U*"},
@@ -58,6 +82,9 @@ static struct fmt_tests tests[] = {
 	{"$6$OmBOuxFYBZCYAadG$WCckkSZok9xhp4U1shIZEV7CCVwQUwMVea7L3A77th6SaE9jOPupEMJB.z0vIWCDiN9WLh2m9Oszrj5G.gt330", "*U*U*U*U"},
 	{"$6$ojWH1AiTee9x1peC$QVEnTvRVlPRhcLQCk/HnHaZmlGAAjCfrAN0FtOsOnUk5K5Bn/9eLHHiRzrTzaIKjW9NTLNIBUCtNVOowWS2mN.", ""},
 	{"$6$saltstring$svn8UoSVapNtMuq1ukKS4tPQd8iKwSMHWjl/O817G3uBnIFNjnQJuesI68u4OTLiBFdcbYEdFCoEOfaS35inz1", "Hello world!"},
+	// 2 block inner loop buffers, and a password too long for SIMD
+	{"$6$Jk4kE1pbfAQ5Gyf2$ZJOWyxIJUeKrrjWxMO7BJGD9X2r23Ntg.DkREKQH0rnUh4Qw3tl2pvYWUiHmkJl37O30oQKJBbNBil9c3gzr10", "The quick brown fox jumps over the lazy dog"},
+	{"$6$x9$DE3a0LZMQaYrgJv7rcsRh5Orqs6QyqT8k3CrWKyStQEmfWvsaw2LM/MrtbCXyRHPnrpoWZkCLoMRcnRRxcAO31", "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789!"},
 #ifdef DEBUG 
 	// Special test cases, the first two exceed the plain text length of the GPU implementations
 	//{"$6$va2Z2zTYTtF$1CzJmk3A2FO6aH.UrF2BU99oZOYcFlJu5ewPz7ZFvq0w3yCC2G9y4EsymHZxXe5e6Q7bPbyk4BQ5bekdVbmZ20", "123456789012345678901234"},
@@ -108,9 +135,12 @@ static void init(struct fmt_main *self)
 	omp_t *= OMP_SCALE;
 	self->params.max_keys_per_crypt *= omp_t;
 #endif
-	saved_key_length = mem_calloc_tiny(sizeof(*saved_key_length) * self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
-	saved_key = mem_calloc_tiny(sizeof(*saved_key) * self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
-	crypt_out = mem_calloc_tiny(sizeof(*crypt_out) * self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
+	self->params.max_keys_per_crypt *= MMX_COEF_SCALE;
+	// we allocate 1 more than needed, and use that 'extra' value as a zero length PW to fill in the
+	// tail groups in SIMD mode.
+	saved_key_length = mem_calloc_tiny(sizeof(*saved_key_length) * (1+self->params.max_keys_per_crypt), MEM_ALIGN_WORD);
+	saved_key = mem_calloc_tiny(sizeof(*saved_key) * (1+self->params.max_keys_per_crypt), MEM_ALIGN_WORD);
+	crypt_out = mem_calloc_tiny(sizeof(*crypt_out) * (1+self->params.max_keys_per_crypt), MEM_ALIGN_WORD);
 }
 
 static int get_hash_0(int index) { return crypt_out[index][0] & 0xf; }
@@ -136,136 +166,300 @@ static char *get_key(int index)
 	return saved_key[index];
 }
 
-static int crypt_all(int *pcount, struct db_salt *salt)
+/* Computes the intermediate result (into crypt_out[index]) and the P and S
+   byte sequences, everything the rounds loop needs. */
+static void crypt_prepare(int index, char *p_bytes, char *s_bytes)
 {
-	int count = *pcount;
-	int index = 0;
-#ifdef _OPENMP
-#pragma omp parallel for
-	for (index = 0; index < count; index++)
-#endif
-	{
-		// portably align temp_result char * pointer machine word size.
-		union xx {
-			unsigned char c[BINARY_SIZE];
-			ARCH_WORD a[BINARY_SIZE/sizeof(ARCH_WORD)];
-		} u;
-		unsigned char *temp_result = u.c;
-		SHA512_CTX ctx;
-		SHA512_CTX alt_ctx;
-		size_t cnt;
-		char *cp;
-		char p_bytes[PLAINTEXT_LENGTH+1];
-		char s_bytes[PLAINTEXT_LENGTH+1];
-
-		/* Prepare for the real work.  */
-		SHA512_Init(&ctx);
-
-		/* Add the key string.  */
-		SHA512_Update(&ctx, (unsigned char*)saved_key[index], saved_key_length[index]);
-
-		/* The last part is the salt string.  This must be at most 16
-		   characters and it ends at the first `$' character (for
-		   compatibility with existing implementations).  */
-		SHA512_Update(&ctx, cur_salt->salt, cur_salt->len);
-
-
-		/* Compute alternate SHA512 sum with input KEY, SALT, and KEY.  The
-		   final result will be added to the first context.  */
-		SHA512_Init(&alt_ctx);
-
-		/* Add key.  */
+	// portably align temp_result char * pointer machine word size.
+	union xx {
+		unsigned char c[BINARY_SIZE];
+		ARCH_WORD a[BINARY_SIZE/sizeof(ARCH_WORD)];
+	} u;
+	unsigned char *temp_result = u.c;
+	SHA512_CTX ctx;
+	SHA512_CTX alt_ctx;
+	size_t cnt;
+	char *cp;
+
+	/* Prepare for the real work.  */
+	SHA512_Init(&ctx);
+
+	/* Add the key string.  */
+	SHA512_Update(&ctx, (unsigned char*)saved_key[index], saved_key_length[index]);
+
+	/* The last part is the salt string.  This must be at most 16
+	   characters and it ends at the first `$' character (for
+	   compatibility with existing implementations).  */
+	SHA512_Update(&ctx, cur_salt->salt, cur_salt->len);
+
+
+	/* Compute alternate SHA512 sum with input KEY, SALT, and KEY.  The
+	   final result will be added to the first context.  */
+	SHA512_Init(&alt_ctx);
+
+	/* Add key.  */
+	SHA512_Update(&alt_ctx, (unsigned char*)saved_key[index], saved_key_length[index]);
+
+	/* Add salt.  */
+	SHA512_Update(&alt_ctx, cur_salt->salt, cur_salt->len);
+
+	/* Add key again.  */
+	SHA512_Update(&alt_ctx, (unsigned char*)saved_key[index], saved_key_length[index]);
+
+	/* Now get result of this (64 bytes) and add it to the other
+	   context.  */
+	SHA512_Final((unsigned char*)crypt_out[index], &alt_ctx);
+
+	/* Add for any character in the key one byte of the alternate sum.  */
+	for (cnt = saved_key_length[index]; cnt > BINARY_SIZE; cnt -= BINARY_SIZE)
+		SHA512_Update(&ctx, (unsigned char*)crypt_out[index], BINARY_SIZE);
+	SHA512_Update(&ctx, (unsigned char*)crypt_out[index], cnt);
+
+	/* Take the binary representation of the length of the key and for every
+	   1 add the alternate sum, for every 0 the key.  */
+	for (cnt = saved_key_length[index]; cnt > 0; cnt >>= 1)
+		if ((cnt & 1) != 0)
+			SHA512_Update(&ctx, (unsigned char*)crypt_out[index], BINARY_SIZE);
+		else
+			SHA512_Update(&ctx, (unsigned char*)saved_key[index], saved_key_length[index]);
+
+	/* Create intermediate result.  */
+	SHA512_Final((unsigned char*)crypt_out[index], &ctx);
+
+	/* Start computation of P byte sequence.  */
+	SHA512_Init(&alt_ctx);
+
+	/* For every character in the password add the entire password.  */
+	for (cnt = 0; cnt < saved_key_length[index]; ++cnt)
 		SHA512_Update(&alt_ctx, (unsigned char*)saved_key[index], saved_key_length[index]);
 
-		/* Add salt.  */
+	/* Finish the digest.  */
+	SHA512_Final(temp_result, &alt_ctx);
+
+	/* Create byte sequence P.  */
+	cp = p_bytes;
+	for (cnt = saved_key_length[index]; cnt >= BINARY_SIZE; cnt -= BINARY_SIZE)
+		cp = (char *) memcpy (cp, temp_result, BINARY_SIZE) + BINARY_SIZE;
+	memcpy (cp, temp_result, cnt);
+
+	/* Start computation of S byte sequence.  */
+	SHA512_Init(&alt_ctx);
+
+	/* For every character in the password add the entire password.  */
+	for (cnt = 0; cnt < 16 + ((unsigned char*)crypt_out[index])[0]; ++cnt)
 		SHA512_Update(&alt_ctx, cur_salt->salt, cur_salt->len);
 
-		/* Add key again.  */
-		SHA512_Update(&alt_ctx, (unsigned char*)saved_key[index], saved_key_length[index]);
+	/* Finish the digest.  */
+	SHA512_Final(temp_result, &alt_ctx);
+
+	/* Create byte sequence S.  */
+	cp = s_bytes;
+	for (cnt = cur_salt->len; cnt >= BINARY_SIZE; cnt -= BINARY_SIZE)
+		cp = (char *) memcpy (cp, temp_result, BINARY_SIZE) + BINARY_SIZE;
+	memcpy (cp, temp_result, cnt);
+}
 
-		/* Now get result of this (64 bytes) and add it to the other
-		   context.  */
-		SHA512_Final((unsigned char*)crypt_out[index], &alt_ctx);
+static void crypt_one(int index)
+{
+	SHA512_CTX ctx;
+	size_t cnt;
+	char p_bytes[PLAINTEXT_LENGTH+1];
+	char s_bytes[PLAINTEXT_LENGTH+1];
 
-		/* Add for any character in the key one byte of the alternate sum.  */
-		for (cnt = saved_key_length[index]; cnt > BINARY_SIZE; cnt -= BINARY_SIZE)
-			SHA512_Update(&ctx, (unsigned char*)crypt_out[index], BINARY_SIZE);
-		SHA512_Update(&ctx, (unsigned char*)crypt_out[index], cnt);
+	crypt_prepare(index, p_bytes, s_bytes);
+
+	/* Repeatedly run the collected hash value through SHA512 to
+	   burn CPU cycles.  */
+	for (cnt = 0; cnt < cur_salt->rounds; ++cnt)
+		{
+			/* New context.  */
+			SHA512_Init(&ctx);
+
+			/* Add key or last result.  */
+			if ((cnt & 1) != 0)
+				SHA512_Update(&ctx, p_bytes, saved_key_length[index]);
+			else
+				SHA512_Update(&ctx, (unsigned char*)crypt_out[index], BINARY_SIZE);
+
+			/* Add salt for numbers not divisible by 3.  */
+			if (cnt % 3 != 0)
+				SHA512_Update(&ctx, s_bytes, cur_salt->len);
+
+			/* Add key for numbers not divisible by 7.  */
+			if (cnt % 7 != 0)
+				SHA512_Update(&ctx, p_bytes, saved_key_length[index]);
 
-		/* Take the binary representation of the length of the key and for every
-		   1 add the alternate sum, for every 0 the key.  */
-		for (cnt = saved_key_length[index]; cnt > 0; cnt >>= 1)
+			/* Add key or last result.  */
 			if ((cnt & 1) != 0)
 				SHA512_Update(&ctx, (unsigned char*)crypt_out[index], BINARY_SIZE);
 			else
-				SHA512_Update(&ctx, (unsigned char*)saved_key[index], saved_key_length[index]);
-
-		/* Create intermediate result.  */
-		SHA512_Final((unsigned char*)crypt_out[index], &ctx);
-
-		/* Start computation of P byte sequence.  */
-		SHA512_Init(&alt_ctx);
-
-		/* For every character in the password add the entire password.  */
-		for (cnt = 0; cnt < saved_key_length[index]; ++cnt)
-			SHA512_Update(&alt_ctx, (unsigned char*)saved_key[index], saved_key_length[index]);
-
-		/* Finish the digest.  */
-		SHA512_Final(temp_result, &alt_ctx);
-
-		/* Create byte sequence P.  */
-		cp = p_bytes;
-		for (cnt = saved_key_length[index]; cnt >= BINARY_SIZE; cnt -= BINARY_SIZE)
-			cp = (char *) memcpy (cp, temp_result, BINARY_SIZE) + BINARY_SIZE;
-		memcpy (cp, temp_result, cnt);
-
-		/* Start computation of S byte sequence.  */
-		SHA512_Init(&alt_ctx);
-
-		/* For every character in the password add the entire password.  */
-		for (cnt = 0; cnt < 16 + ((unsigned char*)crypt_out[index])[0]; ++cnt)
-			SHA512_Update(&alt_ctx, cur_salt->salt, cur_salt->len);
-
-		/* Finish the digest.  */
-		SHA512_Final(temp_result, &alt_ctx);
-
-		/* Create byte sequence S.  */
-		cp = s_bytes;
-		for (cnt = cur_salt->len; cnt >= BINARY_SIZE; cnt -= BINARY_SIZE)
-			cp = (char *) memcpy (cp, temp_result, BINARY_SIZE) + BINARY_SIZE;
-		memcpy (cp, temp_result, cnt);
-
-		/* Repeatedly run the collected hash value through SHA512 to
-		   burn CPU cycles.  */
-		for (cnt = 0; cnt < cur_salt->rounds; ++cnt)
-			{
-				/* New context.  */
-				SHA512_Init(&ctx);
-
-				/* Add key or last result.  */
-				if ((cnt & 1) != 0)
-					SHA512_Update(&ctx, p_bytes, saved_key_length[index]);
-				else
-					SHA512_Update(&ctx, (unsigned char*)crypt_out[index], BINARY_SIZE);
-
-				/* Add salt for numbers not divisible by 3.  */
-				if (cnt % 3 != 0)
-					SHA512_Update(&ctx, s_bytes, cur_salt->len);
-
-				/* Add key for numbers not divisible by 7.  */
-				if (cnt % 7 != 0)
-					SHA512_Update(&ctx, p_bytes, saved_key_length[index]);
-
-				/* Add key or last result.  */
-				if ((cnt & 1) != 0)
-					SHA512_Update(&ctx, (unsigned char*)crypt_out[index], BINARY_SIZE);
-				else
-					SHA512_Update(&ctx, p_bytes, saved_key_length[index]);
-
-				/* Create intermediate [SIC] result.  */
-				SHA512_Final((unsigned char*)crypt_out[index], &ctx);
+				SHA512_Update(&ctx, p_bytes, saved_key_length[index]);
+
+			/* Create intermediate [SIC] result.  */
+			SHA512_Final((unsigned char*)crypt_out[index], &ctx);
+		}
+}
+
+#ifdef MMX_COEF_SHA512
+/* The 42 (2*3*7) round cycle of the inner loop only ever hashes 8 different
+   layouts of p (P bytes), s (S bytes) and c (prior crypt): c comes first on
+   even rounds and last on odd ones, s is there unless the round is divisible
+   by 3 and a second p unless it is divisible by 7.  As in sha256crypt, we
+   build these 8 buffers once per password, fully padded, and then only copy
+   each new crypt into the buffer of the next round. */
+#define ROUND_LAYOUT(r)	((((r)&1)<<2) | (((r)%3 != 0)<<1) | ((r)%7 != 0))
+
+typedef struct cryptloopstruct_t {
+	unsigned char buf[8*2*128*MMX_COEF_SHA512];	// 8 layouts of MMX_COEF_SHA512 2 block lanes (SSEi_2BUF_INPUT)
+	unsigned char *bufs[42];			// lane 0 of the buffer crypted in each round
+	unsigned char *cptr[MMX_COEF_SHA512][42];	// where the crypt of each round goes for the next one
+	int datlen[42];					// 128 or 256, the same for all lanes of a group
+} cryptloopstruct;
+
+// bit n is set if buffer type n (pc, ppsc, ppc, psc) needs 2 blocks
+static int block_sig(unsigned plen)
+{
+	return (plen + BINARY_SIZE > 111) |
+		((2*plen + cur_salt->len + BINARY_SIZE > 111) << 1) |
+		((2*plen + BINARY_SIZE > 111) << 2) |
+		((plen + cur_salt->len + BINARY_SIZE > 111) << 3);
+}
+
+static void LoadCryptStruct(cryptloopstruct *crypt_struct, int index, int idx, char *p_bytes, char *s_bytes)
+{
+	unsigned plen = saved_key_length[index];
+	unsigned slen = cur_salt->len;
+	unsigned char *start[8], *cpos[8];
+	int datlen[8];
+	int i;
+
+	for (i = 0; i < 8; ++i) {
+		unsigned char *cp = start[i] = &crypt_struct->buf[(i*MMX_COEF_SHA512+idx)*2*128];
+		unsigned len = plen + BINARY_SIZE + ((i&2) ? slen : 0) + ((i&1) ? plen : 0);
+
+		datlen[i] = (len <= 111) ? 128 : 256;
+		memset(cp, 0, datlen[i]);
+		if (i&4) {
+			memcpy(cp, p_bytes, plen); cp += plen;
+		} else {
+			cpos[i] = cp; cp += BINARY_SIZE;
+		}
+		if (i&2) {
+			memcpy(cp, s_bytes, slen); cp += slen;
+		}
+		if (i&1) {
+			memcpy(cp, p_bytes, plen); cp += plen;
+		}
+		if (i&4) {
+			cpos[i] = cp; cp += BINARY_SIZE;
+		} else {
+			memcpy(cp, p_bytes, plen); cp += plen;
+		}
+		*cp = 0x80;
+		start[i][datlen[i]-2] = (len<<3)>>8;
+		start[i][datlen[i]-1] = (len<<3)&0xFF;
+	}
+	// round 0 starts out from the intermediate result
+	memcpy(cpos[ROUND_LAYOUT(0)], crypt_out[index], BINARY_SIZE);
+
+	for (i = 0; i < 42; ++i) {
+		if (!idx) {
+			crypt_struct->bufs[i] = start[ROUND_LAYOUT(i)];
+			crypt_struct->datlen[i] = datlen[ROUND_LAYOUT(i)];
+		}
+		crypt_struct->cptr[idx][i] = cpos[ROUND_LAYOUT((i+1)%42)];
+	}
+}
+
+static void crypt_simd(int *order)
+{
+	JTR_ALIGN(MEM_ALIGN_SIMD) cryptloopstruct crypt_struct;
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_64 sse_out[8*MMX_COEF_SHA512];
+	char p_bytes[PLAINTEXT_LENGTH+1];
+	char s_bytes[PLAINTEXT_LENGTH+1];
+	unsigned int cnt;
+	int idx, j, k;
+
+	for (idx = 0; idx < MMX_COEF_SHA512; ++idx) {
+		crypt_prepare(order[idx], p_bytes, s_bytes);
+		LoadCryptStruct(&crypt_struct, order[idx], idx, p_bytes, s_bytes);
+	}
+
+	idx = 0;
+	for (cnt = 1; ; ++cnt) {
+		unsigned char *cp = crypt_struct.bufs[idx];
+
+		SSESHA512body((__m128i *)cp, sse_out, NULL, SSEi_FLAT_IN|SSEi_2BUF_INPUT_FIRST_BLK);
+		if (crypt_struct.datlen[idx] == 256)
+			SSESHA512body((__m128i *)&cp[128], sse_out, sse_out, SSEi_FLAT_IN|SSEi_2BUF_INPUT_FIRST_BLK|SSEi_RELOAD);
+
+		if (cnt == cur_salt->rounds)
+			break;
+		for (k = 0; k < MMX_COEF_SHA512; ++k) {
+			ARCH_WORD_64 *o = (ARCH_WORD_64 *)crypt_struct.cptr[k][idx];
+			for (j = 0; j < 8; ++j)
+				*o++ = JOHNSWAP64(sse_out[(j*MMX_COEF_SHA512)+k]);
+		}
+		if (++idx == 42)
+			idx = 0;
+	}
+	for (k = 0; k < MMX_COEF_SHA512; ++k) {
+		ARCH_WORD_64 *o = (ARCH_WORD_64 *)crypt_out[order[k]];
+		for (j = 0; j < 8; ++j)
+			*o++ = JOHNSWAP64(sse_out[(j*MMX_COEF_SHA512)+k]);
+	}
+}
+#endif
+
+static int crypt_all(int *pcount, struct db_salt *salt)
+{
+	int count = *pcount;
+	int index = 0;
+#ifdef MMX_COEF_SHA512
+	int *MixOrder, simd_todo, tot_todo;
+
+	// group based upon size splits, see sha256crypt.  Passwords too long
+	// for the 2 block buffers are put last, and done one at a time.
+	MixOrder = mem_alloc(sizeof(int)*(count+16*MMX_COEF_SHA512));
+	{
+		int j;
+		tot_todo = 0;
+		saved_key_length[count] = 0; // point all 'tail' SIMD buffer elements to this location.
+		for (j = 0; j < 16; ++j) {
+			for (index = 0; index < count; ++index) {
+				if (saved_key_length[index] <= SIMD_PLAINTEXT_LENGTH &&
+				    block_sig(saved_key_length[index]) == j)
+					MixOrder[tot_todo++] = index;
 			}
+			while (tot_todo & (MMX_COEF_SHA512-1))
+				MixOrder[tot_todo++] = count;
+		}
+		simd_todo = tot_todo;
+		for (index = 0; index < count; ++index)
+			if (saved_key_length[index] > SIMD_PLAINTEXT_LENGTH)
+				MixOrder[tot_todo++] = index;
 	}
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (index = 0; index < simd_todo; index += MMX_COEF_SHA512)
+		crypt_simd(&MixOrder[index]);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (index = simd_todo; index < tot_todo; index++)
+		crypt_one(MixOrder[index]);
+
+	MEM_FREE(MixOrder);
+#else
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (index = 0; index < count; index++)
+		crypt_one(index);
+#endif
 	return count;
 }
 
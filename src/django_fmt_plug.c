@@ -46,7 +46,8 @@ john_register_one(&fmt_django);
 #include "johnswap.h"
 #include "base64.h"
 #include "base64_convert.h"
-#include "pbkdf2_hmac_sha256.h"
+#include "sse-intrinsics.h"
+#include "pbkdf2_hmac.h"
 #ifdef _OPENMP
 #include <omp.h>
 #define OMP_SCALE               4 // tuned on core i7
@@ -70,13 +71,8 @@ static int omp_t = 1;
 #define BINARY_ALIGN	sizeof(ARCH_WORD_32)
 #define SALT_ALIGN		sizeof(int)
 
-#ifdef MMX_COEF_SHA256
-#define MIN_KEYS_PER_CRYPT	SSE_GROUP_SZ_SHA256
-#define MAX_KEYS_PER_CRYPT	SSE_GROUP_SZ_SHA256
-#else
-#define MIN_KEYS_PER_CRYPT	1
-#define MAX_KEYS_PER_CRYPT	1
-#endif
+#define MIN_KEYS_PER_CRYPT	PBKDF2_SHA256_BATCH
+#define MAX_KEYS_PER_CRYPT	PBKDF2_SHA256_BATCH
 
 static struct fmt_tests django_tests[] = {
 	{"$django$*1*pbkdf2_sha256$10000$qPmFbibfAY06$x/geVEkdZSlJMqvIYJ7G6i5l/6KJ0UpvLUU6cfj83VM=", "openwall"},
@@ -199,39 +195,28 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 {
 	int count = *pcount;
 	int index = 0;
+
 #ifdef _OPENMP
 #pragma omp parallel for
-	for (index = 0; index < count; index += MAX_KEYS_PER_CRYPT)
 #endif
+	for (index = 0; index < count; index += MAX_KEYS_PER_CRYPT)
 	{
-#ifdef MMX_COEF_SHA256
+		const unsigned char *pin[MAX_KEYS_PER_CRYPT];
+		unsigned char *pout[MAX_KEYS_PER_CRYPT];
 		int lens[MAX_KEYS_PER_CRYPT], i;
-		unsigned char *pin[MAX_KEYS_PER_CRYPT];
-		union {
-			ARCH_WORD_32 *pout[MAX_KEYS_PER_CRYPT];
-			unsigned char *poutc;
-		} x;
+
 		for (i = 0; i < MAX_KEYS_PER_CRYPT; ++i) {
-			lens[i] = strlen(saved_key[i+index]);
-			pin[i] = (unsigned char*)saved_key[i+index];
-			x.pout[i] = crypt_out[i+index];
+			lens[i] = strlen(saved_key[index+i]);
+			pin[i] = (unsigned char*)saved_key[index+i];
+			pout[i] = (unsigned char*)crypt_out[index+i];
 		}
-		pbkdf2_sha256_sse((const unsigned char **)pin, lens, cur_salt->salt, strlen((char*)cur_salt->salt), cur_salt->iterations, &(x.poutc), 32, 0);
-#else
-//		PKCS5_PBKDF2_HMAC(saved_key[index], strlen(saved_key[index]),
-//			cur_salt->salt, strlen((char*)cur_salt->salt),
-//			cur_salt->iterations, EVP_sha256(), 32, (unsigned char*)crypt_out[index]);
-
-		pbkdf2_sha256((unsigned char *)saved_key[index], strlen(saved_key[index]),
-			cur_salt->salt, strlen((char*)cur_salt->salt),
-			cur_salt->iterations, (unsigned char*)crypt_out[index], 32, 0);
+		pbkdf2_sha256_batch(pin, lens, MAX_KEYS_PER_CRYPT, cur_salt->salt, strlen((char*)cur_salt->salt), cur_salt->iterations, pout, 32, 0);
 #if !ARCH_LITTLE_ENDIAN
-		{
-			int i;
-			for (i = 0; i < 32/sizeof(ARCH_WORD_32); ++i)
-				((ARCH_WORD_32*)crypt_out[index])[i] = JOHNSWAP(((ARCH_WORD_32*)crypt_out[index])[i]);
+		for (i = 0; i < MAX_KEYS_PER_CRYPT; ++i) {
+			int j;
+			for (j = 0; j < 32/sizeof(ARCH_WORD_32); ++j)
+				crypt_out[index+i][j] = JOHNSWAP(crypt_out[index+i][j]);
 		}
-#endif
 #endif
 	}
 	return count;
@@ -14,6 +14,7 @@ extern struct fmt_main fmt_django_scrypt;
 john_register_one(&fmt_django_scrypt);
 #else
 
+#include <stdio.h>
 #include <string.h>
 #include "arch.h"
 #include "misc.h"
@@ -51,8 +52,9 @@ static int omp_t = 1;
 #define BINARY_ALIGN		4
 #define SALT_ALIGN		4
 
+/* Candidates are hashed in pairs, see escrypt_kdf_x2() */
 #define MIN_KEYS_PER_CRYPT	1
-#define MAX_KEYS_PER_CRYPT	1
+#define MAX_KEYS_PER_CRYPT	2
 
 /* notastrongpassword => scrypt$NBGmaGIXijJW$14$8$1$64$achPt01SbytSt+F3CcCFgEPr96+/j9iCTdejFdAARZ8mzfejrP64TJ5XBJa3gYwuCKOEGlw2E/lWCWS7LeS6CA== */
 
@@ -65,6 +67,9 @@ static struct fmt_tests scrypt_tests[] = {
 
 static char (*saved_key)[PLAINTEXT_LENGTH + 1];
 static ARCH_WORD_32 (*crypt_out)[BINARY_SIZE / sizeof(ARCH_WORD_32)];
+/* One V[] per pair of candidates, kept across calls */
+static escrypt_local_t *local;
+static int local_count;
 
 static struct custom_salt {
 	/* int type; */ // not used (another type probably required a new JtR format)
@@ -76,6 +81,8 @@ static struct custom_salt {
 
 static void init(struct fmt_main *self)
 {
+	int i;
+
 #ifdef _OPENMP
 	omp_t = omp_get_max_threads();
 	self->params.min_keys_per_crypt *= omp_t;
@@ -85,6 +92,20 @@ static void init(struct fmt_main *self)
 	saved_key = mem_calloc_tiny(sizeof(*saved_key) *
 			self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
 	crypt_out = mem_calloc_tiny(sizeof(*crypt_out) * self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
+
+	local_count = (self->params.max_keys_per_crypt + 1) / 2;
+	local = mem_alloc(sizeof(*local) * local_count);
+	for (i = 0; i < local_count; i++)
+		escrypt_init_local(&local[i]);
+}
+
+static void done(void)
+{
+	int i;
+
+	for (i = 0; i < local_count; i++)
+		escrypt_free_local(&local[i]);
+	MEM_FREE(local);
 }
 
 static int isDigits(char *p) {
@@ -181,27 +202,54 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 {
 	int count = *pcount;
 	int index = 0;
+	int failed = 0;
 
 #ifdef _OPENMP
 #pragma omp parallel for
-	for (index = 0; index < count; index++)
 #endif
+	for (index = 0; index < count; index += 2)
 	{
-		crypto_scrypt((unsigned char*)saved_key[index], strlen((char*)saved_key[index]),
-				cur_salt->salt, strlen((char*)cur_salt->salt),
-				(1ULL) << cur_salt->N, cur_salt->r,
-				cur_salt->p, (unsigned char*)crypt_out[index],
-				BINARY_SIZE);
+		const uint8_t *salt = cur_salt->salt;
+		size_t saltlen = strlen((char*)cur_salt->salt);
+
+		if (index + 1 < count) {
+			const uint8_t *passwd[2] = {
+				(uint8_t*)saved_key[index],
+				(uint8_t*)saved_key[index + 1]
+			};
+			const size_t passwdlen[2] = {
+				strlen((char*)saved_key[index]),
+				strlen((char*)saved_key[index + 1])
+			};
+			uint8_t *out[2] = {
+				(uint8_t*)crypt_out[index],
+				(uint8_t*)crypt_out[index + 1]
+			};
+
+			if (escrypt_kdf_x2(&local[index >> 1], passwd, passwdlen,
+			        salt, saltlen, (1ULL) << cur_salt->N,
+			        cur_salt->r, cur_salt->p, out, BINARY_SIZE))
+				failed = 1;
+		} else if (escrypt_kdf(&local[index >> 1],
+		        (uint8_t*)saved_key[index], strlen((char*)saved_key[index]),
+		        salt, saltlen, (1ULL) << cur_salt->N, cur_salt->r,
+		        cur_salt->p, (uint8_t*)crypt_out[index], BINARY_SIZE))
+			failed = 1;
+	}
+
+	if (failed) {
+		fprintf(stderr, "scrypt memory allocation failed\n");
+		error();
 	}
+
 	return count;
 }
 
 static int cmp_all(void *binary, int count)
 {
 	int index = 0;
-#ifdef _OPENMP
+
 	for (; index < count; index++)
-#endif
 		if (!memcmp(binary, crypt_out[index], BINARY_SIZE))
 			return 1;
 	return 0;
@@ -283,7 +331,7 @@ struct fmt_main fmt_django_scrypt = {
 		scrypt_tests
 	}, {
 		init,
-		fmt_default_done,
+		done,
 		fmt_default_reset,
 		fmt_default_prepare,
 		valid,
@@ -40,6 +40,11 @@
 #include "dynamic.h"
 #include "johnswap.h"
 #include "sse-intrinsics.h"
+#ifdef __SSE2__
+// sse-intrinsics.h made __m128i a void, for the SSE*body() prototypes
+#undef __m128i
+#include <emmintrin.h>
+#endif
 
 #if (AC_BUILT && HAVE_WHIRLPOOL) ||	\
    (!AC_BUILT && OPENSSL_VERSION_NUMBER >= 0x10000000 && !HAVE_NO_SSL_WHIRLPOOL)
@@ -127,8 +132,30 @@ void DynamicFunc__LargeHash_OUTMode_raw(DYNA_OMP_PARAMS) {
  *****  helpers.  Doing things like this will reduce the size of the large hash
  *****  primitive functions.
  ******************************************************************************/
+#ifdef __SSE2__
+// Base-16 of 16 bytes at once.  alpha is 'a'-'0'-10, or 'A'-'0'-10 for upper case.
+static inline void hex_out_16(unsigned char *cpi, unsigned char *cpo, char alpha) {
+	__m128i v = _mm_loadu_si128((__m128i*)cpi);
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0f));
+	__m128i lo = _mm_and_si128(v, _mm_set1_epi8(0x0f));
+	__m128i a = _mm_unpacklo_epi8(hi, lo);
+	__m128i b = _mm_unpackhi_epi8(hi, lo);
+
+	a = _mm_add_epi8(_mm_add_epi8(a, _mm_set1_epi8('0')),
+		_mm_and_si128(_mm_cmpgt_epi8(a, _mm_set1_epi8(9)), _mm_set1_epi8(alpha)));
+	b = _mm_add_epi8(_mm_add_epi8(b, _mm_set1_epi8('0')),
+		_mm_and_si128(_mm_cmpgt_epi8(b, _mm_set1_epi8(9)), _mm_set1_epi8(alpha)));
+	_mm_storeu_si128((__m128i*)cpo, a);
+	_mm_storeu_si128((__m128i*)(cpo+16), b);
+}
+#endif
+
 static inline unsigned char *hex_out_buf(unsigned char *cpi, unsigned char *cpo, int in_byte_cnt) {
 	int j;
+#ifdef __SSE2__
+	for (; in_byte_cnt >= 16; in_byte_cnt -= 16, cpi += 16, cpo += 32)
+		hex_out_16(cpi, cpo, dynamic_itoa16[10] - '0' - 10);
+#endif
 	for (j = 0; j < in_byte_cnt; ++j) {
 #if ARCH_ALLOWS_UNALIGNED
 		*((unsigned short*)cpo) = itoa16_w2[*cpi++];
@@ -144,6 +171,10 @@ static inline unsigned char *hex_out_buf(unsigned char *cpi, unsigned char *cpo,
 // NOTE, cpo must be at least in_byte_cnt*2 bytes of buffer
 static inline unsigned char *hexu_out_buf(unsigned char *cpi, unsigned char *cpo, int in_byte_cnt) {
 	int j;
+#ifdef __SSE2__
+	for (; in_byte_cnt >= 16; in_byte_cnt -= 16, cpi += 16, cpo += 32)
+		hex_out_16(cpi, cpo, 'A' - '0' - 10);
+#endif
 	for (j = 0; j < in_byte_cnt; ++j) {
 #if ARCH_ALLOWS_UNALIGNED
 		*((unsigned short*)cpo) = itoa16_w2_u[*cpi++];
@@ -335,7 +366,7 @@ static inline uint32_t DoMD5_FixBufferLen32(unsigned char *input_buf, int total_
 	return ret;
 }
 static void DoMD5_crypt_f_sse(void *in, int len[MD5_LOOPS], void *out) {
-	JTR_ALIGN(16) ARCH_WORD_32 a[(16*MD5_LOOPS)/sizeof(ARCH_WORD_32)];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 a[(16*MD5_LOOPS)/sizeof(ARCH_WORD_32)];
 	unsigned int i, j, loops[MD5_LOOPS], bMore, cnt;
 	unsigned char *cp = (unsigned char*)in;
 	for (i = 0; i < MD5_LOOPS; ++i) {
@@ -350,9 +381,9 @@ static void DoMD5_crypt_f_sse(void *in, int len[MD5_LOOPS], void *out) {
 		bMore = 0;
 		for (i = 0; i < MD5_LOOPS; ++i) {
 			if (cnt == loops[i]) {
-				unsigned int offx = ((i>>2)*16)+(i&3);
+				unsigned int offx = ((i/MMX_COEF)*4*MMX_COEF)+(i&(MMX_COEF-1));
 				for (j = 0; j < 4; ++j) {
-					((ARCH_WORD_32*)out)[(i<<2)+j] = a[(j<<2)+offx];
+					((ARCH_WORD_32*)out)[(i<<2)+j] = a[j*MMX_COEF+offx];
 				}
 			} else if (cnt < loops[i])
 				bMore = 1;
@@ -362,7 +393,7 @@ static void DoMD5_crypt_f_sse(void *in, int len[MD5_LOOPS], void *out) {
 	}
 }
 static void DoMD5_crypt_sse(void *in, int ilen[MD5_LOOPS], void *out[MD5_LOOPS], unsigned int *tot_len, int tid) {
-	JTR_ALIGN(16) ARCH_WORD_32 a[(16*MD5_LOOPS)/sizeof(ARCH_WORD_32)];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 a[(16*MD5_LOOPS)/sizeof(ARCH_WORD_32)];
 	union yy { unsigned char u[16]; ARCH_WORD_32 a[16/sizeof(ARCH_WORD_32)]; } y;
 	unsigned int i, j, loops[MD5_LOOPS], bMore, cnt;
 	unsigned char *cp = (unsigned char*)in;
@@ -378,9 +409,9 @@ static void DoMD5_crypt_sse(void *in, int ilen[MD5_LOOPS], void *out[MD5_LOOPS],
 		bMore = 0;
 		for (i = 0; i < MD5_LOOPS; ++i) {
 			if (cnt == loops[i]) {
-				unsigned int offx = ((i>>2)*16)+(i&3);
+				unsigned int offx = ((i/MMX_COEF)*4*MMX_COEF)+(i&(MMX_COEF-1));
 				for (j = 0; j < 4; ++j) {
-					y.a[j] = a[(j<<2)+offx];
+					y.a[j] = a[j*MMX_COEF+offx];
 				}
 				*(tot_len+i) += large_hash_output(y.u, &(((unsigned char*)out[i])[*(tot_len+i)]), 16, tid);
 			} else if (cnt < loops[i])
@@ -737,7 +768,7 @@ static inline uint32_t DoMD4_FixBufferLen32(unsigned char *input_buf, int total_
 	return ret;
 }
 static void DoMD4_crypt_f_sse(void *in, int len[MD4_LOOPS], void *out) {
-	JTR_ALIGN(16) ARCH_WORD_32 a[(16*MD4_LOOPS)/sizeof(ARCH_WORD_32)];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 a[(16*MD4_LOOPS)/sizeof(ARCH_WORD_32)];
 	unsigned int i, j, loops[MD4_LOOPS], bMore, cnt;
 	unsigned char *cp = (unsigned char*)in;
 	for (i = 0; i < MD4_LOOPS; ++i) {
@@ -752,9 +783,9 @@ static void DoMD4_crypt_f_sse(void *in, int len[MD4_LOOPS], void *out) {
 		bMore = 0;
 		for (i = 0; i < MD4_LOOPS; ++i) {
 			if (cnt == loops[i]) {
-				unsigned int offx = ((i>>2)*16)+(i&3);
+				unsigned int offx = ((i/MMX_COEF)*4*MMX_COEF)+(i&(MMX_COEF-1));
 				for (j = 0; j < 4; ++j) {
-					((ARCH_WORD_32*)out)[(i<<2)+j] = a[(j<<2)+offx];
+					((ARCH_WORD_32*)out)[(i<<2)+j] = a[j*MMX_COEF+offx];
 				}
 			} else if (cnt < loops[i])
 				bMore = 1;
@@ -764,7 +795,7 @@ static void DoMD4_crypt_f_sse(void *in, int len[MD4_LOOPS], void *out) {
 	}
 }
 static void DoMD4_crypt_sse(void *in, int ilen[MD4_LOOPS], void *out[MD4_LOOPS], unsigned int *tot_len, int tid) {
-	JTR_ALIGN(16) ARCH_WORD_32 a[(16*MD4_LOOPS)/sizeof(ARCH_WORD_32)];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 a[(16*MD4_LOOPS)/sizeof(ARCH_WORD_32)];
 	union yy { unsigned char u[16]; ARCH_WORD_32 a[16/sizeof(ARCH_WORD_32)]; } y;
 	unsigned int i, j, loops[MD4_LOOPS], bMore, cnt;
 	unsigned char *cp = (unsigned char*)in;
@@ -780,9 +811,9 @@ static void DoMD4_crypt_sse(void *in, int ilen[MD4_LOOPS], void *out[MD4_LOOPS],
 		bMore = 0;
 		for (i = 0; i < MD4_LOOPS; ++i) {
 			if (cnt == loops[i]) {
-				unsigned int offx = ((i>>2)*16)+(i&3);
+				unsigned int offx = ((i/MMX_COEF)*4*MMX_COEF)+(i&(MMX_COEF-1));
 				for (j = 0; j < 4; ++j) {
-					y.a[j] = a[(j<<2)+offx];
+					y.a[j] = a[j*MMX_COEF+offx];
 				}
 				*(tot_len+i) += large_hash_output(y.u, &(((unsigned char*)out[i])[*(tot_len+i)]), 16, tid);
 			} else if (cnt < loops[i])
@@ -1137,7 +1168,7 @@ static inline uint32_t DoSHA1_FixBufferLen32(unsigned char *input_buf, int total
 	return ret;
 }
 static void DoSHA1_crypt_f_sse(void *in, int len[SHA1_LOOPS], void *out) {
-	JTR_ALIGN(16) ARCH_WORD_32 a[(20*SHA1_LOOPS)/sizeof(ARCH_WORD_32)];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 a[(20*SHA1_LOOPS)/sizeof(ARCH_WORD_32)];
 	unsigned int i, j, loops[SHA1_LOOPS], bMore, cnt;
 	unsigned char *cp = (unsigned char*)in;
 	for (i = 0; i < SHA1_LOOPS; ++i) {
@@ -1152,9 +1183,9 @@ static void DoSHA1_crypt_f_sse(void *in, int len[SHA1_LOOPS], void *out) {
 		bMore = 0;
 		for (i = 0; i < SHA1_LOOPS; ++i) {
 			if (cnt == loops[i]) {
-				unsigned int offx = ((i>>2)*20)+(i&3);
+				unsigned int offx = ((i/MMX_COEF)*5*MMX_COEF)+(i&(MMX_COEF-1));
 				for (j = 0; j < 4; ++j) {
-					((ARCH_WORD_32*)out)[(i<<2)+j] = JOHNSWAP(a[(j<<2)+offx]);
+					((ARCH_WORD_32*)out)[(i<<2)+j] = JOHNSWAP(a[j*MMX_COEF+offx]);
 				}
 			} else if (cnt < loops[i])
 				bMore = 1;
@@ -1164,7 +1195,7 @@ static void DoSHA1_crypt_f_sse(void *in, int len[SHA1_LOOPS], void *out) {
 	}
 }
 static void DoSHA1_crypt_sse(void *in, int ilen[SHA1_LOOPS], void *out[SHA1_LOOPS], unsigned int *tot_len, int tid) {
-	JTR_ALIGN(16) ARCH_WORD_32 a[(20*SHA1_LOOPS)/sizeof(ARCH_WORD_32)];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 a[(20*SHA1_LOOPS)/sizeof(ARCH_WORD_32)];
 	union yy { unsigned char u[20]; ARCH_WORD_32 a[20/sizeof(ARCH_WORD_32)]; } y;
 	unsigned int i, j, loops[SHA1_LOOPS], bMore, cnt;
 	unsigned char *cp = (unsigned char*)in;
@@ -1180,9 +1211,9 @@ static void DoSHA1_crypt_sse(void *in, int ilen[SHA1_LOOPS], void *out[SHA1_LOOP
 		bMore = 0;
 		for (i = 0; i < SHA1_LOOPS; ++i) {
 			if (cnt == loops[i]) {
-				unsigned int offx = ((i>>2)*20)+(i&3);
+				unsigned int offx = ((i/MMX_COEF)*5*MMX_COEF)+(i&(MMX_COEF-1));
 				for (j = 0; j < 5; ++j) {
-					y.a[j] =JOHNSWAP(a[(j<<2)+offx]);
+					y.a[j] =JOHNSWAP(a[j*MMX_COEF+offx]);
 				}
 				*(tot_len+i) += large_hash_output(y.u, &(((unsigned char*)out[i])[*(tot_len+i)]), 20, tid);
 			} else if (cnt < loops[i])
@@ -1543,7 +1574,7 @@ static inline uint32_t DoSHA256_FixBufferLen32(unsigned char *input_buf, int tot
 	return ret;
 }
 static void DoSHA256_crypt_f_sse(void *in, int len[MMX_COEF_SHA256], void *out, int isSHA256) {
-	JTR_ALIGN(16) ARCH_WORD_32 a[(32*MMX_COEF_SHA256)/sizeof(ARCH_WORD_32)];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 a[(32*MMX_COEF_SHA256)/sizeof(ARCH_WORD_32)];
 	unsigned int i, j, loops[MMX_COEF_SHA256], bMore, cnt;
 	unsigned char *cp = (unsigned char*)in;
 	for (i = 0; i < MMX_COEF_SHA256; ++i) {
@@ -1559,7 +1590,7 @@ static void DoSHA256_crypt_f_sse(void *in, int len[MMX_COEF_SHA256], void *out,
 		for (i = 0; i < MMX_COEF_SHA256; ++i) {
 			if (cnt == loops[i]) {
 				for (j = 0; j < 4; ++j) {
-					((ARCH_WORD_32*)out)[(i<<2)+j] = JOHNSWAP(a[(j<<2)+i]);
+					((ARCH_WORD_32*)out)[(i<<2)+j] = JOHNSWAP(a[(j*MMX_COEF_SHA256)+i]);
 				}
 			} else if (cnt < loops[i])
 				bMore = 1;
@@ -1569,7 +1600,7 @@ static void DoSHA256_crypt_f_sse(void *in, int len[MMX_COEF_SHA256], void *out,
 	}
 }
 static void DoSHA256_crypt_sse(void *in, int ilen[MMX_COEF_SHA256], void *out[MMX_COEF_SHA256], unsigned int *tot_len, int isSHA256, int tid) {
-	JTR_ALIGN(16) ARCH_WORD_32 a[(32*MMX_COEF_SHA256)/sizeof(ARCH_WORD_32)];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 a[(32*MMX_COEF_SHA256)/sizeof(ARCH_WORD_32)];
 	union yy { unsigned char u[32]; ARCH_WORD_32 a[32/sizeof(ARCH_WORD_32)]; } y;
 	unsigned int i, j, loops[MMX_COEF_SHA256], bMore, cnt;
 	unsigned char *cp = (unsigned char*)in;
@@ -1586,7 +1617,7 @@ static void DoSHA256_crypt_sse(void *in, int ilen[MMX_COEF_SHA256], void *out[MM
 		for (i = 0; i < MMX_COEF_SHA256; ++i) {
 			if (cnt == loops[i]) {
 				for (j = 0; j < 8; ++j) {
-					y.a[j] =JOHNSWAP(a[(j<<2)+i]);
+					y.a[j] =JOHNSWAP(a[(j*MMX_COEF_SHA256)+i]);
 				}
 				*(tot_len+i) += large_hash_output(y.u, &(((unsigned char*)out[i])[*(tot_len+i)]), isSHA256?32:28, tid);
 			} else if (cnt < loops[i])
@@ -2202,11 +2233,133 @@ void DynamicFunc__SHA256_crypt_input2_to_output1_FINAL(DYNA_OMP_PARAMS){
 /********************************************************************
  ****  Here are the SHA384 and SHA512 functions!!!
  *******************************************************************/
-void DynamicFunc__SHA384_crypt_input1_append_input2(DYNA_OMP_PARAMS) {
+#ifdef MMX_COEF_SHA512
+
+static const int sha512_inc = MMX_COEF_SHA512;
+
+// Same as DoSHA256_FixBufferLen32, but for 128 byte blocks.  The 256 byte
+// dynamic buffer holds at most 2 blocks, so the caller has to keep anything
+// longer than 239 bytes off the SIMD path.
+static inline uint32_t DoSHA512_FixBufferLen64(unsigned char *input_buf, int total_len) {
+	uint64_t *p;
+	uint32_t ret = (total_len / 128) + 1;
+	if (total_len % 128 > 111)
+		++ret;
+	input_buf[total_len] = 0x80;
+	memset(&input_buf[total_len+1], 0, (ret<<7)-total_len-1);
+	p = (uint64_t *)input_buf;
+	p[(ret*16)-1] = JOHNSWAP64((uint64_t)total_len<<3);
+	return ret;
+}
+static void DoSHA512_crypt_f_sse(void *in, int len[MMX_COEF_SHA512], void *out, int isSHA512) {
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_64 a[8*MMX_COEF_SHA512];
+	unsigned int i, j, loops[MMX_COEF_SHA512], bMore, cnt;
+	unsigned char *cp = (unsigned char*)in;
+	for (i = 0; i < MMX_COEF_SHA512; ++i) {
+		if (len[i] > 239) {
+			union xx { unsigned char u[64]; ARCH_WORD_64 a[8]; } u;
+			SHA512_CTX ctx;
+			if (isSHA512)
+				SHA512_Init(&ctx);
+			else
+				SHA384_Init(&ctx);
+			SHA512_Update(&ctx, cp, len[i]);
+			SHA512_Final(u.u, &ctx);
+			memcpy(&((unsigned char*)out)[i<<4], u.u, 16);
+			loops[i] = 0;
+		} else
+			loops[i] = DoSHA512_FixBufferLen64(cp, len[i]);
+		cp += 256;
+	}
+	cp = (unsigned char*)in;
+	bMore = 1;
+	cnt = 1;
+	while (bMore) {
+		SSESHA512body(cp, a, a, SSEi_FLAT_IN|(isSHA512?0:SSEi_CRYPT_SHA384)|SSEi_2BUF_INPUT_FIRST_BLK|(cnt==1?0:SSEi_RELOAD));
+		bMore = 0;
+		for (i = 0; i < MMX_COEF_SHA512; ++i) {
+			if (cnt == loops[i]) {
+				for (j = 0; j < 2; ++j) {
+					((ARCH_WORD_64*)out)[(i<<1)+j] = JOHNSWAP64(a[(j*MMX_COEF_SHA512)+i]);
+				}
+			} else if (cnt < loops[i])
+				bMore = 1;
+		}
+		cp += 128;
+		++cnt;
+	}
+}
+static void DoSHA512_crypt_sse(void *in, int ilen[MMX_COEF_SHA512], void *out[MMX_COEF_SHA512], unsigned int *tot_len, int isSHA512, int tid) {
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_64 a[8*MMX_COEF_SHA512];
+	union yy { unsigned char u[64]; ARCH_WORD_64 a[8]; } y;
+	unsigned int i, j, loops[MMX_COEF_SHA512], bMore, cnt;
+	unsigned char *cp = (unsigned char*)in;
+	for (i = 0; i < MMX_COEF_SHA512; ++i) {
+		if (ilen[i] > 239) {
+			SHA512_CTX ctx;
+			if (isSHA512)
+				SHA512_Init(&ctx);
+			else
+				SHA384_Init(&ctx);
+			SHA512_Update(&ctx, cp, ilen[i]);
+			SHA512_Final(y.u, &ctx);
+			*(tot_len+i) += large_hash_output(y.u, &(((unsigned char*)out[i])[*(tot_len+i)]), isSHA512?64:48, tid);
+			loops[i] = 0;
+		} else
+			loops[i] = DoSHA512_FixBufferLen64(cp, ilen[i]);
+		cp += 256;
+	}
+	cp = (unsigned char*)in;
+	bMore = 1;
+	cnt = 1;
+	while (bMore) {
+		SSESHA512body(cp, a, a, SSEi_FLAT_IN|(isSHA512?0:SSEi_CRYPT_SHA384)|SSEi_2BUF_INPUT_FIRST_BLK|(cnt==1?0:SSEi_RELOAD));
+		bMore = 0;
+		for (i = 0; i < MMX_COEF_SHA512; ++i) {
+			if (cnt == loops[i]) {
+				for (j = 0; j < 8; ++j) {
+					y.a[j] = JOHNSWAP64(a[(j*MMX_COEF_SHA512)+i]);
+				}
+				*(tot_len+i) += large_hash_output(y.u, &(((unsigned char*)out[i])[*(tot_len+i)]), isSHA512?64:48, tid);
+			} else if (cnt < loops[i])
+				bMore = 1;
+		}
+		cp += 128;
+		++cnt;
+	}
+}
+#else
+
+static const int sha512_inc = 1;
+
+static void DoSHA512_crypt_f(void *in, int len, void *out, int isSHA512) {
 	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
-	int i, til;
+	unsigned char *crypt_out=u.u;
 	SHA512_CTX ctx;
+	if (isSHA512)
+		SHA512_Init(&ctx);
+	else
+		SHA384_Init(&ctx);
+	SHA512_Update(&ctx, in, len);
+	SHA512_Final(crypt_out, &ctx);
+	memcpy(out, crypt_out, 16);
+}
+static void DoSHA512_crypt(void *in, int ilen, void *out, unsigned int *tot_len, int isSHA512, int tid) {
+	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
+	unsigned char *crypt_out=u.u;
+	SHA512_CTX ctx;
+	if (isSHA512)
+		SHA512_Init(&ctx);
+	else
+		SHA384_Init(&ctx);
+	SHA512_Update(&ctx, in, ilen);
+	SHA512_Final(crypt_out, &ctx);
+	*tot_len += large_hash_output(crypt_out, &(((unsigned char*)out)[*tot_len]), isSHA512?64:48, tid);
+}
+#endif
+
+void DynamicFunc__SHA384_crypt_input1_append_input2(DYNA_OMP_PARAMS) {
+	int i, til;
 
 #ifdef _OPENMP
 	i = first;
@@ -2216,28 +2369,32 @@ void DynamicFunc__SHA384_crypt_input1_append_input2(DYNA_OMP_PARAMS) {
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA384_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA384_Update(&ctx, input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i]);
-			cpo = &(input_buf2_X86[i>>MD5_X2].x2.B2[total_len2_X86[i]]);
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x1.b;
 		}
+		DoSHA512_crypt_sse(input_buf_X86[i>>MD5_X2].x1.b, len, out, &(total_len2_X86[i]), 0, tid);
+#else
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i], input_buf2_X86[i>>MD5_X2].x2.b2, &(total_len2_X86[i]), 0, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i], input_buf2_X86[i>>MD5_X2].x1.b, &(total_len2_X86[i]), 0, tid);
 #endif
-		{
-			SHA384_Update(&ctx, input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i]);
-			cpo = &(input_buf2_X86[i>>MD5_X2].x1.B[total_len2_X86[i]]);
-		}
-		SHA384_Final(crypt_out, &ctx);
-		total_len2_X86[i] += large_hash_output(crypt_out, cpo, 48, tid);
 	}
 }
 void DynamicFunc__SHA512_crypt_input1_append_input2(DYNA_OMP_PARAMS) {
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2247,28 +2404,32 @@ void DynamicFunc__SHA512_crypt_input1_append_input2(DYNA_OMP_PARAMS) {
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA512_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA512_Update(&ctx, input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i]);
-			cpo = &(input_buf2_X86[i>>MD5_X2].x2.B2[total_len2_X86[i]]);
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x1.b;
 		}
+		DoSHA512_crypt_sse(input_buf_X86[i>>MD5_X2].x1.b, len, out, &(total_len2_X86[i]), 1, tid);
+#else
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i], input_buf2_X86[i>>MD5_X2].x2.b2, &(total_len2_X86[i]), 1, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i], input_buf2_X86[i>>MD5_X2].x1.b, &(total_len2_X86[i]), 1, tid);
 #endif
-		{
-			SHA512_Update(&ctx, input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i]);
-			cpo = &(input_buf2_X86[i>>MD5_X2].x1.B[total_len2_X86[i]]);
-		}
-		SHA512_Final(crypt_out, &ctx);
-		total_len2_X86[i] += large_hash_output(crypt_out, cpo, 64, tid);
 	}
 }
 void DynamicFunc__SHA384_crypt_input2_append_input1(DYNA_OMP_PARAMS) {
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2278,28 +2439,32 @@ void DynamicFunc__SHA384_crypt_input2_append_input1(DYNA_OMP_PARAMS) {
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA384_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA384_Update(&ctx, input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i]);
-			cpo = &(input_buf_X86[i>>MD5_X2].x2.B2[total_len_X86[i]]);
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len2_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x1.b;
 		}
+		DoSHA512_crypt_sse(input_buf2_X86[i>>MD5_X2].x1.b, len, out, &(total_len_X86[i]), 0, tid);
+#else
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i], input_buf_X86[i>>MD5_X2].x2.b2, &(total_len_X86[i]), 0, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i], input_buf_X86[i>>MD5_X2].x1.b, &(total_len_X86[i]), 0, tid);
 #endif
-		{
-			SHA384_Update(&ctx, input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i]);
-			cpo = &(input_buf_X86[i>>MD5_X2].x1.B[total_len_X86[i]]);
-		}
-		SHA384_Final(crypt_out, &ctx);
-		total_len_X86[i] += large_hash_output(crypt_out, cpo, 48, tid);
 	}
 }
 void DynamicFunc__SHA512_crypt_input2_append_input1(DYNA_OMP_PARAMS) {
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2309,28 +2474,32 @@ void DynamicFunc__SHA512_crypt_input2_append_input1(DYNA_OMP_PARAMS) {
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA512_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA512_Update(&ctx, input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i]);
-			cpo = &(input_buf_X86[i>>MD5_X2].x2.B2[total_len_X86[i]]);
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len2_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x1.b;
 		}
+		DoSHA512_crypt_sse(input_buf2_X86[i>>MD5_X2].x1.b, len, out, &(total_len_X86[i]), 1, tid);
+#else
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i], input_buf_X86[i>>MD5_X2].x2.b2, &(total_len_X86[i]), 1, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i], input_buf_X86[i>>MD5_X2].x1.b, &(total_len_X86[i]), 1, tid);
 #endif
-		{
-			SHA512_Update(&ctx, input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i]);
-			cpo = &(input_buf_X86[i>>MD5_X2].x1.B[total_len_X86[i]]);
-		}
-		SHA512_Final(crypt_out, &ctx);
-		total_len_X86[i] += large_hash_output(crypt_out, cpo, 64, tid);
 	}
 }
-void DynamicFunc__SHA384_crypt_input1_overwrite_input1(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
+void DynamicFunc__SHA384_crypt_input1_overwrite_input1(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2340,28 +2509,38 @@ void DynamicFunc__SHA384_crypt_input1_overwrite_input1(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA384_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA384_Update(&ctx, input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i]);
-			cpo = input_buf_X86[i>>MD5_X2].x2.B2;
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		unsigned int x[MMX_COEF_SHA512];
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x1.b;
+			x[j] = 0;
 		}
+		DoSHA512_crypt_sse(input_buf_X86[i>>MD5_X2].x1.b, len, out, x, 0, tid);
+		for (j = 0; j < MMX_COEF_SHA512; ++j)
+			total_len_X86[i+j] = x[j];
+#else
+		unsigned int x = 0;
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i], input_buf_X86[i>>MD5_X2].x2.b2, &x, 0, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i], input_buf_X86[i>>MD5_X2].x1.b, &x, 0, tid);
+		total_len_X86[i] = x;
 #endif
-		{
-			SHA384_Update(&ctx, input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i]);
-			cpo = input_buf_X86[i>>MD5_X2].x1.B;
-		}
-		SHA384_Final(crypt_out, &ctx);
-		total_len_X86[i] = large_hash_output(crypt_out, cpo, 48, tid);
 	}
 }
-void DynamicFunc__SHA512_crypt_input1_overwrite_input1(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
+void DynamicFunc__SHA512_crypt_input1_overwrite_input1(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2371,28 +2550,38 @@ void DynamicFunc__SHA512_crypt_input1_overwrite_input1(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA512_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA512_Update(&ctx, input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i]);
-			cpo = input_buf_X86[i>>MD5_X2].x2.B2;
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		unsigned int x[MMX_COEF_SHA512];
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x1.b;
+			x[j] = 0;
 		}
+		DoSHA512_crypt_sse(input_buf_X86[i>>MD5_X2].x1.b, len, out, x, 1, tid);
+		for (j = 0; j < MMX_COEF_SHA512; ++j)
+			total_len_X86[i+j] = x[j];
+#else
+		unsigned int x = 0;
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i], input_buf_X86[i>>MD5_X2].x2.b2, &x, 1, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i], input_buf_X86[i>>MD5_X2].x1.b, &x, 1, tid);
+		total_len_X86[i] = x;
 #endif
-		{
-			SHA512_Update(&ctx, input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i]);
-			cpo = input_buf_X86[i>>MD5_X2].x1.B;
-		}
-		SHA512_Final(crypt_out, &ctx);
-		total_len_X86[i] = large_hash_output(crypt_out, cpo, 64, tid);
 	}
 }
-void DynamicFunc__SHA384_crypt_input1_overwrite_input2(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
+void DynamicFunc__SHA384_crypt_input1_overwrite_input2(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2402,28 +2591,38 @@ void DynamicFunc__SHA384_crypt_input1_overwrite_input2(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA384_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA384_Update(&ctx, input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i]);
-			cpo = input_buf2_X86[i>>MD5_X2].x2.B2;
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		unsigned int x[MMX_COEF_SHA512];
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x1.b;
+			x[j] = 0;
 		}
+		DoSHA512_crypt_sse(input_buf_X86[i>>MD5_X2].x1.b, len, out, x, 0, tid);
+		for (j = 0; j < MMX_COEF_SHA512; ++j)
+			total_len2_X86[i+j] = x[j];
+#else
+		unsigned int x = 0;
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i], input_buf2_X86[i>>MD5_X2].x2.b2, &x, 0, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i], input_buf2_X86[i>>MD5_X2].x1.b, &x, 0, tid);
+		total_len2_X86[i] = x;
 #endif
-		{
-			SHA384_Update(&ctx, input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i]);
-			cpo = input_buf2_X86[i>>MD5_X2].x1.B;
-		}
-		SHA384_Final(crypt_out, &ctx);
-		total_len2_X86[i] = large_hash_output(crypt_out, cpo, 48, tid);
 	}
 }
-void DynamicFunc__SHA512_crypt_input1_overwrite_input2(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
+void DynamicFunc__SHA512_crypt_input1_overwrite_input2(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2433,28 +2632,38 @@ void DynamicFunc__SHA512_crypt_input1_overwrite_input2(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA512_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA512_Update(&ctx, input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i]);
-			cpo = input_buf2_X86[i>>MD5_X2].x2.B2;
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		unsigned int x[MMX_COEF_SHA512];
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x1.b;
+			x[j] = 0;
 		}
+		DoSHA512_crypt_sse(input_buf_X86[i>>MD5_X2].x1.b, len, out, x, 1, tid);
+		for (j = 0; j < MMX_COEF_SHA512; ++j)
+			total_len2_X86[i+j] = x[j];
+#else
+		unsigned int x = 0;
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i], input_buf2_X86[i>>MD5_X2].x2.b2, &x, 1, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i], input_buf2_X86[i>>MD5_X2].x1.b, &x, 1, tid);
+		total_len2_X86[i] = x;
 #endif
-		{
-			SHA512_Update(&ctx, input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i]);
-			cpo = input_buf2_X86[i>>MD5_X2].x1.B;
-		}
-		SHA512_Final(crypt_out, &ctx);
-		total_len2_X86[i] = large_hash_output(crypt_out, cpo, 64, tid);
 	}
 }
-void DynamicFunc__SHA384_crypt_input2_overwrite_input1(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
+void DynamicFunc__SHA384_crypt_input2_overwrite_input1(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2464,28 +2673,38 @@ void DynamicFunc__SHA384_crypt_input2_overwrite_input1(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA384_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA384_Update(&ctx, input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i]);
-			cpo = input_buf_X86[i>>MD5_X2].x2.B2;
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		unsigned int x[MMX_COEF_SHA512];
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len2_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x1.b;
+			x[j] = 0;
 		}
+		DoSHA512_crypt_sse(input_buf2_X86[i>>MD5_X2].x1.b, len, out, x, 0, tid);
+		for (j = 0; j < MMX_COEF_SHA512; ++j)
+			total_len_X86[i+j] = x[j];
+#else
+		unsigned int x = 0;
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i], input_buf_X86[i>>MD5_X2].x2.b2, &x, 0, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i], input_buf_X86[i>>MD5_X2].x1.b, &x, 0, tid);
+		total_len_X86[i] = x;
 #endif
-		{
-			SHA384_Update(&ctx, input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i]);
-			cpo = input_buf_X86[i>>MD5_X2].x1.B;
-		}
-		SHA384_Final(crypt_out, &ctx);
-		total_len_X86[i] = large_hash_output(crypt_out, cpo, 48, tid);
 	}
 }
-void DynamicFunc__SHA512_crypt_input2_overwrite_input1(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
+void DynamicFunc__SHA512_crypt_input2_overwrite_input1(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2495,28 +2714,38 @@ void DynamicFunc__SHA512_crypt_input2_overwrite_input1(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA512_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA512_Update(&ctx, input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i]);
-			cpo = input_buf_X86[i>>MD5_X2].x2.B2;
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		unsigned int x[MMX_COEF_SHA512];
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len2_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf_X86[(i+j)>>MD5_X2].x1.b;
+			x[j] = 0;
 		}
+		DoSHA512_crypt_sse(input_buf2_X86[i>>MD5_X2].x1.b, len, out, x, 1, tid);
+		for (j = 0; j < MMX_COEF_SHA512; ++j)
+			total_len_X86[i+j] = x[j];
+#else
+		unsigned int x = 0;
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i], input_buf_X86[i>>MD5_X2].x2.b2, &x, 1, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i], input_buf_X86[i>>MD5_X2].x1.b, &x, 1, tid);
+		total_len_X86[i] = x;
 #endif
-		{
-			SHA512_Update(&ctx, input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i]);
-			cpo = input_buf_X86[i>>MD5_X2].x1.B;
-		}
-		SHA512_Final(crypt_out, &ctx);
-		total_len_X86[i] = large_hash_output(crypt_out, cpo, 64, tid);
 	}
 }
-void DynamicFunc__SHA384_crypt_input2_overwrite_input2(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[56]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
+void DynamicFunc__SHA384_crypt_input2_overwrite_input2(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2526,28 +2755,38 @@ void DynamicFunc__SHA384_crypt_input2_overwrite_input2(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA384_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA384_Update(&ctx, input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i]);
-			cpo = input_buf2_X86[i>>MD5_X2].x2.B2;
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		unsigned int x[MMX_COEF_SHA512];
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len2_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x1.b;
+			x[j] = 0;
 		}
+		DoSHA512_crypt_sse(input_buf2_X86[i>>MD5_X2].x1.b, len, out, x, 0, tid);
+		for (j = 0; j < MMX_COEF_SHA512; ++j)
+			total_len2_X86[i+j] = x[j];
+#else
+		unsigned int x = 0;
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i], input_buf2_X86[i>>MD5_X2].x2.b2, &x, 0, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i], input_buf2_X86[i>>MD5_X2].x1.b, &x, 0, tid);
+		total_len2_X86[i] = x;
 #endif
-		{
-			SHA384_Update(&ctx, input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i]);
-			cpo = input_buf2_X86[i>>MD5_X2].x1.B;
-		}
-		SHA384_Final(crypt_out, &ctx);
-		total_len2_X86[i] = large_hash_output(crypt_out, cpo, 48, tid);
 	}
 }
-void DynamicFunc__SHA512_crypt_input2_overwrite_input2(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u, *cpo;
+void DynamicFunc__SHA512_crypt_input2_overwrite_input2(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2557,28 +2796,38 @@ void DynamicFunc__SHA512_crypt_input2_overwrite_input2(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA512_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1) {
-			SHA512_Update(&ctx, input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i]);
-			cpo = input_buf2_X86[i>>MD5_X2].x2.B2;
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+		int len[MMX_COEF_SHA512], j;
+		unsigned int x[MMX_COEF_SHA512];
+		void *out[MMX_COEF_SHA512];
+		for (j = 0; j < MMX_COEF_SHA512; ++j) {
+			len[j] = total_len2_X86[i+j];
+			#if (MD5_X2)
+			if (j&1)
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x2.b2;
+			else
+			#endif
+				out[j] = input_buf2_X86[(i+j)>>MD5_X2].x1.b;
+			x[j] = 0;
 		}
+		DoSHA512_crypt_sse(input_buf2_X86[i>>MD5_X2].x1.b, len, out, x, 1, tid);
+		for (j = 0; j < MMX_COEF_SHA512; ++j)
+			total_len2_X86[i+j] = x[j];
+#else
+		unsigned int x = 0;
+		#if (MD5_X2)
+		if (i & 1)
+			DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i], input_buf2_X86[i>>MD5_X2].x2.b2, &x, 1, tid);
 		else
+		#endif
+		DoSHA512_crypt(input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i], input_buf2_X86[i>>MD5_X2].x1.b, &x, 1, tid);
+		total_len2_X86[i] = x;
 #endif
-		{
-			SHA512_Update(&ctx, input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i]);
-			cpo = input_buf2_X86[i>>MD5_X2].x1.B;
-		}
-		SHA512_Final(crypt_out, &ctx);
-		total_len2_X86[i] = large_hash_output(crypt_out, cpo, 64, tid);
 	}
 }
-void DynamicFunc__SHA384_crypt_input1_to_output1_FINAL(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u;
+void DynamicFunc__SHA384_crypt_input1_to_output1_FINAL(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2587,37 +2836,24 @@ void DynamicFunc__SHA384_crypt_input1_to_output1_FINAL(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA384_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1)
-			SHA384_Update(&ctx, input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i]);
-		else
-#endif
-			SHA384_Update(&ctx, input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i]);
-		SHA384_Final(crypt_out, &ctx);
-
-		// Only copies the first 16 out of 28 bytes.  Thus we do not have
-		// the entire SHA384. It would NOT be valid to continue from here. However
-		// it is valid (and 128 bit safe), to simply check the first 128 bits
-		// of SHA384 hash (vs the whole 384 bits), with cmp_all/cmp_one, and if it
-		// matches, then we can 'assume' we have a hit.
-		// That is why the name of the function is *_FINAL()  it is meant to be
-		// something like sha1(md5($p))  and then we simply compare 16 bytes
-		// of hash (instead of the full 28).
-#if (MD5_X2)
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+	int len[MMX_COEF_SHA512], j;
+	for (j = 0; j < MMX_COEF_SHA512; ++j)
+		len[j] = total_len_X86[i+j];
+	DoSHA512_crypt_f_sse(input_buf_X86[i>>MD5_X2].x1.b, len, crypt_key_X86[i>>MD5_X2].x1.b, 0);
+#else
+	#if (MD5_X2)
 		if (i & 1)
-			memcpy(crypt_key_X86[i>>MD5_X2].x2.b2, crypt_out, 16);
+			DoSHA512_crypt_f(input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i], crypt_key_X86[i>>MD5_X2].x2.b2, 0);
 		else
+	#endif
+		DoSHA512_crypt_f(input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i], crypt_key_X86[i>>MD5_X2].x1.b, 0);
 #endif
-			memcpy(crypt_key_X86[i>>MD5_X2].x1.b, crypt_out, 16);
 	}
 }
-void DynamicFunc__SHA512_crypt_input1_to_output1_FINAL(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u;
+void DynamicFunc__SHA512_crypt_input1_to_output1_FINAL(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2626,37 +2862,24 @@ void DynamicFunc__SHA512_crypt_input1_to_output1_FINAL(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA512_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1)
-			SHA512_Update(&ctx, input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i]);
-		else
-#endif
-			SHA512_Update(&ctx, input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i]);
-		SHA512_Final(crypt_out, &ctx);
-
-		// Only copies the first 16 out of 32 bytes.  Thus we do not have
-		// the entire SHA512. It would NOT be valid to continue from here. However
-		// it is valid (and 128 bit safe), to simply check the first 128 bits
-		// of SHA512 hash (vs the whole 512 bits), with cmp_all/cmp_one, and if it
-		// matches, then we can 'assume' we have a hit.
-		// That is why the name of the function is *_FINAL()  it is meant to be
-		// something like sha1(md5($p))  and then we simply compare 16 bytes
-		// of hash (instead of the full 32).
-#if (MD5_X2)
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+	int len[MMX_COEF_SHA512], j;
+	for (j = 0; j < MMX_COEF_SHA512; ++j)
+		len[j] = total_len_X86[i+j];
+	DoSHA512_crypt_f_sse(input_buf_X86[i>>MD5_X2].x1.b, len, crypt_key_X86[i>>MD5_X2].x1.b, 1);
+#else
+	#if (MD5_X2)
 		if (i & 1)
-			memcpy(crypt_key_X86[i>>MD5_X2].x2.b2, crypt_out, 16);
+			DoSHA512_crypt_f(input_buf_X86[i>>MD5_X2].x2.b2, total_len_X86[i], crypt_key_X86[i>>MD5_X2].x2.b2, 1);
 		else
+	#endif
+		DoSHA512_crypt_f(input_buf_X86[i>>MD5_X2].x1.b, total_len_X86[i], crypt_key_X86[i>>MD5_X2].x1.b, 1);
 #endif
-			memcpy(crypt_key_X86[i>>MD5_X2].x1.b, crypt_out, 16);
 	}
 }
-void DynamicFunc__SHA384_crypt_input2_to_output1_FINAL(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u;
+void DynamicFunc__SHA384_crypt_input2_to_output1_FINAL(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2665,37 +2888,24 @@ void DynamicFunc__SHA384_crypt_input2_to_output1_FINAL(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA384_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1)
-			SHA384_Update(&ctx, input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i]);
-		else
-#endif
-			SHA384_Update(&ctx, input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i]);
-		SHA384_Final(crypt_out, &ctx);
-
-		// Only copies the first 16 out of 28 bytes.  Thus we do not have
-		// the entire SHA384. It would NOT be valid to continue from here. However
-		// it is valid (and 128 bit safe), to simply check the first 128 bits
-		// of SHA384 hash (vs the whole 384 bits), with cmp_all/cmp_one, and if it
-		// matches, then we can 'assume' we have a hit.
-		// That is why the name of the function is *_FINAL()  it is meant to be
-		// something like sha1(md5($p))  and then we simply compare 16 bytes
-		// of hash (instead of the full 28).
-#if (MD5_X2)
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+	int len[MMX_COEF_SHA512], j;
+	for (j = 0; j < MMX_COEF_SHA512; ++j)
+		len[j] = total_len2_X86[i+j];
+	DoSHA512_crypt_f_sse(input_buf2_X86[i>>MD5_X2].x1.b, len, crypt_key_X86[i>>MD5_X2].x1.b, 0);
+#else
+	#if (MD5_X2)
 		if (i & 1)
-			memcpy(crypt_key_X86[i>>MD5_X2].x2.b2, crypt_out, 16);
+			DoSHA512_crypt_f(input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i], crypt_key_X86[i>>MD5_X2].x2.b2, 0);
 		else
+	#endif
+		DoSHA512_crypt_f(input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i], crypt_key_X86[i>>MD5_X2].x1.b, 0);
 #endif
-			memcpy(crypt_key_X86[i>>MD5_X2].x1.b, crypt_out, 16);
 	}
 }
-void DynamicFunc__SHA512_crypt_input2_to_output1_FINAL(DYNA_OMP_PARAMS){
-	union xx { unsigned char u[64]; ARCH_WORD a[64/sizeof(ARCH_WORD)]; } u;
-	unsigned char *crypt_out=u.u;
+void DynamicFunc__SHA512_crypt_input2_to_output1_FINAL(DYNA_OMP_PARAMS) {
 	int i, til;
-	SHA512_CTX ctx;
 
 #ifdef _OPENMP
 	i = first;
@@ -2704,30 +2914,20 @@ void DynamicFunc__SHA512_crypt_input2_to_output1_FINAL(DYNA_OMP_PARAMS){
 	i = 0;
 	til = m_count;
 #endif
-	for (; i < til; ++i) {
-		SHA512_Init(&ctx);
-#if (MD5_X2)
-		if (i & 1)
-			SHA512_Update(&ctx, input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i]);
-		else
-#endif
-			SHA512_Update(&ctx, input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i]);
-		SHA512_Final(crypt_out, &ctx);
-
-		// Only copies the first 16 out of 32 bytes.  Thus we do not have
-		// the entire SHA512. It would NOT be valid to continue from here. However
-		// it is valid (and 128 bit safe), to simply check the first 128 bits
-		// of SHA512 hash (vs the whole 512 bits), with cmp_all/cmp_one, and if it
-		// matches, then we can 'assume' we have a hit.
-		// That is why the name of the function is *_FINAL()  it is meant to be
-		// something like sha1(md5($p))  and then we simply compare 16 bytes
-		// of hash (instead of the full 32).
-#if (MD5_X2)
+	for (; i < til; i += sha512_inc) {
+#ifdef MMX_COEF_SHA512
+	int len[MMX_COEF_SHA512], j;
+	for (j = 0; j < MMX_COEF_SHA512; ++j)
+		len[j] = total_len2_X86[i+j];
+	DoSHA512_crypt_f_sse(input_buf2_X86[i>>MD5_X2].x1.b, len, crypt_key_X86[i>>MD5_X2].x1.b, 1);
+#else
+	#if (MD5_X2)
 		if (i & 1)
-			memcpy(crypt_key_X86[i>>MD5_X2].x2.b2, crypt_out, 16);
+			DoSHA512_crypt_f(input_buf2_X86[i>>MD5_X2].x2.b2, total_len2_X86[i], crypt_key_X86[i>>MD5_X2].x2.b2, 1);
 		else
+	#endif
+		DoSHA512_crypt_f(input_buf2_X86[i>>MD5_X2].x1.b, total_len2_X86[i], crypt_key_X86[i>>MD5_X2].x1.b, 1);
 #endif
-			memcpy(crypt_key_X86[i>>MD5_X2].x1.b, crypt_out, 16);
 	}
 }
 
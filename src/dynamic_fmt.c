@@ -224,8 +224,8 @@ static unsigned int *total_len2;
 
 #define MMX_INP_BUF_SZ    (sizeof(input_buf[0]) *BLOCK_LOOPS)
 #define MMX_INP_BUF2_SZ   (sizeof(input_buf2[0])*BLOCK_LOOPS)
-#define MMX_TOT_LEN_SZ    (sizeof(total_len[0]) *BLOCK_LOOPS)
-#define MMX_TOT_LEN2_SZ   (sizeof(total_len2[0])*BLOCK_LOOPS)
+#define MMX_TOT_LEN_SZ    (sizeof(total_len[0]) *BLOCK_LOOPS*MMX_COEF)
+#define MMX_TOT_LEN2_SZ   (sizeof(total_len2[0])*BLOCK_LOOPS*MMX_COEF)
 #define MMX_INP_BUF_SZ    (sizeof(input_buf[0]) *BLOCK_LOOPS)
 #define MMX_CRYPT_KEY_SZ  (sizeof(crypt_key[0]) *BLOCK_LOOPS+1)
 #define MMX_CRYPT_KEY2_SZ (sizeof(crypt_key2[0])*BLOCK_LOOPS)
@@ -818,19 +818,12 @@ static void init(struct fmt_main *pFmt)
 			total_len2_X86[i] = 32;
 #ifdef MMX_COEF
 		for (i = 0; i < BLOCK_LOOPS; ++i) {
-			input_buf2[i].c[GETPOS(32,0)] = 0x80;
-			input_buf2[i].c[GETPOS(57,0)] = 0x1;
-			input_buf2[i].c[GETPOS(32,1)] = 0x80;
-			input_buf2[i].c[GETPOS(57,1)] = 0x1;
-#if (MMX_COEF==4)
-			input_buf2[i].c[GETPOS(32,2)] = 0x80;
-			input_buf2[i].c[GETPOS(57,2)] = 0x1;
-			input_buf2[i].c[GETPOS(32,3)] = 0x80;
-			input_buf2[i].c[GETPOS(57,3)] = 0x1;
-			total_len2[i] = 0x20202020;
-#else
-			total_len2[i] = 0x00200020;
-#endif
+			int j;
+			for (j = 0; j < MMX_COEF; ++j) {
+				input_buf2[i].c[GETPOS(32,j)] = 0x80;
+				input_buf2[i].c[GETPOS(57,j)] = 0x1;
+				total_len2[i*MMX_COEF+j] = 32;
+			}
 		}
 #endif
 	}
@@ -1182,7 +1175,7 @@ static void set_key(char *key, int index)
 		if (dynamic_use_sse==1) {
 			// code derived from rawMD5_fmt_plug.c code from magnum
 			const ARCH_WORD_32 *key32 = (ARCH_WORD_32*)key;
-			unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+			unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 			ARCH_WORD_32 *keybuffer = &input_buf[idx].w[index&(MMX_COEF-1)];
 			ARCH_WORD_32 *keybuf_word = keybuffer;
 			unsigned int len;
@@ -1291,7 +1284,7 @@ static char *get_key(int index)
 		// Note, if we are not in
 		if (dynamic_use_sse && !curdat.md5_startup_in_x86) {
 			unsigned int s;
-			unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+			unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 //if (curdat.store_keys_in_input && dynamic_use_sse==1)
 
 //			s = saved_key_len[index];  // NOTE, we now have to get the length from the buffer, we do NOT store it into a saved_key_len buffer.
@@ -1330,17 +1323,13 @@ static int cmp_all(void *binary, int count)
 	unsigned int i;
 #ifdef MMX_COEF
 	if (dynamic_use_sse&1) {
-		unsigned int cnt = ( ((unsigned)count+MMX_COEF-1)>>(MMX_COEF>>1));
+		unsigned int cnt = ( ((unsigned)count+MMX_COEF-1)/MMX_COEF);
 		for (i = 0; i < cnt; ++i)
 		{
-			if(( *((ARCH_WORD_32 *)binary) == crypt_key[i].w[0])
-			|| ( *((ARCH_WORD_32 *)binary) == crypt_key[i].w[1])
-#if (MMX_COEF > 3)
-			|| ( *((ARCH_WORD_32 *)binary) == crypt_key[i].w[2])
-			|| ( *((ARCH_WORD_32 *)binary) == crypt_key[i].w[3])
-#endif
-			)
-				return 1;
+			unsigned int j;
+			for (j = 0; j < MMX_COEF; ++j)
+				if ( *((ARCH_WORD_32 *)binary) == crypt_key[i].w[j])
+					return 1;
 		}
 		return 0;
 	}
@@ -1369,17 +1358,13 @@ static int cmp_all_64_4x6(void *binary, int count)
 	unsigned int i;
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		unsigned int cnt = ( ((unsigned)count+MMX_COEF-1)>>(MMX_COEF>>1));
+		unsigned int cnt = ( ((unsigned)count+MMX_COEF-1)/MMX_COEF);
 		for (i = 0; i < cnt; ++i)
 		{
-			if(( *((ARCH_WORD_32 *)binary) == (crypt_key[i].w[0] & MASK_4x6))
-			|| ( *((ARCH_WORD_32 *)binary) == (crypt_key[i].w[1] & MASK_4x6))
-#if (MMX_COEF > 3)
-		        || ( *((ARCH_WORD_32 *)binary) == (crypt_key[i].w[2] & MASK_4x6))
-			|| ( *((ARCH_WORD_32 *)binary) == (crypt_key[i].w[3] & MASK_4x6))
-#endif
-			)
-				return 1;
+			unsigned int j;
+			for (j = 0; j < MMX_COEF; ++j)
+				if ( *((ARCH_WORD_32 *)binary) == (crypt_key[i].w[j] & MASK_4x6))
+					return 1;
 		}
 		return 0;
 	}
@@ -1415,7 +1400,7 @@ static int cmp_one(void *binary, int index)
 {
 #ifdef MMX_COEF
 	if (dynamic_use_sse&1) {
-		unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+		unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 		if( (((ARCH_WORD_32 *)binary)[0] == ((ARCH_WORD_32 *)&(crypt_key[idx].c))[0*MMX_COEF+(index&(MMX_COEF-1))]) &&
 			(((ARCH_WORD_32 *)binary)[1] == ((ARCH_WORD_32 *)&(crypt_key[idx].c))[1*MMX_COEF+(index&(MMX_COEF-1))]) &&
 			(((ARCH_WORD_32 *)binary)[2] == ((ARCH_WORD_32 *)&(crypt_key[idx].c))[2*MMX_COEF+(index&(MMX_COEF-1))]) &&
@@ -1446,7 +1431,7 @@ static int cmp_one_64_4x6(void *binary, int index)
 {
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+		unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 		if( (((ARCH_WORD_32 *)binary)[0] == (((ARCH_WORD_32 *)&(crypt_key[idx].c))[0*MMX_COEF+(index&(MMX_COEF-1))] & MASK_4x6)) &&
 			(((ARCH_WORD_32 *)binary)[1] == (((ARCH_WORD_32 *)&(crypt_key[idx].c))[1*MMX_COEF+(index&(MMX_COEF-1))] & MASK_4x6)) &&
 			(((ARCH_WORD_32 *)binary)[2] == (((ARCH_WORD_32 *)&(crypt_key[idx].c))[2*MMX_COEF+(index&(MMX_COEF-1))] & MASK_4x6)) &&
@@ -1737,7 +1722,7 @@ static int get_hash_0(int index)
 {
 #ifdef MMX_COEF
 	if (dynamic_use_sse&1) {
-		unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+		unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 		return ((ARCH_WORD_32 *)&(crypt_key[idx].c))[index&(MMX_COEF-1)] & 0xf;
 	}
 #endif
@@ -1752,7 +1737,7 @@ static int get_hash_1(int index)
 {
 #ifdef MMX_COEF
 	if (dynamic_use_sse&1) {
-		unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+		unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 		return ((ARCH_WORD_32 *)&(crypt_key[idx].c))[index&(MMX_COEF-1)] & 0xff;
 	}
 #endif
@@ -1767,7 +1752,7 @@ static int get_hash_2(int index)
 {
 #ifdef MMX_COEF
 	if (dynamic_use_sse&1) {
-		unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+		unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 		return ((ARCH_WORD_32 *)&(crypt_key[idx].c))[index&(MMX_COEF-1)] & 0xfff;
 	}
 #endif
@@ -1782,7 +1767,7 @@ static int get_hash_3(int index)
 {
 #ifdef MMX_COEF
 	if (dynamic_use_sse&1) {
-		unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+		unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 		return ((ARCH_WORD_32 *)&(crypt_key[idx].c))[index&(MMX_COEF-1)] & 0xffff;
 	}
 #endif
@@ -1796,7 +1781,7 @@ static int get_hash_4(int index)
 {
 #ifdef MMX_COEF
 	if (dynamic_use_sse&1) {
-		unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+		unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 		return ((ARCH_WORD_32 *)&(crypt_key[idx].c))[index&(MMX_COEF-1)] & 0xfffff;
 	}
 #endif
@@ -1810,7 +1795,7 @@ static int get_hash_5(int index)
 {
 #ifdef MMX_COEF
 	if (dynamic_use_sse&1) {
-		unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+		unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 		return ((ARCH_WORD_32 *)&(crypt_key[idx].c))[index&(MMX_COEF-1)] & 0xffffff;
 	}
 #endif
@@ -1824,7 +1809,7 @@ static int get_hash_6(int index)
 {
 #ifdef MMX_COEF
 	if (dynamic_use_sse&1) {
-		unsigned int idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+		unsigned int idx = ( ((unsigned)index)/MMX_COEF);
 		return ((ARCH_WORD_32 *)&(crypt_key[idx].c))[index&(MMX_COEF-1)] & 0x7ffffff;
 	}
 #endif
@@ -2660,11 +2645,7 @@ static void __SSE_append_output_base16_to_input(ARCH_WORD_32 *IPBdw, unsigned ch
 	// 3381K  (ath64, $dynamic_2$)
 	// 824.7k (ath64, $dynamic_1006$)
 #undef inc
-#if (MMX_COEF==4)
-#define inc 6
-#else
-#define inc 2
-#endif
+#define inc (2*MMX_COEF-2)
 	unsigned short *IPBw = (unsigned short*)IPBdw;
 	IPBw += (idx_mod<<1);
 	CRY += (idx_mod<<2);
@@ -2712,11 +2693,7 @@ static void __SSE_overwrite_output_base16_to_input(ARCH_WORD_32 *IPBdw, unsigned
 	// 3381K  (ath64, $dynamic_2$)
 	// 824.7k (ath64, $dynamic_1006$)
 #undef inc
-#if (MMX_COEF==4)
-#define inc 6
-#else
-#define inc 2
-#endif
+#define inc (2*MMX_COEF-2)
 	unsigned short *IPBw = (unsigned short *)IPBdw;
 	IPBw += (idx_mod<<1);
 	CRY += (idx_mod<<2);
@@ -2761,13 +2738,8 @@ static void __SSE_append_output_base16_to_input_semi_aligned_2(unsigned ip, ARCH
     // 5113k/4382k  (core2,$dynamic_10$)
 	//  (ath64, $dynamic_9$)
 	//  (ath64, $dynamic_10$)
-#if (MMX_COEF==4)
-# define inc 4
-# define incCRY 12
-#else
-# define inc 2
-# define incCRY 4
-#endif
+# define inc MMX_COEF
+# define incCRY (4*MMX_COEF-4)
 	// Ok, here we are 1/2 off. We are starting in the 'middle' of a DWORD (and end
 	// in the middle of the last one).
 
@@ -2826,14 +2798,8 @@ static void __SSE_append_output_base16_to_input_semi_aligned_0(unsigned ip, ARCH
 	// 3537K  (ath64, $dynamic_2$)
 	// 890.3K (ath64, $dynamic_1006$)
 #undef inc
-#if (MMX_COEF==4)
-#define inc 4
-//# define incCRY 12
-# define incCRY 14
-#else
-#define inc 2
-# define incCRY 6
-#endif
+#define inc MMX_COEF
+# define incCRY (4*MMX_COEF-2)
 
 
 	// start our pointers out at the right 32 bit offset into the first MMX/SSE buffer
@@ -2877,6 +2843,75 @@ static void __SSE_append_output_base16_to_input_semi_aligned_0(unsigned ip, ARCH
 #undef incCRY
 }
 
+#if MMX_COEF >= 4 && defined(__SSE2__)
+#define SSE_BASE16_GROUP
+// sse-intrinsics.h made __m128i a void, for the SSE*body() prototypes
+#undef __m128i
+#include <emmintrin.h>
+
+/*
+ * Base-16 of all MMX_COEF digests of a crypt_key block at once, written
+ * straight into the interleaved input block from 32 bit word ipw on.
+ * Digest word w of a lane becomes its input words ipw+2*w and ipw+2*w+1,
+ * so each vector of 4 lanes' digest words gives two vectors of input words.
+ */
+static void __SSE_base16_group(ARCH_WORD_32 *IPBdw, ARCH_WORD_32 *CRYdw, unsigned ipw)
+{
+	const __m128i mask = _mm_set1_epi8(0x0f);
+	const __m128i nine = _mm_set1_epi8(9);
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i alpha = _mm_set1_epi8(dynamic_itoa16[10] - '0' - 10);
+	unsigned w, k;
+
+	IPBdw += ipw*MMX_COEF;
+	for (w = 0; w < 4; ++w) {
+		for (k = 0; k < MMX_COEF; k += 4) {
+			__m128i v = _mm_loadu_si128((__m128i*)&CRYdw[w*MMX_COEF+k]);
+			__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+			__m128i lo = _mm_and_si128(v, mask);
+			__m128i a = _mm_unpacklo_epi8(hi, lo);
+			__m128i b = _mm_unpackhi_epi8(hi, lo);
+
+			a = _mm_add_epi8(_mm_add_epi8(a, zero),
+				_mm_and_si128(_mm_cmpgt_epi8(a, nine), alpha));
+			b = _mm_add_epi8(_mm_add_epi8(b, zero),
+				_mm_and_si128(_mm_cmpgt_epi8(b, nine), alpha));
+			// a is lanes k, k+1 and b lanes k+2, k+3, two words each
+			a = _mm_shuffle_epi32(a, _MM_SHUFFLE(3,1,2,0));
+			b = _mm_shuffle_epi32(b, _MM_SHUFFLE(3,1,2,0));
+			_mm_storeu_si128((__m128i*)&IPBdw[(2*w)*MMX_COEF+k], _mm_unpacklo_epi64(a, b));
+			_mm_storeu_si128((__m128i*)&IPBdw[(2*w+1)*MMX_COEF+k], _mm_unpackhi_epi64(a, b));
+		}
+	}
+}
+
+/*
+ * The append case, for when every lane of the block has the same 4 byte
+ * aligned length, with room for the 32 bytes.  That is the usual case
+ * (nothing, or a fixed length salt, before the digest).  Leaves things just
+ * as the per-lane functions above would, or returns 0 if it can't.
+ */
+static int __SSE_append_base16_group(ARCH_WORD_32 *IPBdw, ARCH_WORD_32 *CRYdw, unsigned *TL)
+{
+	unsigned ip = TL[0], k;
+
+	if ((ip&3) || ip > 28)
+		return 0;
+	for (k = 1; k < MMX_COEF; ++k)
+		if (TL[k] != ip)
+			return 0;
+	__SSE_base16_group(IPBdw, CRYdw, ip>>2);
+	for (k = 0; k < MMX_COEF; ++k) {
+		if (!ip)
+			*(unsigned short*)&IPBdw[8*MMX_COEF+k] = 0x80;
+		else
+			IPBdw[((ip+32)>>2)*MMX_COEF+k] = 0x80;
+		TL[k] += 32;
+	}
+	return 1;
+}
+#endif
+
 static void __SSE_append_string_to_input_unicode(unsigned char *IPB, unsigned idx_mod, unsigned char *cp, unsigned len, unsigned bf_ptr, unsigned bUpdate0x80)
 {
 	unsigned char *cpO;
@@ -3004,10 +3039,10 @@ static inline void __append_string(DYNA_OMP_PARAMSm unsigned char *Str, unsigned
 	if (dynamic_use_sse==1) {
 		if (!md5_unicode_convert_get(tid)) {
 			for (; j < til; ++j) {
-				unsigned idx = (j>>(MMX_COEF>>1));
+				unsigned idx = (j/MMX_COEF);
 				unsigned idx_mod = j&(MMX_COEF-1);
-				unsigned bf_ptr = (total_len[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
-				total_len[idx] += (len << ((32/MMX_COEF)*idx_mod));
+				unsigned bf_ptr = total_len[idx*MMX_COEF+idx_mod];
+				total_len[idx*MMX_COEF+idx_mod] += len;
 				__SSE_append_string_to_input(input_buf[idx].c,idx_mod,Str,len,bf_ptr,1);
 			}
 		} else {
@@ -3019,19 +3054,19 @@ static inline void __append_string(DYNA_OMP_PARAMSm unsigned char *Str, unsigned
 				if (outlen < 0)
 					outlen = strlen16(utf16Str) * sizeof(UTF16);
 				for (; j < til; ++j) {
-					unsigned idx = (j>>(MMX_COEF>>1));
+					unsigned idx = (j/MMX_COEF);
 					unsigned idx_mod = j&(MMX_COEF-1);
-					unsigned bf_ptr = (total_len[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
-					total_len[idx] += ( outlen << ((32/MMX_COEF)*idx_mod));
+					unsigned bf_ptr = total_len[idx*MMX_COEF+idx_mod];
+					total_len[idx*MMX_COEF+idx_mod] += outlen;
 					// note we use the 'non' unicode variant, since we have already computed the unicode, and length properly
 					__SSE_append_string_to_input(input_buf[idx].c,idx_mod,(unsigned char*)utf16Str,outlen,bf_ptr,1);
 				}
 			} else {
 				for (; j < til; ++j) {
-					unsigned idx = (j>>(MMX_COEF>>1));
+					unsigned idx = (j/MMX_COEF);
 					unsigned idx_mod = j&(MMX_COEF-1);
-					unsigned bf_ptr = (total_len[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
-					total_len[idx] += ( (len<<1) << ((32/MMX_COEF)*idx_mod));
+					unsigned bf_ptr = total_len[idx*MMX_COEF+idx_mod];
+					total_len[idx*MMX_COEF+idx_mod] += len<<1;
 					__SSE_append_string_to_input_unicode(input_buf[idx].c,idx_mod,Str,len,bf_ptr,1);
 				}
 			}
@@ -3107,10 +3142,10 @@ static inline void __append2_string(DYNA_OMP_PARAMSm unsigned char *Str, unsigne
 	if (dynamic_use_sse==1) {
 		if (!md5_unicode_convert_get(tid)) {
 			for (; j < til; ++j) {
-				unsigned idx = (j>>(MMX_COEF>>1));
+				unsigned idx = (j/MMX_COEF);
 				unsigned idx_mod = j&(MMX_COEF-1);
-				unsigned bf_ptr = (total_len2[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
-				total_len2[idx] += ( len << ((32/MMX_COEF)*idx_mod));
+				unsigned bf_ptr = total_len2[idx*MMX_COEF+idx_mod];
+				total_len2[idx*MMX_COEF+idx_mod] += len;
 				__SSE_append_string_to_input(input_buf2[idx].c,idx_mod,Str,len,bf_ptr,1);
 			}
 		} else {
@@ -3122,19 +3157,19 @@ static inline void __append2_string(DYNA_OMP_PARAMSm unsigned char *Str, unsigne
 				if (outlen < 0)
 					outlen = strlen16(utf16Str) * sizeof(UTF16);
 				for (; j < til; ++j) {
-					unsigned idx = (j>>(MMX_COEF>>1));
+					unsigned idx = (j/MMX_COEF);
 					unsigned idx_mod = j&(MMX_COEF-1);
-					unsigned bf_ptr = (total_len2[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
-					total_len2[idx] += ( outlen << ((32/MMX_COEF)*idx_mod));
+					unsigned bf_ptr = total_len2[idx*MMX_COEF+idx_mod];
+					total_len2[idx*MMX_COEF+idx_mod] += outlen;
 					// note we use the 'non' unicode variant of __SSE_append_string_to_input(), since it's already unicode, and length properly
 					__SSE_append_string_to_input(input_buf2[idx].c,idx_mod,(unsigned char*)utf16Str,outlen,bf_ptr,1);
 				}
 			} else {
 				for (; j < til; ++j) {
-					unsigned idx = (j>>(MMX_COEF>>1));
+					unsigned idx = (j/MMX_COEF);
 					unsigned idx_mod = j&(MMX_COEF-1);
-					unsigned bf_ptr = (total_len2[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
-					total_len2[idx] += ( (len<<1) << ((32/MMX_COEF)*idx_mod));
+					unsigned bf_ptr = total_len2[idx*MMX_COEF+idx_mod];
+					total_len2[idx*MMX_COEF+idx_mod] += len<<1;
 					__SSE_append_string_to_input_unicode(input_buf2[idx].c,idx_mod,Str,len,bf_ptr,1);
 				}
 			}
@@ -3220,7 +3255,7 @@ void DynamicFunc__clean_input(DYNA_OMP_PARAMS)
 		int y = (last+MMX_COEF-1) / MMX_COEF;
 		while (x < y) {
 			memset(input_buf[x].c, 0, sizeof(input_buf[0]));
-			total_len[x] = 0;
+			memset(&total_len[x*MMX_COEF], 0, sizeof(total_len[0])*MMX_COEF);
 			++x;
 		}
 		return;
@@ -3249,7 +3284,7 @@ void DynamicFunc__clean_input2(DYNA_OMP_PARAMS)
 		int y = (last+MMX_COEF-1) / MMX_COEF;
 		while (x < y) {
 			memset(input_buf2[x].c, 0, sizeof(input_buf2[0]));
-			total_len2[x] = 0;
+			memset(&total_len2[x*MMX_COEF], 0, sizeof(total_len2[0])*MMX_COEF);
 			++x;
 		}
 		return;
@@ -3278,7 +3313,7 @@ void DynamicFunc__clean_input_full(DYNA_OMP_PARAMS)
 	int y = (last+MMX_COEF-1) / MMX_COEF;
 	while (x < y) {
 		memset(input_buf[x].c, 0, sizeof(input_buf[0]));
-		total_len[x] = 0;
+		memset(&total_len[x*MMX_COEF], 0, sizeof(total_len[0])*MMX_COEF);
 		++x;
 	}
 #endif
@@ -3304,7 +3339,7 @@ void DynamicFunc__clean_input2_full(DYNA_OMP_PARAMS)
 	int y = (last+MMX_COEF-1) / MMX_COEF;
 	while (x < y) {
 		memset(input_buf2[x].c, 0, sizeof(input_buf2[0]));
-		total_len2[x] = 0;
+		memset(&total_len2[x*MMX_COEF], 0, sizeof(total_len2[0])*MMX_COEF);
 		++x;
 	}
 #endif
@@ -3329,8 +3364,7 @@ void DynamicFunc__clean_input_kwik(DYNA_OMP_PARAMS)
 	if (dynamic_use_sse==1) {
 		int x = first / MMX_COEF;
 		int y = (last+MMX_COEF-1) / MMX_COEF;
-		while (x < y)
-			total_len[x++] = 0;
+		memset(&total_len[x*MMX_COEF], 0, sizeof(total_len[0])*MMX_COEF*(y-x));
 		return;
 	}
 #else
@@ -3359,8 +3393,7 @@ void DynamicFunc__clean_input2_kwik(DYNA_OMP_PARAMS)
 	if (dynamic_use_sse==1) {
 		int x = first / MMX_COEF;
 		int y = (last+MMX_COEF-1) / MMX_COEF;
-		while (x < y)
-			total_len2[x++] = 0;
+		memset(&total_len2[x*MMX_COEF], 0, sizeof(total_len2[0])*MMX_COEF*(y-x));
 		return;
 	}
 #else
@@ -3399,9 +3432,9 @@ void DynamicFunc__append_keys(DYNA_OMP_PARAMS)
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
 		for (; j < til; ++j) {
-			unsigned idx = (j>>(MMX_COEF>>1));
+			unsigned idx = (j/MMX_COEF);
 			unsigned idx_mod = j&(MMX_COEF-1);
-			unsigned bf_ptr = (total_len[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
+			unsigned bf_ptr = total_len[idx*MMX_COEF+idx_mod];
 			if (md5_unicode_convert_get(tid)) {
 				if (pers_opts.target_enc != ASCII && pers_opts.target_enc != ISO_8859_1) {
 					UTF16 utf16Str[27+1]; // 27 chars is 'max' that fits in SSE without overflow, so that is where we limit it at now
@@ -3415,14 +3448,14 @@ void DynamicFunc__append_keys(DYNA_OMP_PARAMS)
 						if (outlen < 0)
 							outlen = strlen16(utf16Str) * sizeof(UTF16);
 					}
-					total_len[idx] += ( outlen << ((32/MMX_COEF)*idx_mod));
+					total_len[idx*MMX_COEF+idx_mod] += outlen;
 					__SSE_append_string_to_input(input_buf[idx].c,idx_mod,(unsigned char*)utf16Str,outlen,bf_ptr,1);
 				} else {
-					total_len[idx] += ( ((saved_key_len[j])<<1) << ((32/MMX_COEF)*idx_mod));
+					total_len[idx*MMX_COEF+idx_mod] += saved_key_len[j]<<1;
 					__SSE_append_string_to_input_unicode(input_buf[idx].c,idx_mod,(unsigned char*)saved_key[j],saved_key_len[j],bf_ptr,1);
 				}
 			} else {
-				total_len[idx] += (saved_key_len[j] << ((32/MMX_COEF)*idx_mod));
+				total_len[idx*MMX_COEF+idx_mod] += saved_key_len[j];
 				__SSE_append_string_to_input(input_buf[idx].c,idx_mod,(unsigned char*)saved_key[j],saved_key_len[j],bf_ptr,1);
 			}
 		}
@@ -3499,17 +3532,17 @@ void DynamicFunc__append_keys_pad16(DYNA_OMP_PARAMS)
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
 		for (; j < til; ++j) {
-			unsigned idx = (j>>(MMX_COEF>>1));
+			unsigned idx = (j/MMX_COEF);
 			unsigned idx_mod = j&(MMX_COEF-1);
-			unsigned bf_ptr = (total_len[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
+			unsigned bf_ptr = total_len[idx*MMX_COEF+idx_mod];
 			saved_key[j][saved_key_len[j]] = 0; // so strncpy 'works'
 			if (saved_key_len[j] < 16) {
 				char buf[17];
 				strncpy(buf, saved_key[j], 17);
-				total_len[idx] += (16 << ((32/MMX_COEF)*idx_mod));
+				total_len[idx*MMX_COEF+idx_mod] += 16;
 				__SSE_append_string_to_input(input_buf[idx].c,idx_mod,(unsigned char*)buf,16,bf_ptr,1);
 			} else {
-				total_len[idx] += (saved_key_len[j] << ((32/MMX_COEF)*idx_mod));
+				total_len[idx*MMX_COEF+idx_mod] += saved_key_len[j];
 				__SSE_append_string_to_input(input_buf[idx].c,idx_mod,(unsigned char*)saved_key[j],saved_key_len[j],bf_ptr,1);
 			}
 		}
@@ -3541,17 +3574,17 @@ void DynamicFunc__append_keys_pad20(DYNA_OMP_PARAMS)
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
 		for (; j < til; ++j) {
-			unsigned idx = (j>>(MMX_COEF>>1));
+			unsigned idx = (j/MMX_COEF);
 			unsigned idx_mod = j&(MMX_COEF-1);
-			unsigned bf_ptr = (total_len[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
+			unsigned bf_ptr = total_len[idx*MMX_COEF+idx_mod];
 			saved_key[j][saved_key_len[j]] = 0; // so strncpy 'works'
 			if (saved_key_len[j] < 20) {
 				char buf[21];
 				strncpy(buf, saved_key[j], 21);
-				total_len[idx] += (20 << ((32/MMX_COEF)*idx_mod));
+				total_len[idx*MMX_COEF+idx_mod] += 20;
 				__SSE_append_string_to_input(input_buf[idx].c,idx_mod,(unsigned char*)buf,20,bf_ptr,1);
 			} else {
-				total_len[idx] += (saved_key_len[j] << ((32/MMX_COEF)*idx_mod));
+				total_len[idx*MMX_COEF+idx_mod] += saved_key_len[j];
 				__SSE_append_string_to_input(input_buf[idx].c,idx_mod,(unsigned char*)saved_key[j],saved_key_len[j],bf_ptr,1);
 			}
 		}
@@ -3588,9 +3621,9 @@ void DynamicFunc__append_keys2(DYNA_OMP_PARAMS)
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
 		for (; j < til; ++j) {
-			unsigned idx = (j>>(MMX_COEF>>1));
+			unsigned idx = (j/MMX_COEF);
 			unsigned idx_mod = j&(MMX_COEF-1);
-			unsigned bf_ptr = (total_len2[idx] >> ((32/MMX_COEF)*idx_mod)) & 0xFF;
+			unsigned bf_ptr = total_len2[idx*MMX_COEF+idx_mod];
 			if (md5_unicode_convert_get(tid)) {
 				if (pers_opts.target_enc != ASCII && pers_opts.target_enc != ISO_8859_1) {
 					UTF16 utf16Str[27+1]; // 27 chars is 'max' that fits in SSE without overflow, so that is where we limit it at now
@@ -3604,14 +3637,14 @@ void DynamicFunc__append_keys2(DYNA_OMP_PARAMS)
 						if (outlen < 0)
 							outlen = strlen16(utf16Str) * sizeof(UTF16);
 					}
-					total_len2[idx] += ( outlen << ((32/MMX_COEF)*idx_mod));
+					total_len2[idx*MMX_COEF+idx_mod] += outlen;
 					__SSE_append_string_to_input(input_buf2[idx].c,idx_mod,(unsigned char*)utf16Str,outlen,bf_ptr,1);
 				} else {
-					total_len2[idx] += ( (saved_key_len[j]<<1) << ((32/MMX_COEF)*idx_mod));
+					total_len2[idx*MMX_COEF+idx_mod] += saved_key_len[j]<<1;
 					__SSE_append_string_to_input_unicode(input_buf2[idx].c,idx_mod,(unsigned char*)saved_key[j],saved_key_len[j],bf_ptr,1);
 				}
 			} else {
-				total_len2[idx] += (saved_key_len[j] << ((32/MMX_COEF)*idx_mod));
+				total_len2[idx*MMX_COEF+idx_mod] += saved_key_len[j];
 				__SSE_append_string_to_input(input_buf2[idx].c,idx_mod,(unsigned char*)saved_key[j],saved_key_len[j],bf_ptr,1);
 			}
 		}
@@ -3690,23 +3723,13 @@ void DynamicFunc__set_input_len_16(DYNA_OMP_PARAMS)
 		{
 			// If length is < 16, then remove existing end of buffer marker, and then set
 			// one at offset 16
-			unsigned cur_block_len = total_len[j];
 			for (k = 0; k < MMX_COEF; ++k) {
-				unsigned this_item_len = cur_block_len & 0xFF;
-#if (MMX_COEF==4)
-				cur_block_len >>= 8;
-#else
-				cur_block_len >>= 16;
-#endif
+				unsigned this_item_len = total_len[j*MMX_COEF+k];
 				if (this_item_len < 16)
 					input_buf[j].c[GETPOS(this_item_len, k&(MMX_COEF-1))] = 0x00;
 				input_buf[j].c[GETPOS(16, k&(MMX_COEF-1))] = 0x80;
+				total_len[j*MMX_COEF+k] = 16;
 			}
-#if (MMX_COEF==4)
-			total_len[j] = 0x10101010;
-#else
-			total_len[j] = 0x100010;
-#endif
 		}
 		return;
 	}
@@ -3746,23 +3769,13 @@ void DynamicFunc__set_input2_len_16(DYNA_OMP_PARAMS)
 		{
 			// If length is < 16, then remove existing end of buffer marker, and then set
 			// one at offset 16
-			unsigned cur_block_len = total_len2[j];
 			for (k = 0; k < MMX_COEF; ++k) {
-				unsigned this_item_len = cur_block_len & 0xFF;
-#if (MMX_COEF==4)
-				cur_block_len >>= 8;
-#else
-				cur_block_len >>= 16;
-#endif
+				unsigned this_item_len = total_len2[j*MMX_COEF+k];
 				if (this_item_len < 16)
 					input_buf2[j].c[GETPOS(this_item_len, k&(MMX_COEF-1))] = 0x00;
 				input_buf2[j].c[GETPOS(16, k&(MMX_COEF-1))] = 0x80;
+				total_len2[j*MMX_COEF+k] = 16;
 			}
-#if (MMX_COEF==4)
-			total_len2[j] = 0x10101010;
-#else
-			total_len2[j] = 0x100010;
-#endif
 		}
 		return;
 	}
@@ -3802,23 +3815,13 @@ void DynamicFunc__set_input_len_20(DYNA_OMP_PARAMS)
 		{
 			// If length is < 20, then remove existing end of buffer marker, and then set
 			// one at offset 20
-			unsigned cur_block_len = total_len[j];
 			for (k = 0; k < MMX_COEF; ++k) {
-				unsigned this_item_len = cur_block_len & 0xFF;
-#if (MMX_COEF==4)
-				cur_block_len >>= 8;
-#else
-				cur_block_len >>= 16;
-#endif
+				unsigned this_item_len = total_len[j*MMX_COEF+k];
 				if (this_item_len < 20)
 					input_buf[j].c[GETPOS(this_item_len, k&(MMX_COEF-1))] = 0x00;
 				input_buf[j].c[GETPOS(20, k&(MMX_COEF-1))] = 0x80;
+				total_len[j*MMX_COEF+k] = 20;
 			}
-#if (MMX_COEF==4)
-			total_len[j] = 0x14141414;
-#else
-			total_len[j] = 0x140014;
-#endif
 		}
 		return;
 	}
@@ -3857,23 +3860,13 @@ void DynamicFunc__set_input2_len_20(DYNA_OMP_PARAMS)
 		{
 			// If length is < 20, then remove existing end of buffer marker, and then set
 			// one at offset 20
-			unsigned cur_block_len = total_len2[j];
 			for (k = 0; k < MMX_COEF; ++k) {
-				unsigned this_item_len = cur_block_len & 0xFF;
-#if (MMX_COEF==4)
-				cur_block_len >>= 8;
-#else
-				cur_block_len >>= 16;
-#endif
+				unsigned this_item_len = total_len2[j*MMX_COEF+k];
 				if (this_item_len < 20)
 					input_buf2[j].c[GETPOS(this_item_len, k&(MMX_COEF-1))] = 0x00;
 				input_buf2[j].c[GETPOS(20, k&(MMX_COEF-1))] = 0x80;
+				total_len2[j*MMX_COEF+k] = 20;
 			}
-#if (MMX_COEF==4)
-			total_len2[j] = 0x14141414;
-#else
-			total_len2[j] = 0x100014;
-#endif
 		}
 		return;
 	}
@@ -3910,13 +3903,10 @@ void DynamicFunc__set_input_len_32(DYNA_OMP_PARAMS)
 		for (; j < til; ++j)
 		{
 			unsigned k;
-			for (k = 0; k < MMX_COEF; ++k)
+			for (k = 0; k < MMX_COEF; ++k) {
 				input_buf[j].c[GETPOS(32, k&(MMX_COEF-1))] = 0x80;
-#if (MMX_COEF==4)
-			total_len[j] = 0x20202020;
-#else
-			total_len[j] = 0x200020;
-#endif
+				total_len[j*MMX_COEF+k] = 32;
+			}
 		}
 		return;
 	}
@@ -3957,13 +3947,10 @@ void DynamicFunc__set_input2_len_32(DYNA_OMP_PARAMS)
 		for (; j < til; ++j)
 		{
 			unsigned k;
-			for (k = 0; k < MMX_COEF; ++k)
+			for (k = 0; k < MMX_COEF; ++k) {
 				input_buf2[j].c[GETPOS(32, k&(MMX_COEF-1))] = 0x80;
-#if (MMX_COEF==4)
-			total_len2[j] = 0x20202020;
-#else
-			total_len2[j] = 0x200020;
-#endif
+				total_len2[j*MMX_COEF+k] = 32;
+			}
 		}
 		return;
 	}
@@ -4004,13 +3991,10 @@ void DynamicFunc__set_input_len_40(DYNA_OMP_PARAMS)
 		for (; j < til; ++j)
 		{
 			unsigned k;
-			for (k = 0; k < MMX_COEF; ++k)
+			for (k = 0; k < MMX_COEF; ++k) {
 				input_buf[j].c[GETPOS(40, k&(MMX_COEF-1))] = 0x80;
-#if (MMX_COEF==4)
-			total_len[j] = 0x28282828;
-#else
-			total_len[j] = 0x280028;
-#endif
+				total_len[j*MMX_COEF+k] = 40;
+			}
 		}
 		return;
 	}
@@ -4049,13 +4033,10 @@ void DynamicFunc__set_input2_len_40(DYNA_OMP_PARAMS)
 		for (; j < til; ++j)
 		{
 			unsigned k;
-			for (k = 0; k < MMX_COEF; ++k)
+			for (k = 0; k < MMX_COEF; ++k) {
 				input_buf2[j].c[GETPOS(40, k&(MMX_COEF-1))] = 0x80;
-#if (MMX_COEF==4)
-			total_len2[j] = 0x28282828;
-#else
-			total_len2[j] = 0x280028;
-#endif
+				total_len2[j*MMX_COEF+k] = 40;
+			}
 		}
 		return;
 	}
@@ -4184,8 +4165,8 @@ unsigned i, til;
 		{
 			for (j = 0; j < MMX_COEF; ++j)
 			{
-				unsigned start_len = (total_len[i] >> ((32/MMX_COEF)*j)) & 0xFF;
-				unsigned len1 = (total_len2[i] >> ((32/MMX_COEF)*j)) & 0xFF;
+				unsigned start_len = total_len[i*MMX_COEF+j];
+				unsigned len1 = total_len2[i*MMX_COEF+j];
 				for (k = 0; k < len1; ++k)
 					input_buf[i].c[GETPOS((k+start_len), j)] = input_buf2[i].c[GETPOS(k,j)];
 				input_buf[i].c[GETPOS((len1+start_len), j)] = 0x80;
@@ -4226,8 +4207,8 @@ unsigned i, til;
 		{
 			for (j = 0; j < MMX_COEF; ++j)
 			{
-				unsigned start_len = (total_len2[i] >> ((32/MMX_COEF)*j)) & 0xFF;
-				unsigned len1 = (total_len[i] >> ((32/MMX_COEF)*j)) & 0xFF;
+				unsigned start_len = total_len2[i*MMX_COEF+j];
+				unsigned len1 = total_len[i*MMX_COEF+j];
 				for (k = 0; k < len1; ++k)
 					input_buf2[i].c[GETPOS((k+start_len), j)] = input_buf[i].c[GETPOS(k,j)];
 				input_buf2[i].c[GETPOS((len1+start_len), j)] = 0x80;
@@ -4268,7 +4249,7 @@ unsigned i, til;
 		{
 			for (j = 0; j < MMX_COEF; ++j)
 			{
-				unsigned start_len = (total_len[i] >> ((32/MMX_COEF)*j)) & 0xFF;
+				unsigned start_len = total_len[i*MMX_COEF+j];
 				for (k = 0; k < start_len; ++k)
 					input_buf[i].c[GETPOS((k+start_len), j)] = input_buf[i].c[GETPOS(k,j)];
 				input_buf[i].c[GETPOS((start_len+start_len), j)] = 0x80;
@@ -4308,7 +4289,7 @@ unsigned i, til;
 		{
 			for (j = 0; j < MMX_COEF; ++j)
 			{
-				unsigned start_len = (total_len2[i] >> ((32/MMX_COEF)*j)) & 0xFF;
+				unsigned start_len = total_len2[i*MMX_COEF+j];
 				for (k = 0; k < start_len; ++k)
 					input_buf2[i].c[GETPOS((k+start_len), j)] = input_buf2[i].c[GETPOS(k,j)];
 				input_buf2[i].c[GETPOS((start_len+start_len), j)] = 0x80;
@@ -4334,18 +4315,16 @@ unsigned i, til;
 static void SSE_Intrinsics_LoadLens(int side, int i)
 {
 	ARCH_WORD_32 *p;
-	ARCH_WORD_32 TL;
-	int j;
+	unsigned int *TL;
+	int j, k;
 	if (side == 0)
 	{
 		for (j = 0; j < MD5_SSE_PARA; j++)
 		{
 			p = input_buf[i+j].w;
-			TL = (ARCH_WORD_32)total_len[i+j];
-			p[14*MMX_COEF+0] = ((TL>>0)&0xFF)<<3;
-			p[14*MMX_COEF+1] = ((TL>>8)&0xFF)<<3;
-			p[14*MMX_COEF+2] = ((TL>>16)&0xFF)<<3;
-			p[14*MMX_COEF+3] = ((TL>>24)&0xFF)<<3;
+			TL = &total_len[(i+j)*MMX_COEF];
+			for (k = 0; k < MMX_COEF; ++k)
+				p[14*MMX_COEF+k] = TL[k]<<3;
 		}
 	}
 	else
@@ -4353,11 +4332,9 @@ static void SSE_Intrinsics_LoadLens(int side, int i)
 		for (j = 0; j < MD5_SSE_PARA; j++)
 		{
 			p = input_buf2[i+j].w;
-			TL = (ARCH_WORD_32)total_len2[i+j];
-			p[14*MMX_COEF+0] = ((TL>>0)&0xFF)<<3;
-			p[14*MMX_COEF+1] = ((TL>>8)&0xFF)<<3;
-			p[14*MMX_COEF+2] = ((TL>>16)&0xFF)<<3;
-			p[14*MMX_COEF+3] = ((TL>>24)&0xFF)<<3;
+			TL = &total_len2[(i+j)*MMX_COEF];
+			for (k = 0; k < MMX_COEF; ++k)
+				p[14*MMX_COEF+k] = TL[k]<<3;
 		}
 	}
 }
@@ -4386,8 +4363,8 @@ void DynamicFunc__crypt_md5(DYNA_OMP_PARAMS)
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		if (curdat.store_keys_in_input) {
 			for (; i < til; i += MD5_SSE_PARA) {
 				SSEmd5body(input_buf[i].c, crypt_key[i].w, NULL, SSEi_MIXED_IN);
@@ -4427,8 +4404,8 @@ unsigned i, til;
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		if (curdat.store_keys_in_input) {
 			for (; i < til; i += MD4_SSE_PARA) {
 				SSEmd4body(input_buf[i].c, crypt_key[i].w, NULL, SSEi_MIXED_IN);
@@ -4618,8 +4595,8 @@ void DynamicFunc__crypt2_md5(DYNA_OMP_PARAMS)
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		for (; i < til; i += MD5_SSE_PARA) {
 			SSE_Intrinsics_LoadLens(1, i);
 			SSEmd5body(input_buf2[i].c, crypt_key2[i].w, NULL, SSEi_MIXED_IN);
@@ -4653,8 +4630,8 @@ void DynamicFunc__crypt2_md4(DYNA_OMP_PARAMS)
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		for (; i < til; i += MD4_SSE_PARA) {
 			SSE_Intrinsics_LoadLens(1, i);
 			SSEmd4body(input_buf2[i].c, crypt_key2[i].w, NULL, SSEi_MIXED_IN);
@@ -4695,8 +4672,8 @@ void DynamicFunc__crypt_md5_in1_to_out2(DYNA_OMP_PARAMS)
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		if (curdat.store_keys_in_input) {
 			for (; i < til; i += MD5_SSE_PARA) {
 				SSEmd5body(input_buf[i].c, crypt_key2[i].w, NULL, SSEi_MIXED_IN);
@@ -4736,8 +4713,8 @@ void DynamicFunc__crypt_md4_in1_to_out2(DYNA_OMP_PARAMS)
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		if (curdat.store_keys_in_input) {
 			for (; i < til; i += MD4_SSE_PARA) {
 				SSEmd4body(input_buf[i].c, crypt_key2[i].w, NULL, SSEi_MIXED_IN);
@@ -4784,8 +4761,8 @@ void DynamicFunc__crypt_md5_in2_to_out1(DYNA_OMP_PARAMS)
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		for (; i < til; i += MD5_SSE_PARA)
 		{
 			SSE_Intrinsics_LoadLens(1, i);
@@ -4809,6 +4786,123 @@ void DynamicFunc__crypt_md5_in2_to_out1(DYNA_OMP_PARAMS)
 		DoMD5(input_buf2_X86[i>>MD5_X2], len, crypt_key_X86[i>>MD5_X2]);
 	}
 }
+
+/**************************************************************
+ * DYNAMIC primitive fusion
+ * A few runs of primitives are very common in scripts, such as
+ * crypt_md5, overwrite_..._as_base16_no_size_fix, set_input2_len_32
+ * for md5(md5($p)).  Each primitive walks all the keys, so the
+ * digests and inputs make several trips through memory.  FuseFuncs()
+ * replaces such runs with one of these, which does the whole run
+ * one SIMD group at a time, while the group is still in L1.  The
+ * buffers end up exactly as the run would have left them.  Out of
+ * SSE mode, they simply call the original primitives.
+ *************************************************************/
+#ifdef MMX_COEF
+static void __SSE_crypt_md5_base16_to_input2(unsigned i, unsigned til,
+                                             int side, int crypt_to_out1)
+{
+	unsigned j, k;
+
+	til = (til+MMX_COEF-1)/MMX_COEF;
+	i /= MMX_COEF;
+	for (; i < til; i += MD5_SSE_PARA) {
+		if (side == 0) {
+			if (!curdat.store_keys_in_input)
+				SSE_Intrinsics_LoadLens(0, i);
+			SSEmd5body(input_buf[i].c, crypt_key[i].w, NULL, SSEi_MIXED_IN);
+		} else {
+			SSE_Intrinsics_LoadLens(1, i);
+			SSEmd5body(input_buf2[i].c, crypt_key2[i].w, NULL, SSEi_MIXED_IN);
+		}
+		for (j = i; j < i + MD5_SSE_PARA; ++j) {
+#ifdef SSE_BASE16_GROUP
+			__SSE_base16_group(input_buf2[j].w,
+				side ? crypt_key2[j].w : crypt_key[j].w, 0);
+#endif
+			for (k = 0; k < MMX_COEF; ++k) {
+#ifndef SSE_BASE16_GROUP
+				__SSE_overwrite_output_base16_to_input(input_buf2[j].w,
+					side ? crypt_key2[j].c : crypt_key[j].c, k);
+#endif
+				input_buf2[j].c[GETPOS(32, k)] = 0x80;
+				total_len2[j*MMX_COEF+k] = 32;
+			}
+		}
+		if (crypt_to_out1) {
+			SSE_Intrinsics_LoadLens(1, i);
+			SSEmd5body(input_buf2[i].c, crypt_key[i].w, NULL, SSEi_MIXED_IN);
+		}
+	}
+}
+#endif
+
+static void DynamicFunc__crypt_md5_base16_to_input2(DYNA_OMP_PARAMS)
+{
+#ifdef MMX_COEF
+	if (dynamic_use_sse==1) {
+#ifdef _OPENMP
+		__SSE_crypt_md5_base16_to_input2(first, last, 0, 0);
+#else
+		__SSE_crypt_md5_base16_to_input2(0, m_count, 0, 0);
+#endif
+		return;
+	}
+#endif
+	DynamicFunc__crypt_md5(DYNA_OMP_PARAMSd);
+	DynamicFunc__overwrite_from_last_output_to_input2_as_base16_no_size_fix(DYNA_OMP_PARAMSd);
+	DynamicFunc__set_input2_len_32(DYNA_OMP_PARAMSd);
+}
+
+static void DynamicFunc__crypt2_md5_base16_to_input2(DYNA_OMP_PARAMS)
+{
+#ifdef MMX_COEF
+	if (dynamic_use_sse==1) {
+#ifdef _OPENMP
+		__SSE_crypt_md5_base16_to_input2(first, last, 1, 0);
+#else
+		__SSE_crypt_md5_base16_to_input2(0, m_count, 1, 0);
+#endif
+		return;
+	}
+#endif
+	DynamicFunc__crypt2_md5(DYNA_OMP_PARAMSd);
+	DynamicFunc__overwrite_from_last_output2_as_base16_no_size_fix(DYNA_OMP_PARAMSd);
+	DynamicFunc__set_input2_len_32(DYNA_OMP_PARAMSd);
+}
+
+static void DynamicFunc__crypt_md5_base16_to_input2_crypt_to_out1(DYNA_OMP_PARAMS)
+{
+#ifdef MMX_COEF
+	if (dynamic_use_sse==1) {
+#ifdef _OPENMP
+		__SSE_crypt_md5_base16_to_input2(first, last, 0, 1);
+#else
+		__SSE_crypt_md5_base16_to_input2(0, m_count, 0, 1);
+#endif
+		return;
+	}
+#endif
+	DynamicFunc__crypt_md5_base16_to_input2(DYNA_OMP_PARAMSd);
+	DynamicFunc__crypt_md5_in2_to_out1(DYNA_OMP_PARAMSd);
+}
+
+static void DynamicFunc__crypt2_md5_base16_to_input2_crypt_to_out1(DYNA_OMP_PARAMS)
+{
+#ifdef MMX_COEF
+	if (dynamic_use_sse==1) {
+#ifdef _OPENMP
+		__SSE_crypt_md5_base16_to_input2(first, last, 1, 1);
+#else
+		__SSE_crypt_md5_base16_to_input2(0, m_count, 1, 1);
+#endif
+		return;
+	}
+#endif
+	DynamicFunc__crypt2_md5_base16_to_input2(DYNA_OMP_PARAMSd);
+	DynamicFunc__crypt_md5_in2_to_out1(DYNA_OMP_PARAMSd);
+}
+
 void DynamicFunc__crypt_md4_in2_to_out1(DYNA_OMP_PARAMS)
 {
 	int i, til;
@@ -4821,8 +4915,8 @@ void DynamicFunc__crypt_md4_in2_to_out1(DYNA_OMP_PARAMS)
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		for (; i < til; i += MD4_SSE_PARA)
 		{
 			SSE_Intrinsics_LoadLens(1, i);
@@ -4860,11 +4954,11 @@ void DynamicFunc__crypt_md5_to_input_raw(DYNA_OMP_PARAMS)
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		for (; i < til; i += MD5_SSE_PARA)
 		{
-			unsigned j;
+			unsigned j, k;
 			SSE_Intrinsics_LoadLens(0, i);
 			// NOTE, since crypt_key array is 16 bytes each, and input_buf is 64 bytes
 			// each, and we are doing 3 at a time, we can NOT directly write to the
@@ -4873,8 +4967,9 @@ void DynamicFunc__crypt_md5_to_input_raw(DYNA_OMP_PARAMS)
 			for (j = 0; j < MD5_SSE_PARA; ++j)
 			{
 				memset(input_buf[i+j].c, 0, sizeof(input_buf[0]));
-				memcpy(input_buf[i+j].c, crypt_key[i+j].c, 16*4);
-				total_len[i+j] = 0x10101010;
+				memcpy(input_buf[i+j].c, crypt_key[i+j].c, 16*MMX_COEF);
+				for (k = 0; k < MMX_COEF; ++k)
+					total_len[(i+j)*MMX_COEF+k] = 16;
 			}
 		}
 		return;
@@ -4908,8 +5003,8 @@ void DynamicFunc__crypt_md5_to_input_raw_Overwrite_NoLen_but_setlen_in_SSE(DYNA_
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>=(MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		for (; i < til; i += MD5_SSE_PARA)
 		{
 			unsigned j;
@@ -4919,7 +5014,7 @@ void DynamicFunc__crypt_md5_to_input_raw_Overwrite_NoLen_but_setlen_in_SSE(DYNA_
 			// input buff, but have to use the crypt_key buffer, and then memcpy when done.
 			SSEmd5body(input_buf[i].c, crypt_key[i].w, NULL, SSEi_MIXED_IN);
 			for (j = 0; j < MD5_SSE_PARA; ++j)
-				memcpy(input_buf[i+j].c, crypt_key[i+j].c, 16*4);
+				memcpy(input_buf[i+j].c, crypt_key[i+j].c, 16*MMX_COEF);
 		}
 		return;
 	}
@@ -4951,8 +5046,8 @@ void DynamicFunc__crypt_md5_to_input_raw_Overwrite_NoLen(DYNA_OMP_PARAMS)
 #endif
 #ifdef MMX_COEF
 	if (dynamic_use_sse==1) {
-		til = (til+MMX_COEF-1)>>(MMX_COEF>>1);
-		i >>= (MMX_COEF>>1);
+		til = (til+MMX_COEF-1)/MMX_COEF;
+		i /= MMX_COEF;
 		for (; i < til; i += MD5_SSE_PARA)
 		{
 			unsigned j;
@@ -4961,7 +5056,7 @@ void DynamicFunc__crypt_md5_to_input_raw_Overwrite_NoLen(DYNA_OMP_PARAMS)
 			// input buff, but have to use the crypt_key buffer, and then memcpy when done.
 			SSEmd5body(input_buf[i].c, crypt_key[i].w, NULL, SSEi_MIXED_IN);
 			for (j = 0; j < MD5_SSE_PARA; ++j)
-				memcpy(input_buf[i+j].c, crypt_key[i+j].c, 16*4);
+				memcpy(input_buf[i+j].c, crypt_key[i+j].c, 16*MMX_COEF);
 		}
 		return;
 	}
@@ -5002,16 +5097,16 @@ void DynamicFunc__overwrite_salt_to_input1_no_size_fix(DYNA_OMP_PARAMS)
 				if (outlen < 0)
 					outlen = strlen16(utf16Str) * sizeof(UTF16);
 				for (; j < til; ++j) {
-					__SSE_append_string_to_input(input_buf[j>>(MMX_COEF>>1)].c,j&(MMX_COEF-1),(unsigned char*)utf16Str,outlen,0,0);
+					__SSE_append_string_to_input(input_buf[j/MMX_COEF].c,j&(MMX_COEF-1),(unsigned char*)utf16Str,outlen,0,0);
 				}
 			} else {
 				for (; j < til; ++j)
-					__SSE_append_string_to_input_unicode(input_buf[j>>(MMX_COEF>>1)].c,j&(MMX_COEF-1),(unsigned char*)cursalt,saltlen,0,0);
+					__SSE_append_string_to_input_unicode(input_buf[j/MMX_COEF].c,j&(MMX_COEF-1),(unsigned char*)cursalt,saltlen,0,0);
 			}
 			return;
 		}
 		for (; j < til; ++j)
-			__SSE_append_string_to_input(input_buf[j>>(MMX_COEF>>1)].c,j&(MMX_COEF-1),cursalt,saltlen,0,0);
+			__SSE_append_string_to_input(input_buf[j/MMX_COEF].c,j&(MMX_COEF-1),cursalt,saltlen,0,0);
 		return;
 	}
 #endif
@@ -5082,16 +5177,16 @@ void DynamicFunc__overwrite_salt_to_input2_no_size_fix(DYNA_OMP_PARAMS)
 				if (outlen < 0)
 					outlen = strlen16(utf16Str) * sizeof(UTF16);
 				for (; j < til; ++j) {
-					__SSE_append_string_to_input(input_buf2[j>>(MMX_COEF>>1)].c,j&(MMX_COEF-1),(unsigned char*)utf16Str,outlen,0,0);
+					__SSE_append_string_to_input(input_buf2[j/MMX_COEF].c,j&(MMX_COEF-1),(unsigned char*)utf16Str,outlen,0,0);
 				}
 			} else {
 				for (; j < til; ++j)
-					__SSE_append_string_to_input_unicode(input_buf2[j>>(MMX_COEF>>1)].c,j&(MMX_COEF-1),(unsigned char*)cursalt,saltlen,0,0);
+					__SSE_append_string_to_input_unicode(input_buf2[j/MMX_COEF].c,j&(MMX_COEF-1),(unsigned char*)cursalt,saltlen,0,0);
 			}
 			return;
 		}
 		for (; j < til; ++j)
-			__SSE_append_string_to_input(input_buf2[j>>(MMX_COEF>>1)].c,j&(MMX_COEF-1),cursalt,saltlen,0,0);
+			__SSE_append_string_to_input(input_buf2[j/MMX_COEF].c,j&(MMX_COEF-1),cursalt,saltlen,0,0);
 		return;
 	}
 #endif
@@ -5163,7 +5258,14 @@ void DynamicFunc__overwrite_from_last_output2_to_input1_as_base16_no_size_fix(DY
 		unsigned idx;
 		for (; j < til; ++j)
 		{
-			idx = ( ((unsigned)j)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)j)/MMX_COEF);
+#ifdef SSE_BASE16_GROUP
+			if (!(j&(MMX_COEF-1)) && j+MMX_COEF <= til) {
+				__SSE_base16_group(input_buf[idx].w, crypt_key2[idx].w, 0);
+				j += MMX_COEF-1;
+				continue;
+			}
+#endif
 			__SSE_overwrite_output_base16_to_input(input_buf[idx].w, crypt_key2[idx].c, j&(MMX_COEF-1));
 		}
 		return;
@@ -5208,7 +5310,14 @@ void DynamicFunc__overwrite_from_last_output_as_base16_no_size_fix(DYNA_OMP_PARA
 		unsigned idx;
 		for (; j < til; ++j)
 		{
-			idx = ( ((unsigned)j)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)j)/MMX_COEF);
+#ifdef SSE_BASE16_GROUP
+			if (!(j&(MMX_COEF-1)) && j+MMX_COEF <= til) {
+				__SSE_base16_group(input_buf[idx].w, crypt_key[idx].w, 0);
+				j += MMX_COEF-1;
+				continue;
+			}
+#endif
 			__SSE_overwrite_output_base16_to_input(input_buf[idx].w, crypt_key[idx].c, j&(MMX_COEF-1));
 		}
 		return;
@@ -5257,10 +5366,17 @@ void DynamicFunc__append_from_last_output_as_base16(DYNA_OMP_PARAMS)
 		for (; j < til; ++j)
 		{
 			unsigned ip;
-			idx = ( ((unsigned)j)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)j)/MMX_COEF);
+#ifdef SSE_BASE16_GROUP
+			if (!(j&(MMX_COEF-1)) && j+MMX_COEF <= til &&
+			    __SSE_append_base16_group(input_buf[idx].w, crypt_key[idx].w, &total_len[idx*MMX_COEF])) {
+				j += MMX_COEF-1;
+				continue;
+			}
+#endif
 			// This is the 'actual' work.
-			ip = (total_len[idx] >> ((32/MMX_COEF)*(j&(MMX_COEF-1)))) & 0xFF;
-			total_len[idx] += (32<<((32/MMX_COEF)*(j&(MMX_COEF-1))));
+			ip = total_len[idx*MMX_COEF+(j&(MMX_COEF-1))];
+			total_len[idx*MMX_COEF+(j&(MMX_COEF-1))] += 32;
 			if (!ip)
 				__SSE_append_output_base16_to_input(input_buf[idx].w, crypt_key[idx].c, j&(MMX_COEF-1));
 			else if (ip&1)
@@ -5331,10 +5447,17 @@ void DynamicFunc__append_from_last_output2_as_base16(DYNA_OMP_PARAMS)
 		for (; i < til; ++i)
 		{
 			unsigned ip, j;
-			idx = ( ((unsigned)i)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)i)/MMX_COEF);
+#ifdef SSE_BASE16_GROUP
+			if (!(i&(MMX_COEF-1)) && i+MMX_COEF <= til &&
+			    __SSE_append_base16_group(input_buf2[idx].w, crypt_key2[idx].w, &total_len2[idx*MMX_COEF])) {
+				i += MMX_COEF-1;
+				continue;
+			}
+#endif
 			// This is the 'actual' work.
-			ip = (total_len2[idx] >> ((32/MMX_COEF)*(i&(MMX_COEF-1)))) & 0xFF;
-			total_len2[idx] += (32<<((32/MMX_COEF)*(i&(MMX_COEF-1))));
+			ip = total_len2[idx*MMX_COEF+(i&(MMX_COEF-1))];
+			total_len2[idx*MMX_COEF+(i&(MMX_COEF-1))] += 32;
 			if (!ip)
 				__SSE_append_output_base16_to_input(input_buf2[idx].w, crypt_key2[idx].c, i&(MMX_COEF-1));
 			else if (ip&1)
@@ -5404,7 +5527,14 @@ void DynamicFunc__overwrite_from_last_output_to_input2_as_base16_no_size_fix(DYN
 		unsigned idx;
 		for (; i < til; ++i)
 		{
-			idx = ( ((unsigned)i)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)i)/MMX_COEF);
+#ifdef SSE_BASE16_GROUP
+			if (!(i&(MMX_COEF-1)) && i+MMX_COEF <= til) {
+				__SSE_base16_group(input_buf2[idx].w, crypt_key[idx].w, 0);
+				i += MMX_COEF-1;
+				continue;
+			}
+#endif
 			__SSE_overwrite_output_base16_to_input(input_buf2[idx].w, crypt_key[idx].c, i&(MMX_COEF-1));
 		}
 		return;
@@ -5448,7 +5578,14 @@ void DynamicFunc__overwrite_from_last_output2_as_base16_no_size_fix(DYNA_OMP_PAR
 		unsigned idx;
 		for (; i < til; ++i)
 		{
-			idx = ( ((unsigned)i)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)i)/MMX_COEF);
+#ifdef SSE_BASE16_GROUP
+			if (!(i&(MMX_COEF-1)) && i+MMX_COEF <= til) {
+				__SSE_base16_group(input_buf2[idx].w, crypt_key2[idx].w, 0);
+				i += MMX_COEF-1;
+				continue;
+			}
+#endif
 			__SSE_overwrite_output_base16_to_input(input_buf2[idx].w, crypt_key2[idx].c, i&(MMX_COEF-1));
 		}
 		return;
@@ -5496,10 +5633,17 @@ void DynamicFunc__append_from_last_output_to_input2_as_base16(DYNA_OMP_PARAMS)
 		for (; index < til; ++index)
 		{
 			unsigned ip;
-			idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)index)/MMX_COEF);
+#ifdef SSE_BASE16_GROUP
+			if (!(index&(MMX_COEF-1)) && index+MMX_COEF <= til &&
+			    __SSE_append_base16_group(input_buf2[idx].w, crypt_key[idx].w, &total_len2[idx*MMX_COEF])) {
+				index += MMX_COEF-1;
+				continue;
+			}
+#endif
 			// This is the 'actual' work.
-			ip = (total_len2[idx] >> ((32/MMX_COEF)*(index&(MMX_COEF-1)))) & 0xFF;
-			total_len2[idx] += (32<<((32/MMX_COEF)*(index&(MMX_COEF-1))));
+			ip = total_len2[idx*MMX_COEF+(index&(MMX_COEF-1))];
+			total_len2[idx*MMX_COEF+(index&(MMX_COEF-1))] += 32;
 			if (!ip)
 				__SSE_append_output_base16_to_input(input_buf2[idx].w, crypt_key[idx].c, index&(MMX_COEF-1));
 			else if (ip&1)
@@ -5568,10 +5712,17 @@ void DynamicFunc__append_from_last_output2_to_input1_as_base16(DYNA_OMP_PARAMS)
 		for (; index < til; ++index)
 		{
 			unsigned ip;
-			idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)index)/MMX_COEF);
+#ifdef SSE_BASE16_GROUP
+			if (!(index&(MMX_COEF-1)) && index+MMX_COEF <= til &&
+			    __SSE_append_base16_group(input_buf[idx].w, crypt_key2[idx].w, &total_len[idx*MMX_COEF])) {
+				index += MMX_COEF-1;
+				continue;
+			}
+#endif
 			// This is the 'actual' work.
-			ip = (total_len[idx] >> ((32/MMX_COEF)*(index&(MMX_COEF-1)))) & 0xFF;
-			total_len[idx] += (32<<((32/MMX_COEF)*(index&(MMX_COEF-1))));
+			ip = total_len[idx*MMX_COEF+(index&(MMX_COEF-1))];
+			total_len[idx*MMX_COEF+(index&(MMX_COEF-1))] += 32;
 			if (!ip)
 				__SSE_append_output_base16_to_input(input_buf[idx].w, crypt_key2[idx].c, index&(MMX_COEF-1));
 			else if (ip&1)
@@ -5635,9 +5786,9 @@ void DynamicFunc__append_from_last_output2_as_raw(DYNA_OMP_PARAMS)
 		for (; index < til; ++index)
 		{
 			unsigned ip;
-			idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)index)/MMX_COEF);
 			// This is the 'actual' work.
-			ip = (total_len[idx] >> ((32/MMX_COEF)*(index&(MMX_COEF-1)))) & 0xFF;
+			ip = total_len[idx*MMX_COEF+(index&(MMX_COEF-1))];
 			if (!ip)
 			{
 				ARCH_WORD_32 *po = input_buf[idx].w;
@@ -5658,7 +5809,7 @@ void DynamicFunc__append_from_last_output2_as_raw(DYNA_OMP_PARAMS)
 					input_buf[idx].c[GETPOS(ip+i, index&(MMX_COEF-1))] = crypt_key2[idx].c[GETPOS(i, index&(MMX_COEF-1))];
 				input_buf[idx].c[GETPOS(ip+16, index&(MMX_COEF-1))] = 0x80;
 			}
-			total_len[idx] += (16<<((32/MMX_COEF)*(index&(MMX_COEF-1))));
+			total_len[idx*MMX_COEF+(index&(MMX_COEF-1))] += 16;
 		}
 		return;
 	}
@@ -5698,9 +5849,9 @@ void DynamicFunc__append2_from_last_output2_as_raw(DYNA_OMP_PARAMS)
 		for (; index < til; ++index)
 		{
 			unsigned ip;
-			idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)index)/MMX_COEF);
 			// This is the 'actual' work.
-			ip = (total_len2[idx] >> ((32/MMX_COEF)*(index&(MMX_COEF-1)))) & 0xFF;
+			ip = total_len2[idx*MMX_COEF+(index&(MMX_COEF-1))];
 			if (!ip)
 			{
 				ARCH_WORD_32 *po = input_buf2[idx].w;
@@ -5721,7 +5872,7 @@ void DynamicFunc__append2_from_last_output2_as_raw(DYNA_OMP_PARAMS)
 					input_buf2[idx].c[GETPOS(ip+i, index&(MMX_COEF-1))] = crypt_key2[idx].c[GETPOS(i, index&(MMX_COEF-1))];
 				input_buf2[idx].c[GETPOS(ip+16, index&(MMX_COEF-1))] = 0x80;
 			}
-			total_len2[idx] += (16<<((32/MMX_COEF)*(index&(MMX_COEF-1))));
+			total_len2[idx*MMX_COEF+(index&(MMX_COEF-1))] += 16;
 		}
 		return;
 	}
@@ -5760,9 +5911,9 @@ void DynamicFunc__append_from_last_output1_as_raw(DYNA_OMP_PARAMS)
 		for (index = i; index < til; ++index)
 		{
 			unsigned ip;
-			idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)index)/MMX_COEF);
 			// This is the 'actual' work.
-			ip = (total_len[idx] >> ((32/MMX_COEF)*(index&(MMX_COEF-1)))) & 0xFF;
+			ip = total_len[idx*MMX_COEF+(index&(MMX_COEF-1))];
 			if (!ip)
 			{
 				ARCH_WORD_32 *po = input_buf[idx].w;
@@ -5783,7 +5934,7 @@ void DynamicFunc__append_from_last_output1_as_raw(DYNA_OMP_PARAMS)
 					input_buf[idx].c[GETPOS(ip+i, index&(MMX_COEF-1))] = crypt_key[idx].c[GETPOS(i, index&(MMX_COEF-1))];
 				input_buf[idx].c[GETPOS(ip+16, index&(MMX_COEF-1))] = 0x80;
 			}
-			total_len[idx] += (16<<((32/MMX_COEF)*(index&(MMX_COEF-1))));
+			total_len[idx*MMX_COEF+(index&(MMX_COEF-1))] += 16;
 		}
 		return;
 	}
@@ -5822,9 +5973,9 @@ void DynamicFunc__append2_from_last_output1_as_raw(DYNA_OMP_PARAMS)
 		for (index = i; index < til; ++index)
 		{
 			unsigned ip;
-			idx = ( ((unsigned)index)>>(MMX_COEF>>1));
+			idx = ( ((unsigned)index)/MMX_COEF);
 			// This is the 'actual' work.
-			ip = (total_len2[idx] >> ((32/MMX_COEF)*(index&(MMX_COEF-1)))) & 0xFF;
+			ip = total_len2[idx*MMX_COEF+(index&(MMX_COEF-1))];
 			if (!ip)
 			{
 				ARCH_WORD_32 *po = input_buf2[idx].w;
@@ -5845,7 +5996,7 @@ void DynamicFunc__append2_from_last_output1_as_raw(DYNA_OMP_PARAMS)
 					input_buf2[idx].c[GETPOS(ip+i, index&(MMX_COEF-1))] = crypt_key[idx].c[GETPOS(i, index&(MMX_COEF-1))];
 				input_buf2[idx].c[GETPOS(ip+16, index&(MMX_COEF-1))] = 0x80;
 			}
-			total_len2[idx] += (16<<((32/MMX_COEF)*(index&(MMX_COEF-1))));
+			total_len2[idx*MMX_COEF+(index&(MMX_COEF-1))] += 16;
 		}
 		return;
 	}
@@ -6051,9 +6202,18 @@ void DynamicFunc__append2_fld9(DYNA_OMP_PARAMS)
 	__append2_string(DYNA_OMP_PARAMSdm flds[9], fld_lens[9]);
 }
 
+#ifdef MMX_COEF
+/* 32 bit word pointer into the flat x86 buffer of candidate i */
+#if (MD5_X2)
+#define X86_W(buf, i) (((i)&1) ? (buf)[(i)>>1].x2.w2 : (buf)[(i)>>1].x1.w)
+#else
+#define X86_W(buf, i) ((buf)[i].x1.w)
+#endif
+#endif
+
 void DynamicFunc__SSEtoX86_switch_input1(DYNA_OMP_PARAMS) {
 #ifdef MMX_COEF
-	int j, k, idx, max;
+	int j, k, l, idx, max;
 	if (dynamic_use_sse == 0)
 		return;
 	dynamic_use_sse = 2;
@@ -6061,58 +6221,30 @@ void DynamicFunc__SSEtoX86_switch_input1(DYNA_OMP_PARAMS) {
 	for (j = 0; j < m_count; j += MMX_COEF)
 	{
 		ARCH_WORD_32 *cpi;
-#if (MD5_X2)
-		ARCH_WORD_32 *cpo  = input_buf_X86[j>>1].x1.w;
-		ARCH_WORD_32 *cpo2 = input_buf_X86[j>>1].x2.w2;
-		ARCH_WORD_32 *cpo3 = input_buf_X86[(j>>1)+1].x1.w;
-		ARCH_WORD_32 *cpo4 = input_buf_X86[(j>>1)+1].x2.w2;
-#else
-		ARCH_WORD_32 *cpo = input_buf_X86[j].x1.w;
-		ARCH_WORD_32 *cpo2 = input_buf_X86[j+1].x1.w;
-#if (MMX_COEF==4)
-		ARCH_WORD_32 *cpo3 = input_buf_X86[j+2].x1.w;
-		ARCH_WORD_32 *cpo4 = input_buf_X86[j+3].x1.w;
-#endif
-#endif
-		idx = ( ((unsigned)j)>>(MMX_COEF>>1));
+		ARCH_WORD_32 *cpo[MMX_COEF];
+		idx = ( ((unsigned)j)/MMX_COEF);
 		cpi = input_buf[idx].w;
 
-		max = total_len_X86[j] = (total_len[idx]&0xFF);
-		if (max < (total_len_X86[j+1]=((total_len[idx]>> 8)&0xFF)))
-			max = total_len_X86[j+1];
-		if (max < (total_len_X86[j+2]=((total_len[idx]>>16)&0xFF)))
-			max = total_len_X86[j+2];
-		if (max < (total_len_X86[j+3]=((total_len[idx]>>24)&0xFF)))
-			max = total_len_X86[j+3];
-		max = (max+3)>>2;
-		for (k = 0; k < max; ++k) {
-			*cpo++ = *cpi++;
-			*cpo2++ = *cpi++;
-#if (MMX_COEF==4)
-			*cpo3++ = *cpi++;
-			*cpo4++ = *cpi++;
-#endif
+		max = 0;
+		for (l = 0; l < MMX_COEF; ++l) {
+			cpo[l] = X86_W(input_buf_X86, j+l);
+			total_len_X86[j+l] = total_len[idx*MMX_COEF+l];
+			if (max < total_len_X86[j+l])
+				max = total_len_X86[j+l];
 		}
-#if (MD5_X2)
-		input_buf_X86[j>>1].x1.b[total_len_X86[j]] = 0;
-		input_buf_X86[j>>1].x2.b2[total_len_X86[j+1]] = 0;
-		input_buf_X86[(j>>1)+1].x1.b[total_len_X86[j+2]] = 0;
-		input_buf_X86[(j>>1)+1].x2.b2[total_len_X86[j+3]] = 0;
-#else
-		input_buf_X86[j].x1.b[total_len_X86[j]] = 0;
-		input_buf_X86[j+1].x1.b[total_len_X86[j+1]] = 0;
-#if (MMX_COEF==4)
-		input_buf_X86[j+2].x1.b[total_len_X86[j+2]] = 0;
-		input_buf_X86[j+3].x1.b[total_len_X86[j+3]] = 0;
-#endif
-#endif
+		max = (max+3)>>2;
+		for (k = 0; k < max; ++k)
+			for (l = 0; l < MMX_COEF; ++l)
+				*cpo[l]++ = *cpi++;
+		// get rid of the 0x80
+		for (l = 0; l < MMX_COEF; ++l)
+			((unsigned char*)X86_W(input_buf_X86, j+l))[total_len_X86[j+l]] = 0;
 	}
 #endif
 }
 void DynamicFunc__SSEtoX86_switch_input2(DYNA_OMP_PARAMS) {
 #ifdef MMX_COEF
-	int j, k, idx, max;
-
+	int j, k, l, idx, max;
 	if (dynamic_use_sse == 0)
 		return;
 	dynamic_use_sse = 2;
@@ -6120,58 +6252,30 @@ void DynamicFunc__SSEtoX86_switch_input2(DYNA_OMP_PARAMS) {
 	for (j = 0; j < m_count; j += MMX_COEF)
 	{
 		ARCH_WORD_32 *cpi;
-#if (MD5_X2)
-		ARCH_WORD_32 *cpo  = input_buf2_X86[j>>1].x1.w;
-		ARCH_WORD_32 *cpo2 = input_buf2_X86[j>>1].x2.w2;
-		ARCH_WORD_32 *cpo3 = input_buf2_X86[(j>>1)+1].x1.w;
-		ARCH_WORD_32 *cpo4 = input_buf2_X86[(j>>1)+1].x2.w2;
-#else
-		ARCH_WORD_32 *cpo = input_buf2_X86[j].x1.w;
-		ARCH_WORD_32 *cpo2 = input_buf2_X86[j+1].x1.w;
-#if (MMX_COEF==4)
-		ARCH_WORD_32 *cpo3 = input_buf2_X86[j+2].x1.w;
-		ARCH_WORD_32 *cpo4 = input_buf2_X86[j+3].x1.w;
-#endif
-#endif
-		idx = ( ((unsigned)j)>>(MMX_COEF>>1));
+		ARCH_WORD_32 *cpo[MMX_COEF];
+		idx = ( ((unsigned)j)/MMX_COEF);
 		cpi = input_buf2[idx].w;
 
-		max = total_len2_X86[j] = (total_len2[idx]&0xFF);
-		if (max < (total_len2_X86[j+1]=((total_len2[idx]>> 8)&0xFF)))
-			max = total_len2_X86[j+1];
-		if (max < (total_len2_X86[j+2]=((total_len2[idx]>>16)&0xFF)))
-			max = total_len2_X86[j+2];
-		if (max < (total_len2_X86[j+3]=((total_len2[idx]>>24)&0xFF)))
-			max = total_len2_X86[j+3];
-		max = (max+3)>>2;
-		for (k = 0; k < max; ++k) {
-			*cpo++ = *cpi++;
-			*cpo2++ = *cpi++;
-#if (MMX_COEF==4)
-			*cpo3++ = *cpi++;
-			*cpo4++ = *cpi++;
-#endif
+		max = 0;
+		for (l = 0; l < MMX_COEF; ++l) {
+			cpo[l] = X86_W(input_buf2_X86, j+l);
+			total_len2_X86[j+l] = total_len2[idx*MMX_COEF+l];
+			if (max < total_len2_X86[j+l])
+				max = total_len2_X86[j+l];
 		}
+		max = (max+3)>>2;
+		for (k = 0; k < max; ++k)
+			for (l = 0; l < MMX_COEF; ++l)
+				*cpo[l]++ = *cpi++;
 		// get rid of the 0x80
-#if (MD5_X2)
-		input_buf2_X86[j>>1].x1.b[total_len2_X86[j]] = 0;
-		input_buf2_X86[j>>1].x2.b2[total_len2_X86[j+1]] = 0;
-		input_buf2_X86[(j>>1)+1].x1.b[total_len2_X86[j+2]] = 0;
-		input_buf2_X86[(j>>1)+1].x2.b2[total_len2_X86[j+3]] = 0;
-#else
-		input_buf2_X86[j].x1.b[total_len2_X86[j]] = 0;
-		input_buf2_X86[j+1].x1.b[total_len2_X86[j+1]] = 0;
-#if (MMX_COEF==4)
-		input_buf2_X86[j+2].x1.b[total_len2_X86[j+2]] = 0;
-		input_buf2_X86[j+3].x1.b[total_len2_X86[j+3]] = 0;
-#endif
-#endif
+		for (l = 0; l < MMX_COEF; ++l)
+			((unsigned char*)X86_W(input_buf2_X86, j+l))[total_len2_X86[j+l]] = 0;
 	}
 #endif
 }
 void DynamicFunc__SSEtoX86_switch_output1(DYNA_OMP_PARAMS) {
 #ifdef MMX_COEF
-	int j, k, idx;
+	int j, k, l, idx;
 
 	if (dynamic_use_sse == 0)
 		return;
@@ -6180,35 +6284,20 @@ void DynamicFunc__SSEtoX86_switch_output1(DYNA_OMP_PARAMS) {
 	for (j = 0; j < m_count; j += MMX_COEF)
 	{
 		ARCH_WORD_32 *cpi;
-#if (MD5_X2)
-		ARCH_WORD_32 *cpo = crypt_key_X86[j>>1].x1.w;
-		ARCH_WORD_32 *cpo2 = crypt_key_X86[j>>1].x2.w2;
-		ARCH_WORD_32 *cpo3 = crypt_key_X86[(j>>1)+1].x1.w;
-		ARCH_WORD_32 *cpo4 = crypt_key_X86[(j>>1)+1].x2.w2;
-#else
-		ARCH_WORD_32 *cpo = crypt_key_X86[j].x1.w;
-		ARCH_WORD_32 *cpo2 = crypt_key_X86[j+1].x1.w;
-#if (MMX_COEF==4)
-		ARCH_WORD_32 *cpo3 = crypt_key_X86[j+2].x1.w;
-		ARCH_WORD_32 *cpo4 = crypt_key_X86[j+3].x1.w;
-#endif
-#endif
-		idx = ( ((unsigned)j)>>(MMX_COEF>>1));
-		cpi = (void*)crypt_key[idx].c;
-		for (k = 0; k < 4; ++k) {
-			*cpo++ = *cpi++;
-			*cpo2++ = *cpi++;
-#if (MMX_COEF==4)
-			*cpo3++ = *cpi++;
-			*cpo4++ = *cpi++;
-#endif
-		}
+		ARCH_WORD_32 *cpo[MMX_COEF];
+		for (l = 0; l < MMX_COEF; ++l)
+			cpo[l] = X86_W(crypt_key_X86, j+l);
+		idx = ( ((unsigned)j)/MMX_COEF);
+		cpi = crypt_key[idx].w;
+		for (k = 0; k < 4; ++k)
+			for (l = 0; l < MMX_COEF; ++l)
+				*cpo[l]++ = *cpi++;
 	}
 #endif
 }
 void DynamicFunc__SSEtoX86_switch_output2(DYNA_OMP_PARAMS) {
 #ifdef MMX_COEF
-	int j, k, idx;
+	int j, k, l, idx;
 
 	if (dynamic_use_sse == 0)
 		return;
@@ -6217,29 +6306,14 @@ void DynamicFunc__SSEtoX86_switch_output2(DYNA_OMP_PARAMS) {
 	for (j = 0; j < m_count; j += MMX_COEF)
 	{
 		ARCH_WORD_32 *cpi;
-#if (MD5_X2)
-		ARCH_WORD_32 *cpo = crypt_key2_X86[j>>1].x1.w;
-		ARCH_WORD_32 *cpo2 = crypt_key2_X86[j>>1].x2.w2;
-		ARCH_WORD_32 *cpo3 = crypt_key2_X86[(j>>1)+1].x1.w;
-		ARCH_WORD_32 *cpo4 = crypt_key2_X86[(j>>1)+1].x2.w2;
-#else
-		ARCH_WORD_32 *cpo = crypt_key2_X86[j].x1.w;
-		ARCH_WORD_32 *cpo2 = crypt_key2_X86[j+1].x1.w;
-#if (MMX_COEF==4)
-		ARCH_WORD_32 *cpo3 = crypt_key2_X86[j+2].x1.w;
-		ARCH_WORD_32 *cpo4 = crypt_key2_X86[j+3].x1.w;
-#endif
-#endif
-		idx = ( ((unsigned)j)>>(MMX_COEF>>1));
+		ARCH_WORD_32 *cpo[MMX_COEF];
+		for (l = 0; l < MMX_COEF; ++l)
+			cpo[l] = X86_W(crypt_key2_X86, j+l);
+		idx = ( ((unsigned)j)/MMX_COEF);
 		cpi = crypt_key2[idx].w;
-		for (k = 0; k < 4; ++k) {
-			*cpo++ = *cpi++;
-			*cpo2++ = *cpi++;
-#if (MMX_COEF==4)
-			*cpo3++ = *cpi++;
-			*cpo4++ = *cpi++;
-#endif
-		}
+		for (k = 0; k < 4; ++k)
+			for (l = 0; l < MMX_COEF; ++l)
+				*cpo[l]++ = *cpi++;
 	}
 #endif
 }
@@ -6251,9 +6325,9 @@ void DynamicFunc__X86toSSE_switch_input1(DYNA_OMP_PARAMS) {
 	dynamic_use_sse = 1;
 	__nonMP_DynamicFunc__clean_input();
 	for (j = 0; j < m_count; ++j) {
-		idx = (j>>(MMX_COEF>>1));
+		idx = (j/MMX_COEF);
 		idx_mod = j&(MMX_COEF-1);
-		total_len[idx] += (total_len_X86[j] << ((32/MMX_COEF)*idx_mod));
+		total_len[idx*MMX_COEF+idx_mod] += total_len_X86[j];
 #if (MD5_X2)
 		if (j & 1)
 			__SSE_append_string_to_input(input_buf[idx].c,idx_mod,input_buf_X86[j>>1].x2.B2,total_len_X86[j],0,1);
@@ -6271,9 +6345,9 @@ void DynamicFunc__X86toSSE_switch_input2(DYNA_OMP_PARAMS) {
 	dynamic_use_sse = 1;
 	__nonMP_DynamicFunc__clean_input2();
 	for (j = 0; j < m_count; ++j) {
-		idx = (j>>(MMX_COEF>>1));
+		idx = (j/MMX_COEF);
 		idx_mod = j&(MMX_COEF-1);
-		total_len2[idx] += (total_len2_X86[j] << ((32/MMX_COEF)*idx_mod));
+		total_len2[idx*MMX_COEF+idx_mod] += total_len2_X86[j];
 #if (MD5_X2)
 		if (j & 1)
 			__SSE_append_string_to_input(input_buf2[idx].c,idx_mod,input_buf2_X86[j>>1].x2.B2,total_len2_X86[j],0,1);
@@ -6285,7 +6359,7 @@ void DynamicFunc__X86toSSE_switch_input2(DYNA_OMP_PARAMS) {
 }
 void DynamicFunc__X86toSSE_switch_output1(DYNA_OMP_PARAMS) {
 #ifdef MMX_COEF
-	int j, k, idx;
+	int j, k, l, idx;
 
 	if (dynamic_use_sse == 0)
 		return;
@@ -6294,35 +6368,20 @@ void DynamicFunc__X86toSSE_switch_output1(DYNA_OMP_PARAMS) {
 	for (j = 0; j < m_count; j += MMX_COEF)
 	{
 		ARCH_WORD_32 *cpi;
-#if (MD5_X2)
-		ARCH_WORD_32 *cpo = crypt_key_X86[j>>1].x1.w;
-		ARCH_WORD_32 *cpo2 = crypt_key_X86[j>>1].x2.w2;
-		ARCH_WORD_32 *cpo3 = crypt_key_X86[(j>>1)+1].x1.w;
-		ARCH_WORD_32 *cpo4 = crypt_key_X86[(j>>1)+1].x2.w2;
-#else
-		ARCH_WORD_32 *cpo = crypt_key_X86[j].x1.w;
-		ARCH_WORD_32 *cpo2 = crypt_key_X86[j+1].x1.w;
-#if (MMX_COEF==4)
-		ARCH_WORD_32 *cpo3 = crypt_key_X86[j+2].x1.w;
-		ARCH_WORD_32 *cpo4 = crypt_key_X86[j+3].x1.w;
-#endif
-#endif
-		idx = ( ((unsigned)j)>>(MMX_COEF>>1));
-		cpi = (void*)crypt_key[idx].c;
-		for (k = 0; k < 4; ++k) {
-			*cpi++ = *cpo++;
-			*cpi++ = *cpo2++;
-#if (MMX_COEF==4)
-			*cpi++ = *cpo3++;
-			*cpi++ = *cpo4++;
-#endif
-		}
+		ARCH_WORD_32 *cpo[MMX_COEF];
+		for (l = 0; l < MMX_COEF; ++l)
+			cpo[l] = X86_W(crypt_key_X86, j+l);
+		idx = ( ((unsigned)j)/MMX_COEF);
+		cpi = crypt_key[idx].w;
+		for (k = 0; k < 4; ++k)
+			for (l = 0; l < MMX_COEF; ++l)
+				*cpi++ = *cpo[l]++;
 	}
 #endif
 }
 void DynamicFunc__X86toSSE_switch_output2(DYNA_OMP_PARAMS) {
 #ifdef MMX_COEF
-	int j, k, idx;
+	int j, k, l, idx;
 
 	if (dynamic_use_sse == 0)
 		return;
@@ -6331,29 +6390,14 @@ void DynamicFunc__X86toSSE_switch_output2(DYNA_OMP_PARAMS) {
 	for (j = 0; j < m_count; j += MMX_COEF)
 	{
 		ARCH_WORD_32 *cpi;
-#if (MD5_X2)
-		ARCH_WORD_32 *cpo = crypt_key2_X86[j>>1].x1.w;
-		ARCH_WORD_32 *cpo2 = crypt_key2_X86[j>>1].x2.w2;
-		ARCH_WORD_32 *cpo3 = crypt_key2_X86[(j>>1)+1].x1.w;
-		ARCH_WORD_32 *cpo4 = crypt_key2_X86[(j>>1)+1].x2.w2;
-#else
-		ARCH_WORD_32 *cpo = crypt_key2_X86[j].x1.w;
-		ARCH_WORD_32 *cpo2 = crypt_key2_X86[j+1].x1.w;
-#if (MMX_COEF==4)
-		ARCH_WORD_32 *cpo3 = crypt_key2_X86[j+2].x1.w;
-		ARCH_WORD_32 *cpo4 = crypt_key2_X86[j+3].x1.w;
-#endif
-#endif
-		idx = ( ((unsigned)j)>>(MMX_COEF>>1));
+		ARCH_WORD_32 *cpo[MMX_COEF];
+		for (l = 0; l < MMX_COEF; ++l)
+			cpo[l] = X86_W(crypt_key2_X86, j+l);
+		idx = ( ((unsigned)j)/MMX_COEF);
 		cpi = crypt_key2[idx].w;
-		for (k = 0; k < 4; ++k) {
-			*cpi++ = *cpo++;
-			*cpi++ = *cpo2++;
-#if (MMX_COEF==4)
-			*cpi++ = *cpo3++;
-			*cpi++ = *cpo4++;
-#endif
-		}
+		for (k = 0; k < 4; ++k)
+			for (l = 0; l < MMX_COEF; ++l)
+				*cpi++ = *cpo[l]++;
 	}
 #endif
 }
@@ -6535,6 +6579,61 @@ static DYNAMIC_primitive_funcp *ConvertFuncs(DYNAMIC_primitive_funcp p, int *cou
 	return fncs;
 }
 
+// Comment this out to run scripts exactly as written, e.g. to compare
+// the fused primitives against the originals.
+#define DYNAMIC_FUSION
+
+#ifdef DYNAMIC_FUSION
+// Runs of primitives, longest first, and what replaces them.  See the
+// 'DYNAMIC primitive fusion' comment above the fused primitives.
+static struct {
+	DYNAMIC_primitive_funcp run[5];
+	DYNAMIC_primitive_funcp fused;
+} FusedFuncs[] = {
+	{ { DynamicFunc__crypt_md5,
+	    DynamicFunc__overwrite_from_last_output_to_input2_as_base16_no_size_fix,
+	    DynamicFunc__set_input2_len_32,
+	    DynamicFunc__crypt_md5_in2_to_out1, NULL },
+	  DynamicFunc__crypt_md5_base16_to_input2_crypt_to_out1 },
+	{ { DynamicFunc__crypt2_md5,
+	    DynamicFunc__overwrite_from_last_output2_as_base16_no_size_fix,
+	    DynamicFunc__set_input2_len_32,
+	    DynamicFunc__crypt_md5_in2_to_out1, NULL },
+	  DynamicFunc__crypt2_md5_base16_to_input2_crypt_to_out1 },
+	{ { DynamicFunc__crypt_md5,
+	    DynamicFunc__overwrite_from_last_output_to_input2_as_base16_no_size_fix,
+	    DynamicFunc__set_input2_len_32, NULL },
+	  DynamicFunc__crypt_md5_base16_to_input2 },
+	{ { DynamicFunc__crypt2_md5,
+	    DynamicFunc__overwrite_from_last_output2_as_base16_no_size_fix,
+	    DynamicFunc__set_input2_len_32, NULL },
+	  DynamicFunc__crypt2_md5_base16_to_input2 },
+};
+
+// Replace fusable runs in the NULL terminated pFuncs, in place.
+static void FuseFuncs(DYNAMIC_primitive_funcp *pFuncs)
+{
+	unsigned f;
+	int i, j, n;
+
+	for (i = j = 0; pFuncs[i]; ++j) {
+		for (f = 0; f < ARRAY_COUNT(FusedFuncs); ++f) {
+			for (n = 0; FusedFuncs[f].run[n]; ++n)
+				if (pFuncs[i+n] != FusedFuncs[f].run[n])
+					break;
+			if (!FusedFuncs[f].run[n])
+				break;
+		}
+		if (f < ARRAY_COUNT(FusedFuncs)) {
+			pFuncs[j] = FusedFuncs[f].fused;
+			i += n;
+		} else
+			pFuncs[j] = pFuncs[i++];
+	}
+	pFuncs[j] = NULL;
+}
+#endif
+
 #ifdef _OPENMP
 static int isBadOMPFunc(DYNAMIC_primitive_funcp p) {
 	// If ANY of these functions are seen, we can NOT use OMP for this single format.
@@ -6774,9 +6873,20 @@ static void dyna_setupOMP(DYNAMIC_Setup *Setup, struct fmt_main *pFmt) {
 #ifndef MMX_COEF
 	curdat.omp_granularity=OMP_INC;
 #else
-	if ((curdat.pSetup->flags& MGF_NOTSSE2Safe) == MGF_NOTSSE2Safe)
+	if ((curdat.pSetup->flags& MGF_NOTSSE2Safe) == MGF_NOTSSE2Safe) {
 		curdat.omp_granularity=OMP_INC;
-	else {
+		// The SHA2 primitives step whole SIMD groups even on flat x86 buffers.
+		for (i=0; Setup->pFuncs[i]; ++i) {
+#if MMX_COEF_SHA256
+			if (isSHA2_256Func(Setup->pFuncs[i]))
+				curdat.omp_granularity = LCM(curdat.omp_granularity, MMX_COEF_SHA256);
+#endif
+#if MMX_COEF_SHA512
+			if (isSHA2_512Func(Setup->pFuncs[i]))
+				curdat.omp_granularity = LCM(curdat.omp_granularity, MMX_COEF_SHA512);
+#endif
+		}
+	} else {
 		curdat.omp_granularity = 1;
 		for (i=0; Setup->pFuncs[i]; ++i) {
 			if (isMD5Func(Setup->pFuncs[i]))
@@ -7341,6 +7451,9 @@ int dynamic_SETUP(DYNAMIC_Setup *Setup, struct fmt_main *pFmt)
 			}
 		}
 		curdat.dynamic_FUNCTIONS[j] = NULL;
+#ifdef DYNAMIC_FUSION
+		FuseFuncs(curdat.dynamic_FUNCTIONS);
+#endif
 	}
 	if (!Setup->pPreloads || Setup->pPreloads[0].ciphertext == NULL)
 	{
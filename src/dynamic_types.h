@@ -160,6 +160,26 @@ typedef struct private_subformat_data
 #   elif MD5_SSE_PARA==6
 #    define BY_X			240
 #   endif
+// wider SIMD keeps the same key count (it must match the x86 buffers), so
+// it just uses fewer blocks
+#  elif MMX_COEF == 8
+#   define BLOCK_LOOPS		768
+#   if !defined MD5_SSE_PARA || MD5_SSE_PARA==1
+#    define BY_X			768
+#   elif MD5_SSE_PARA==2
+#    define BY_X			384
+#   elif MD5_SSE_PARA==3
+#    define BY_X			256
+#   endif
+#  elif MMX_COEF == 16
+#   define BLOCK_LOOPS		384
+#   if !defined MD5_SSE_PARA || MD5_SSE_PARA==1
+#    define BY_X			384
+#   elif MD5_SSE_PARA==2
+#    define BY_X			192
+#   elif MD5_SSE_PARA==3
+#    define BY_X			128
+#   endif
 #  endif
 # else
 #  if MMX_COEF == 4
@@ -177,31 +197,49 @@ typedef struct private_subformat_data
 #   elif MD5_SSE_PARA==6
 #    define BY_X			5
 #   endif
-# endif
+#  elif MMX_COEF == 8
+#   define BLOCK_LOOPS		16
+#   if !defined MD5_SSE_PARA || MD5_SSE_PARA==1
+#    define BY_X			16
+#   elif MD5_SSE_PARA==2
+#    define BY_X			8
+#   elif MD5_SSE_PARA==3
+#    define BY_X			5
+#   endif
+#  elif MMX_COEF == 16
+#   define BLOCK_LOOPS		8
+#   if !defined MD5_SSE_PARA || MD5_SSE_PARA==1
+#    define BY_X			8
+#   elif MD5_SSE_PARA==2
+#    define BY_X			4
+#   elif MD5_SSE_PARA==3
+#    define BY_X			2
+#   endif
+#  endif
 # endif
 # define LOOP_STR
-# if MMX_COEF == 4
+# if MMX_COEF >= 4
 #  ifdef MD5_SSE_PARA
-#   define ALGORITHM_NAME		"128/128 " MD5_SSE_type  " " STRINGIZE(BY_X) "x4x" STRINGIZE(MD5_SSE_PARA)
+#   define ALGORITHM_NAME		SIMD_WIDTH_STR MD5_SSE_type  " " STRINGIZE(BY_X) "x" STRINGIZE(MMX_COEF) "x" STRINGIZE(MD5_SSE_PARA)
 #   define BSD_BLKS (MD5_SSE_PARA)
 #  else
-#   define ALGORITHM_NAME		"128/128 " MD5_SSE_type  " " STRINGIZE(BY_X) "x4"
+#   define ALGORITHM_NAME		SIMD_WIDTH_STR MD5_SSE_type  " " STRINGIZE(BY_X) "x" STRINGIZE(MMX_COEF)
 #   define BSD_BLKS 1
 #  endif
 #  ifdef SHA1_SSE_PARA
-#   define ALGORITHM_NAME_S		"128/128 " SHA1_SSE_type " " STRINGIZE(BY_X) "x4x" STRINGIZE(SHA1_SSE_PARA)
+#   define ALGORITHM_NAME_S		SIMD_WIDTH_STR SHA1_SSE_type " " STRINGIZE(BY_X) "x" STRINGIZE(MMX_COEF) "x" STRINGIZE(SHA1_SSE_PARA)
 #  else
-#   define ALGORITHM_NAME_S		"128/128 " SHA1_SSE_type " " STRINGIZE(BY_X) "x4"
+#   define ALGORITHM_NAME_S		SIMD_WIDTH_STR SHA1_SSE_type " " STRINGIZE(BY_X) "x" STRINGIZE(MMX_COEF)
 #  endif
 #  ifdef MD4_SSE_PARA
-#   define ALGORITHM_NAME_4		"128/128 " MD4_SSE_type  " " STRINGIZE(BY_X) "x4x" STRINGIZE(MD4_SSE_PARA)
+#   define ALGORITHM_NAME_4		SIMD_WIDTH_STR MD4_SSE_type  " " STRINGIZE(BY_X) "x" STRINGIZE(MMX_COEF) "x" STRINGIZE(MD4_SSE_PARA)
 #  else
-#   define ALGORITHM_NAME_4		"128/128 " MD4_SSE_type  " " STRINGIZE(BY_X) "x4"
+#   define ALGORITHM_NAME_4		SIMD_WIDTH_STR MD4_SSE_type  " " STRINGIZE(BY_X) "x" STRINGIZE(MMX_COEF)
 #  endif
 #  define PLAINTEXT_LENGTH	(27*3+1) // for worst-case UTF-8
 #  ifdef MD5_SSE_PARA
 // gives us 16 'loops' for para=2 and 10 loops for para==3 (or max of 128 for 2 and 120 for 3)
-#   define MAX_KEYS_PER_CRYPT	(((MMX_COEF*BLOCK_LOOPS)/(MD5_SSE_PARA*4))*(MD5_SSE_PARA*4))
+#   define MAX_KEYS_PER_CRYPT	(((MMX_COEF*BLOCK_LOOPS)/(MD5_SSE_PARA*MMX_COEF))*(MD5_SSE_PARA*MMX_COEF))
 #  else
 #   define MAX_KEYS_PER_CRYPT	MMX_COEF*BLOCK_LOOPS
 #  endif
@@ -228,8 +266,13 @@ typedef struct private_subformat_data
 #define ALGORITHM_NAME_X86_S	ARCH_BITS_STR"/"ARCH_BITS_STR" "STRINGIZE(X86_BLOCK_LOOPS) "x1"
 #define ALGORITHM_NAME_X86_4	ARCH_BITS_STR"/"ARCH_BITS_STR" "STRINGIZE(X86_BLOCK_LOOPS) "x1"
 
+#ifdef MMX_COEF_SHA256
+#define ALGORITHM_NAME_S2_256		SHA256_ALGORITHM_NAME
+#define ALGORITHM_NAME_S2_512		SHA512_ALGORITHM_NAME
+#else
 #define ALGORITHM_NAME_S2_256		"128/128 "CPU_NAME" 4x"
 #define ALGORITHM_NAME_S2_512		"128/128 "CPU_NAME" 2x"
+#endif
 #if defined (COMMON_DIGEST_FOR_OPENSSL)
 #define ALGORITHM_NAME_X86_S2_256	ARCH_BITS_STR"/"ARCH_BITS_STR" "STRINGIZE(X86_BLOCK_LOOPS) "x1 CommonCrypto"
 #define ALGORITHM_NAME_X86_S2_512	ARCH_BITS_STR"/64 "STRINGIZE(X86_BLOCK_LOOPS) "x1 CommonCrypto"
@@ -107,64 +107,67 @@ const uint8_t * decode64_uint32(uint32_t * dst, uint32_t dstbits,
 	return src;
 }
 
-uint8_t *
-escrypt_r(escrypt_local_t * local,
-    const uint8_t * passwd, size_t passwdlen,
-    const uint8_t * setting,
-    uint8_t * buf, size_t buflen)
+/**
+ * parse_setting(setting, N, r, p, salt, saltlen):
+ * Decode the "$7$" setting string into the scrypt parameters and salt.
+ *
+ * Return the length of the prefix before the salt; or 0 on error.
+ */
+static size_t
+parse_setting(const uint8_t * setting,
+    uint64_t * N, uint32_t * r, uint32_t * p,
+    const uint8_t ** salt, size_t * saltlen)
 {
-	uint8_t hash[HASH_SIZE];
-	const uint8_t * src, * salt;
-	uint8_t * dst;
-	size_t prefixlen, saltlen, need;
-	uint64_t N;
-	uint32_t r, p;
+	const uint8_t * src;
 
 	if (setting[0] != '$' || setting[1] != '7' || setting[2] != '$')
-		return NULL;
+		return 0;
 	src = setting + 3;
 
 	{
 		uint32_t N_log2;
 		if (decode64_one(&N_log2, *src))
-			return NULL;
+			return 0;
 		src++;
-		N = (uint64_t)1 << N_log2;
+		*N = (uint64_t)1 << N_log2;
 	}
 
-	src = decode64_uint32(&r, 30, src);
+	src = decode64_uint32(r, 30, src);
 	if (!src)
-		return NULL;
+		return 0;
 
-	src = decode64_uint32(&p, 30, src);
+	src = decode64_uint32(p, 30, src);
 	if (!src)
-		return NULL;
-
-	prefixlen = src - setting;
+		return 0;
 
-	salt = src;
-	src = (uint8_t *)strrchr((char *)salt, '$');
+	*salt = src;
+	src = (uint8_t *)strrchr((char *)*salt, '$');
 	if (src)
-		saltlen = src - salt;
+		*saltlen = src - *salt;
 	else
-		saltlen = strlen((char *)salt);
+		*saltlen = strlen((char *)*salt);
 
-	need = prefixlen + saltlen + 1 + HASH_LEN + 1;
-	if (need > buflen || need < saltlen)
-		return NULL;
+	return *salt - setting;
+}
 
-	if (escrypt_kdf(local, passwd, passwdlen, salt, saltlen,
-	    N, r, p, hash, sizeof(hash)))
-		return NULL;
+/**
+ * encode_result(setting, prefixlen, saltlen, hash, buf, buflen):
+ * Write the setting followed by '$' and the encoded hash into buf.
+ *
+ * Return buf on success; or NULL on error.
+ */
+static uint8_t *
+encode_result(const uint8_t * setting, size_t prefixlen, size_t saltlen,
+    const uint8_t * hash, uint8_t * buf, size_t buflen)
+{
+	uint8_t * dst;
 
 	dst = buf;
 	memcpy(dst, setting, prefixlen + saltlen);
 	dst += prefixlen + saltlen;
 	*dst++ = '$';
 
-	dst = encode64(dst, buflen - (dst - buf), hash, sizeof(hash));
-	/* Could zeroize hash[] here, but escrypt_kdf() doesn't zeroize its
-	 * memory allocations yet anyway. */
+	dst = encode64(dst, buflen - (dst - buf), hash, HASH_SIZE);
 	if (!dst || dst >= buf + buflen) /* Can't happen */
 		return NULL;
 
@@ -173,6 +176,75 @@ escrypt_r(escrypt_local_t * local,
 	return buf;
 }
 
+uint8_t *
+escrypt_r(escrypt_local_t * local,
+    const uint8_t * passwd, size_t passwdlen,
+    const uint8_t * setting,
+    uint8_t * buf, size_t buflen)
+{
+	uint8_t hash[HASH_SIZE];
+	const uint8_t * salt;
+	size_t prefixlen, saltlen, need;
+	uint64_t N;
+	uint32_t r, p;
+
+	prefixlen = parse_setting(setting, &N, &r, &p, &salt, &saltlen);
+	if (!prefixlen)
+		return NULL;
+
+	need = prefixlen + saltlen + 1 + HASH_LEN + 1;
+	if (need > buflen || need < saltlen)
+		return NULL;
+
+	if (escrypt_kdf(local, passwd, passwdlen, salt, saltlen,
+	    N, r, p, hash, sizeof(hash)))
+		return NULL;
+
+	/* Could zeroize hash[] here, but escrypt_kdf() doesn't zeroize its
+	 * memory allocations yet anyway. */
+	return encode_result(setting, prefixlen, saltlen, hash, buf, buflen);
+}
+
+/**
+ * escrypt_r_x2(local, passwd, passwdlen, setting, buf, buflen):
+ * Like escrypt_r(), but for the two passwords passwd[0] and passwd[1],
+ * writing their hashes into buf[0] and buf[1] (each buflen bytes) by way
+ * of escrypt_kdf_x2().
+ *
+ * Return buf[0] on success; or NULL on error.
+ */
+uint8_t *
+escrypt_r_x2(escrypt_local_t * local,
+    const uint8_t * const passwd[2], const size_t passwdlen[2],
+    const uint8_t * setting,
+    uint8_t * const buf[2], size_t buflen)
+{
+	uint8_t hash[2][HASH_SIZE];
+	uint8_t * const hashp[2] = { hash[0], hash[1] };
+	const uint8_t * salt;
+	size_t prefixlen, saltlen, need;
+	uint64_t N;
+	uint32_t r, p;
+
+	prefixlen = parse_setting(setting, &N, &r, &p, &salt, &saltlen);
+	if (!prefixlen)
+		return NULL;
+
+	need = prefixlen + saltlen + 1 + HASH_LEN + 1;
+	if (need > buflen || need < saltlen)
+		return NULL;
+
+	if (escrypt_kdf_x2(local, passwd, passwdlen, salt, saltlen,
+	    N, r, p, hashp, HASH_SIZE))
+		return NULL;
+
+	if (!encode_result(setting, prefixlen, saltlen, hash[1],
+	    buf[1], buflen))
+		return NULL;
+	return encode_result(setting, prefixlen, saltlen, hash[0],
+	    buf[0], buflen);
+}
+
 uint8_t *
 escrypt(const uint8_t * passwd, const uint8_t * setting)
 {
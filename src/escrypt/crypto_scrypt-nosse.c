@@ -330,3 +330,27 @@ escrypt_kdf(escrypt_local_t * local,
 	/* Success! */
 	return 0;
 }
+
+/**
+ * escrypt_kdf_x2(local, passwd, passwdlen, salt, saltlen,
+ *     N, r, p, buf, buflen):
+ * Compute escrypt_kdf() for the two passwords passwd[0] and passwd[1]
+ * under the same salt and parameters, writing the results into buf[0] and
+ * buf[1].  There's nothing to interleave without SSE2, so this is simply
+ * two escrypt_kdf() calls sharing local.
+ *
+ * Return 0 on success; or -1 on error.
+ */
+int
+escrypt_kdf_x2(escrypt_local_t * local,
+    const uint8_t * const passwd[2], const size_t passwdlen[2],
+    const uint8_t * salt, size_t saltlen,
+    uint64_t N, uint32_t r, uint32_t p,
+    uint8_t * const buf[2], size_t buflen)
+{
+	if (escrypt_kdf(local, passwd[0], passwdlen[0], salt, saltlen,
+	    N, r, p, buf[0], buflen))
+		return -1;
+	return escrypt_kdf(local, passwd[1], passwdlen[1], salt, saltlen,
+	    N, r, p, buf[1], buflen);
+}
@@ -215,20 +215,20 @@ integerify(const void * B, size_t r)
 }
 
 /**
- * smix(B, r, N, V, XY):
- * Compute B = SMix_r(B, N).  The input B must be 128r bytes in length;
- * the temporary storage V must be 128rN bytes in length; the temporary
- * storage XY must be 256r + 64 bytes in length.  The value N must be a
- * power of 2 greater than 1.  The arrays B, V, and XY must be aligned to a
- * multiple of 64 bytes.
+ * smix1(B, r, N, V, XY):
+ * Compute the first loop of SMix_r(B, N), filling V, and leave X in XY.
+ * The input B must be 128r bytes in length; the temporary storage V must
+ * be 128rN bytes in length; the temporary storage XY must be 256r + 64
+ * bytes in length.  The value N must be a power of 2 greater than 1.  The
+ * arrays B, V, and XY must be aligned to a multiple of 64 bytes.
  */
 static void
-smix(uint8_t * B, size_t r, uint32_t N, void * V, void * XY)
+smix1(const uint8_t * B, size_t r, uint32_t N, void * V, void * XY)
 {
 	size_t s = 128 * r;
 	__m128i * X = V, * Y;
 	uint32_t * X32 = V;
-	uint32_t i, j;
+	uint32_t i;
 	size_t k;
 
 	/* 1: X <-- B */
@@ -260,11 +260,45 @@ smix(uint8_t * B, size_t r, uint32_t N, void * V, void * XY)
 
 	/* 4: X <-- H(X) */
 	/* 3: V_i <-- X */
-	X = XY;
-	blockmix_salsa8(Y, X, r);
+	blockmix_salsa8(Y, XY, r);
+}
 
-	X32 = XY;
-	Y = (void *)((uintptr_t)(XY) + s);
+/**
+ * smix_out(B, r, XY):
+ * Store the final X from XY back into B.
+ */
+static inline void
+smix_out(uint8_t * B, size_t r, const void * XY)
+{
+	const uint32_t * X32 = XY;
+	uint32_t i;
+	size_t k;
+
+	/* 10: B' <-- X */
+	for (k = 0; k < 2 * r; k++) {
+		for (i = 0; i < 16; i++) {
+			le32enc(&B[(k * 16 + (i * 5 % 16)) * 4],
+			    X32[k * 16 + i]);
+		}
+	}
+}
+
+/**
+ * smix(B, r, N, V, XY):
+ * Compute B = SMix_r(B, N).  The input B must be 128r bytes in length;
+ * the temporary storage V must be 128rN bytes in length; the temporary
+ * storage XY must be 256r + 64 bytes in length.  The value N must be a
+ * power of 2 greater than 1.  The arrays B, V, and XY must be aligned to a
+ * multiple of 64 bytes.
+ */
+static void
+smix(uint8_t * B, size_t r, uint32_t N, void * V, void * XY)
+{
+	size_t s = 128 * r;
+	__m128i * X = XY, * Y = (void *)((uintptr_t)(XY) + s);
+	uint32_t i, j;
+
+	smix1(B, r, N, V, XY);
 
 	/* 7: j <-- Integerify(X) mod N */
 	j = integerify(X, r) & (N - 1);
@@ -283,36 +317,87 @@ smix(uint8_t * B, size_t r, uint32_t N, void * V, void * XY)
 		j = blockmix_salsa8_xor(Y, V_j, X, r) & (N - 1);
 	}
 
-	/* 10: B' <-- X */
-	for (k = 0; k < 2 * r; k++) {
-		for (i = 0; i < 16; i++) {
-			le32enc(&B[(k * 16 + (i * 5 % 16)) * 4],
-			    X32[k * 16 + i]);
-		}
+	smix_out(B, r, XY);
+}
+
+/*
+ * Fetch all of V_j while the other lane is being mixed.  The reads of
+ * the second SMix loop are random across a V of 128rN bytes, so each one
+ * would otherwise stall for a full trip to memory.
+ */
+#define PREFETCH_BLOCK(p, r) \
+	{ \
+		const char * P = (const char *)(p); \
+		size_t K; \
+		for (K = 0; K < 2 * (r); K++) \
+			_mm_prefetch(P + K * 64, _MM_HINT_T0); \
+	}
+
+/**
+ * smix_x2(B0, B1, r, N, V0, V1, XY0, XY1):
+ * Compute B0 = SMix_r(B0, N) and B1 = SMix_r(B1, N) for two independent
+ * inputs, with the second loops interleaved so that the memory latency of
+ * one lane's V_j is hidden behind the other lane's BlockMix.  The buffer
+ * requirements are those of smix(), for each of the two lanes.
+ */
+static void
+smix_x2(uint8_t * B0, uint8_t * B1, size_t r, uint32_t N,
+    void * V0, void * V1, void * XY0, void * XY1)
+{
+	size_t s = 128 * r;
+	__m128i * X0 = XY0, * Y0 = (void *)((uintptr_t)(XY0) + s);
+	__m128i * X1 = XY1, * Y1 = (void *)((uintptr_t)(XY1) + s);
+	__m128i * V_j;
+	uint32_t i, j0, j1;
+
+	smix1(B0, r, N, V0, XY0);
+	smix1(B1, r, N, V1, XY1);
+
+	/* 7: j <-- Integerify(X) mod N */
+	j0 = integerify(X0, r) & (N - 1);
+	j1 = integerify(X1, r) & (N - 1);
+	PREFETCH_BLOCK((uintptr_t)(V1) + j1 * s, r)
+
+	/* 6: for i = 0 to N - 1 do */
+	for (i = 0; i < N; i += 2) {
+		/* 8: X <-- H(X \xor V_j) */
+		/* 7: j <-- Integerify(X) mod N */
+		V_j = (void *)((uintptr_t)(V0) + j0 * s);
+		j0 = blockmix_salsa8_xor(X0, V_j, Y0, r) & (N - 1);
+		PREFETCH_BLOCK((uintptr_t)(V0) + j0 * s, r)
+
+		V_j = (void *)((uintptr_t)(V1) + j1 * s);
+		j1 = blockmix_salsa8_xor(X1, V_j, Y1, r) & (N - 1);
+		PREFETCH_BLOCK((uintptr_t)(V1) + j1 * s, r)
+
+		/* 8: X <-- H(X \xor V_j) */
+		/* 7: j <-- Integerify(X) mod N */
+		V_j = (void *)((uintptr_t)(V0) + j0 * s);
+		j0 = blockmix_salsa8_xor(Y0, V_j, X0, r) & (N - 1);
+		PREFETCH_BLOCK((uintptr_t)(V0) + j0 * s, r)
+
+		V_j = (void *)((uintptr_t)(V1) + j1 * s);
+		j1 = blockmix_salsa8_xor(Y1, V_j, X1, r) & (N - 1);
+		PREFETCH_BLOCK((uintptr_t)(V1) + j1 * s, r)
 	}
+
+	smix_out(B0, r, XY0);
+	smix_out(B1, r, XY1);
 }
 
+#undef PREFETCH_BLOCK
+
 /**
- * escrypt_kdf(local, passwd, passwdlen, salt, saltlen,
- *     N, r, p, buf, buflen):
- * Compute scrypt(passwd[0 .. passwdlen - 1], salt[0 .. saltlen - 1], N, r,
- * p, buflen) and write the result into buf.  The parameters r, p, and buflen
- * must satisfy r * p < 2^30 and buflen <= (2^32 - 1) * 32.  The parameter N
- * must be a power of 2 greater than 1.
+ * check_params(N, r, p, buflen, need):
+ * Sanity-check the escrypt_kdf() parameters and compute the size of the
+ * B, V and XY buffers needed for one password.
  *
  * Return 0 on success; or -1 on error.
  */
-int
-escrypt_kdf(escrypt_local_t * local,
-    const uint8_t * passwd, size_t passwdlen,
-    const uint8_t * salt, size_t saltlen,
-    uint64_t N, uint32_t r, uint32_t p,
-    uint8_t * buf, size_t buflen)
+static int
+check_params(uint64_t N, uint32_t r, uint32_t p, size_t buflen, size_t * need)
 {
-	size_t B_size, V_size, XY_size, need;
-	uint8_t * B;
-	uint32_t * V, * XY;
-	uint32_t i;
+	size_t B_size, V_size, XY_size;
 
 	/* Sanity-check parameters. */
 #if SIZE_MAX > UINT32_MAX
@@ -342,26 +427,56 @@ escrypt_kdf(escrypt_local_t * local,
 		return -1;
 	}
 
-	/* Allocate memory. */
 	B_size = (size_t)128 * r * p;
 	V_size = (size_t)128 * r * N;
-	need = B_size + V_size;
-	if (need < V_size) {
+	*need = B_size + V_size;
+	if (*need < V_size) {
 		errno = ENOMEM;
 		return -1;
 	}
 	XY_size = (size_t)256 * r + 64;
-	need += XY_size;
-	if (need < XY_size) {
+	*need += XY_size;
+	if (*need < XY_size) {
 		errno = ENOMEM;
 		return -1;
 	}
+	return 0;
+}
+
+/**
+ * escrypt_kdf(local, passwd, passwdlen, salt, saltlen,
+ *     N, r, p, buf, buflen):
+ * Compute scrypt(passwd[0 .. passwdlen - 1], salt[0 .. saltlen - 1], N, r,
+ * p, buflen) and write the result into buf.  The parameters r, p, and buflen
+ * must satisfy r * p < 2^30 and buflen <= (2^32 - 1) * 32.  The parameter N
+ * must be a power of 2 greater than 1.
+ *
+ * Return 0 on success; or -1 on error.
+ */
+int
+escrypt_kdf(escrypt_local_t * local,
+    const uint8_t * passwd, size_t passwdlen,
+    const uint8_t * salt, size_t saltlen,
+    uint64_t N, uint32_t r, uint32_t p,
+    uint8_t * buf, size_t buflen)
+{
+	size_t B_size, V_size, need;
+	uint8_t * B;
+	uint32_t * V, * XY;
+	uint32_t i;
+
+	if (check_params(N, r, p, buflen, &need))
+		return -1;
+
+	/* Allocate memory. */
 	if (local->size < need) {
 		if (free_region(local))
 			return -1;
 		if (!alloc_region(local, need))
 			return -1;
 	}
+	B_size = (size_t)128 * r * p;
+	V_size = (size_t)128 * r * N;
 	B = (uint8_t *)local->aligned;
 	V = (uint32_t *)((uint8_t *)B + B_size);
 	XY = (uint32_t *)((uint8_t *)V + V_size);
@@ -381,3 +496,68 @@ escrypt_kdf(escrypt_local_t * local,
 	/* Success! */
 	return 0;
 }
+
+/**
+ * escrypt_kdf_x2(local, passwd, passwdlen, salt, saltlen,
+ *     N, r, p, buf, buflen):
+ * Compute escrypt_kdf() for the two passwords passwd[0] and passwd[1]
+ * under the same salt and parameters, writing the results into buf[0] and
+ * buf[1].  The two SMix computations are interleaved, which needs twice
+ * the memory of escrypt_kdf() in local.
+ *
+ * Return 0 on success; or -1 on error.
+ */
+int
+escrypt_kdf_x2(escrypt_local_t * local,
+    const uint8_t * const passwd[2], const size_t passwdlen[2],
+    const uint8_t * salt, size_t saltlen,
+    uint64_t N, uint32_t r, uint32_t p,
+    uint8_t * const buf[2], size_t buflen)
+{
+	size_t B_size, V_size, need;
+	uint8_t * B0, * B1;
+	uint32_t * V0, * V1, * XY0, * XY1;
+	uint32_t i;
+
+	if (check_params(N, r, p, buflen, &need))
+		return -1;
+
+	/* Allocate memory, rounding each lane up to keep it 64-byte aligned. */
+	need = (need + 63) & ~(size_t)63;
+	if (need > SIZE_MAX / 2) {
+		errno = ENOMEM;
+		return -1;
+	}
+	if (local->size < 2 * need) {
+		if (free_region(local))
+			return -1;
+		if (!alloc_region(local, 2 * need))
+			return -1;
+	}
+	B_size = (size_t)128 * r * p;
+	V_size = (size_t)128 * r * N;
+	B0 = (uint8_t *)local->aligned;
+	B1 = B0 + need;
+	V0 = (uint32_t *)(B0 + B_size);
+	V1 = (uint32_t *)(B1 + B_size);
+	XY0 = (uint32_t *)((uint8_t *)V0 + V_size);
+	XY1 = (uint32_t *)((uint8_t *)V1 + V_size);
+
+	/* 1: (B_0 ... B_{p-1}) <-- PBKDF2(P, S, 1, p * MFLen) */
+	PBKDF2_SHA256(passwd[0], passwdlen[0], salt, saltlen, 1, B0, B_size);
+	PBKDF2_SHA256(passwd[1], passwdlen[1], salt, saltlen, 1, B1, B_size);
+
+	/* 2: for i = 0 to p - 1 do */
+	for (i = 0; i < p; i++) {
+		/* 3: B_i <-- MF(B_i, N) */
+		smix_x2(&B0[(size_t)128 * i * r], &B1[(size_t)128 * i * r],
+		    r, N, V0, V1, XY0, XY1);
+	}
+
+	/* 5: DK <-- PBKDF2(P, B, 1, dkLen) */
+	PBKDF2_SHA256(passwd[0], passwdlen[0], B0, B_size, 1, buf[0], buflen);
+	PBKDF2_SHA256(passwd[1], passwdlen[1], B1, B_size, 1, buf[1], buflen);
+
+	/* Success! */
+	return 0;
+}
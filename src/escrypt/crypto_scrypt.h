@@ -68,11 +68,22 @@ extern int escrypt_kdf(escrypt_local_t * __local,
     uint64_t __N, uint32_t __r, uint32_t __p,
     uint8_t * __buf, size_t __buflen);
 
+extern int escrypt_kdf_x2(escrypt_local_t * __local,
+    const uint8_t * const __passwd[2], const size_t __passwdlen[2],
+    const uint8_t * __salt, size_t __saltlen,
+    uint64_t __N, uint32_t __r, uint32_t __p,
+    uint8_t * const __buf[2], size_t __buflen);
+
 extern uint8_t * escrypt_r(escrypt_local_t * __local,
     const uint8_t * __passwd, size_t __passwdlen,
     const uint8_t * __setting,
     uint8_t * __buf, size_t __buflen);
 
+extern uint8_t * escrypt_r_x2(escrypt_local_t * __local,
+    const uint8_t * const __passwd[2], const size_t __passwdlen[2],
+    const uint8_t * __setting,
+    uint8_t * const __buf[2], size_t __buflen);
+
 extern uint8_t * escrypt(const uint8_t * __passwd, const uint8_t * __setting);
 
 extern uint8_t * escrypt_gensalt_r(
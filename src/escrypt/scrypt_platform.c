@@ -29,19 +29,73 @@
 #include "../memdbg.h"
 #include "../memory.h"
 
-static void *
-alloc_region(escrypt_region_t * region, size_t size)
-{
-	uint8_t * base, * aligned;
 #if defined(MAP_ANON) && !defined (MEMDBG_ON)
-	if ((base = mmap(NULL, size, PROT_READ | PROT_WRITE,
 #ifdef MAP_NOCORE
-	    MAP_ANON | MAP_PRIVATE | MAP_NOCORE,
+#define MAP_FLAGS (MAP_ANON | MAP_PRIVATE | MAP_NOCORE)
 #else
-	    MAP_ANON | MAP_PRIVATE,
+#define MAP_FLAGS (MAP_ANON | MAP_PRIVATE)
+#endif
+
+/*
+ * SMix reads V at random, so with 4 KB pages nearly every V_j lookup is
+ * also a TLB miss.  Regions of at least this size are put on 2 MB pages
+ * where the system lets us: explicit huge pages if any are reserved, else
+ * transparent ones.
+ */
+#define HUGEPAGE_SIZE ((size_t)2 << 20)
+
+static uint8_t *
+map_region(size_t * size)
+{
+	uint8_t * base;
+	size_t hsize = (*size + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+
+	if (*size >= HUGEPAGE_SIZE && hsize >= *size &&
+	    hsize + HUGEPAGE_SIZE > hsize) {
+#ifdef MAP_HUGETLB
+		if ((base = mmap(NULL, hsize, PROT_READ | PROT_WRITE,
+		    MAP_FLAGS | MAP_HUGETLB, -1, 0)) != MAP_FAILED) {
+			*size = hsize;
+			return base;
+		}
+#endif
+#ifdef MADV_HUGEPAGE
+		{
+			size_t head;
+
+			/* Over-map and trim so that the region starts on a
+			 * 2 MB boundary, or THP can't back its first pages. */
+			if ((base = mmap(NULL, hsize + HUGEPAGE_SIZE,
+			    PROT_READ | PROT_WRITE, MAP_FLAGS,
+			    -1, 0)) == MAP_FAILED)
+				return NULL;
+			head = (HUGEPAGE_SIZE -
+			    ((uintptr_t)base & (HUGEPAGE_SIZE - 1))) &
+			    (HUGEPAGE_SIZE - 1);
+			if (head)
+				munmap(base, head);
+			munmap(base + head + hsize, HUGEPAGE_SIZE - head);
+			base += head;
+			madvise(base, hsize, MADV_HUGEPAGE);
+			*size = hsize;
+			return base;
+		}
 #endif
+	}
+
+	if ((base = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_FLAGS,
 	    -1, 0)) == MAP_FAILED)
-		base = NULL;
+		return NULL;
+	return base;
+}
+#endif
+
+static void *
+alloc_region(escrypt_region_t * region, size_t size)
+{
+	uint8_t * base, * aligned;
+#if defined(MAP_ANON) && !defined (MEMDBG_ON)
+	base = map_region(&size);
 	aligned = base;
 #elif defined(HAVE_POSIX_MEMALIGN) && !defined (MEMDBG_ON)
 	if ((errno = posix_memalign(&base, 64, size)) != 0)
@@ -15,6 +15,9 @@
 #include "config.h"
 #ifndef BENCH_BUILD
 #include "options.h"
+#if SIMD_DISPATCH
+#include "sse-intrinsics.h"
+#endif
 #else
 #if ARCH_INT_GT_32
 typedef unsigned short ARCH_WORD_32;
@@ -77,6 +80,9 @@ void fmt_init(struct fmt_main *format)
 			d = atof(opt);
 		if ((int)d > 1)
 			format->params.max_keys_per_crypt *= (int)d;
+#if SIMD_DISPATCH
+		simd_dispatch_init();
+#endif
 		format->methods.init(format);
 		format->private.initialized = 1;
 		if (d > 0 && d < 1.0) {
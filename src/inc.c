@@ -337,6 +337,7 @@ static int inc_key_loop(int length, int fixed, int count,
 	int counts_cache;
 	int numbers_cache;
 	int pos;
+	int whole_runs = !options.mask && !f_filter;
 
 	key_i[length + 1] = 0;
 	numbers[fixed] = count;
@@ -368,6 +369,18 @@ update_ending:
 		chars_cache = (*chars[pos - 2])
 		    [ARCH_INDEX(key_i[pos - 2]) - CHARSET_MIN]
 		    [ARCH_INDEX(key_i[pos - 1]) - CHARSET_MIN];
+/*
+ * Only the last character changes from here on, so hand the cracker the
+ * whole remaining run of last characters at once.
+ */
+		if (whole_runs && fixed < length) {
+			if (crk_process_key_run(key_i, length,
+			    &chars_cache[numbers_cache],
+			    counts_cache - numbers_cache + 1))
+				return 1;
+			numbers_cache = counts_cache;
+			goto next_key;
+		}
 update_last:
 		key_i[length] = chars_cache[numbers_cache];
 	}
@@ -381,6 +394,7 @@ update_last:
 		if (crk_process_key(key))
 			return 1;
 
+next_key:
 	pos = length;
 	if (fixed < length) {
 		if (++numbers_cache <= counts_cache) {
@@ -46,8 +46,25 @@ john_register_one(&fmt_KeePass);
 #define SALT_SIZE		sizeof(struct custom_salt)
 // salt align of 4 was crashing on sparc.  Probably due to the long long value.
 #define SALT_ALIGN		sizeof(long long)
-#define MIN_KEYS_PER_CRYPT	1
-#define MAX_KEYS_PER_CRYPT	1
+#define MIN_KEYS_PER_CRYPT	KEEPASS_LANES
+#define MAX_KEYS_PER_CRYPT	KEEPASS_LANES
+
+/*
+ * The key transform is key_transf_rounds of AES-256-ECB over each half of
+ * the hashed password, every block depending on the one before.  With
+ * AES-NI the transforms of KEEPASS_LANES candidates are run in lockstep so
+ * that their aesenc latencies overlap.  This is built whenever gcc can
+ * target AES-NI, whatever the -m flags, and used if the CPU has it.
+ */
+#define KEEPASS_LANES		8
+#if defined(__GNUC__) && !defined(__clang__) && \
+	!defined(__INTEL_COMPILER) && \
+	(defined(__x86_64__) || defined(__i386__)) && GCC_VERSION >= 60000
+#define KEEPASS_AESNI		1
+#include <wmmintrin.h>
+#else
+#define KEEPASS_AESNI		0
+#endif
 
 static struct fmt_tests KeePass_tests[] = {
 	{"$keepass$*1*50000*124*60eed105dac456cfc37d89d950ca846e*72ffef7c0bc3698b8eca65184774f6cd91a9356d338e5140e47e319a87f5e46a*8725bdfd3580cf054a1564dc724aaffe*8e58cc08af2462ddffe2ee39735ad14b15e8cb96dc05ef70d8e64d475eca7bf5*1*752*71d7e65fb3e20b288da8cd582b5c2bc3b63162eef6894e5e92eea73f711fe86e7a7285d5ac9d5ffd07798b83673b06f34180b7f5f3d05222ebf909c67e6580c646bcb64ad039fcdc6f33178fe475739a562dc78012f6be3104da9af69e0e12c2c9c5cd7134bb99d5278f2738a40155acbe941ff2f88db18daf772c7b5fc1855ff9e93ceb35a1db2c30cabe97a96c58b07c16912b2e095e530cc8c24041e7d4876b842f2e7c6df41d08da8c5c4f2402dd3241c3367b6e6e06cd0fa369934e78a6aab1479756a15264af09e3c8e1037f07a58f70f4bf634737ff58725414db10d7b2f61a7ed69878bc0de8bb99f3795bf9980d87992848cd9b9abe0fa6205a117ab1dd5165cf11ffa10b765e8723251ea0907bbc5f3eef8cf1f08bb89e193842b40c95922f38c44d0c3197033a5c7c926a33687aa71c482c48381baa4a34a46b8a4f78715f42eccbc8df80ee3b43335d92bdeb3bb0667cf6da83a018e4c0cd5803004bf6c300b9bee029246d16bd817ff235fcc22bb8c729929499afbf90bf787e98479db5ff571d3d727059d34c1f14454ff5f0a1d2d025437c2d8db4a7be7b901c067b929a0028fe8bb74fa96cb84831ccd89138329708d12c76bd4f5f371e43d0a2d234e5db2b3d6d5164e773594ab201dc9498078b48d4303dd8a89bf81c76d1424084ebf8d96107cb2623fb1cb67617257a5c7c6e56a8614271256b9dd80c76b6d668de4ebe17574ad617f5b1133f45a6d8621e127fcc99d8e788c535da9f557d91903b4e388108f02e9539a681d42e61f8e2f8b06654d4dec308690902a5c76f55b3d79b7c9a0ce994494bc60eff79ff41debc3f2684f40fc912f09035aae022148238ba6f5cfb92f54a5fb28cbb417ff01f39cc464e95929fba5e19be0251bef59879303063e6392c3a49032af3d03d5c9027868d5d6a187698dd75dfc295d2789a0e6cf391a380cc625b0a49f3084f45558ac273b0bbe62a8614db194983b2e207cef7deb1fa6a0bd39b0215d72bf646b599f187ee0009b7b458bb4930a1aea55222099446a0250a975447ff52", "openwall"},
@@ -83,14 +100,12 @@ static struct custom_salt {
 	int algorithm; // 1 for Twofish
 } *cur_salt;
 
-static void transform_key(char *masterkey, struct custom_salt *csp, unsigned char *final_key)
+/* Hash the password, and the key file if any, into the transform input */
+static void hash_key(char *masterkey, struct custom_salt *csp, unsigned char *hash)
 {
-        // First, hash the masterkey
 	SHA256_CTX ctx;
-	unsigned char hash[32];
 	unsigned char temphash[32];
-	int i;
-	AES_KEY akey;
+
 	SHA256_Init(&ctx);
 	SHA256_Update(&ctx, masterkey, strlen(masterkey));
 	SHA256_Final(hash, &ctx);
@@ -99,49 +114,148 @@ static void transform_key(char *masterkey, struct custom_salt *csp, unsigned cha
 		SHA256_Update(&ctx, hash, 32);
 		SHA256_Final(hash, &ctx);
 	}
-	memset(&akey, 0, sizeof(AES_KEY));
-	if(AES_set_encrypt_key(csp->transf_randomseed, 256, &akey) < 0) {
-		fprintf(stderr, "AES_set_encrypt_key failed!\n");
-	}
 	/* keyfile handling (only tested for KeePass 1.x files) */
-	if (cur_salt->have_keyfile) {
+	if (csp->have_keyfile) {
 		SHA256_CTX composite_ctx;  // for keyfile handling
 		SHA256_CTX keyfile_ctx;
 
 		SHA256_Init(&composite_ctx);
 		SHA256_Update(&composite_ctx, hash, 32);
 
-		if (cur_salt->keyfilesize != 32 && cur_salt->keyfilesize != 64) {
+		if (csp->keyfilesize != 32 && csp->keyfilesize != 64) {
 			SHA256_Init(&keyfile_ctx);
-			SHA256_Update(&keyfile_ctx, cur_salt->keyfile, cur_salt->keyfilesize);
+			SHA256_Update(&keyfile_ctx, csp->keyfile, csp->keyfilesize);
 			SHA256_Final(temphash, &keyfile_ctx);
-		} else if(cur_salt->keyfilesize == 32) {
-			memcpy(temphash, cur_salt->keyfile, 32);
-		} else if (cur_salt->keyfilesize == 64) { /* do hex decoding */
+		} else if(csp->keyfilesize == 32) {
+			memcpy(temphash, csp->keyfile, 32);
+		} else if (csp->keyfilesize == 64) { /* do hex decoding */
 			abort();  // TODO
 		}
 
 		SHA256_Update(&composite_ctx, temphash, 32);
 		SHA256_Final(hash, &composite_ctx);
 	}
+}
+
+#if KEEPASS_AESNI
+static int use_aesni;
+
+#define AESNI_EXPAND(k, t) \
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4)); \
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4)); \
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4)); \
+	k = _mm_xor_si128(k, t)
+
+#define AESNI_KEY256(i, rcon) \
+	AESNI_EXPAND(a, _mm_shuffle_epi32( \
+		_mm_aeskeygenassist_si128(b, rcon), 0xff)); \
+	rk[i] = a; \
+	AESNI_EXPAND(b, _mm_shuffle_epi32( \
+		_mm_aeskeygenassist_si128(a, 0), 0xaa)); \
+	rk[i + 1] = b
+
+__attribute__((target("aes")))
+static void aesni_key256(const unsigned char *key, __m128i *rk)
+{
+	__m128i a = _mm_loadu_si128((const __m128i *)key);
+	__m128i b = _mm_loadu_si128((const __m128i *)(key + 16));
+
+	rk[0] = a;
+	rk[1] = b;
+	AESNI_KEY256(2, 0x01);
+	AESNI_KEY256(4, 0x02);
+	AESNI_KEY256(6, 0x04);
+	AESNI_KEY256(8, 0x08);
+	AESNI_KEY256(10, 0x10);
+	AESNI_KEY256(12, 0x20);
+	AESNI_EXPAND(a, _mm_shuffle_epi32(
+		_mm_aeskeygenassist_si128(b, 0x40), 0xff));
+	rk[14] = a;
+}
+
+#define AESNI_X8(op, k) \
+	b0 = op(b0, k); b1 = op(b1, k); b2 = op(b2, k); b3 = op(b3, k); \
+	b4 = op(b4, k); b5 = op(b5, k); b6 = op(b6, k); b7 = op(b7, k)
+
+#define AESNI_LOAD(j) \
+	_mm_loadu_si128((__m128i *)&hash[(j) < n ? (j) : 0][half])
+
+#define AESNI_STORE(j, v) \
+	if ((j) < n) \
+		_mm_storeu_si128((__m128i *)&hash[j][half], v)
+
+/* Unused lanes just redo the first candidate's half */
+__attribute__((target("aes")))
+static void transform_aesni(unsigned char (*hash)[32], int n,
+                            struct custom_salt *csp)
+{
+	__m128i rk[15];
+	int half, r;
+
+	aesni_key256(csp->transf_randomseed, rk);
+	for (half = 0; half < 32; half += 16) {
+		__m128i b0 = AESNI_LOAD(0), b1 = AESNI_LOAD(1);
+		__m128i b2 = AESNI_LOAD(2), b3 = AESNI_LOAD(3);
+		__m128i b4 = AESNI_LOAD(4), b5 = AESNI_LOAD(5);
+		__m128i b6 = AESNI_LOAD(6), b7 = AESNI_LOAD(7);
+		uint32_t i = csp->key_transf_rounds;
+
+		while (i--) {
+			AESNI_X8(_mm_xor_si128, rk[0]);
+			for (r = 1; r < 14; r++) {
+				AESNI_X8(_mm_aesenc_si128, rk[r]);
+			}
+			AESNI_X8(_mm_aesenclast_si128, rk[14]);
+		}
+		AESNI_STORE(0, b0); AESNI_STORE(1, b1);
+		AESNI_STORE(2, b2); AESNI_STORE(3, b3);
+		AESNI_STORE(4, b4); AESNI_STORE(5, b5);
+		AESNI_STORE(6, b6); AESNI_STORE(7, b7);
+	}
+}
+#endif
 
-        // Next, encrypt the created hash
-	i = csp->key_transf_rounds >> 2;
-	while (i--) {
-		AES_encrypt(hash, hash, &akey);
-		AES_encrypt(hash, hash, &akey);
-		AES_encrypt(hash, hash, &akey);
-		AES_encrypt(hash, hash, &akey);
-		AES_encrypt(hash+16, hash+16, &akey);
-		AES_encrypt(hash+16, hash+16, &akey);
-		AES_encrypt(hash+16, hash+16, &akey);
-		AES_encrypt(hash+16, hash+16, &akey);
+/* Encrypt the n hashes key_transf_rounds times, in place */
+static void transform_keys(unsigned char (*hash)[32], int n,
+                           struct custom_salt *csp)
+{
+	AES_KEY akey;
+	int i, j;
+
+#if KEEPASS_AESNI
+	if (use_aesni) {
+		transform_aesni(hash, n, csp);
+		return;
 	}
-	i = csp->key_transf_rounds & 3;
-	while (i--) {
-		AES_encrypt(hash, hash, &akey);
-		AES_encrypt(hash+16, hash+16, &akey);
+#endif
+	memset(&akey, 0, sizeof(AES_KEY));
+	if(AES_set_encrypt_key(csp->transf_randomseed, 256, &akey) < 0) {
+		fprintf(stderr, "AES_set_encrypt_key failed!\n");
 	}
+	for (j = 0; j < n; j++) {
+		i = csp->key_transf_rounds >> 2;
+		while (i--) {
+			AES_encrypt(hash[j], hash[j], &akey);
+			AES_encrypt(hash[j], hash[j], &akey);
+			AES_encrypt(hash[j], hash[j], &akey);
+			AES_encrypt(hash[j], hash[j], &akey);
+			AES_encrypt(hash[j]+16, hash[j]+16, &akey);
+			AES_encrypt(hash[j]+16, hash[j]+16, &akey);
+			AES_encrypt(hash[j]+16, hash[j]+16, &akey);
+			AES_encrypt(hash[j]+16, hash[j]+16, &akey);
+		}
+		i = csp->key_transf_rounds & 3;
+		while (i--) {
+			AES_encrypt(hash[j], hash[j], &akey);
+			AES_encrypt(hash[j]+16, hash[j]+16, &akey);
+		}
+	}
+}
+
+static void finish_key(unsigned char *hash, struct custom_salt *csp, unsigned char *final_key)
+{
+	SHA256_CTX ctx;
+
         // Finally, hash it again...
 	SHA256_Init(&ctx);
 	SHA256_Update(&ctx, hash, 32);
@@ -175,6 +289,10 @@ static void init(struct fmt_main *self)
 	cracked = mem_calloc_tiny(cracked_size, MEM_ALIGN_WORD);
 
 	Twofish_initialise();
+#if KEEPASS_AESNI
+	__builtin_cpu_init();
+	use_aesni = __builtin_cpu_supports("aes");
+#endif
 }
 
 static int valid(char *ciphertext, struct fmt_main *self)
@@ -381,7 +499,7 @@ static void set_salt(void *salt)
 static int crypt_all(int *pcount, struct db_salt *salt)
 {
 	int count = *pcount;
-	int index = 0;
+	int group;
 
 	if (any_cracked) {
 		memset(cracked, 0, cracked_size);
@@ -390,78 +508,90 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 
 #ifdef _OPENMP
 #pragma omp parallel for
-	for (index = 0; index < count; index++)
 #endif
+	for (group = 0; group < count; group += KEEPASS_LANES)
 	{
-		unsigned char final_key[32];
-		unsigned char decrypted_content[LINE_BUFFER_SIZE];
-		SHA256_CTX ctx;
-		unsigned char iv[16];
-		unsigned char out[32];
-		int pad_byte;
-		int datasize;
-		AES_KEY akey;
-		Twofish_key tkey;
-
-		// derive and set decryption key
-		transform_key(saved_key[index], cur_salt, final_key);
-		if (cur_salt->algorithm == 0) {
-			/* AES decrypt cur_salt->contents with final_key */
-			memcpy(iv, cur_salt->enc_iv, 16);
-			memset(&akey, 0, sizeof(AES_KEY));
-			if(AES_set_decrypt_key(final_key, 256, &akey) < 0) {
-				fprintf(stderr, "AES_set_decrypt_key failed in crypt!\n");
+		unsigned char hash[KEEPASS_LANES][32];
+		int n = count - group < KEEPASS_LANES ?
+			count - group : KEEPASS_LANES;
+		int index;
+
+		for (index = group; index < group + n; index++)
+			hash_key(saved_key[index], cur_salt, hash[index - group]);
+		transform_keys(hash, n, cur_salt);
+
+		for (index = group; index < group + n; index++)
+		{
+			unsigned char final_key[32];
+			unsigned char decrypted_content[LINE_BUFFER_SIZE];
+			SHA256_CTX ctx;
+			unsigned char iv[16];
+			unsigned char out[32];
+			int pad_byte;
+			int datasize;
+			AES_KEY akey;
+			Twofish_key tkey;
+
+			// derive and set decryption key
+			finish_key(hash[index - group], cur_salt, final_key);
+			if (cur_salt->algorithm == 0) {
+				/* AES decrypt cur_salt->contents with final_key */
+				memcpy(iv, cur_salt->enc_iv, 16);
+				memset(&akey, 0, sizeof(AES_KEY));
+				if(AES_set_decrypt_key(final_key, 256, &akey) < 0) {
+					fprintf(stderr, "AES_set_decrypt_key failed in crypt!\n");
+				}
+			} else if (cur_salt->algorithm == 1) {
+				memcpy(iv, cur_salt->enc_iv, 16);
+				memset(&tkey, 0, sizeof(Twofish_key));
+				Twofish_prepare_key(final_key, 32, &tkey);
 			}
-		} else if (cur_salt->algorithm == 1) {
-			memcpy(iv, cur_salt->enc_iv, 16);
-			memset(&tkey, 0, sizeof(Twofish_key));
-			Twofish_prepare_key(final_key, 32, &tkey);
-		}
 
-		if (cur_salt->version == 1 && cur_salt->algorithm == 0) {
-			AES_cbc_encrypt(cur_salt->contents, decrypted_content, cur_salt->contentsize, &akey, iv, AES_DECRYPT);
-			pad_byte = decrypted_content[cur_salt->contentsize-1];
-			datasize = cur_salt->contentsize - pad_byte;
-			SHA256_Init(&ctx);
-			SHA256_Update(&ctx, decrypted_content, datasize);
-			SHA256_Final(out, &ctx);
-			if(!memcmp(out, cur_salt->contents_hash, 32)) {
-				cracked[index] = 1;
+			if (cur_salt->version == 1 && cur_salt->algorithm == 0) {
+				AES_cbc_encrypt(cur_salt->contents, decrypted_content, cur_salt->contentsize, &akey, iv, AES_DECRYPT);
+				pad_byte = decrypted_content[cur_salt->contentsize-1];
+				datasize = cur_salt->contentsize - pad_byte;
+				SHA256_Init(&ctx);
+				SHA256_Update(&ctx, decrypted_content, datasize);
+				SHA256_Final(out, &ctx);
+				if(!memcmp(out, cur_salt->contents_hash, 32)) {
+					cracked[index] = 1;
 #ifdef _OPENMP
 #pragma omp atomic
 #endif
-				any_cracked |= 1;
+					any_cracked |= 1;
+				}
 			}
-		}
-		else if (cur_salt->version == 2 && cur_salt->algorithm == 0) {
-			AES_cbc_encrypt(cur_salt->contents, decrypted_content, 32, &akey, iv, AES_DECRYPT);
-			if(!memcmp(decrypted_content, cur_salt->expected_bytes, 32)) {
-				cracked[index] = 1;
+			else if (cur_salt->version == 2 && cur_salt->algorithm == 0) {
+				AES_cbc_encrypt(cur_salt->contents, decrypted_content, 32, &akey, iv, AES_DECRYPT);
+				if(!memcmp(decrypted_content, cur_salt->expected_bytes, 32)) {
+					cracked[index] = 1;
 #ifdef _OPENMP
 #pragma omp atomic
 #endif
-				any_cracked |= 1;
-			}
+					any_cracked |= 1;
+				}
 
-		}
-		else if (cur_salt->version == 1 && cur_salt->algorithm == 1) { /* KeePass 1.x with Twofish */
-			int crypto_size;
-			crypto_size = Twofish_Decrypt(&tkey, cur_salt->contents, decrypted_content, cur_salt->contentsize, iv);
-			datasize = crypto_size;  // awesome, right?
-			if (datasize <= cur_salt->contentsize && datasize > 0) {
-				SHA256_Init(&ctx);
-				SHA256_Update(&ctx, decrypted_content, datasize);
-				SHA256_Final(out, &ctx);
-				if(!memcmp(out, cur_salt->contents_hash, 32)) {
-					cracked[index] = 1;
+			}
+			else if (cur_salt->version == 1 && cur_salt->algorithm == 1) { /* KeePass 1.x with Twofish */
+				int crypto_size;
+				crypto_size = Twofish_Decrypt(&tkey, cur_salt->contents, decrypted_content, cur_salt->contentsize, iv);
+				datasize = crypto_size;  // awesome, right?
+				if (datasize <= cur_salt->contentsize && datasize > 0) {
+					SHA256_Init(&ctx);
+					SHA256_Update(&ctx, decrypted_content, datasize);
+					SHA256_Final(out, &ctx);
+					if(!memcmp(out, cur_salt->contents_hash, 32)) {
+						cracked[index] = 1;
 #ifdef _OPENMP
 #pragma omp atomic
 #endif
-					any_cracked |= 1;
+						any_cracked |= 1;
+					}
 				}
+			} else {  // KeePass version 2 with Twofish is TODO
+				abort();
 			}
-		} else {  // KeePass version 2 with Twofish is TODO
-			abort();
 		}
 	}
 	return count;
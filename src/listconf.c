@@ -38,6 +38,9 @@
 #include "formats.h"
 #include "options.h"
 #include "unicode.h"
+#ifdef MMX_COEF
+#include "sse-intrinsics.h"
+#endif
 #include "dynamic.h"
 #include "config.h"
 
@@ -155,6 +158,14 @@ static void listconf_list_build_info(void)
 	puts("Build: " JOHN_BLD);
 	printf("Arch: %d-bit %s\n", ARCH_BITS,
 	       ARCH_LITTLE_ENDIAN ? "LE" : "BE");
+#ifdef MMX_COEF
+#if SIMD_DISPATCH
+	printf("SIMD: " SIMD_WIDTH_STR SSE_type " build, running %s kernels\n",
+	       simd_dispatch_name());
+#else
+	puts("SIMD: " SIMD_WIDTH_STR SSE_type);
+#endif
+#endif
 #if JOHN_SYSTEMWIDE
 	puts("System-wide exec: " JOHN_SYSTEMWIDE_EXEC);
 	puts("System-wide home: " JOHN_SYSTEMWIDE_HOME);
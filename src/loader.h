@@ -99,8 +99,14 @@ struct db_keys {
 /* Number of recursive calls for this salt */
 	int lock;
 
-/* The keys, allocated as (plaintext_length * min_keys_per_crypt) bytes */
-	char buffer[1];
+/* With --single-mem, the number of other salts' successful guesses (in a list
+ * kept by single.c) this salt has been given so far */
+	int guesses;
+
+/* The keys, (plaintext_length * min_keys_per_crypt) bytes.  With
+ * --single-mem, this and the hash table are borrowed from a shared pool and
+ * both are NULL while the salt holds no buffer. */
+	char *buffer;
 };
 
 /*
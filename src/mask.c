@@ -839,6 +839,25 @@ static int calc_pos_in_key(const char *mask, parsed_ctx *parsed_mask,
 	return ret_pos;
 }
 
+/*
+ * For a case-insensitive format, reduce a range to one of each character
+ * that only differs in case, like ?a and the other static placeholders
+ * already do.  LM then tries each 7-character half once even with masks
+ * like [a-zA-Z0-9].
+ */
+static void fold_case(mask_range *range)
+{
+	int i, count = 0;
+
+	for (i = 0; i < range->count; i++) {
+		unsigned char c = CP_down[range->chars[i]];
+
+		if (!memchr(range->chars, c, count))
+			range->chars[count++] = c;
+	}
+	range->count = count;
+}
+
 /*
  * This function will finally remove any escape characters (after honoring
  * them of course, if they protected any of our specials)
@@ -966,6 +985,8 @@ static void init_cpu_mask(const char *mask, parsed_ctx *parsed_mask,
 				j++;
 			}
 
+			if (!fmt_case)
+				fold_case(&cpu_mask_ctx->ranges[i]);
 			set_range_start();
 
 			op_ctr++;
@@ -984,6 +1005,8 @@ static void init_cpu_mask(const char *mask, parsed_ctx *parsed_mask,
 
 			add_string(plhdr2string(mask[load_qtn(qtn_ctr) + 1],
 			                        fmt_case));
+			if (!fmt_case)
+				fold_case(&cpu_mask_ctx->ranges[i]);
 			set_range_start();
 
 			qtn_ctr++;
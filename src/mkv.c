@@ -136,6 +136,8 @@ static int show_pwd_r(struct s_pwd * pwd, unsigned int bs)
 		}
 		gidx++;
 		k++;
+		if(gidx>gend)
+			return 1;
 	}
 	pwd->password[pwd->len] = 0;
 	while(i>1)
@@ -170,6 +172,12 @@ static int show_pwd_r(struct s_pwd * pwd, unsigned int bs)
 	return 0;
 }
 
+/*
+ * Enumerate candidates gidx..gend (inclusive, 0-based). nbparts[] holds the
+ * size of every subtree, so print_pwd() seeks straight to any index without
+ * enumerating what comes before it. This is what makes node splitting and
+ * session restore cheap: each slice starts generating at once.
+ */
 static int show_pwd(unsigned long long start)
 {
 	struct s_pwd pwd;
@@ -183,12 +191,14 @@ static int show_pwd(unsigned long long start)
 
 	if(gidx>0)
 	{
-		print_pwd(gidx, &pwd, gmax_level, gmax_len);
+		/* print_pwd() counts from 1 */
+		print_pwd(gidx + 1, &pwd, gmax_level, gmax_len);
 		while(charsorted[i] != pwd.password[0])
 			i++;
 		pwd.len = 1;
 		pwd.level = proba1[pwd.password[0]];
-		if(show_pwd_r(&pwd, 1))
+		/* If we landed on a single char, its subtree is already done */
+		if(pwd.password[1] != 0 && show_pwd_r(&pwd, 1))
 			return 1;
 
 		if( (pwd.len >= gmin_len) && (pwd.level >= gmin_level) )
@@ -204,6 +214,8 @@ static int show_pwd(unsigned long long start)
 		}
 		gidx++;
 		i++;
+		if(gidx>gend)
+			return 1;
 	}
 	while(proba1[charsorted[i]]<=gmax_level)
 	{
@@ -244,7 +256,7 @@ static double get_progress(void)
 
 	try = ((unsigned long long)status.cands.hi << 32) + status.cands.lo;
 
-	return 100.0 * try / ((gend - gstart) * mask_mult);
+	return 100.0 * try / ((gend - gstart + 1) * mask_mult);
 }
 
 void get_markov_options(struct db_main *db,
@@ -586,6 +598,18 @@ void get_markov_start_end(char *start_token, char *end_token,
 	}
 }
 
+/*
+ * Offset of the first candidate of node number "node" (0-based) when
+ * splitting "size" candidates evenly over options.node_count nodes. Avoids
+ * the overflow of size * node for large keyspaces.
+ */
+static unsigned long long node_offset(unsigned long long size, unsigned int node)
+{
+	unsigned int count = options.node_count;
+
+	return size / count * node + size % count * node / count;
+}
+
 void do_markov_crack(struct db_main *db, char *mkv_param)
 {
 	char *statfile = NULL;
@@ -626,7 +650,12 @@ void do_markov_crack(struct db_main *db, char *mkv_param)
 
 	nb_parts(0, 0, 0, mkv_level, mkv_maxlen);
 
-	get_markov_start_end(start_token, end_token, nbparts[0], &mkv_start, &mkv_end);
+	/*
+	 * nbparts[0] counts nbparts[0] - 1 real candidates, as it includes the
+	 * empty root. With 0-based indexing, the last one is nbparts[0] - 2.
+	 */
+	get_markov_start_end(start_token, end_token, nbparts[0] - 2,
+	                     &mkv_start, &mkv_end);
 
 	if (john_main_process)
 	{
@@ -634,7 +663,7 @@ void do_markov_crack(struct db_main *db, char *mkv_param)
 		if(mkv_minlevel>0) fprintf(stderr, "%d-", mkv_minlevel);
 		fprintf(stderr, "%d len=", mkv_level);
 		if(mkv_minlen>0) fprintf(stderr, "%d-", mkv_minlen);
-		fprintf(stderr, "%d pwd="LLd"%s)\n", mkv_maxlen, mkv_end-mkv_start,
+		fprintf(stderr, "%d pwd="LLd"%s)\n", mkv_maxlen, mkv_end-mkv_start+1,
 		        options.node_count > 1 ? " split over nodes" : "");
 	}
 
@@ -642,13 +671,12 @@ void do_markov_crack(struct db_main *db, char *mkv_param)
 		unsigned long long mkv_size;
 
 		mkv_size = mkv_end - mkv_start + 1;
-		if (options.node_max != options.node_count)
-			mkv_end = mkv_start + mkv_size / options.node_count * options.node_max - 1;
-		mkv_start += mkv_size / options.node_count * (options.node_min - 1);
+		mkv_end = mkv_start + node_offset(mkv_size, options.node_max) - 1;
+		mkv_start += node_offset(mkv_size, options.node_min - 1);
 	}
 
 	gstart = mkv_start;
-	gend = mkv_end + 10; /* omg !! */
+	gend = mkv_end;
 
 	if(param)
 		log_event("Proceeding with Markov mode %s", param);
@@ -82,8 +82,8 @@ typedef uint128_t               mpz_t;
 #define mpz_sub(rop, op1, op2) do { mpz_t temp = op1; rop = op1 - op2; if (rop > temp) rop = 0; } while (0)
 #define mpz_sub_ui(rop, op1, op2) do { mpz_t temp = op1; rop = op1 - (op2); if (rop > temp) rop = 0; } while (0)
 
-#define mpz_mul(rop, op1, op2) do { rop = op1 * op2; if (rop < op2) rop = UINT128_MAX; } while (0)
-#define mpz_mul_ui(rop, op1, op2) do { rop = op1 * (op2); if (rop < (op2)) rop = UINT128_MAX; } while (0)
+#define mpz_mul(rop, op1, op2) do { if (op2 && op1 > UINT128_MAX / op2) rop = UINT128_MAX; else rop = op1 * op2; } while (0)
+#define mpz_mul_ui(rop, op1, op2) do { if ((op2) && op1 > UINT128_MAX / (op2)) rop = UINT128_MAX; else rop = op1 * (op2); } while (0)
 #define mpz_mul_2exp(rop, op1, op2) rop = op1 << (op2)
 
 #define mpz_div_ui(q, n, d) q = (n) / (d)
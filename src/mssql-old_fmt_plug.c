@@ -51,7 +51,7 @@ john_register_one(&fmt_mssql);
 #ifdef MMX_COEF
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
 #if (MMX_COEF==2)
 #define SALT_EXTRA_LEN          0x40004
 #else
@@ -85,8 +85,8 @@ static unsigned char cursalt[SALT_SIZE];
 /* Cygwin would not guarantee the alignment if these were declared static */
 #define saved_key mssql_saved_key
 #define crypt_key mssql_crypt_key
-JTR_ALIGN(16) char saved_key[SHA_BUF_SIZ*4*NBKEYS];
-JTR_ALIGN(16) char crypt_key[BINARY_SIZE*NBKEYS];
+JTR_ALIGN(MEM_ALIGN_SIMD) char saved_key[SHA_BUF_SIZ*4*NBKEYS];
+JTR_ALIGN(MEM_ALIGN_SIMD) char crypt_key[BINARY_SIZE*NBKEYS];
 static char plain_keys[NBKEYS][PLAINTEXT_LENGTH*3+1];
 #else
 
@@ -181,7 +181,7 @@ static void set_key(char *key, int index) {
 		return;
 
 #ifdef MMX_COEF
-	((unsigned int *)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF] = (2*utf8len+SALT_SIZE)<<3;
+	((unsigned int *)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = (2*utf8len+SALT_SIZE)<<3;
 	for(i=0;i<utf8len;i++)
 		saved_key[GETPOS((i*2), index)] = utf8[i];
 	saved_key[GETPOS((i*2+SALT_SIZE) , index)] = 0x80;
@@ -216,7 +216,7 @@ static void set_key_enc(char *key, int index) {
 		utf16len *= -1;
 
 #ifdef MMX_COEF
-	((unsigned int *)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF] = (2*utf16len+SALT_SIZE)<<3;
+	((unsigned int *)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = (2*utf16len+SALT_SIZE)<<3;
 	for(i=0;i<utf16len;i++)
 	{
 		saved_key[GETPOS((i*2), index)] = (char)utf16key[i];
@@ -267,7 +267,7 @@ static int cmp_one(void * binary, int index)
 #ifdef MMX_COEF
 	unsigned int x,y;
 	x = index&(MMX_COEF-1);
-	y = index>>(MMX_COEF>>1);
+	y = index/MMX_COEF;
 
 	if( (((unsigned int *)binary)[0] != ((unsigned int *)crypt_key)[x+y*MMX_COEF*5])   |
 	    (((unsigned int *)binary)[1] != ((unsigned int *)crypt_key)[x+y*MMX_COEF*5+MMX_COEF]) |
@@ -289,7 +289,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 
 	for (index = 0; index < count; ++index)
 	{
-		unsigned len = (((((unsigned int *)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF]) >> 3) & 0xff) - SALT_SIZE;
+		unsigned len = (((((unsigned int *)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF]) >> 3) & 0xff) - SALT_SIZE;
 		for(i=0;i<SALT_SIZE;i++)
 			saved_key[GETPOS((len+i), index)] = cursalt[i];
 	}
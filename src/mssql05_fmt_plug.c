@@ -53,7 +53,7 @@ john_register_one(&fmt_mssql05);
 #ifdef MMX_COEF
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
 
 #else
 #define MIN_KEYS_PER_CRYPT		1
@@ -78,8 +78,8 @@ static unsigned char cursalt[SALT_SIZE];
 /* Cygwin would not guarantee the alignment if these were declared static */
 #define saved_key mssql05_saved_key
 #define crypt_key mssql05_crypt_key
-JTR_ALIGN(16) unsigned char saved_key[SHA_BUF_SIZ*4*NBKEYS];
-JTR_ALIGN(16) unsigned char crypt_key[BINARY_SIZE*NBKEYS];
+JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char saved_key[SHA_BUF_SIZ*4*NBKEYS];
+JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char crypt_key[BINARY_SIZE*NBKEYS];
 
 #else
 
@@ -203,7 +203,7 @@ key_cleaning:
 		keybuf_word += MMX_COEF;
 	}
 
-	((unsigned int *)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF] = len << 4;
+	((unsigned int *)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = len << 4;
 #else
 	UTF8 *s = (UTF8*)_key;
 	UTF16 *d = (UTF16*)saved_key;
@@ -256,7 +256,7 @@ key_cleaning_enc:
 		keybuf_word += MMX_COEF;
 	}
 
-	((unsigned int *)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF] = len << 4;
+	((unsigned int *)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = len << 4;
 #else
 	key_length = enc_to_utf16((UTF16*)saved_key, PLAINTEXT_LENGTH,
 	                          (unsigned char*)_key, strlen(_key));
@@ -387,7 +387,7 @@ bailout:
 		keybuf_word += MMX_COEF;
 	}
 
-	((unsigned int *)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF] = len << 4;
+	((unsigned int *)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = len << 4;
 #else
 	key_length = utf8_to_utf16((UTF16*)saved_key, PLAINTEXT_LENGTH,
 	                           (unsigned char*)_key, strlen(_key));
@@ -403,7 +403,7 @@ static char *get_key(int index) {
 	static UTF16 out[PLAINTEXT_LENGTH + 1];
 	unsigned int i,s;
 
-	s = ((((unsigned int *)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF] >> 3) - SALT_SIZE) >> 1;
+	s = ((((unsigned int *)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] >> 3) - SALT_SIZE) >> 1;
 	for(i=0;i<s;i++) {
 		out[i] = saved_key[GETPOS(i<<1, index)] |
 			(saved_key[GETPOS((i<<1) + 1, index)] << 8);
@@ -441,7 +441,7 @@ static int cmp_one(void * binary, int index)
 #ifdef MMX_COEF
 	unsigned int x,y;
 	x = index&(MMX_COEF-1);
-	y = index>>(MMX_COEF>>1);
+	y = index/MMX_COEF;
 
 	if( (((unsigned int *)binary)[0] != ((unsigned int *)crypt_key)[x+y*MMX_COEF*5])   |
 	    (((unsigned int *)binary)[1] != ((unsigned int *)crypt_key)[x+y*MMX_COEF*5+MMX_COEF]) |
@@ -463,7 +463,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 
 	for (index = 0; index < count; ++index)
 	{
-		unsigned len = ((((unsigned int *)saved_key)[15*MMX_COEF + (index&3) + (index>>2)*SHA_BUF_SIZ*MMX_COEF]) >> 3) - SALT_SIZE;
+		unsigned len = ((((unsigned int *)saved_key)[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF]) >> 3) - SALT_SIZE;
 		for(i=0;i<SALT_SIZE;i++)
 			saved_key[GETPOS((len+i), index)] = cursalt[i];
 	}
@@ -22,6 +22,13 @@ john_register_one(&fmt_NT2);
 
 #ifdef MMX_COEF
 #define NBKEYS				(MMX_COEF * MD4_SSE_PARA)
+/* The prebuilt icc kernels (USING_ICC_S_FILE) know no SSEi_REVERSE_STEPS */
+#ifndef USING_ICC_S_FILE
+#define REVERSE_STEPS
+#define MMX_FLAGS			(SSEi_MIXED_IN|SSEi_REVERSE_STEPS)
+#else
+#define MMX_FLAGS			SSEi_MIXED_IN
+#endif
 #endif
 #include "sse-intrinsics.h"
 
@@ -70,7 +77,8 @@ john_register_one(&fmt_NT2);
 #define PLAINTEXT_LENGTH		27
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS * BLOCK_LOOPS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*16*MMX_COEF*4 )
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index/MMX_COEF)*16*MMX_COEF*4 )
+#define SQRT_3				0x6ed9eba1
 #else
 #define PLAINTEXT_LENGTH		125
 #define MIN_KEYS_PER_CRYPT		1
@@ -266,6 +274,13 @@ static void *binary(char *ciphertext)
 		out[i]=JOHNSWAP(temp);
 #endif
 	}
+#ifdef REVERSE_STEPS
+	/* The kernel stops short of the final add (SSEi_REVERSE_STEPS) */
+	out[0] -= 0x67452301;
+	out[1] -= 0xefcdab89;
+	out[2] -= 0x98badcfe;
+	out[3] -= 0x10325476;
+#endif
 //	dump_stuff_msg("binary", out, 16);
 	return out;
 }
@@ -309,7 +324,7 @@ key_cleaning:
 		keybuf_word += MMX_COEF;
 	}
 
-	((unsigned int *)saved_key)[14*MMX_COEF + (index&3) + (index>>2)*16*MMX_COEF] = len << 4;
+	((unsigned int *)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*16*MMX_COEF] = len << 4;
 #else
 #if ARCH_LITTLE_ENDIAN
 	UTF8 *s = (UTF8*)_key;
@@ -366,7 +381,7 @@ key_cleaning_enc:
 		*keybuf_word = 0;
 		keybuf_word += MMX_COEF;
 	}
-	((unsigned int *)saved_key)[14*MMX_COEF + (index&3) + (index>>2)*16*MMX_COEF] = len << 4;
+	((unsigned int *)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*16*MMX_COEF] = len << 4;
 #else
 	saved_key_length = enc_to_utf16((UTF16*)&saved_key,
 	                                PLAINTEXT_LENGTH + 1,
@@ -500,7 +515,7 @@ bailout:
 		keybuf_word += MMX_COEF;
 	}
 
-	((unsigned int *)saved_key)[14*MMX_COEF + (index&3) + (index>>2)*16*MMX_COEF] = len << 4;
+	((unsigned int *)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*16*MMX_COEF] = len << 4;
 
 #else
 	saved_key_length = utf8_to_utf16((UTF16*)&saved_key,
@@ -553,9 +568,9 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 #pragma omp parallel for
 #endif
 	for (i = 0; i < count; i++)
-		SSEmd4body(&saved_key[i*NBKEYS*64], (unsigned int*)&crypt_key[i*NBKEYS*DIGEST_SIZE], NULL, SSEi_MIXED_IN);
+		SSEmd4body(&saved_key[i*NBKEYS*64], (unsigned int*)&crypt_key[i*NBKEYS*DIGEST_SIZE], NULL, MMX_FLAGS);
 #else
-	SSEmd4body(saved_key, (ARCH_WORD_32*)crypt_key, NULL, SSEi_MIXED_IN);
+	SSEmd4body(saved_key, (ARCH_WORD_32*)crypt_key, NULL, MMX_FLAGS);
 #endif
 
 #else
@@ -585,7 +600,33 @@ static int cmp_all(void *binary, int count) {
 
 static int cmp_one(void *binary, int index)
 {
-#ifdef MMX_COEF
+#ifdef REVERSE_STEPS
+	unsigned int x = index&(MMX_COEF-1);
+	unsigned int y = index/MMX_COEF;
+	ARCH_WORD_32 *t = (ARCH_WORD_32*)binary;
+	ARCH_WORD_32 *key = (ARCH_WORD_32*)&saved_key[GETPOS(0, index)];
+	ARCH_WORD_32 *state = &((ARCH_WORD_32*)crypt_key)[y*MMX_COEF*4+x];
+	ARCH_WORD_32 a, b, c, d;
+
+	a = state[0];
+	b = state[MMX_COEF];
+	c = state[2*MMX_COEF];
+	d = state[3*MMX_COEF];
+	if (a != t[0])
+		return 0;
+
+	/* The three steps SSEi_REVERSE_STEPS left out */
+	d += (a ^ b ^ c) + key[11*MMX_COEF] + SQRT_3; d = (d << 9 ) | (d >> 23);
+	if (d != t[3])
+		return 0;
+
+	c += (d ^ a ^ b) + key[7*MMX_COEF] + SQRT_3; c = (c << 11) | (c >> 21);
+	if (c != t[2])
+		return 0;
+
+	b += (c ^ d ^ a) + key[15*MMX_COEF] + SQRT_3; b = (b << 15) | (b >> 17);
+	return b == t[1];
+#elif defined(MMX_COEF)
 	unsigned int x = index&(MMX_COEF-1);
 	unsigned int y = index/MMX_COEF;
 
@@ -629,50 +670,50 @@ static int cmp_exact(char *source, int index)
 static int get_hash_0(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xf;
 }
 static int get_hash_1(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xff;
 }
 static int get_hash_2(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xfff;
 }
 static int get_hash_3(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xffff;
 }
 static int get_hash_4(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xfffff;
 }
 static int get_hash_5(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xffffff;
 }
 static int get_hash_6(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0x7ffffff;
 }
 #else
@@ -688,6 +729,7 @@ static int get_hash_6(int index) { return ((ARCH_WORD_32*)crypt_key)[index] & 0x
 static char *source(char *source, void *binary)
 {
 	static char Buf[CIPHERTEXT_LENGTH + 4 + 1];
+	ARCH_WORD_32 out[4];
 	unsigned char *cpi;
 	char *cpo;
 	int i;
@@ -695,7 +737,14 @@ static char *source(char *source, void *binary)
 	strcpy(Buf, "$NT$");
 	cpo = &Buf[4];
 
-	cpi = (unsigned char*)(binary);
+	memcpy(out, binary, DIGEST_SIZE);
+#ifdef REVERSE_STEPS
+	out[0] += 0x67452301;
+	out[1] += 0xefcdab89;
+	out[2] += 0x98badcfe;
+	out[3] += 0x10325476;
+#endif
+	cpi = (unsigned char*)out;
 
 	for (i = 0; i < 16; ++i) {
 		*cpo++ = itoa16[(*cpi)>>4];
@@ -139,8 +139,8 @@ extern volatile int bench_running;
 #endif
 #define MIN_KEYS_PER_CRYPT      (NBKEYS * BLOCK_LOOPS)
 #define MAX_KEYS_PER_CRYPT      (NBKEYS * BLOCK_LOOPS)
-#define GETPOS(i, index)        ( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*16*MMX_COEF*4 )
-#define GETOUTPOS(i, index)     ( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*4*MMX_COEF*4 )
+#define GETPOS(i, index)        ( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index/MMX_COEF)*16*MMX_COEF*4 )
+#define GETOUTPOS(i, index)     ( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index/MMX_COEF)*4*MMX_COEF*4 )
 #else
 #define PLAINTEXT_LENGTH        64
 #define MIN_KEYS_PER_CRYPT      1
@@ -745,8 +745,8 @@ key_cleaning:
 		*keybuf_word = 0;
 		keybuf_word += MMX_COEF;
 	}
-	((unsigned int*)saved_key)[14*MMX_COEF + (index&3) +
-	                           (index>>2)*16*MMX_COEF] = len << 4;
+	((unsigned int*)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) +
+	                           (index/MMX_COEF)*16*MMX_COEF] = len << 4;
 #else
 #if ARCH_LITTLE_ENDIAN
 	UTF8 *s = (UTF8*)_key;
@@ -803,8 +803,8 @@ key_cleaning_enc:
 		*keybuf_word = 0;
 		keybuf_word += MMX_COEF;
 	}
-	((unsigned int*)saved_key)[14*MMX_COEF + (index&3) +
-	                           (index>>2)*16*MMX_COEF] = len << 4;
+	((unsigned int*)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) +
+	                           (index/MMX_COEF)*16*MMX_COEF] = len << 4;
 #else
 	saved_key_length[index] = enc_to_utf16(saved_key[index],
 	                                       PLAINTEXT_LENGTH + 1,
@@ -940,8 +940,8 @@ bailout:
 		*keybuf_word = 0;
 		keybuf_word += MMX_COEF;
 	}
-	((unsigned int*)saved_key)[14*MMX_COEF + (index&3) +
-	                           (index>>2)*16*MMX_COEF] = len << 4;
+	((unsigned int*)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) +
+	                           (index/MMX_COEF)*16*MMX_COEF] = len << 4;
 #else
 	saved_key_length[index] = utf8_to_utf16(saved_key[index],
 	                                        PLAINTEXT_LENGTH + 1,
@@ -29,11 +29,22 @@ john_register_one(&fmt_office);
 #include "sha2.h"
 #include "johnswap.h"
 #include "office_common.h"
+#include "sse-intrinsics.h"
 #include "memdbg.h"
 
 #define FORMAT_LABEL		"Office"
 #define FORMAT_NAME		"2007/2010 (SHA-1) / 2013 (SHA-512), with AES"
-#define ALGORITHM_NAME		"32/" ARCH_BITS_STR " " SHA2_LIB
+#ifdef MMX_COEF
+#define ALGO_SHA1		"SHA1 " SHA1_ALGORITHM_NAME
+#else
+#define ALGO_SHA1		"SHA1 32/" ARCH_BITS_STR
+#endif
+#ifdef MMX_COEF_SHA512
+#define ALGO_SHA512		" SHA512 " SHA512_ALGORITHM_NAME
+#else
+#define ALGO_SHA512		" SHA512 32/" ARCH_BITS_STR " " SHA2_LIB
+#endif
+#define ALGORITHM_NAME		ALGO_SHA1 ALGO_SHA512
 #define BENCHMARK_COMMENT	""
 #define BENCHMARK_LENGTH	-1
 #define PLAINTEXT_LENGTH	32
@@ -41,11 +52,25 @@ john_register_one(&fmt_office);
 #define SALT_SIZE		sizeof(*cur_salt)
 #define BINARY_ALIGN	4
 #define SALT_ALIGN	sizeof(int)
-#define MIN_KEYS_PER_CRYPT	1
-#define MAX_KEYS_PER_CRYPT	1
+#ifdef MMX_COEF
+#define SHA1_LOOP_CNT		(MMX_COEF * SHA1_SSE_PARA)
+#define GETPOS(i, index)	( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index/MMX_COEF)*SHA_BUF_SIZ*4*MMX_COEF ) //for endianity conversion
+#else
+#define SHA1_LOOP_CNT		1
+#endif
+#ifdef MMX_COEF_SHA512
+#define SHA512_LOOP_CNT		MMX_COEF_SHA512
+#else
+#define SHA512_LOOP_CNT		1
+#endif
+/* Both are powers of two, so this is a whole number of either */
+#define MIN_KEYS_PER_CRYPT	MAX(SHA1_LOOP_CNT, SHA512_LOOP_CNT)
+#define MAX_KEYS_PER_CRYPT	MAX(SHA1_LOOP_CNT, SHA512_LOOP_CNT)
 
 #undef MIN
 #define MIN(a, b)		(((a) > (b)) ? (b) : (a))
+#undef MAX
+#define MAX(a, b)		(((a) > (b)) ? (a) : (b))
 
 static struct fmt_tests office_tests[] = {
 	{"$office$*2007*20*128*16*8b2c9e8c878844fc842012273be4bea8*aa862168b80d8c45c852696a8bb499eb*a413507fabe2d87606595f987f679ff4b5b4c2cd", "Password"},
@@ -130,30 +155,72 @@ static unsigned char *DeriveKey(unsigned char *hashValue, unsigned char *X1)
 	return NULL;
 }
 
-static unsigned char* GeneratePasswordHashUsingSHA1(UTF16 *passwordBuf, int passwordBufSize, unsigned char *final)
+/* H(0) = H(salt, password) */
+static void hash_password_sha1(int index, unsigned char *hashBuf)
 {
-	unsigned char hashBuf[20], *key;
-	/* H(0) = H(salt, password)
-	 * hashBuf = SHA1Hash(salt, password);
-	 * create input buffer for SHA1 from salt and unicode version of password */
-	unsigned int inputBuf[(0x14 + 0x04 + 4) / sizeof(int)];
-	unsigned char X1[20];
-	int i;
 	SHA_CTX ctx;
 
 	SHA1_Init(&ctx);
 	SHA1_Update(&ctx, cur_salt->osalt, cur_salt->saltSize);
-	SHA1_Update(&ctx, passwordBuf, passwordBufSize);
+	SHA1_Update(&ctx, saved_key[index], saved_len[index]);
 	SHA1_Final(hashBuf, &ctx);
+}
+
+static void hash_password_sha512(int index, unsigned char *hashBuf)
+{
+	SHA512_CTX ctx;
+
+	SHA512_Init(&ctx);
+	SHA512_Update(&ctx, cur_salt->osalt, cur_salt->saltSize);
+	SHA512_Update(&ctx, saved_key[index], saved_len[index]);
+	SHA512_Final(hashBuf, &ctx);
+}
+
+/*
+ * Generate each hash in turn, for n <= SHA1_LOOP_CNT candidates at once
+ * H(n) = H(i, H(n-1))
+ * hashBuf = SHA1Hash(i, hashBuf);
+ *
+ * 1.3.6 says that little-endian byte ordering is expected for i.  The
+ * 24-byte input is a single block, and SIMD builds keep it in the kernel's
+ * interleaved format throughout: each digest is written straight back
+ * into words 1..5 as the next input.
+ */
+static void spin_sha1(unsigned char (*hash)[64], int n, int iterations)
+{
+#ifdef MMX_COEF
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char buf[SHA_BUF_SIZ * 4 * SHA1_LOOP_CNT];
+	ARCH_WORD_32 *w = (ARCH_WORD_32*)buf;
+	int i, x, k;
+
+	memset(buf, 0, sizeof(buf));
+	for (x = 0; x < SHA1_LOOP_CNT; x++) {
+		unsigned char *h = hash[x < n ? x : n - 1];
+
+		for (k = 0; k < 20; k++)
+			buf[GETPOS(4 + k, x)] = h[k];
+		buf[GETPOS(24, x)] = 0x80;
+		buf[GETPOS(63, x)] = 24 << 3;
+	}
+	for (i = 0; i < iterations; i++) {
+		ARCH_WORD_32 ctr = JOHNSWAP(i);
 
-	/* Generate each hash in turn
-	 * H(n) = H(i, H(n-1))
-	 * hashBuf = SHA1Hash(i, hashBuf); */
+		for (x = 0; x < SHA1_LOOP_CNT; x++)
+			w[GETPOS(0, x) >> 2] = ctr;
+		SSESHA1body((__m128i*)buf, &w[MMX_COEF], NULL,
+		            SSEi_MIXED_IN|SSEi_OUTPUT_AS_INP_FMT);
+	}
+	for (x = 0; x < n; x++)
+		for (k = 0; k < 20; k++)
+			hash[x][k] = buf[GETPOS(4 + k, x)];
+#else
+	unsigned int inputBuf[(0x14 + 0x04 + 4) / sizeof(int)];
+	int i;
+	SHA_CTX ctx;
 
 	// Create a byte array of the integer and put at the front of the input buffer
-	// 1.3.6 says that little-endian byte ordering is expected
-	memcpy(&inputBuf[1], hashBuf, 20);
-	for (i = 0; i < MS_OFFICE_2007_ITERATIONS; i++) {
+	memcpy(&inputBuf[1], hash[0], 20);
+	for (i = 0; i < iterations; i++) {
 #if ARCH_LITTLE_ENDIAN
 		*inputBuf = i;
 #else
@@ -164,8 +231,88 @@ static unsigned char* GeneratePasswordHashUsingSHA1(UTF16 *passwordBuf, int pass
 		SHA1_Update(&ctx, inputBuf, 0x14 + 0x04);
 		SHA1_Final((unsigned char*)&inputBuf[1], &ctx);
 	}
+	memcpy(hash[0], &inputBuf[1], 20);
+#endif
+}
+
+/*
+ * Same for SHA-512, n <= SHA512_LOOP_CNT.  The 4-byte counter leaves the
+ * digest straddling the kernel's 64-bit words, so SIMD builds shift each
+ * digest into place for the next block.
+ */
+static void spin_sha512(unsigned char (*hash)[64], int n, int iterations)
+{
+#ifdef MMX_COEF_SHA512
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_64 buf[SHA512_BUF_SIZ * SHA512_LOOP_CNT];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_64 out[8 * SHA512_LOOP_CNT];
+	int i, x, k;
+
+#define W64(i, index)	((i) * MMX_COEF_SHA512 + (index))
+	memset(buf, 0, sizeof(buf));
+	for (x = 0; x < SHA512_LOOP_CNT; x++) {
+		unsigned char *h = hash[x < n ? x : n - 1];
+
+		for (k = 0; k < 8; k++) {
+			ARCH_WORD_64 v;
+
+			memcpy(&v, &h[8 * k], 8);
+			out[W64(k, x)] = JOHNSWAP64(v);
+		}
+		buf[W64(15, x)] = (64 + 4) << 3;
+	}
+	for (i = 0; i < iterations; i++) {
+		ARCH_WORD_64 ctr = (ARCH_WORD_64)JOHNSWAP(i) << 32;
+
+		for (x = 0; x < SHA512_LOOP_CNT; x++)
+			buf[W64(0, x)] = ctr | out[W64(0, x)] >> 32;
+		for (k = 1; k < 8; k++)
+			for (x = 0; x < SHA512_LOOP_CNT; x++)
+				buf[W64(k, x)] = out[W64(k - 1, x)] << 32 |
+					out[W64(k, x)] >> 32;
+		for (x = 0; x < SHA512_LOOP_CNT; x++)
+			buf[W64(8, x)] = out[W64(7, x)] << 32 | 0x80000000;
+		SSESHA512body((__m128i*)buf, out, NULL, SSEi_MIXED_IN);
+	}
+	for (x = 0; x < n; x++)
+		for (k = 0; k < 8; k++) {
+			ARCH_WORD_64 v = JOHNSWAP64(out[W64(k, x)]);
+
+			memcpy(&hash[x][8 * k], &v, 8);
+		}
+#undef W64
+#else
+	unsigned int inputBuf[128 / sizeof(int)];
+	int i;
+	SHA512_CTX ctx;
+
+	// Create a byte array of the integer and put at the front of the input buffer
+	memcpy(&inputBuf[1], hash[0], 64);
+	for (i = 0; i < iterations; i++) {
+#if ARCH_LITTLE_ENDIAN
+		*inputBuf = i;
+#else
+		*inputBuf = JOHNSWAP(i);
+#endif
+		// 'append' the previously generated hash to the input buffer
+		SHA512_Init(&ctx);
+		SHA512_Update(&ctx, inputBuf, 64 + 0x04);
+		SHA512_Final((unsigned char*)&inputBuf[1], &ctx);
+	}
+	memcpy(hash[0], &inputBuf[1], 64);
+#endif
+}
+
+/* The spin loop is done: hash holds H(n) */
+static unsigned char* GeneratePasswordHashUsingSHA1(unsigned char *hash, unsigned char *final)
+{
+	unsigned char hashBuf[20], *key;
+	unsigned int inputBuf[(0x14 + 0x04 + 4) / sizeof(int)];
+	unsigned char X1[20];
+	SHA_CTX ctx;
+
 	// Finally, append "block" (0) to H(n)
 	// hashBuf = SHA1Hash(hashBuf, 0);
+	memcpy(&inputBuf[1], hash, 20);
 	memset(&inputBuf[6], 0, 4);
 	SHA1_Init(&ctx);
 	SHA1_Update(&ctx, &inputBuf[1], 0x14 + 0x04);
@@ -180,38 +327,13 @@ static unsigned char* GeneratePasswordHashUsingSHA1(UTF16 *passwordBuf, int pass
 	return final;
 }
 
-static void GenerateAgileEncryptionKey(UTF16 *passwordBuf, int passwordBufSize, int hashSize, unsigned char *hashBuf)
+static void GenerateAgileEncryptionKey(unsigned char *hash, int hashSize, unsigned char *hashBuf)
 {
-	/* H(0) = H(salt, password)
-	 * hashBuf = SHA1Hash(salt, password);
-	 * create input buffer for SHA1 from salt and unicode version of password */
 	unsigned int inputBuf[(28 + 4) / sizeof(int)];
 	int i;
 	SHA_CTX ctx;
 
-	SHA1_Init(&ctx);
-	SHA1_Update(&ctx, cur_salt->osalt, cur_salt->saltSize);
-	SHA1_Update(&ctx, passwordBuf, passwordBufSize);
-	SHA1_Final(hashBuf, &ctx);
-
-	/* Generate each hash in turn
-	 * H(n) = H(i, H(n-1))
-	 * hashBuf = SHA1Hash(i, hashBuf); */
-
-	// Create a byte array of the integer and put at the front of the input buffer
-	// 1.3.6 says that little-endian byte ordering is expected
-	memcpy(&inputBuf[1], hashBuf, 20);
-	for (i = 0; i < cur_salt->spinCount; i++) {
-#if ARCH_LITTLE_ENDIAN
-		*inputBuf = i;
-#else
-		*inputBuf = JOHNSWAP(i);
-#endif
-		// 'append' the previously generated hash to the input buffer
-		SHA1_Init(&ctx);
-		SHA1_Update(&ctx, inputBuf, 0x14 + 0x04);
-		SHA1_Final((unsigned char*)&inputBuf[1], &ctx);
-	}
+	memcpy(&inputBuf[1], hash, 20);
 	// Finally, append "block" (0) to H(n)
 	memcpy(&inputBuf[6], encryptedVerifierHashInputBlockKey, 8);
 	SHA1_Init(&ctx);
@@ -233,31 +355,12 @@ static void GenerateAgileEncryptionKey(UTF16 *passwordBuf, int passwordBufSize,
 	}
 }
 
-static void GenerateAgileEncryptionKey512(UTF16 *passwordBuf, int passwordBufSize, unsigned char *hashBuf)
+static void GenerateAgileEncryptionKey512(unsigned char *hash, unsigned char *hashBuf)
 {
 	unsigned int inputBuf[128 / sizeof(int)];
-	int i;
 	SHA512_CTX ctx;
 
-	SHA512_Init(&ctx);
-	SHA512_Update(&ctx, cur_salt->osalt, cur_salt->saltSize);
-	SHA512_Update(&ctx, passwordBuf, passwordBufSize);
-	SHA512_Final(hashBuf, &ctx);
-
-	// Create a byte array of the integer and put at the front of the input buffer
-	// 1.3.6 says that little-endian byte ordering is expected
-	memcpy(&inputBuf[1], hashBuf, 64);
-	for (i = 0; i < cur_salt->spinCount; i++) {
-#if ARCH_LITTLE_ENDIAN
-		*inputBuf = i;
-#else
-		*inputBuf = JOHNSWAP(i);
-#endif
-		// 'append' the previously generated hash to the input buffer
-		SHA512_Init(&ctx);
-		SHA512_Update(&ctx, inputBuf, 64 + 0x04);
-		SHA512_Final((unsigned char*)&inputBuf[1], &ctx);
-	}
+	memcpy(&inputBuf[1], hash, 64);
 	// Finally, append "block" (0) to H(n)
 	memcpy(&inputBuf[68/4], encryptedVerifierHashInputBlockKey, 8);
 	SHA512_Init(&ctx);
@@ -300,40 +403,59 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 {
 	int count = *pcount;
 	int index = 0;
+	int inc = cur_salt->version == 2013 ? SHA512_LOOP_CNT : SHA1_LOOP_CNT;
 
 #ifdef _OPENMP
 #pragma omp parallel for
-	for (index = 0; index < count; index++)
 #endif
+	for (index = 0; index < count; index += inc)
 	{
+		unsigned char hash[MAX_KEYS_PER_CRYPT][64];
+		int n = MIN(inc, count - index), i;
+
 		if(cur_salt->version == 2007) {
-			unsigned char encryptionKey[256];
-			GeneratePasswordHashUsingSHA1(saved_key[index], saved_len[index], encryptionKey);
-			ms_office_common_PasswordVerifier(cur_salt, encryptionKey, crypt_key[index]);
+			for (i = 0; i < n; i++)
+				hash_password_sha1(index + i, hash[i]);
+			spin_sha1(hash, n, MS_OFFICE_2007_ITERATIONS);
+			for (i = 0; i < n; i++) {
+				unsigned char encryptionKey[256];
+				GeneratePasswordHashUsingSHA1(hash[i], encryptionKey);
+				ms_office_common_PasswordVerifier(cur_salt, encryptionKey, crypt_key[index + i]);
+			}
 		}
 		else if (cur_salt->version == 2010) {
-			unsigned char verifierKeys[64], decryptedVerifierHashInputBytes[16], decryptedVerifierHashBytes[32];
-			unsigned char hash[20];
-			SHA_CTX ctx;
-			GenerateAgileEncryptionKey(saved_key[index], saved_len[index], cur_salt->keySize >> 3, verifierKeys);
-			ms_office_common_DecryptUsingSymmetricKeyAlgorithm(cur_salt, verifierKeys, cur_salt->encryptedVerifier, decryptedVerifierHashInputBytes, 16);
-			ms_office_common_DecryptUsingSymmetricKeyAlgorithm(cur_salt, &verifierKeys[32], cur_salt->encryptedVerifierHash, decryptedVerifierHashBytes, 32);
-			SHA1_Init(&ctx);
-			SHA1_Update(&ctx, decryptedVerifierHashInputBytes, 16);
-			SHA1_Final(hash, &ctx);
-			cracked[index] = !memcmp(hash, decryptedVerifierHashBytes, 20);
+			for (i = 0; i < n; i++)
+				hash_password_sha1(index + i, hash[i]);
+			spin_sha1(hash, n, cur_salt->spinCount);
+			for (i = 0; i < n; i++) {
+				unsigned char verifierKeys[64], decryptedVerifierHashInputBytes[16], decryptedVerifierHashBytes[32];
+				unsigned char hashBuf[20];
+				SHA_CTX ctx;
+				GenerateAgileEncryptionKey(hash[i], cur_salt->keySize >> 3, verifierKeys);
+				ms_office_common_DecryptUsingSymmetricKeyAlgorithm(cur_salt, verifierKeys, cur_salt->encryptedVerifier, decryptedVerifierHashInputBytes, 16);
+				ms_office_common_DecryptUsingSymmetricKeyAlgorithm(cur_salt, &verifierKeys[32], cur_salt->encryptedVerifierHash, decryptedVerifierHashBytes, 32);
+				SHA1_Init(&ctx);
+				SHA1_Update(&ctx, decryptedVerifierHashInputBytes, 16);
+				SHA1_Final(hashBuf, &ctx);
+				cracked[index + i] = !memcmp(hashBuf, decryptedVerifierHashBytes, 20);
+			}
 		}
 		else if (cur_salt->version == 2013) {
-			unsigned char verifierKeys[128], decryptedVerifierHashInputBytes[16], decryptedVerifierHashBytes[32];
-			unsigned char hash[64];
-			SHA512_CTX ctx;
-			GenerateAgileEncryptionKey512(saved_key[index], saved_len[index], verifierKeys);
-			ms_office_common_DecryptUsingSymmetricKeyAlgorithm(cur_salt, verifierKeys, cur_salt->encryptedVerifier, decryptedVerifierHashInputBytes, 16);
-			ms_office_common_DecryptUsingSymmetricKeyAlgorithm(cur_salt, &verifierKeys[64], cur_salt->encryptedVerifierHash, decryptedVerifierHashBytes, 32);
-			SHA512_Init(&ctx);
-			SHA512_Update(&ctx, decryptedVerifierHashInputBytes, 16);
-			SHA512_Final(hash, &ctx);
-			cracked[index] = !memcmp(hash, decryptedVerifierHashBytes, 20);
+			for (i = 0; i < n; i++)
+				hash_password_sha512(index + i, hash[i]);
+			spin_sha512(hash, n, cur_salt->spinCount);
+			for (i = 0; i < n; i++) {
+				unsigned char verifierKeys[128], decryptedVerifierHashInputBytes[16], decryptedVerifierHashBytes[32];
+				unsigned char hashBuf[64];
+				SHA512_CTX ctx;
+				GenerateAgileEncryptionKey512(hash[i], verifierKeys);
+				ms_office_common_DecryptUsingSymmetricKeyAlgorithm(cur_salt, verifierKeys, cur_salt->encryptedVerifier, decryptedVerifierHashInputBytes, 16);
+				ms_office_common_DecryptUsingSymmetricKeyAlgorithm(cur_salt, &verifierKeys[64], cur_salt->encryptedVerifierHash, decryptedVerifierHashBytes, 32);
+				SHA512_Init(&ctx);
+				SHA512_Update(&ctx, decryptedVerifierHashInputBytes, 16);
+				SHA512_Final(hashBuf, &ctx);
+				cracked[index + i] = !memcmp(hashBuf, decryptedVerifierHashBytes, 20);
+			}
 		}
 	}
 	return count;
@@ -29,6 +29,7 @@ john_register_one(&fmt_oldoffice);
 #include "params.h"
 #include "options.h"
 #include "unicode.h"
+#include "sse-intrinsics.h"
 #ifdef _OPENMP
 #include <omp.h>
 #define OMP_SCALE               256
@@ -37,7 +38,7 @@ john_register_one(&fmt_oldoffice);
 
 #define FORMAT_LABEL		"oldoffice"
 #define FORMAT_NAME		"MS Office <= 2003"
-#define ALGORITHM_NAME		"MD5/SHA1 RC4 32/" ARCH_BITS_STR
+#define ALGORITHM_NAME		"MD5 " MD5_ALGORITHM_NAME " SHA1 RC4 32/" ARCH_BITS_STR
 #define BENCHMARK_COMMENT	""
 #define BENCHMARK_LENGTH	-1000
 #define PLAINTEXT_LENGTH	64
@@ -46,8 +47,16 @@ john_register_one(&fmt_oldoffice);
 #define BINARY_ALIGN	1
 #define SALT_ALIGN	sizeof(int)
 
-#define MIN_KEYS_PER_CRYPT	1
-#define MAX_KEYS_PER_CRYPT	1
+#ifdef MD5_SSE_PARA
+#define NBKEYS			(MMX_COEF * MD5_SSE_PARA)
+#else
+#define NBKEYS			1
+#endif
+#define MIN_KEYS_PER_CRYPT	NBKEYS
+#define MAX_KEYS_PER_CRYPT	NBKEYS
+
+#undef MIN
+#define MIN(a, b)		(((a) > (b)) ? (b) : (a))
 
 #define CIPHERTEXT_LENGTH	(TAG_LEN + 120)
 #define FORMAT_TAG		"$oldoffice$"
@@ -262,6 +271,69 @@ static void set_salt(void *salt)
 	cur_salt = (struct custom_salt *)salt;
 }
 
+/*
+ * mid_key = MD5(16 x (first 5 bytes of MD5(password), salt)) for the n
+ * candidates starting at index.  That is six MD5 blocks per candidate, so
+ * SIMD builds lay them out block by block (the kernel's flat input) and
+ * hash all lanes at once.
+ */
+static void md5_mid_keys(int index, int n, unsigned char (*mid_key)[16])
+{
+	MD5_CTX ctx;
+	int i, j;
+#ifdef MD5_SSE_PARA
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char buf[6][NBKEYS][64];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 state[4 * NBKEYS];
+	union {
+		unsigned char c[6 * 64];
+		ARCH_WORD_32 w[6 * 64 / 4];
+	} hashBuf;
+
+	memset(hashBuf.c, 0, sizeof(hashBuf.c));
+	hashBuf.c[21 * 16] = 0x80;
+	hashBuf.w[6 * 16 - 2] = 21 * 16 << 3;
+	for (j = 0; j < NBKEYS; j++) {
+		int k = index + (j < n ? j : n - 1);
+
+		MD5_Init(&ctx);
+		MD5_Update(&ctx, saved_key[k], saved_len[k]);
+		MD5_Final(mid_key[0], &ctx);
+		for (i = 0; i < 16; i++)
+		{
+			memcpy(hashBuf.c + i * 21, mid_key[0], 5);
+			memcpy(hashBuf.c + i * 21 + 5, cur_salt->salt, 16);
+		}
+		for (i = 0; i < 6; i++)
+			memcpy(buf[i][j], &hashBuf.c[64 * i], 64);
+	}
+	SSEmd5body((__m128i*)buf[0], state, NULL, SSEi_FLAT_IN);
+	for (i = 1; i < 6; i++)
+		SSEmd5body((__m128i*)buf[i], state, state,
+		           SSEi_FLAT_IN|SSEi_RELOAD);
+	for (j = 0; j < n; j++)
+		for (i = 0; i < 4; i++)
+			memcpy(&mid_key[j][4 * i],
+			       &state[(j / MMX_COEF) * 4 * MMX_COEF +
+			              i * MMX_COEF + (j & (MMX_COEF - 1))], 4);
+#else
+	unsigned char hashBuf[21 * 16];
+
+	for (j = 0; j < n; j++) {
+		MD5_Init(&ctx);
+		MD5_Update(&ctx, saved_key[index + j], saved_len[index + j]);
+		MD5_Final(mid_key[j], &ctx);
+		for (i = 0; i < 16; i++)
+		{
+			memcpy(hashBuf + i * 21, mid_key[j], 5);
+			memcpy(hashBuf + i * 21 + 5, cur_salt->salt, 16);
+		}
+		MD5_Init(&ctx);
+		MD5_Update(&ctx, hashBuf, 21 * 16);
+		MD5_Final(mid_key[j], &ctx);
+	}
+#endif
+}
+
 static int crypt_all(int *pcount, struct db_salt *salt)
 {
 	int count = *pcount;
@@ -275,94 +347,88 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
-	for (index = 0; index < count; index++)
+	for (index = 0; index < count; index += NBKEYS)
 	{
-		int i;
+		int j, n = MIN(NBKEYS, count - index);
 		RC4_KEY key;
 
 		if(cur_salt->type < 3) {
 			MD5_CTX ctx;
-			unsigned char mid_key[16];
+			unsigned char mid_key[NBKEYS][16];
 			unsigned char pwdHash[16];
-			unsigned char hashBuf[21 * 16];
-
-			MD5_Init(&ctx);
-			MD5_Update(&ctx, saved_key[index], saved_len[index]);
-			MD5_Final(mid_key, &ctx);
-			for (i = 0; i < 16; i++)
-			{
-				memcpy(hashBuf + i * 21, mid_key, 5);
-				memcpy(hashBuf + i * 21 + 5, cur_salt->salt, 16);
-			}
-			MD5_Init(&ctx);
-			MD5_Update(&ctx, hashBuf, 21 * 16);
-			MD5_Final(mid_key, &ctx);
-			// Early reject if we got a hint
-			if (cur_salt->has_mitm &&
-			    memcmp(mid_key, cur_salt->mitm, 5))
-				continue;
-			memcpy(hashBuf, mid_key, 5);
-			memset(hashBuf + 5, 0, 4);
-			MD5_Init(&ctx);
-			MD5_Update(&ctx, hashBuf, 9);
-			MD5_Final(pwdHash, &ctx);
-			RC4_set_key(&key, 16, pwdHash); /* rc4Key */
-			RC4(&key, 16, cur_salt->verifier, hashBuf); /* encryptedVerifier */
-			RC4(&key, 16, cur_salt->verifierHash, hashBuf + 16); /* encryptedVerifierHash */
-			/* hash the decrypted verifier */
-			MD5_Init(&ctx);
-			MD5_Update(&ctx, hashBuf, 16);
-			MD5_Final(pwdHash, &ctx);
-			if(!memcmp(pwdHash, hashBuf + 16, 16)) {
+			unsigned char hashBuf[32];
+
+			md5_mid_keys(index, n, mid_key);
+			for (j = 0; j < n; j++) {
+				// Early reject if we got a hint
+				if (cur_salt->has_mitm &&
+				    memcmp(mid_key[j], cur_salt->mitm, 5))
+					continue;
+				memcpy(hashBuf, mid_key[j], 5);
+				memset(hashBuf + 5, 0, 4);
+				MD5_Init(&ctx);
+				MD5_Update(&ctx, hashBuf, 9);
+				MD5_Final(pwdHash, &ctx);
+				RC4_set_key(&key, 16, pwdHash); /* rc4Key */
+				RC4(&key, 16, cur_salt->verifier, hashBuf); /* encryptedVerifier */
+				RC4(&key, 16, cur_salt->verifierHash, hashBuf + 16); /* encryptedVerifierHash */
+				/* hash the decrypted verifier */
+				MD5_Init(&ctx);
+				MD5_Update(&ctx, hashBuf, 16);
+				MD5_Final(pwdHash, &ctx);
+				if(!memcmp(pwdHash, hashBuf + 16, 16)) {
 #ifdef _OPENMP
 #pragma omp critical
 #endif
-				{
-					any_cracked = cracked[index] = 1;
-					cur_salt->has_mitm = 1;
-					memcpy(cur_salt->mitm, mid_key, 5);
+					{
+						any_cracked = cracked[index + j] = 1;
+						cur_salt->has_mitm = 1;
+						memcpy(cur_salt->mitm, mid_key[j], 5);
+					}
 				}
 			}
 		}
 		else {
-			SHA_CTX ctx;
-			unsigned char H0[24];
-			unsigned char mid_key[20];
-			unsigned char Hfinal[20];
-			unsigned char DecryptedVerifier[16];
-			unsigned char DecryptedVerifierHash[20];
-
-			SHA1_Init(&ctx);
-			SHA1_Update(&ctx, cur_salt->salt, 16);
-			SHA1_Update(&ctx, saved_key[index], saved_len[index]);
-			SHA1_Final(H0, &ctx);
-			memset(&H0[20], 0, 4);
-			SHA1_Init(&ctx);
-			SHA1_Update(&ctx, H0, 24);
-			SHA1_Final(mid_key, &ctx);
-			// Early reject if we got a hint
-			if (cur_salt->has_mitm &&
-			    memcmp(mid_key, cur_salt->mitm, 5))
-				continue;
-			if(cur_salt->type < 4) {
-				memcpy(Hfinal, mid_key, 5);
-				memset(&Hfinal[5], 0, 11);
-			} else
-				memcpy(Hfinal, mid_key, 20);
-			RC4_set_key(&key, 16, Hfinal); /* dek */
-			RC4(&key, 16, cur_salt->verifier, DecryptedVerifier);
-			RC4(&key, 20, cur_salt->verifierHash, DecryptedVerifierHash);
-			SHA1_Init(&ctx);
-			SHA1_Update(&ctx, DecryptedVerifier, 16);
-			SHA1_Final(Hfinal, &ctx);
-			if(!memcmp(Hfinal, DecryptedVerifierHash, 16)) {
+			for (j = 0; j < n; j++) {
+				SHA_CTX ctx;
+				unsigned char H0[24];
+				unsigned char mid_key[20];
+				unsigned char Hfinal[20];
+				unsigned char DecryptedVerifier[16];
+				unsigned char DecryptedVerifierHash[20];
+
+				SHA1_Init(&ctx);
+				SHA1_Update(&ctx, cur_salt->salt, 16);
+				SHA1_Update(&ctx, saved_key[index + j], saved_len[index + j]);
+				SHA1_Final(H0, &ctx);
+				memset(&H0[20], 0, 4);
+				SHA1_Init(&ctx);
+				SHA1_Update(&ctx, H0, 24);
+				SHA1_Final(mid_key, &ctx);
+				// Early reject if we got a hint
+				if (cur_salt->has_mitm &&
+				    memcmp(mid_key, cur_salt->mitm, 5))
+					continue;
+				if(cur_salt->type < 4) {
+					memcpy(Hfinal, mid_key, 5);
+					memset(&Hfinal[5], 0, 11);
+				} else
+					memcpy(Hfinal, mid_key, 20);
+				RC4_set_key(&key, 16, Hfinal); /* dek */
+				RC4(&key, 16, cur_salt->verifier, DecryptedVerifier);
+				RC4(&key, 20, cur_salt->verifierHash, DecryptedVerifierHash);
+				SHA1_Init(&ctx);
+				SHA1_Update(&ctx, DecryptedVerifier, 16);
+				SHA1_Final(Hfinal, &ctx);
+				if(!memcmp(Hfinal, DecryptedVerifierHash, 16)) {
 #ifdef _OPENMP
 #pragma omp critical
 #endif
-				{
-					any_cracked = cracked[index] = 1;
-					cur_salt->has_mitm = 1;
-					memcpy(cur_salt->mitm, mid_key, 5);
+					{
+						any_cracked = cracked[index + j] = 1;
+						cur_salt->has_mitm = 1;
+						memcpy(cur_salt->mitm, mid_key, 5);
+					}
 				}
 			}
 		}
@@ -240,6 +240,8 @@ static struct opt_entry opt_list[] = {
 		"%u", &options.force_maxlength},
 	{"max-run-time", FLG_ZERO, 0, 0, OPT_REQ_PARAM,
 		"%u", &options.max_run_time},
+	{"single-mem", FLG_ZERO, 0, 0, OPT_REQ_PARAM,
+		"%u", &options.single_mem},
 	{"progress-every", FLG_ZERO, 0, 0, OPT_REQ_PARAM,
 		"%u", &options.status_interval},
 	{"regen-lost-salts", FLG_ZERO, 0, 0, OPT_REQ_PARAM,
@@ -375,6 +377,8 @@ void opt_print_hidden_usage(void)
 	puts("                          without any parameters");
 	puts("--config=FILE             use FILE instead of john.conf or john.ini");
 	puts("--mem-file-size=SIZE      size threshold for wordlist preload (default 5 MB)");
+	puts("--single-mem=MB           cap memory used for \"single crack\" mode key");
+	puts("                          buffers, flushing them early when needed");
 	printf("--format=CLASS            valid classes: dynamic, cpu");
 #if defined(HAVE_OPENCL) || defined(HAVE_CUDA)
 	printf(", gpu");
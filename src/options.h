@@ -267,6 +267,9 @@ struct options_main {
 /* Graceful exit after this many seconds of cracking */
 	int max_run_time;
 
+/* Cap for "single crack" mode key buffers, in MB (0 = no cap) */
+	unsigned int single_mem;
+
 /* Emit a status line every N seconds */
 	int status_interval;
 
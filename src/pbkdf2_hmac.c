@@ -0,0 +1,97 @@
+/*
+ * Batched PBKDF2-HMAC-SHA1/SHA256/SHA512, see pbkdf2_hmac.h.
+ *
+ * No copyright is claimed, and the software is hereby placed in the public
+ * domain.  In case this attempt to disclaim copyright and place the software
+ * in the public domain is deemed null and void, then the software is
+ * hereby released to the general public under the following terms:
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted.
+ */
+
+#include <string.h>
+
+#include "arch.h"
+#include "pbkdf2_hmac.h"
+#include "pbkdf2_hmac_sha1.h"
+#include "pbkdf2_hmac_sha256.h"
+#include "pbkdf2_hmac_sha512.h"
+#include "memdbg.h"
+
+/*
+ * Fill one SIMD group starting at index.  Lanes past count repeat the last
+ * password and write to its output too: same input, same bytes, so this
+ * costs nothing but the (unavoidable) wasted lanes.
+ */
+#define PBKDF2_GROUP(n) \
+	for (j = 0; j < (n); j++) { \
+		int k = index + j < count ? index + j : count - 1; \
+		pin[j] = K[k]; \
+		lens[j] = KL[k]; \
+		pout[j] = out[k]; \
+	}
+
+void pbkdf2_sha1_batch(const unsigned char *K[], const int KL[],
+	int count, const unsigned char *S, int SL, int R,
+	unsigned char *out[], int outlen, int skip_bytes)
+{
+	int index;
+#ifdef MMX_COEF
+	const unsigned char *pin[SSE_GROUP_SZ_SHA1];
+	unsigned char *pout[SSE_GROUP_SZ_SHA1];
+	int lens[SSE_GROUP_SZ_SHA1], j;
+
+	for (index = 0; index < count; index += SSE_GROUP_SZ_SHA1) {
+		PBKDF2_GROUP(SSE_GROUP_SZ_SHA1)
+		pbkdf2_sha1_sse(pin, lens, S, SL, R, pout, outlen, skip_bytes);
+	}
+#else
+	for (index = 0; index < count; index++)
+		pbkdf2_sha1(K[index], KL[index], S, SL, R,
+		            out[index], outlen, skip_bytes);
+#endif
+}
+
+void pbkdf2_sha256_batch(const unsigned char *K[], const int KL[],
+	int count, const unsigned char *S, int SL, int R,
+	unsigned char *out[], int outlen, int skip_bytes)
+{
+	int index;
+#ifdef MMX_COEF_SHA256
+	const unsigned char *pin[SSE_GROUP_SZ_SHA256];
+	unsigned char *pout[SSE_GROUP_SZ_SHA256];
+	int lens[SSE_GROUP_SZ_SHA256], j;
+
+	for (index = 0; index < count; index += SSE_GROUP_SZ_SHA256) {
+		PBKDF2_GROUP(SSE_GROUP_SZ_SHA256)
+		pbkdf2_sha256_sse(pin, lens, (unsigned char*)S, SL, R,
+		                  pout, outlen, skip_bytes);
+	}
+#else
+	for (index = 0; index < count; index++)
+		pbkdf2_sha256(K[index], KL[index], (unsigned char*)S, SL, R,
+		              out[index], outlen, skip_bytes);
+#endif
+}
+
+void pbkdf2_sha512_batch(const unsigned char *K[], const int KL[],
+	int count, const unsigned char *S, int SL, int R,
+	unsigned char *out[], int outlen, int skip_bytes)
+{
+	int index;
+#ifdef MMX_COEF_SHA512
+	const unsigned char *pin[SSE_GROUP_SZ_SHA512];
+	unsigned char *pout[SSE_GROUP_SZ_SHA512];
+	int lens[SSE_GROUP_SZ_SHA512], j;
+
+	for (index = 0; index < count; index += SSE_GROUP_SZ_SHA512) {
+		PBKDF2_GROUP(SSE_GROUP_SZ_SHA512)
+		pbkdf2_sha512_sse(pin, lens, (unsigned char*)S, SL, R,
+		                  pout, outlen, skip_bytes);
+	}
+#else
+	for (index = 0; index < count; index++)
+		pbkdf2_sha512(K[index], KL[index], (unsigned char*)S, SL, R,
+		              out[index], outlen, skip_bytes);
+#endif
+}
@@ -0,0 +1,77 @@
+/*
+ * Batched PBKDF2-HMAC-SHA1/SHA256/SHA512, shared by the CPU formats.
+ *
+ * The pbkdf2_hmac_sha*.h headers hold the actual code.  These entry points
+ * take any number of passwords under one salt, cut them into groups for the
+ * widest SIMD kernel of the build, and pad the last group.  The ipad/opad
+ * state is computed once per password, and the iterations stay in the
+ * interleaved SIMD layout throughout.  Non-SIMD builds simply loop over the
+ * scalar code.
+ *
+ * So far only PBKDF2-HMAC-SHA256, Django, agilekeychain and cloudkeychain
+ * use them.  The other PBKDF2 formats still include the headers and call
+ * pbkdf2_sha*() or pbkdf2_sha*_sse() directly.  Those calls get the same
+ * interleaved iteration loop, but the caller must fill whole SIMD groups.
+ * pbkdf2_hmac_ripemd160.h and pbkdf2_hmac_whirlpool.h have no SIMD code and
+ * nothing here covers them.
+ *
+ * Output is the plain PBKDF2 byte string of outlen bytes per password,
+ * starting skip_bytes into the derived key.
+ *
+ * No copyright is claimed, and the software is hereby placed in the public
+ * domain.  In case this attempt to disclaim copyright and place the software
+ * in the public domain is deemed null and void, then the software is
+ * hereby released to the general public under the following terms:
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted.
+ */
+
+#ifndef _JOHN_PBKDF2_HMAC_H
+#define _JOHN_PBKDF2_HMAC_H
+
+#include "arch.h"
+
+/*
+ * Passwords per SIMD kernel call.  Any count works, but a multiple of
+ * this avoids padding the last group with duplicate work, so formats
+ * use it for their MIN/MAX_KEYS_PER_CRYPT.
+ */
+#ifdef MMX_COEF
+#define PBKDF2_SHA1_BATCH		(MMX_COEF * SHA1_SSE_PARA)
+#else
+#define PBKDF2_SHA1_BATCH		1
+#endif
+
+#ifdef MMX_COEF_SHA256
+#if SHA256_SSE_PARA
+#define PBKDF2_SHA256_BATCH		(MMX_COEF_SHA256 * SHA256_SSE_PARA)
+#else
+#define PBKDF2_SHA256_BATCH		MMX_COEF_SHA256
+#endif
+#else
+#define PBKDF2_SHA256_BATCH		1
+#endif
+
+#ifdef MMX_COEF_SHA512
+#if SHA512_SSE_PARA
+#define PBKDF2_SHA512_BATCH		(MMX_COEF_SHA512 * SHA512_SSE_PARA)
+#else
+#define PBKDF2_SHA512_BATCH		MMX_COEF_SHA512
+#endif
+#else
+#define PBKDF2_SHA512_BATCH		1
+#endif
+
+extern void pbkdf2_sha1_batch(const unsigned char *K[], const int KL[],
+	int count, const unsigned char *S, int SL, int R,
+	unsigned char *out[], int outlen, int skip_bytes);
+
+extern void pbkdf2_sha256_batch(const unsigned char *K[], const int KL[],
+	int count, const unsigned char *S, int SL, int R,
+	unsigned char *out[], int outlen, int skip_bytes);
+
+extern void pbkdf2_sha512_batch(const unsigned char *K[], const int KL[],
+	int count, const unsigned char *S, int SL, int R,
+	unsigned char *out[], int outlen, int skip_bytes);
+
+#endif
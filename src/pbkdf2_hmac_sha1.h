@@ -182,9 +182,12 @@ static void pbkdf2_sha1_sse(const unsigned char *K[SSE_GROUP_SZ_SHA1], int KL[SS
 	SHA_CTX ipad[SSE_GROUP_SZ_SHA1], opad[SSE_GROUP_SZ_SHA1], ctx;
 
 	// sse_hash1 would need to be 'adjusted' for SHA1_PARA
-	JTR_ALIGN(16) unsigned char sse_hash1[SHA_BUF_SIZ*sizeof(ARCH_WORD_32)*SSE_GROUP_SZ_SHA1];
-	JTR_ALIGN(16) unsigned char sse_crypt1[SHA_DIGEST_LENGTH*SSE_GROUP_SZ_SHA1];
-	JTR_ALIGN(16) unsigned char sse_crypt2[SHA_DIGEST_LENGTH*SSE_GROUP_SZ_SHA1];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char sse_hash1[SHA_BUF_SIZ*sizeof(ARCH_WORD_32)*SSE_GROUP_SZ_SHA1];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char sse_crypt1[SHA_DIGEST_LENGTH*SSE_GROUP_SZ_SHA1];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char sse_crypt2[SHA_DIGEST_LENGTH*SSE_GROUP_SZ_SHA1];
+	// the running xor of the iterations, in the same interleaved layout as the
+	// hash output, so that the xor in the inner loop runs over whole SIMD words
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 sse_dgst[SHA_DIGEST_LENGTH/sizeof(ARCH_WORD_32)*SSE_GROUP_SZ_SHA1];
 	i1 = (ARCH_WORD_32*)sse_crypt1;
 	i2 = (ARCH_WORD_32*)sse_crypt2;
 	o1 = (ARCH_WORD_32*)sse_hash1;
@@ -250,24 +253,28 @@ static void pbkdf2_sha1_sse(const unsigned char *K[SSE_GROUP_SZ_SHA1], int KL[SS
 			// Also, perform the 'first' ^= into the crypt buffer.  NOTE, we are doing that in BE format
 			// so we will need to 'undo' that in the end.
 			ptmp = &o1[(j/MMX_COEF)*MMX_COEF*SHA_BUF_SIZ+(j&(MMX_COEF-1))];
-			ptmp[0]           = dgst[j][0] = ctx.h0;
-			ptmp[MMX_COEF]    = dgst[j][1] = ctx.h1;
-			ptmp[MMX_COEF*2]  = dgst[j][2] = ctx.h2;
-			ptmp[MMX_COEF*3]  = dgst[j][3] = ctx.h3;
-			ptmp[MMX_COEF*4]  = dgst[j][4] = ctx.h4;
+			ptmp[0]           = ctx.h0;
+			ptmp[MMX_COEF]    = ctx.h1;
+			ptmp[MMX_COEF*2]  = ctx.h2;
+			ptmp[MMX_COEF*3]  = ctx.h3;
+			ptmp[MMX_COEF*4]  = ctx.h4;
 		}
+		for (k = 0; k < SSE_GROUP_SZ_SHA1/MMX_COEF; k++)
+			memcpy(&sse_dgst[k*MMX_COEF*(SHA_DIGEST_LENGTH/sizeof(ARCH_WORD_32))],
+			       &o1[k*MMX_COEF*SHA_BUF_SIZ], MMX_COEF*SHA_DIGEST_LENGTH);
 
 		// Here is the inner loop.  We loop from 1 to count.  iteration 0 was done in the ipad/opad computation.
 		for(i = 1; i < R; i++) {
 			SSESHA1body((unsigned char*)o1,o1,i1, SSEi_MIXED_IN|SSEi_RELOAD|SSEi_OUTPUT_AS_INP_FMT);
 			SSESHA1body((unsigned char*)o1,o1,i2, SSEi_MIXED_IN|SSEi_RELOAD|SSEi_OUTPUT_AS_INP_FMT);
 #if !defined (PBKDF1_LOGIC)
-			for (k = 0; k < SSE_GROUP_SZ_SHA1; k++) {
-				unsigned *p = &o1[(k/MMX_COEF)*MMX_COEF*SHA_BUF_SIZ + (k&(MMX_COEF-1))];
-				for(j = 0; j < (SHA_DIGEST_LENGTH/sizeof(ARCH_WORD_32)); j++) {
-					dgst[k][j] ^= p[(j<<(MMX_COEF>>1))];
+			for (k = 0; k < SSE_GROUP_SZ_SHA1/MMX_COEF; k++) {
+				ARCH_WORD_32 *p = &o1[k*MMX_COEF*SHA_BUF_SIZ];
+				ARCH_WORD_32 *d = &sse_dgst[k*MMX_COEF*(SHA_DIGEST_LENGTH/sizeof(ARCH_WORD_32))];
+				for(j = 0; j < MMX_COEF*(SHA_DIGEST_LENGTH/sizeof(ARCH_WORD_32)); j++) {
+					d[j] ^= p[j];
 #if defined (EFS_CRAP_LOGIC)
-					p[(j<<(MMX_COEF>>1))] = dgst[k][j];
+					p[j] = d[j];
 #endif
 				}
 			}
@@ -275,12 +282,15 @@ static void pbkdf2_sha1_sse(const unsigned char *K[SSE_GROUP_SZ_SHA1], int KL[SS
 		}
 #if defined (PBKDF1_LOGIC)
 		// PBKDF1 simply uses the end 'result' of all of the HMAC iterations.
+		for (k = 0; k < SSE_GROUP_SZ_SHA1/MMX_COEF; k++)
+			memcpy(&sse_dgst[k*MMX_COEF*(SHA_DIGEST_LENGTH/sizeof(ARCH_WORD_32))],
+			       &o1[k*MMX_COEF*SHA_BUF_SIZ], MMX_COEF*SHA_DIGEST_LENGTH);
+#endif
 		for (k = 0; k < SSE_GROUP_SZ_SHA1; k++) {
-			unsigned *p = &o1[(k/MMX_COEF)*MMX_COEF*SHA_BUF_SIZ + (k&(MMX_COEF-1))];
+			ARCH_WORD_32 *d = &sse_dgst[(k/MMX_COEF)*MMX_COEF*(SHA_DIGEST_LENGTH/sizeof(ARCH_WORD_32)) + (k&(MMX_COEF-1))];
 			for(j = 0; j < (SHA_DIGEST_LENGTH/sizeof(ARCH_WORD_32)); j++)
-				dgst[k][j] = p[(j<<(MMX_COEF>>1))];
+				dgst[k][j] = d[j*MMX_COEF];
 		}
-#endif
 
 		// we must fixup final results.  We have been working in BE (NOT switching out of, just to switch back into it at every loop).
 		// for the 'very' end of the crypt, we remove BE logic, so the calling function can view it in native format.
@@ -204,16 +204,19 @@ static void pbkdf2_sha256_sse(const unsigned char *K[MMX_COEF_SHA256], int KL[MM
 {
 	unsigned char tmp_hash[SHA256_DIGEST_LENGTH];
 	ARCH_WORD_32 *i1, *i2, *o1, *ptmp;
-	int i,j;
+	int i,j,k;
 	ARCH_WORD_32 dgst[SSE_GROUP_SZ_SHA256][SHA256_DIGEST_LENGTH/sizeof(ARCH_WORD_32)];
 	int loops, accum=0;
 	unsigned char loop;
 	SHA256_CTX ipad[SSE_GROUP_SZ_SHA256], opad[SSE_GROUP_SZ_SHA256], ctx;
 
 	// sse_hash1 would need to be 'adjusted' for SHA256_PARA
-	JTR_ALIGN(16) unsigned char sse_hash1[SHA256_BUF_SIZ*sizeof(ARCH_WORD_32)*SSE_GROUP_SZ_SHA256];
-	JTR_ALIGN(16) unsigned char sse_crypt1[SHA256_DIGEST_LENGTH*SSE_GROUP_SZ_SHA256];
-	JTR_ALIGN(16) unsigned char sse_crypt2[SHA256_DIGEST_LENGTH*SSE_GROUP_SZ_SHA256];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char sse_hash1[SHA256_BUF_SIZ*sizeof(ARCH_WORD_32)*SSE_GROUP_SZ_SHA256];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char sse_crypt1[SHA256_DIGEST_LENGTH*SSE_GROUP_SZ_SHA256];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char sse_crypt2[SHA256_DIGEST_LENGTH*SSE_GROUP_SZ_SHA256];
+	// the running xor of the iterations, in the same interleaved layout as the
+	// hash output, so that the xor in the inner loop runs over whole SIMD words
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 sse_dgst[SHA256_DIGEST_LENGTH/sizeof(ARCH_WORD_32)*SSE_GROUP_SZ_SHA256];
 	i1 = (ARCH_WORD_32*)sse_crypt1;
 	i2 = (ARCH_WORD_32*)sse_crypt2;
 	o1 = (ARCH_WORD_32*)sse_hash1;
@@ -283,26 +286,33 @@ static void pbkdf2_sha256_sse(const unsigned char *K[MMX_COEF_SHA256], int KL[MM
 			ptmp = &o1[(j/MMX_COEF_SHA256)*MMX_COEF_SHA256*SHA256_BUF_SIZ+(j&(MMX_COEF_SHA256-1))];
 			for (i = 0; i < (SHA256_DIGEST_LENGTH/sizeof(ARCH_WORD_32)); ++i) {
 #if COMMON_DIGEST_FOR_OPENSSL
-				*ptmp = dgst[j][i] = ctx.hash[i];
+				*ptmp = ctx.hash[i];
 #else
-				*ptmp = dgst[j][i] = ctx.h[i];
+				*ptmp = ctx.h[i];
 #endif
 				ptmp += MMX_COEF_SHA256;
 			}
 		}
+		for (k = 0; k < SSE_GROUP_SZ_SHA256/MMX_COEF_SHA256; k++)
+			memcpy(&sse_dgst[k*MMX_COEF_SHA256*(SHA256_DIGEST_LENGTH/sizeof(ARCH_WORD_32))],
+			       &o1[k*MMX_COEF_SHA256*SHA256_BUF_SIZ], MMX_COEF_SHA256*SHA256_DIGEST_LENGTH);
 
 		// Here is the inner loop.  We loop from 1 to count.  iteration 0 was done in the ipad/opad computation.
 		for(i = 1; i < R; i++) {
-			int k;
 			SSESHA256body(o1,o1,i1, SSEi_MIXED_IN|SSEi_RELOAD|SSEi_OUTPUT_AS_INP_FMT);
 			SSESHA256body(o1,o1,i2, SSEi_MIXED_IN|SSEi_RELOAD|SSEi_OUTPUT_AS_INP_FMT);
-			// only xor first 16 bytes, since that is ALL this format uses
-			for (k = 0; k < SSE_GROUP_SZ_SHA256; k++) {
-				ARCH_WORD_32 *p = &o1[(k/MMX_COEF_SHA256)*MMX_COEF_SHA256*SHA256_BUF_SIZ + (k&(MMX_COEF_SHA256-1))];
-				for(j = 0; j < (SHA256_DIGEST_LENGTH/sizeof(ARCH_WORD_32)); j++)
-					dgst[k][j] ^= p[(j<<(MMX_COEF_SHA256>>1))];
+			for (k = 0; k < SSE_GROUP_SZ_SHA256/MMX_COEF_SHA256; k++) {
+				ARCH_WORD_32 *p = &o1[k*MMX_COEF_SHA256*SHA256_BUF_SIZ];
+				ARCH_WORD_32 *d = &sse_dgst[k*MMX_COEF_SHA256*(SHA256_DIGEST_LENGTH/sizeof(ARCH_WORD_32))];
+				for(j = 0; j < MMX_COEF_SHA256*(SHA256_DIGEST_LENGTH/sizeof(ARCH_WORD_32)); j++)
+					d[j] ^= p[j];
 			}
 		}
+		for (k = 0; k < SSE_GROUP_SZ_SHA256; k++) {
+			ARCH_WORD_32 *d = &sse_dgst[(k/MMX_COEF_SHA256)*MMX_COEF_SHA256*(SHA256_DIGEST_LENGTH/sizeof(ARCH_WORD_32)) + (k&(MMX_COEF_SHA256-1))];
+			for(j = 0; j < (SHA256_DIGEST_LENGTH/sizeof(ARCH_WORD_32)); j++)
+				dgst[k][j] = d[j*MMX_COEF_SHA256];
+		}
 
 		// we must fixup final results.  We have been working in BE (NOT switching out of, just to switch back into it at every loop).
 		// for the 'very' end of the crypt, we remove BE logic, so the calling function can view it in native format.
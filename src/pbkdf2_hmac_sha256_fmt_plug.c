@@ -35,7 +35,8 @@ john_register_one(&fmt_pbkdf2_hmac_sha256);
 #include "sha2.h"
 #include "johnswap.h"
 #include "stdint.h"
-#include "pbkdf2_hmac_sha256.h"
+#include "sse-intrinsics.h"
+#include "pbkdf2_hmac.h"
 
 #define FORMAT_LABEL            "PBKDF2-HMAC-SHA256"
 #define FORMAT_NAME		""
@@ -59,13 +60,8 @@ john_register_one(&fmt_pbkdf2_hmac_sha256);
 #define SALT_SIZE               sizeof(struct custom_salt)
 #define FMT_PREFIX		"$pbkdf2-sha256$"
 #define FMT_CISCO8		"$8$"
-#ifdef MMX_COEF_SHA256
-#define MIN_KEYS_PER_CRYPT	SSE_GROUP_SZ_SHA256
-#define MAX_KEYS_PER_CRYPT	SSE_GROUP_SZ_SHA256
-#else
-#define MIN_KEYS_PER_CRYPT      1
-#define MAX_KEYS_PER_CRYPT      1
-#endif
+#define MIN_KEYS_PER_CRYPT	PBKDF2_SHA256_BATCH
+#define MAX_KEYS_PER_CRYPT	PBKDF2_SHA256_BATCH
 #define BENCHMARK_LENGTH        -1
 #ifdef _OPENMP
 static int omp_t = 1;
@@ -256,24 +252,16 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 #endif
 	for (index = 0; index < count; index += MAX_KEYS_PER_CRYPT)
 	{
-#ifdef SSE_GROUP_SZ_SHA256
-		int lens[SSE_GROUP_SZ_SHA256], i;
-		unsigned char *pin[SSE_GROUP_SZ_SHA256];
-		union {
-			ARCH_WORD_32 *pout[SSE_GROUP_SZ_SHA256];
-			unsigned char *poutc;
-		} x;
-		for (i = 0; i < SSE_GROUP_SZ_SHA256; ++i) {
+		const unsigned char *pin[MAX_KEYS_PER_CRYPT];
+		unsigned char *pout[MAX_KEYS_PER_CRYPT];
+		int lens[MAX_KEYS_PER_CRYPT], i;
+
+		for (i = 0; i < MAX_KEYS_PER_CRYPT; ++i) {
 			lens[i] = strlen(saved_key[index+i]);
 			pin[i] = (unsigned char*)saved_key[index+i];
-			x.pout[i] = crypt_out[index+i];
+			pout[i] = (unsigned char*)crypt_out[index+i];
 		}
-		pbkdf2_sha256_sse((const unsigned char **)pin, lens, cur_salt->salt, cur_salt->length, cur_salt->rounds, &(x.poutc), BINARY_SIZE, 0);
-#else
-		pbkdf2_sha256((const unsigned char*)(saved_key[index]), strlen(saved_key[index]),
-			cur_salt->salt, cur_salt->length,
-			cur_salt->rounds, (unsigned char*)crypt_out[index], BINARY_SIZE, 0);
-#endif
+		pbkdf2_sha256_batch(pin, lens, MAX_KEYS_PER_CRYPT, cur_salt->salt, cur_salt->length, cur_salt->rounds, pout, BINARY_SIZE, 0);
 	}
 	return count;
 }
@@ -55,6 +55,8 @@ john_register_one(&fmt_pkzip);
 
 #define MIN_KEYS_PER_CRYPT		1
 #define MAX_KEYS_PER_CRYPT		64
+/* candidates run in lockstep through the key setup and first header check */
+#define PKZIP_LANES			8
 #define OMP_SCALE			64
 
 //#define ZIP_DEBUG 1
@@ -1301,6 +1303,70 @@ MAYBE_INLINE static int check_inflate_CODE1(u8 *next, int left) {
 		}
 #endif
 
+/*
+ * Key setup and the checksum byte(s) of the first hash, for PKZIP_LANES
+ * candidates in lockstep.  Each candidate is one long serial chain of crc
+ * lookups, so stepping several independent chains together keeps the CPU
+ * busy while the lookups are in flight.  All candidates share the same 12
+ * header bytes.  Only those passing the check get chk[] set, and only those
+ * go on to the (much slower) per candidate checks in crypt_all.
+ */
+static void crypt_lanes(int idx, int lanes)
+{
+	MY_WORD key0[PKZIP_LANES], key1[PKZIP_LANES], key2[PKZIP_LANES];
+	u8 C[PKZIP_LANES];
+	const u8 *b = salt->H[0].h;
+	u16 e = salt->H[0].c, e2 = salt->H[0].c2;
+	int i, l;
+
+	if (dirty) {
+		int len[PKZIP_LANES], max_len = 0;
+
+		for (l = 0; l < lanes; ++l) {
+			len[l] = strlen(saved_key[idx+l]);
+			if (len[l] > max_len)
+				max_len = len[l];
+			key0[l].u = 0x12345678UL; key1[l].u = 0x23456789UL; key2[l].u = 0x34567890UL;
+		}
+		for (i = 0; i < max_len; ++i)
+		for (l = 0; l < lanes; ++l) {
+			if (i < len[l]) {
+				key0[l].u = pkzip_crc32 (key0[l].u, (u8)saved_key[idx+l][i]);
+				key1[l].u = (key1[l].u + key0[l].c[KB1]) * 134775813 + 1;
+				key2[l].u = pkzip_crc32 (key2[l].u, key1[l].c[KB2]);
+			}
+		}
+		for (l = 0; l < lanes; ++l) {
+			K12[(idx+l)*3] = key0[l].u;
+			K12[(idx+l)*3+1] = key1[l].u;
+			K12[(idx+l)*3+2] = key2[l].u;
+		}
+	} else {
+		for (l = 0; l < lanes; ++l) {
+			key0[l].u = K12[(idx+l)*3];
+			key1[l].u = K12[(idx+l)*3+1];
+			key2[l].u = K12[(idx+l)*3+2];
+		}
+	}
+
+	for (i = 0; i < 11; ++i)
+	for (l = 0; l < lanes; ++l) {
+		C[l] = PKZ_MULT(b[i],key2[l]);
+		key0[l].u = pkzip_crc32 (key0[l].u, C[l]);
+		key1[l].u = (key1[l].u + key0[l].c[KB1]) * 134775813 + 1;
+		key2[l].u = pkzip_crc32 (key2[l].u, key1[l].c[KB2]);
+	}
+	for (l = 0; l < lanes; ++l) {
+		chk[idx+l] = 0;
+		if (salt->chk_bytes == 2 && C[l] != (e&0xFF) && C[l] != (e2&0xFF))
+			continue;
+		C[l] = PKZ_MULT(b[11],key2[l]);
+		if (C[l] != (e>>8) && C[l] != (e2>>8))
+			continue;
+		chk[idx+l] = 1;
+	}
+}
+
 /*
  * Crypt_all simply performs the checksum .zip validatation of the data. It performs
  * this for ALL hashes provided. If any of them fail to match, then crypt all puts the
@@ -1331,6 +1397,13 @@ static int crypt_all(int *pcount, struct db_salt *_salt)
 	// Again, hopefully globbing many tests into a threads working set will flatten out these differences.
 #ifdef _OPENMP
 #pragma omp parallel for private(idx)
+#endif
+	for (idx = 0; idx < _count; idx += PKZIP_LANES)
+		crypt_lanes(idx, _count-idx < PKZIP_LANES ? _count-idx : PKZIP_LANES);
+
+	// Only the few candidates passing the first checksum are left for the full checks.
+#ifdef _OPENMP
+#pragma omp parallel for private(idx)
 #endif
 	for (idx = 0; idx < _count; ++idx) {
 		int cur_hash_count = salt->cnt;
@@ -1347,30 +1420,16 @@ static int crypt_all(int *pcount, struct db_salt *_salt)
 		z_stream strm;
 		int ret;
 
-		/* use the pwkey for each hash.  We mangle on the 12 bytes of IV to what  was computed in the pwkey load. */
-
-		if (dirty) {
-			u8 *p = (u8*)saved_key[idx];
-
-			/* load the 'pwkey' one time, put it into the K12 array */
-			key0.u = 0x12345678UL; key1.u = 0x23456789UL; key2.u = 0x34567890UL;
-			do {
-				key0.u = pkzip_crc32 (key0.u, *p++);
-				key1.u = (key1.u + key0.c[KB1]) * 134775813 + 1;
-				key2.u = pkzip_crc32 (key2.u, key1.c[KB2]);
-			} while (*p);
-			K12[idx*3] = key0.u, K12[idx*3+1] = key1.u, K12[idx*3+2] = key2.u;
-			goto SkipKeyLoadInit;
-		}
+		if (!chk[idx])
+			continue;
 
+		/* use the pwkey for each hash.  We mangle on the 12 bytes of IV to what  was computed in the pwkey load. */
 		do
 		{
-			// 2nd, and later times through the loop, AND if keys are not dirty (i.e. multiple salts
-			// for the same key load), we do NOT perform the key compute, but instead load the pre-computed
-			// key data from the array.
+			// The 'pwkey' was computed by crypt_lanes() into the K12 array.  The first hash is
+			// redone here, which is cheap, as only the few candidates that passed its checksum get here.
 			key0.u = K12[idx*3], key1.u = K12[idx*3+1], key2.u = K12[idx*3+2];
 
-SkipKeyLoadInit:;
 			b = salt->H[++cur_hash_idx].h;
 			k=11;
 			e = salt->H[cur_hash_idx].c;
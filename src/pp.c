@@ -35,7 +35,9 @@
 #define __USE_MINGW_ANSI_STDIO 1
 #endif
 
-#if HAVE_LIBGMP || HAVE_INT128 || HAVE___INT128 || HAVE___INT128_T
+#if (HAVE_LIBGMP || HAVE_INT128 || HAVE___INT128 || HAVE___INT128_T) && \
+	(!PP_GMP_FALLBACK || \
+	 (HAVE_LIBGMP && (HAVE_INT128 || HAVE___INT128 || HAVE___INT128_T)))
 
 #include <stdio.h>
 #ifndef JTR_MODE
@@ -79,9 +81,16 @@
 #include <sys/mman.h>
 #endif
 
-#if HAVE_INT128 || HAVE___INT128 || HAVE___INT128_T
+#if (HAVE_INT128 || HAVE___INT128 || HAVE___INT128_T) && !PP_GMP_FALLBACK
 #include "mpz_int128.h"
 #define REALGMP "int128"
+#if HAVE_LIBGMP && defined(JTR_MODE)
+/*
+ * The int128 build is the fast path. Should the keyspace not fit in 128
+ * bits, we hand over to the GMP build of this very file (see pp_gmp.c).
+ */
+#define PP_HAVE_GMP_FALLBACK 1
+#endif
 #else
 #define REALGMP "GMP"
 #if HAVE_GMP_GMP_H
@@ -135,10 +144,22 @@
 #define _STR_VALUE(arg) #arg
 #define STR_MACRO(n)    _STR_VALUE(n)
 
+#if !PP_GMP_FALLBACK
 int prince_elem_cnt_min;
 int prince_elem_cnt_max;
 char *prince_skip_str;
 char *prince_limit_str;
+#endif
+
+#if PP_GMP_FALLBACK
+/*
+ * We only run after a handover from the int128 build, which has already
+ * logged the options and the loading of the wordlist.
+ */
+#define setup_log_event(...)
+#else
+#define setup_log_event log_event
+#endif
 
 static char *mem_map, *map_pos, *map_end;
 #endif
@@ -805,7 +826,7 @@ static void add_uniq (db_entry_t *db_entry, char *input_buf, int input_len)
   uniq->index++;
 }
 
-mpz_t save;
+static mpz_t save;
 
 #ifndef JTR_MODE
 static void catch_int ()
@@ -980,8 +1001,16 @@ static MAYBE_INLINE char *mgets(int *len)
   return pos;
 }
 
+#if PP_HAVE_GMP_FALLBACK || PP_GMP_FALLBACK
+extern void do_prince_crack_gmp(struct db_main *db, char *wordlist, int rules);
+#endif
+
+#if PP_GMP_FALLBACK
+void do_prince_crack_gmp(struct db_main *db, char *wordlist, int rules)
+#else
 void do_prince_crack(struct db_main *db, char *wordlist, int rules)
 #endif
+#endif
 {
   mpz_t pw_ks_pos[OUT_LEN_MAX + 1];
   mpz_t pw_ks_cnt[OUT_LEN_MAX + 1];
@@ -1184,14 +1213,17 @@ void do_prince_crack(struct db_main *db, char *wordlist, int rules)
   #endif
 #else
   struct rpp_context ctx;
+#if PP_HAVE_GMP_FALLBACK
+  char *wordlist_arg = wordlist;
+#endif
   char *prerule="", *rule="", *word="";
   char *last = "\r";
   int loopback = (options.flags & FLG_PRINCE_LOOPBACK) ? 1 : 0;
 
   dupe_check = (options.flags & FLG_DUPESUPP) ? 1 : 0;
 
-  log_event("Proceeding with PRINCE (" REALGMP " version)%s",
-            loopback ? " in loopback mode" : "");
+  setup_log_event("Proceeding with PRINCE (" REALGMP " version)%s",
+                  loopback ? " in loopback mode" : "");
 
   /* This mode defaults to length 16 (unless lowered by format) */
   pw_min = MAX(PW_MIN, options.force_minlength);
@@ -1252,38 +1284,9 @@ void do_prince_crack(struct db_main *db, char *wordlist, int rules)
   if (!(wordlist = cfg_get_param(SECTION_OPTIONS, NULL, "Wordlist")))
     wordlist = options.wordlist = WORDLIST_NAME;
 
-  log_event("- Wordlist file: %.100s", path_expand(wordlist));
-  log_event("- Will generate candidates of length %d - %d", pw_min, pw_max);
-  log_event("- Using chains with %d - %d elements.", elem_cnt_min, elem_cnt_max);
-
-  if (rules) {
-    if (pers_opts.activewordlistrules)
-      log_event("- Rules: %.100s", pers_opts.activewordlistrules);
-
-    if (rpp_init(rule_ctx = &ctx, pers_opts.activewordlistrules)) {
-      log_event("! No \"%s\" mode rules found",
-                pers_opts.activewordlistrules);
-      if (john_main_process)
-        fprintf(stderr,
-                "No \"%s\" mode rules found in %s\n",
-                pers_opts.activewordlistrules, cfg_name);
-      error();
-    }
-
-  /* rules.c honors -min/max-len options on its own */
-    rules_init(pers_opts.internal_enc == pers_opts.target_enc ?
-               pw_max : db->format->params.plaintext_length);
-    rule_count = rules_count(&ctx, -1);
-
-    log_event("- %d preprocessed word mangling rules", rule_count);
-
-    prerule = rpp_next(&ctx);
-  }
-  else
-  {
-    log_event("- No word mangling rules");
-    rule_count = 1;
-  }
+  setup_log_event("- Wordlist file: %.100s", path_expand(wordlist));
+  setup_log_event("- Will generate candidates of length %d - %d", pw_min, pw_max);
+  setup_log_event("- Using chains with %d - %d elements.", elem_cnt_min, elem_cnt_max);
 #endif
 
   /**
@@ -1386,12 +1389,15 @@ void do_prince_crack(struct db_main *db, char *wordlist, int rules)
 
   if (!john_main_process)
     warn = 0;
+#if PP_GMP_FALLBACK
+  warn = 0; /* the int128 build already warned */
+#endif
 
   wordlist = path_expand(wordlist);
 
   if (!(read_fp = jtr_fopen(wordlist, "rb")))
     pexit(STR_MACRO(jtr_fopen)": %s", wordlist);
-  log_event("- Input file: %.100s", wordlist);
+  setup_log_event("- Input file: %.100s", wordlist);
 
   jtr_fseek64(read_fp, 0, SEEK_END);
   if ((file_len = jtr_ftell64(read_fp)) == -1)
@@ -1407,8 +1413,8 @@ void do_prince_crack(struct db_main *db, char *wordlist, int rules)
 #ifdef HAVE_MMAP
   if (options.flags & FLG_PRINCE_MMAP)
   {
-    log_event("- Memory mapping wordlist ("LLd" bytes)",
-              (long long)file_len);
+    setup_log_event("- Memory mapping wordlist ("LLd" bytes)",
+                    (long long)file_len);
 #if (SIZEOF_SIZE_T < 8)
     /* Now even though we are 64 bit file size, we must still
      * deal with some 32 bit functions ;) */
@@ -1424,18 +1430,18 @@ void do_prince_crack(struct db_main *db, char *wordlist, int rules)
       fprintf(stderr, "wordlist: memory mapping failed (%s) (non-fatal)\n",
               strerror(errno));
 #endif
-      log_event("! Memory mapping failed (%s) - but we'll do "
-                "fine without it.", strerror(errno));
+      setup_log_event("! Memory mapping failed (%s) - but we'll do "
+                      "fine without it.", strerror(errno));
     } else {
       map_pos = mem_map;
       map_end = mem_map + file_len;
     }
   }
 #endif
-  log_event("Loading elements from %s", loopback ? ".pot file" : "wordlist");
+  setup_log_event("Loading elements from %s", loopback ? ".pot file" : "wordlist");
 
   if (case_permute)
-    log_event("- Permuting case of 1st character");
+    setup_log_event("- Permuting case of 1st character");
 
   size_t uniq_mem = 0;
 
@@ -1447,7 +1453,7 @@ void do_prince_crack(struct db_main *db, char *wordlist, int rules)
       hash_log++;
 
     if (john_main_process && options.verbosity < 5)
-      log_event("- Suppressing dupes");
+      setup_log_event("- Suppressing dupes");
 
     int in_max = MIN(IN_LEN_MAX, pw_max);
 
@@ -1471,10 +1477,10 @@ void do_prince_crack(struct db_main *db, char *wordlist, int rules)
       db_entry->uniq = uniq;
 
       if (john_main_process && options.verbosity > 4)
-        log_event("- Dupe suppression len %d: hash size %u, "
-                  "temporarily allocating %zu bytes", pw_len,
-                  hash_size, sizeof(uniq_t) + hash_alloc * sizeof(uniq_data_t) +
-                  hash_size * sizeof(u32));
+        setup_log_event("- Dupe suppression len %d: hash size %u, "
+                        "temporarily allocating %zu bytes", pw_len,
+                        hash_size, sizeof(uniq_t) + hash_alloc * sizeof(uniq_data_t) +
+                        hash_size * sizeof(u32));
     }
   }
 
@@ -1629,7 +1635,7 @@ void do_prince_crack(struct db_main *db, char *wordlist, int rules)
    */
 
 #ifdef JTR_MODE
-  log_event("Initializing chains");
+  setup_log_event("Initializing chains");
 #endif
   for (int pw_len = pw_min; pw_len <= pw_max; pw_len++)
   {
@@ -1686,6 +1692,93 @@ void do_prince_crack(struct db_main *db, char *wordlist, int rules)
     memset (db_entry->cur_chain_ks_poses, 0, OUT_LEN_MAX * sizeof (u64));
   }
 
+#if PP_HAVE_GMP_FALLBACK
+  /**
+   * hand over to GMP if the keyspace does not fit in 128 bits
+   */
+
+  mpz_set_si (tmp, 0);
+
+  for (int pw_len = pw_min; pw_len <= pw_max; pw_len++)
+  {
+    db_entry_t *db_entry = &db_entries[pw_len];
+
+    for (int chains_idx = 0; chains_idx < db_entry->chains_cnt; chains_idx++)
+    {
+      chain_t *chain_buf = &db_entry->chains_buf[chains_idx];
+
+      chain_ks (chain_buf, db_entries, &chain_buf->ks_cnt);
+
+      mpz_add (tmp, tmp, chain_buf->ks_cnt);
+    }
+  }
+
+  if (tmp == UINT128_MAX ||
+      cfg_get_bool(SECTION_PRINCE, NULL, "ForceGMP", 0))
+  {
+    if (tmp == UINT128_MAX)
+      log_event("- Keyspace exceeds %d bits, switching to GMP", FAKE_GMP);
+    else
+      log_event("- ForceGMP set in john.conf, switching to GMP");
+
+    for (int pw_len = IN_LEN_MIN; pw_len <= pw_max; pw_len++)
+    {
+      db_entry_t *db_entry = &db_entries[pw_len];
+
+      if (db_entry->chains_buf) free (db_entry->chains_buf);
+      if (db_entry->elems_buf)  free (db_entry->elems_buf);
+    }
+
+    free (wordlen_dist);
+    free (pw_orders);
+    free (db_entries);
+
+    if (mem_map)
+    {
+      munmap(mem_map, file_len);
+      mem_map = NULL;
+    }
+
+    do_prince_crack_gmp(db, wordlist_arg, rules);
+    return;
+  }
+#endif
+
+  /**
+   * init rules, not before the GMP handover so it's done only once
+   */
+
+#ifdef JTR_MODE
+  if (rules) {
+    if (pers_opts.activewordlistrules)
+      log_event("- Rules: %.100s", pers_opts.activewordlistrules);
+
+    if (rpp_init(rule_ctx = &ctx, pers_opts.activewordlistrules)) {
+      log_event("! No \"%s\" mode rules found",
+                pers_opts.activewordlistrules);
+      if (john_main_process)
+        fprintf(stderr,
+                "No \"%s\" mode rules found in %s\n",
+                pers_opts.activewordlistrules, cfg_name);
+      error();
+    }
+
+  /* rules.c honors -min/max-len options on its own */
+    rules_init(pers_opts.internal_enc == pers_opts.target_enc ?
+               pw_max : db->format->params.plaintext_length);
+    rule_count = rules_count(&ctx, -1);
+
+    log_event("- %d preprocessed word mangling rules", rule_count);
+
+    prerule = rpp_next(&ctx);
+  }
+  else
+  {
+    log_event("- No word mangling rules");
+    rule_count = 1;
+  }
+#endif
+
   /**
    * calculate password candidate output length distribution
    */
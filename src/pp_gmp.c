@@ -0,0 +1,14 @@
+/*
+ * No copyright is claimed, and the software is hereby placed in the public
+ * domain.  In case this attempt to disclaim copyright and place the software
+ * in the public domain is deemed null and void, then the software is
+ * hereby released to the general public under the following terms:
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted.
+ *
+ * GMP build of PRINCE mode. When int128 is available, pp.c uses native
+ * 128-bit arithmetic and only calls do_prince_crack_gmp() from here if the
+ * keyspace does not fit. Otherwise this compiles to nothing.
+ */
+#define PP_GMP_FALLBACK 1
+#include "pp.c"
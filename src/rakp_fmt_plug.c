@@ -57,7 +57,7 @@ john_register_one(&fmt_rakp);
 #ifdef MMX_COEF
 #define MIN_KEYS_PER_CRYPT      SHA1_N
 #define MAX_KEYS_PER_CRYPT      SHA1_N
-#define GETPOS(i, index)        ((index & (MMX_COEF - 1)) * 4 + ((i) & (0xffffffff - 3)) * MMX_COEF + (3 - ((i) & 3)) + (index >> (MMX_COEF >> 1)) * SHA_BUF_SIZ * 4 * MMX_COEF)
+#define GETPOS(i, index)        ((index & (MMX_COEF - 1)) * 4 + ((i) & (0xffffffff - 3)) * MMX_COEF + (3 - ((i) & 3)) + (index / MMX_COEF) * SHA_BUF_SIZ * 4 * MMX_COEF)
 
 #else
 #define MIN_KEYS_PER_CRYPT      1
@@ -78,7 +78,7 @@ static struct fmt_tests tests[] = {
 static unsigned char *crypt_key;
 static unsigned char *ipad, *prep_ipad;
 static unsigned char *opad, *prep_opad;
-JTR_ALIGN(16) unsigned char cur_salt[2][SHA_BUF_SIZ * 4 * SHA1_N];
+JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char cur_salt[2][SHA_BUF_SIZ * 4 * SHA1_N];
 static int bufsize;
 #else
 static struct {
@@ -126,7 +126,7 @@ static void init(struct fmt_main *self)
 	prep_opad = mem_calloc_tiny(sizeof(*prep_opad) * self->params.max_keys_per_crypt * BINARY_SIZE, MEM_ALIGN_SIMD);
 	for (i = 0; i < self->params.max_keys_per_crypt; ++i) {
 		crypt_key[GETPOS(BINARY_SIZE, i)] = 0x80;
-		((unsigned int*)crypt_key)[15 * MMX_COEF + (i & 3) + (i >> 2) * SHA_BUF_SIZ * MMX_COEF] = (BINARY_SIZE + 64) << 3;
+		((unsigned int*)crypt_key)[15 * MMX_COEF + (i & (MMX_COEF - 1)) + (i / MMX_COEF) * SHA_BUF_SIZ * MMX_COEF] = (BINARY_SIZE + 64) << 3;
 	}
 	clear_keys();
 #else
@@ -293,7 +293,7 @@ static int cmp_one(void *binary, int index)
 	int i;
 	for(i = 0; i < (BINARY_SIZE/4); i++)
 		// NOTE crypt_key is in input format (4*SHA_BUF_SIZ*MMX_COEF)
-		if (((ARCH_WORD_32*)binary)[i] != ((ARCH_WORD_32*)crypt_key)[i * MMX_COEF + (index & 3) + (index >> 2) * SHA_BUF_SIZ * MMX_COEF])
+		if (((ARCH_WORD_32*)binary)[i] != ((ARCH_WORD_32*)crypt_key)[i * MMX_COEF + (index & (MMX_COEF - 1)) + (index / MMX_COEF) * SHA_BUF_SIZ * MMX_COEF])
 			return 0;
 	return 1;
 #else
@@ -414,7 +414,7 @@ static void *salt(char *ciphertext)
 			cur_salt[j>>6][GETPOS(j & 63, i)] = 0;
 
 	for (i = 0; i < SHA1_N; ++i)
-		((unsigned int*)cur_salt[1])[15 * MMX_COEF + (i & 3) + (i >> 2) * SHA_BUF_SIZ * MMX_COEF] = (len + 64) << 3;
+		((unsigned int*)cur_salt[1])[15 * MMX_COEF + (i & (MMX_COEF - 1)) + (i / MMX_COEF) * SHA_BUF_SIZ * MMX_COEF] = (len + 64) << 3;
 	return &cur_salt;
 #else
 	cur_salt.length = len;
@@ -84,10 +84,11 @@ john_register_one(&fmt_rar);
 #include "unrar.h"
 #include "config.h"
 #include "jumbo.h"
+#include "sse-intrinsics.h"
 
 #define FORMAT_LABEL		"rar"
 #define FORMAT_NAME		"RAR3"
-#define ALGORITHM_NAME		"SHA1 AES 32/" ARCH_BITS_STR
+#define ALGORITHM_NAME		"SHA1 AES " SHA1_ALGORITHM_NAME
 
 #ifdef DEBUG
 #define BENCHMARK_COMMENT	" (1-16 characters)"
@@ -102,8 +103,19 @@ john_register_one(&fmt_rar);
 #define BINARY_ALIGN		MEM_ALIGN_NONE
 #define SALT_SIZE		sizeof(rarfile*)
 #define SALT_ALIGN		sizeof(rarfile*)
+#ifdef MMX_COEF
+#define NBKEYS			(MMX_COEF * SHA1_SSE_PARA)
+#define MIN_KEYS_PER_CRYPT	NBKEYS
+#define MAX_KEYS_PER_CRYPT	NBKEYS
+#define GETPOS(i, index)	( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index/MMX_COEF)*SHA_BUF_SIZ*4*MMX_COEF ) //for endianity conversion
+#define GETOUTPOS(i, index)	( (index&(MMX_COEF-1)) + (i)*MMX_COEF + (index/MMX_COEF)*5*MMX_COEF )
+/* One SHA-1 block for all lanes, and room for the longest 64-record chunk */
+#define KDF_BLOCK_SIZE		(SHA_BUF_SIZ * 4 * NBKEYS)
+#define KDF_BUF_SIZE		((UNICODE_LENGTH + 8 + 3) * KDF_BLOCK_SIZE)
+#else
 #define MIN_KEYS_PER_CRYPT	1
 #define MAX_KEYS_PER_CRYPT	1
+#endif
 
 #define ROUNDS			0x40000
 
@@ -136,6 +148,22 @@ static unsigned int *saved_len;
 static unsigned char *aes_key;
 static unsigned char *aes_iv;
 
+//#define RAR_REJECT_STATS
+
+#ifdef RAR_REJECT_STATS
+/* Candidates rejected by each verification stage, racy under OMP */
+static struct {
+	unsigned long long header, unpack, crc;
+} rejected;
+#define REJECTED(stage)	rejected.stage++
+#else
+#define REJECTED(stage)
+#endif
+#ifdef MMX_COEF
+static int *kdf_order, *kdf_group;
+static unsigned char *kdf_buf;
+#endif
+
 typedef struct {
 	dyna_salt dsalt; /* must be first. allows dyna_salt to work */
 	/* place all items we are NOT going to use for salt comparison, first */
@@ -431,6 +459,11 @@ static void init(struct fmt_main *self)
 	saved_salt = mem_calloc_tiny(8, MEM_ALIGN_NONE);
 	aes_key = mem_calloc_tiny(16 * self->params.max_keys_per_crypt, MEM_ALIGN_NONE);
 	aes_iv = mem_calloc_tiny(16 * self->params.max_keys_per_crypt, MEM_ALIGN_NONE);
+#ifdef MMX_COEF
+	kdf_order = mem_calloc_tiny(sizeof(*kdf_order) * self->params.max_keys_per_crypt, MEM_ALIGN_WORD);
+	kdf_group = mem_calloc_tiny(sizeof(*kdf_group) * (self->params.max_keys_per_crypt + 1), MEM_ALIGN_WORD);
+	kdf_buf = mem_alloc_tiny(KDF_BUF_SIZE * omp_t, MEM_ALIGN_SIMD);
+#endif
 
 #ifdef DEBUG
 	self->params.benchmark_comment = " (1-16 characters)";
@@ -657,11 +690,177 @@ static MAYBE_INLINE int check_huffman(unsigned char *next) {
 	return 1; /* Passed this check! */
 }
 
+#ifdef MMX_COEF
+/*
+ * The key derivation hashes ROUNDS records of password, salt and a 3-byte
+ * counter, snapshotting the state every ROUNDS / 16 records for the IV.
+ * With all NBKEYS passwords of one length, 64 records fill exactly len + 11
+ * blocks in every lane, and only the counter bytes differ between such
+ * 64-record chunks.  So we lay one chunk out in the kernel's interleaved
+ * format once, then just patch the counters before hashing each chunk.
+ *
+ * idx[] holds n <= NBKEYS indices of keys with the same length.  Unused
+ * lanes repeat the last key.
+ */
+static void rar_kdf_simd(const int *idx, int n, unsigned char *buf)
+{
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 state[5 * NBKEYS];
+	JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 tmp[5 * NBKEYS];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char pad[2 * KDF_BLOCK_SIZE];
+	unsigned int lane[NBKEYS], ctr[64];
+	unsigned int len = saved_len[idx[0]];
+	unsigned int rlen = len + 8 + 3;
+	unsigned int i, r, b, x, q;
+
+#define KDF_POS(p, x)	(((p) >> 6) * KDF_BLOCK_SIZE + GETPOS((p) & 63, x))
+
+	for (x = 0; x < NBKEYS; x++) {
+		unsigned char *key =
+			&saved_key[UNICODE_LENGTH * idx[x < n ? x : n - 1]];
+
+		lane[x] = GETPOS(0, x) - GETPOS(0, 0);
+		for (r = 0; r < 64; r++) {
+			unsigned int p = r * rlen;
+
+			for (q = 0; q < len; q++, p++)
+				buf[KDF_POS(p, x)] = key[q];
+			for (q = 0; q < 8; q++, p++)
+				buf[KDF_POS(p, x)] = saved_salt[q];
+		}
+	}
+	/* Counter bytes of each record, lane 0; other lanes add lane[x] */
+	for (r = 0; r < 64; r++)
+		ctr[r] = KDF_POS(r * rlen + len + 8, 0);
+
+	for (x = 0; x < NBKEYS; x++) {
+		state[GETOUTPOS(0, x)] = 0x67452301;
+		state[GETOUTPOS(1, x)] = 0xefcdab89;
+		state[GETOUTPOS(2, x)] = 0x98badcfe;
+		state[GETOUTPOS(3, x)] = 0x10325476;
+		state[GETOUTPOS(4, x)] = 0xc3d2e1f0;
+	}
+
+	for (i = 0; i < ROUNDS; i += 64) {
+		/* Byte 0 changes every chunk, bytes 1 and 2 every 4th */
+		for (r = 0; r < 64; r++) {
+			unsigned char *p = &buf[ctr[r]];
+
+			for (x = 0; x < NBKEYS; x++)
+				p[lane[x]] = (unsigned char)(i + r);
+			if (i & 0xff)
+				continue;
+			for (x = 0; x < NBKEYS; x++) {
+				buf[KDF_POS(r * rlen + len + 9, x)] =
+					(unsigned char)(i >> 8);
+				buf[KDF_POS(r * rlen + len + 10, x)] =
+					(unsigned char)(i >> 16);
+			}
+		}
+		for (b = 0; b < rlen; b++) {
+			/*
+			 * The IV byte is the last one of the digest of all
+			 * records up to and including number i, which is the
+			 * first one of this chunk.  Finish a copy of the state
+			 * once that many blocks are done.
+			 */
+			if (!(i % (ROUNDS / 16)) && b == rlen >> 6) {
+				unsigned int t = rlen & 63, npad = t < 56 ? 1 : 2;
+				unsigned int bits = (i + 1) * rlen * 8;
+
+				memcpy(pad, &buf[b * KDF_BLOCK_SIZE], KDF_BLOCK_SIZE);
+				memset(&pad[KDF_BLOCK_SIZE], 0, KDF_BLOCK_SIZE);
+				for (x = 0; x < NBKEYS; x++) {
+					for (q = t; q < 64; q++)
+						pad[GETPOS(q, x)] = 0;
+					pad[GETPOS(t, x)] = 0x80;
+					((ARCH_WORD_32*)&pad[(npad - 1) * KDF_BLOCK_SIZE])
+						[GETPOS(60, x) >> 2] = bits;
+				}
+				SSESHA1body((__m128i*)pad, tmp, state,
+				            SSEi_MIXED_IN|SSEi_RELOAD);
+				if (npad == 2)
+					SSESHA1body((__m128i*)&pad[KDF_BLOCK_SIZE],
+					            tmp, tmp,
+					            SSEi_MIXED_IN|SSEi_RELOAD);
+				for (x = 0; x < n; x++)
+					aes_iv[idx[x] * 16 + i / (ROUNDS / 16)] =
+						tmp[GETOUTPOS(4, x)];
+			}
+			SSESHA1body((__m128i*)&buf[b * KDF_BLOCK_SIZE], state,
+			            state, SSEi_MIXED_IN|SSEi_RELOAD);
+		}
+	}
+
+	/* ROUNDS * rlen is a whole number of blocks: one more for padding */
+	memset(pad, 0, KDF_BLOCK_SIZE);
+	for (x = 0; x < NBKEYS; x++) {
+		pad[GETPOS(0, x)] = 0x80;
+		((ARCH_WORD_32*)pad)[GETPOS(60, x) >> 2] = ROUNDS * rlen * 8;
+	}
+	SSESHA1body((__m128i*)pad, state, state, SSEi_MIXED_IN|SSEi_RELOAD);
+
+	/* The key is the first 16 digest bytes, byte order reversed per word */
+	for (x = 0; x < n; x++)
+	for (i = 0; i < 4; i++) {
+		ARCH_WORD_32 w = state[GETOUTPOS(i, x)];
+
+		memcpy(&aes_key[idx[x] * 16 + 4 * i], &w, 4);
+	}
+#undef KDF_POS
+}
+#endif
+
+#ifdef RAR_REJECT_STATS
+static void done(void)
+{
+	fprintf(stderr, "RAR rejects: header %llu, unpack %llu, crc %llu\n",
+	        rejected.header, rejected.unpack, rejected.crc);
+}
+#endif
+
 static int crypt_all(int *pcount, struct db_salt *salt)
 {
 	int count = *pcount;
 	int index = 0;
 
+#ifdef MMX_COEF
+	{
+		unsigned int start[UNICODE_LENGTH + 2] = { 0 };
+		int ngroups = 0, g;
+
+		/* All lanes of a kernel call need the same length */
+		for (index = 0; index < count; index++)
+			start[saved_len[index] + 1]++;
+		for (index = 1; index <= UNICODE_LENGTH; index++)
+			start[index] += start[index - 1];
+		for (index = 0; index < count; index++)
+			kdf_order[start[saved_len[index]]++] = index;
+
+		for (index = 0; index < count; ) {
+			int len = saved_len[kdf_order[index]];
+			int end = MIN(count, index + NBKEYS);
+
+			kdf_group[ngroups++] = index;
+			while (index < end && saved_len[kdf_order[index]] == len)
+				index++;
+		}
+		kdf_group[ngroups] = count;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (g = 0; g < ngroups; g++) {
+#ifdef _OPENMP
+			int t = omp_get_thread_num();
+#else
+			int t = 0;
+#endif
+			rar_kdf_simd(&kdf_order[kdf_group[g]],
+			             kdf_group[g + 1] - kdf_group[g],
+			             &kdf_buf[t * KDF_BUF_SIZE]);
+		}
+	}
+#else
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
@@ -701,6 +900,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 			digest[i] = JOHNSWAP(digest[i]);
 		memcpy(&aes_key[i16], (unsigned char*)digest, 16);
 	}
+#endif
 
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -726,6 +926,8 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 			EVP_DecryptFinal_ex(&aes_ctx, &plain[outlen], &outlen);
 
 			cracked[index] = !memcmp(plain, "\xc4\x3d\x7b\x00\x40\x07\x00", 7);
+			if (!cracked[index])
+				REJECTED(header);
 
 		} else {
 
@@ -757,6 +959,8 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 
 				/* Compare computed CRC with stored CRC */
 				cracked[index] = !memcmp(crc_out, &cur_file->crc.c, 4);
+				if (!cracked[index])
+					REJECTED(crc);
 			} else {
 				const int solid = 0;
 				unpack_data_t *unpack_t;
@@ -774,13 +978,17 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 				if (plain[0] & 0x80) {
 					// PPM checks here.
 					if (!(plain[0] & 0x20) ||  // Reset bit must be set
-					    (plain[1] & 0x80))     // MaxMB must be < 128
+					    (plain[1] & 0x80)) {   // MaxMB must be < 128
+						REJECTED(header);
 						goto bailOut;
+					}
 				} else {
 					// LZ checks here.
 					if ((plain[0] & 0x40) ||   // KeepOldTable can't be set
-					    !check_huffman(plain)) // Huffman table check
+					    !check_huffman(plain)) { // Huffman table check
+						REJECTED(header);
 						goto bailOut;
+					}
 				}
 #endif
 				/* Reset stuff for full check */
@@ -798,8 +1006,10 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 				unpack_t->ctx = &aes_ctx;
 				unpack_t->key = &aes_key[i16];
 
-				if (rar_unpack29(cur_file->blob, solid, unpack_t))
-					cracked[index] = !memcmp(&unpack_t->unp_crc, &cur_file->crc.c, 4);
+				if (!rar_unpack29(cur_file->blob, solid, unpack_t))
+					REJECTED(unpack);
+				else if (!(cracked[index] = !memcmp(&unpack_t->unp_crc, &cur_file->crc.c, 4)))
+					REJECTED(crc);
 bailOut:;
 			}
 		}
@@ -850,7 +1060,11 @@ struct fmt_main fmt_rar = {
 		cpu_tests
 	},{
 		init,
+#ifdef RAR_REJECT_STATS
+		done,
+#else
 		fmt_default_done,
+#endif
 		fmt_default_reset,
 		fmt_default_prepare,
 		valid,
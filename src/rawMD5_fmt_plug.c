@@ -42,7 +42,14 @@ john_register_one(&fmt_rawMD5);
 
 #ifdef MMX_COEF
 #  define NBKEYS				(MMX_COEF * MD5_SSE_PARA)
-#  define DO_MMX_MD5(in, out)	SSEmd5body(in, (unsigned int*)out, NULL, SSEi_MIXED_IN)
+/* The prebuilt icc kernels (USING_ICC_S_FILE) know no SSEi_REVERSE_STEPS */
+#  ifndef USING_ICC_S_FILE
+#    define REVERSE_STEPS
+#    define MMX_FLAGS				(SSEi_MIXED_IN|SSEi_REVERSE_STEPS)
+#  else
+#    define MMX_FLAGS				SSEi_MIXED_IN
+#  endif
+#  define DO_MMX_MD5(in, out)	SSEmd5body(in, (unsigned int*)out, NULL, MMX_FLAGS)
 #endif
 
 #define BENCHMARK_COMMENT		""
@@ -82,7 +89,7 @@ static struct fmt_tests tests[] = {
 #define PLAINTEXT_LENGTH		55
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*MD5_BUF_SIZ*4*MMX_COEF )
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index/MMX_COEF)*MD5_BUF_SIZ*4*MMX_COEF )
 #else
 #define PLAINTEXT_LENGTH		125
 #define MIN_KEYS_PER_CRYPT		1
@@ -160,6 +167,13 @@ static void *binary(char *ciphertext)
 		    atoi16[ARCH_INDEX(p[1])];
 		p += 2;
 	}
+#ifdef REVERSE_STEPS
+	/* The kernel stops short of the final add (SSEi_REVERSE_STEPS) */
+	((ARCH_WORD_32*)out)[0] -= 0x67452301;
+	((ARCH_WORD_32*)out)[1] -= 0xefcdab89;
+	((ARCH_WORD_32*)out)[2] -= 0x98badcfe;
+	((ARCH_WORD_32*)out)[3] -= 0x10325476;
+#endif
 
 	return out;
 }
@@ -187,7 +201,7 @@ static int get_hash_6(int index) { return crypt_key[index][0] & 0x7ffffff; }
 static void set_key(char *_key, int index)
 {
 	const ARCH_WORD_32 *key = (ARCH_WORD_32*)_key;
-	ARCH_WORD_32 *keybuffer = &((ARCH_WORD_32*)saved_key)[(index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*MD5_BUF_SIZ*MMX_COEF];
+	ARCH_WORD_32 *keybuffer = &((ARCH_WORD_32*)saved_key)[(index&(MMX_COEF-1)) + (index/MMX_COEF)*MD5_BUF_SIZ*MMX_COEF];
 	ARCH_WORD_32 *keybuf_word = keybuffer;
 	unsigned int len;
 	ARCH_WORD_32 temp;
@@ -248,7 +262,7 @@ static char *get_key(int index)
 {
 	static char out[PLAINTEXT_LENGTH + 1];
 	unsigned int i;
-	ARCH_WORD_32 len = ((ARCH_WORD_32*)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*MD5_BUF_SIZ*MMX_COEF] >> 3;
+	ARCH_WORD_32 len = ((ARCH_WORD_32*)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*MD5_BUF_SIZ*MMX_COEF] >> 3;
 
 	for(i=0;i<len;i++)
 		out[i] = ((char*)saved_key)[GETPOS(i, index)];
@@ -291,7 +305,7 @@ static int cmp_all(void *binary, int count) {
 	int index;
 	for (index = 0; index < count; index++)
 #ifdef MMX_COEF
-        if (((ARCH_WORD_32 *) binary)[0] == ((ARCH_WORD_32*)crypt_key)[(index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*4*MMX_COEF])
+        if (((ARCH_WORD_32 *) binary)[0] == ((ARCH_WORD_32*)crypt_key)[(index&(MMX_COEF-1)) + (index/MMX_COEF)*4*MMX_COEF])
 #else
 		if ( ((ARCH_WORD_32*)binary)[0] == crypt_key[index][0] )
 #endif
@@ -301,11 +315,38 @@ static int cmp_all(void *binary, int count) {
 
 static int cmp_one(void *binary, int index)
 {
-#ifdef MMX_COEF
-    int i;
+#ifdef REVERSE_STEPS
+	ARCH_WORD_32 *t = (ARCH_WORD_32*)binary;
+	ARCH_WORD_32 *key = (ARCH_WORD_32*)&((char*)saved_key)[GETPOS(0, index)];
+	ARCH_WORD_32 *state = &((ARCH_WORD_32*)crypt_key)[(index&(MMX_COEF-1)) + (index/MMX_COEF)*4*MMX_COEF];
+	ARCH_WORD_32 a, b, c, d;
+
+	a = state[0];
+	b = state[MMX_COEF];
+	c = state[2*MMX_COEF];
+	d = state[3*MMX_COEF];
+	if (a != t[0])
+		return 0;
+
+	/* The three steps SSEi_REVERSE_STEPS left out */
+	d += (b ^ (a | ~c)) + key[11*MMX_COEF] + 0xbd3af235;
+	d = ((d << 10) | (d >> 22)) + a;
+	if (d != t[3])
+		return 0;
+
+	c += (a ^ (d | ~b)) + key[2*MMX_COEF] + 0x2ad7d2bb;
+	c = ((c << 15) | (c >> 17)) + d;
+	if (c != t[2])
+		return 0;
+
+	b += (d ^ (c | ~a)) + key[9*MMX_COEF] + 0xeb86d391;
+	b = ((b << 21) | (b >> 11)) + c;
+	return b == t[1];
+#elif defined(MMX_COEF)
+	int i;
 	for (i = 0; i < BINARY_SIZE/sizeof(ARCH_WORD_32); i++)
-        if (((ARCH_WORD_32 *) binary)[i] != ((ARCH_WORD_32*)crypt_key)[(index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*4*MMX_COEF+i*MMX_COEF])
-            return 0;
+		if (((ARCH_WORD_32 *) binary)[i] != ((ARCH_WORD_32*)crypt_key)[(index&(MMX_COEF-1)) + (index/MMX_COEF)*4*MMX_COEF+i*MMX_COEF])
+			return 0;
 	return 1;
 #else
 	return !memcmp(binary, crypt_key[index], BINARY_SIZE);
@@ -320,6 +361,7 @@ static int cmp_exact(char *source, int index)
 static char *source(char *source, void *binary)
 {
 	static char Buf[CIPHERTEXT_LENGTH + TAG_LENGTH + 1];
+	ARCH_WORD_32 out[DIGEST_SIZE / 4];
 	unsigned char *cpi;
 	char *cpo;
 	int i;
@@ -327,7 +369,14 @@ static char *source(char *source, void *binary)
 	strcpy(Buf, FORMAT_TAG);
 	cpo = &Buf[TAG_LENGTH];
 
-	cpi = (unsigned char*)(binary);
+	memcpy(out, binary, DIGEST_SIZE);
+#ifdef REVERSE_STEPS
+	out[0] += 0x67452301;
+	out[1] += 0xefcdab89;
+	out[2] += 0x98badcfe;
+	out[3] += 0x10325476;
+#endif
+	cpi = (unsigned char*)out;
 
 	for (i = 0; i < BINARY_SIZE; ++i) {
 		*cpo++ = itoa16[(*cpi)>>4];
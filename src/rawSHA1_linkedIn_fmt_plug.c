@@ -61,7 +61,7 @@ john_register_one(&fmt_rawSHA1_LI);
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS
 // this version works properly for MMX, SSE2 (.S) and SSE2 intrinsic.
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
 #else
 #define MIN_KEYS_PER_CRYPT		1
 #define MAX_KEYS_PER_CRYPT		1
@@ -88,6 +88,19 @@ static struct fmt_tests tests[] = {
 	//{"00000c1163897ac86e393fa16d6ae2c2fce21602", "7850"},
 	{"dd3fbb0ba9e133c4fd84ed31ac2e5bc597d61774", "7858"},
 	//{"00000b0ba9e133c4fd84ed31ac2e5bc597d61774", "7858"},
+	// source() rebuilds the first limb from crypt_key, so keep at least
+	// one more distinct test than the widest SIMD batch, otherwise the
+	// self test sees its own earlier crack and reports a source error.
+	{"7728240c80b6bfd450849405e8500d6d207783b6", "linkedin"},
+	{"e38ad214943daad1d64c102faec29de4afe9da3d", "password1"},
+	{"7c4a8d09ca3762af61e59520943dc26494f8941b", "123456"},
+	{"2f77a250b04e7c390270402fb42033102b28b071", "qwerty12"},
+	{"b7a875fc1ea228b9061041b7cec4bd3c52ab3ce3", "letmein"},
+	{"61cf29abf0fbc61c35927a723cb9f715b3d0d393", "monkey99"},
+	{"af8978b1797b72acfff9595a5a2a373ec3d9106d", "dragon"},
+	{"73ab3511512653f609284c27d9ee47052897c772", "sunshine7"},
+	{"e90196f9b2fccd9c137f64b2b5dab3a63f80137d", "shadow11"},
+	{"e68e11be8b70e435c65aef8ba9798ff7775c361e", "trustno1"},
 	{NULL}
 };
 
@@ -95,8 +108,8 @@ static struct fmt_tests tests[] = {
 #define saved_key rawSHA1_saved_key_LI
 #define crypt_key rawSHA1_crypt_key_LI
 #ifdef MMX_COEF
-JTR_ALIGN(16) ARCH_WORD_32 saved_key[SHA_BUF_SIZ*NBKEYS];
-JTR_ALIGN(16) ARCH_WORD_32 crypt_key[BINARY_SIZE/4*NBKEYS];
+JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 saved_key[SHA_BUF_SIZ*NBKEYS];
+JTR_ALIGN(MEM_ALIGN_SIMD) ARCH_WORD_32 crypt_key[BINARY_SIZE/4*NBKEYS];
 static unsigned char out[PLAINTEXT_LENGTH + 1];
 #else
 static char saved_key[PLAINTEXT_LENGTH + 1];
@@ -147,7 +160,7 @@ static char *split(char *ciphertext, int index, struct fmt_main *self)
 static void set_key(char *key, int index) {
 #ifdef MMX_COEF
 	const ARCH_WORD_32 *wkey = (ARCH_WORD_32*)key;
-	ARCH_WORD_32 *keybuffer = &saved_key[(index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF];
+	ARCH_WORD_32 *keybuffer = &saved_key[(index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF];
 	ARCH_WORD_32 *keybuf_word = keybuffer;
 	unsigned int len;
 	ARCH_WORD_32 temp;
@@ -194,7 +207,7 @@ static char *get_key(int index) {
 #ifdef MMX_COEF
 	unsigned int i,s;
 
-	s = saved_key[15*MMX_COEF + (index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF] >> 3;
+	s = saved_key[15*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] >> 3;
 	for(i=0;i<s;i++)
 		out[i] = ((unsigned char*)saved_key)[ GETPOS(i, index) ];
 	out[i] = 0;
@@ -229,8 +242,8 @@ static int cmp_one(void * binary, int index)
 {
 #ifdef MMX_COEF
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 
 //	if( ((ARCH_WORD_32*)binary)[0] != crypt_key[x+y*MMX_COEF*5] )
 //		return 0;
@@ -300,7 +313,7 @@ static int binary_hash_5(void * binary) { return ((ARCH_WORD_32*)binary)[1] & 0x
 static int binary_hash_6(void * binary) { return ((ARCH_WORD_32*)binary)[1] & 0x7ffffff; }
 
 #ifdef MMX_COEF
-#define INDEX	((index&3)+(index>>2)*MMX_COEF*5)
+#define INDEX	((index&(MMX_COEF-1))+(index/MMX_COEF)*MMX_COEF*5)
 static int get_hash_0(int index) { return ((ARCH_WORD_32*)crypt_key)[INDEX+MMX_COEF] & 0xf; }
 static int get_hash_1(int index) { return ((ARCH_WORD_32*)crypt_key)[INDEX+MMX_COEF] & 0xff; }
 static int get_hash_2(int index) { return ((ARCH_WORD_32*)crypt_key)[INDEX+MMX_COEF] & 0xfff; }
@@ -329,12 +342,12 @@ static char *source(char *source, void *binary)
 
 #ifdef MMX_COEF
 	for (i = 0; i < NBKEYS; ++i) {
-		if (crypt_key[(i/MMX_COEF)*20+MMX_COEF+(i%MMX_COEF)] == ((ARCH_WORD_32*)binary)[1]) {
+		if (crypt_key[(i/MMX_COEF)*5*MMX_COEF+MMX_COEF+(i%MMX_COEF)] == ((ARCH_WORD_32*)binary)[1]) {
 			// Ok, we may have found it.  Check the next 3 DWORDS
-			if (crypt_key[(i/MMX_COEF)*20+MMX_COEF*2+(i%MMX_COEF)] == ((ARCH_WORD_32*)binary)[2] &&
-			    crypt_key[(i/MMX_COEF)*20+MMX_COEF*3+(i%MMX_COEF)] == ((ARCH_WORD_32*)binary)[3] &&
-			    crypt_key[(i/MMX_COEF)*20+MMX_COEF*4+(i%MMX_COEF)] == ((ARCH_WORD_32*)binary)[4]) {
-				((ARCH_WORD_32*)binary)[0] = crypt_key[(i/MMX_COEF)*20+(i%MMX_COEF)];
+			if (crypt_key[(i/MMX_COEF)*5*MMX_COEF+MMX_COEF*2+(i%MMX_COEF)] == ((ARCH_WORD_32*)binary)[2] &&
+			    crypt_key[(i/MMX_COEF)*5*MMX_COEF+MMX_COEF*3+(i%MMX_COEF)] == ((ARCH_WORD_32*)binary)[3] &&
+			    crypt_key[(i/MMX_COEF)*5*MMX_COEF+MMX_COEF*4+(i%MMX_COEF)] == ((ARCH_WORD_32*)binary)[4]) {
+				((ARCH_WORD_32*)binary)[0] = crypt_key[(i/MMX_COEF)*5*MMX_COEF+(i%MMX_COEF)];
 				break;
 			}
 		}
@@ -112,7 +112,7 @@ static struct fmt_tests tests[] = {
 };
 
 #ifdef MMX_COEF_SHA256
-#define GETPOS(i, index)        ( (index&(MMX_COEF_SHA256-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF_SHA256 + (3-((i)&3)) + (index>>(MMX_COEF_SHA256>>1))*SHA256_BUF_SIZ*MMX_COEF_SHA256*4 )
+#define GETPOS(i, index)        ( (index&(MMX_COEF_SHA256-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF_SHA256 + (3-((i)&3)) + (index/MMX_COEF_SHA256)*SHA256_BUF_SIZ*MMX_COEF_SHA256*4 )
 static uint32_t (*saved_key)[SHA256_BUF_SIZ*MMX_COEF_SHA256];
 static uint32_t (*crypt_out)[8*MMX_COEF_SHA256];
 #else
@@ -162,13 +162,13 @@ static void *binary(char *ciphertext)
 }
 
 #ifdef MMX_COEF_SHA256
-static int get_hash_0 (int index) { return crypt_out[index>>(MMX_COEF_SHA256>>1)][index&(MMX_COEF_SHA256-1)] & 0xf; }
-static int get_hash_1 (int index) { return crypt_out[index>>(MMX_COEF_SHA256>>1)][index&(MMX_COEF_SHA256-1)] & 0xff; }
-static int get_hash_2 (int index) { return crypt_out[index>>(MMX_COEF_SHA256>>1)][index&(MMX_COEF_SHA256-1)] & 0xfff; }
-static int get_hash_3 (int index) { return crypt_out[index>>(MMX_COEF_SHA256>>1)][index&(MMX_COEF_SHA256-1)] & 0xffff; }
-static int get_hash_4 (int index) { return crypt_out[index>>(MMX_COEF_SHA256>>1)][index&(MMX_COEF_SHA256-1)] & 0xfffff; }
-static int get_hash_5 (int index) { return crypt_out[index>>(MMX_COEF_SHA256>>1)][index&(MMX_COEF_SHA256-1)] & 0xffffff; }
-static int get_hash_6 (int index) { return crypt_out[index>>(MMX_COEF_SHA256>>1)][index&(MMX_COEF_SHA256-1)] & 0x7ffffff; }
+static int get_hash_0 (int index) { return crypt_out[index/MMX_COEF_SHA256][index&(MMX_COEF_SHA256-1)] & 0xf; }
+static int get_hash_1 (int index) { return crypt_out[index/MMX_COEF_SHA256][index&(MMX_COEF_SHA256-1)] & 0xff; }
+static int get_hash_2 (int index) { return crypt_out[index/MMX_COEF_SHA256][index&(MMX_COEF_SHA256-1)] & 0xfff; }
+static int get_hash_3 (int index) { return crypt_out[index/MMX_COEF_SHA256][index&(MMX_COEF_SHA256-1)] & 0xffff; }
+static int get_hash_4 (int index) { return crypt_out[index/MMX_COEF_SHA256][index&(MMX_COEF_SHA256-1)] & 0xfffff; }
+static int get_hash_5 (int index) { return crypt_out[index/MMX_COEF_SHA256][index&(MMX_COEF_SHA256-1)] & 0xffffff; }
+static int get_hash_6 (int index) { return crypt_out[index/MMX_COEF_SHA256][index&(MMX_COEF_SHA256-1)] & 0x7ffffff; }
 #else
 static int get_hash_0(int index) { return crypt_out[index][0] & 0xf; }
 static int get_hash_1(int index) { return crypt_out[index][0] & 0xff; }
@@ -182,7 +182,7 @@ static int get_hash_6(int index) { return crypt_out[index][0] & 0x7ffffff; }
 #ifdef MMX_COEF_SHA256
 static void set_key(char *key, int index) {
 	const ARCH_WORD_32 *wkey = (ARCH_WORD_32*)key;
-	ARCH_WORD_32 *keybuffer = &((ARCH_WORD_32 *)saved_key)[(index&(MMX_COEF_SHA256-1)) + (index>>(MMX_COEF_SHA256>>1))*SHA256_BUF_SIZ*MMX_COEF_SHA256];
+	ARCH_WORD_32 *keybuffer = &((ARCH_WORD_32 *)saved_key)[(index&(MMX_COEF_SHA256-1)) + (index/MMX_COEF_SHA256)*SHA256_BUF_SIZ*MMX_COEF_SHA256];
 	ARCH_WORD_32 *keybuf_word = keybuffer;
 	unsigned int len;
 	ARCH_WORD_32 temp;
@@ -238,7 +238,7 @@ static char *get_key(int index) {
 	static char out[PLAINTEXT_LENGTH+1];
 	unsigned char *wucp = (unsigned char*)saved_key;
 
-	s = ((ARCH_WORD_32 *)saved_key)[15*MMX_COEF_SHA256 + (index&(MMX_COEF_SHA256-1)) + (index>>(MMX_COEF_SHA256>>1))*SHA256_BUF_SIZ*MMX_COEF_SHA256] >> 3;
+	s = ((ARCH_WORD_32 *)saved_key)[15*MMX_COEF_SHA256 + (index&(MMX_COEF_SHA256-1)) + (index/MMX_COEF_SHA256)*SHA256_BUF_SIZ*MMX_COEF_SHA256] >> 3;
 	for(i=0;i<s;i++)
 		out[i] = wucp[ GETPOS(i, index) ];
 	out[i] = 0;
@@ -286,7 +286,7 @@ static int cmp_all(void *binary, int count)
 
 	for (index = 0; index < count; index++)
 #ifdef MMX_COEF_SHA256
-		if (((uint32_t *) binary)[0] == crypt_out[index>>(MMX_COEF_SHA256>>1)][index&(MMX_COEF_SHA256-1)])
+		if (((uint32_t *) binary)[0] == crypt_out[index/MMX_COEF_SHA256][index&(MMX_COEF_SHA256-1)])
 #else
 		if ( ((ARCH_WORD_32*)binary)[0] == crypt_out[index][0] )
 #endif
@@ -299,7 +299,7 @@ static int cmp_one(void *binary, int index)
 #ifdef MMX_COEF_SHA256
 	int i;
 	for (i = 0; i < BINARY_SIZE/4; i++)
-		if (((uint32_t *) binary)[i] != crypt_out[index>>(MMX_COEF_SHA256>>1)][(index&(MMX_COEF_SHA256-1))+i*MMX_COEF_SHA256])
+		if (((uint32_t *) binary)[i] != crypt_out[index/MMX_COEF_SHA256][(index&(MMX_COEF_SHA256-1))+i*MMX_COEF_SHA256])
 			return 0;
 	return 1;
 #else
@@ -82,7 +82,7 @@ static struct fmt_tests tests[] = {
 };
 
 #ifdef MMX_COEF_SHA512
-#define GETPOS(i, index)        ( (index&(MMX_COEF_SHA512-1))*8 + ((i)&(0xffffffff-7))*MMX_COEF_SHA512 + (7-((i)&7)) + (index>>(MMX_COEF_SHA512>>1))*SHA512_BUF_SIZ*MMX_COEF_SHA512*8 )
+#define GETPOS(i, index)        ( (index&(MMX_COEF_SHA512-1))*8 + ((i)&(0xffffffff-7))*MMX_COEF_SHA512 + (7-((i)&7)) + (index/MMX_COEF_SHA512)*SHA512_BUF_SIZ*MMX_COEF_SHA512*8 )
 static ARCH_WORD_64 (*saved_key)[SHA512_BUF_SIZ*MMX_COEF_SHA512];
 static ARCH_WORD_64 (*crypt_out)[8*MMX_COEF_SHA512];
 #else
@@ -159,13 +159,13 @@ static void *binary(char *ciphertext)
 }
 
 #ifdef MMX_COEF_SHA512
-static int get_hash_0 (int index) { return crypt_out[index>>(MMX_COEF_SHA512>>1)][index&(MMX_COEF_SHA512-1)] & 0xf; }
-static int get_hash_1 (int index) { return crypt_out[index>>(MMX_COEF_SHA512>>1)][index&(MMX_COEF_SHA512-1)] & 0xff; }
-static int get_hash_2 (int index) { return crypt_out[index>>(MMX_COEF_SHA512>>1)][index&(MMX_COEF_SHA512-1)] & 0xfff; }
-static int get_hash_3 (int index) { return crypt_out[index>>(MMX_COEF_SHA512>>1)][index&(MMX_COEF_SHA512-1)] & 0xffff; }
-static int get_hash_4 (int index) { return crypt_out[index>>(MMX_COEF_SHA512>>1)][index&(MMX_COEF_SHA512-1)] & 0xfffff; }
-static int get_hash_5 (int index) { return crypt_out[index>>(MMX_COEF_SHA512>>1)][index&(MMX_COEF_SHA512-1)] & 0xffffff; }
-static int get_hash_6 (int index) { return crypt_out[index>>(MMX_COEF_SHA512>>1)][index&(MMX_COEF_SHA512-1)] & 0x7ffffff; }
+static int get_hash_0 (int index) { return crypt_out[index/MMX_COEF_SHA512][index&(MMX_COEF_SHA512-1)] & 0xf; }
+static int get_hash_1 (int index) { return crypt_out[index/MMX_COEF_SHA512][index&(MMX_COEF_SHA512-1)] & 0xff; }
+static int get_hash_2 (int index) { return crypt_out[index/MMX_COEF_SHA512][index&(MMX_COEF_SHA512-1)] & 0xfff; }
+static int get_hash_3 (int index) { return crypt_out[index/MMX_COEF_SHA512][index&(MMX_COEF_SHA512-1)] & 0xffff; }
+static int get_hash_4 (int index) { return crypt_out[index/MMX_COEF_SHA512][index&(MMX_COEF_SHA512-1)] & 0xfffff; }
+static int get_hash_5 (int index) { return crypt_out[index/MMX_COEF_SHA512][index&(MMX_COEF_SHA512-1)] & 0xffffff; }
+static int get_hash_6 (int index) { return crypt_out[index/MMX_COEF_SHA512][index&(MMX_COEF_SHA512-1)] & 0x7ffffff; }
 #else
 static int get_hash_0(int index) { return crypt_out[index][0] & 0xf; }
 static int get_hash_1(int index) { return crypt_out[index][0] & 0xff; }
@@ -179,7 +179,7 @@ static int get_hash_6(int index) { return crypt_out[index][0] & 0x7ffffff; }
 #ifdef MMX_COEF_SHA512
 static void set_key(char *key, int index) {
 	const ARCH_WORD_64 *wkey = (ARCH_WORD_64*)key;
-	ARCH_WORD_64 *keybuffer = &((ARCH_WORD_64 *)saved_key)[(index&(MMX_COEF_SHA512-1)) + (index>>(MMX_COEF_SHA512>>1))*SHA512_BUF_SIZ*MMX_COEF_SHA512];
+	ARCH_WORD_64 *keybuffer = &((ARCH_WORD_64 *)saved_key)[(index&(MMX_COEF_SHA512-1)) + (index/MMX_COEF_SHA512)*SHA512_BUF_SIZ*MMX_COEF_SHA512];
 	ARCH_WORD_64 *keybuf_word = keybuffer;
 	unsigned int len;
 	ARCH_WORD_64 temp;
@@ -258,7 +258,7 @@ static char *get_key(int index) {
 	static char out[PLAINTEXT_LENGTH + 1];
 	char *wucp = (char*)saved_key;
 
-	s = ((ARCH_WORD_64 *)saved_key)[15*MMX_COEF_SHA512 + (index&(MMX_COEF_SHA512-1)) + (index>>(MMX_COEF_SHA512>>1))*SHA512_BUF_SIZ*MMX_COEF_SHA512] >> 3;
+	s = ((ARCH_WORD_64 *)saved_key)[15*MMX_COEF_SHA512 + (index&(MMX_COEF_SHA512-1)) + (index/MMX_COEF_SHA512)*SHA512_BUF_SIZ*MMX_COEF_SHA512] >> 3;
 	for(i=0;i<(unsigned)s;i++)
 		out[i] = wucp[ GETPOS(i, index) ];
 	out[i] = 0;
@@ -305,7 +305,7 @@ static int cmp_all(void *binary, int count)
 	int index;
 	for (index = 0; index < count; index++)
 #ifdef MMX_COEF_SHA512
-        if (((ARCH_WORD_64 *) binary)[0] == crypt_out[index>>(MMX_COEF_SHA512>>1)][index&(MMX_COEF_SHA512-1)])
+        if (((ARCH_WORD_64 *) binary)[0] == crypt_out[index/MMX_COEF_SHA512][index&(MMX_COEF_SHA512-1)])
 #else
 		if ( ((ARCH_WORD_32*)binary)[0] == crypt_out[index][0] )
 #endif
@@ -318,7 +318,7 @@ static int cmp_one(void *binary, int index)
 #ifdef MMX_COEF_SHA512
     int i;
 	for (i = 0; i < BINARY_SIZE/sizeof(ARCH_WORD_64); i++)
-        if (((ARCH_WORD_64 *) binary)[i] != crypt_out[index>>(MMX_COEF_SHA512>>1)][(index&(MMX_COEF_SHA512-1))+i*MMX_COEF_SHA512])
+        if (((ARCH_WORD_64 *) binary)[i] != crypt_out[index/MMX_COEF_SHA512][(index&(MMX_COEF_SHA512-1))+i*MMX_COEF_SHA512])
             return 0;
 	return 1;
 #else
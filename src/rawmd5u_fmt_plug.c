@@ -52,7 +52,7 @@ john_register_one(&fmt_rawmd5uthick);
 #define PLAINTEXT_LENGTH		27
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS * BLOCK_LOOPS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*16*MMX_COEF*4 )
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index/MMX_COEF)*16*MMX_COEF*4 )
 #else
 #define PLAINTEXT_LENGTH		125
 #define MIN_KEYS_PER_CRYPT		1
@@ -237,7 +237,7 @@ key_cleaning:
 		keybuf_word += MMX_COEF;
 	}
 
-	((unsigned int *)saved_key)[14*MMX_COEF + (index&3) + (index>>2)*16*MMX_COEF] = len << 4;
+	((unsigned int *)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*16*MMX_COEF] = len << 4;
 #else
 #if ARCH_LITTLE_ENDIAN
 	UTF8 *s = (UTF8*)_key;
@@ -294,7 +294,7 @@ key_cleaning_enc:
 		keybuf_word += MMX_COEF;
 	}
 
-	((unsigned int *)saved_key)[14*MMX_COEF + (index&3) + (index>>2)*16*MMX_COEF] = len << 4;
+	((unsigned int *)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*16*MMX_COEF] = len << 4;
 #else
 	saved_key_length = enc_to_utf16((UTF16*)&saved_key,
 	                                PLAINTEXT_LENGTH + 1,
@@ -421,7 +421,7 @@ bailout:
 		keybuf_word += MMX_COEF;
 	}
 
-	((unsigned int *)saved_key)[14*MMX_COEF + (index&3) + (index>>2)*16*MMX_COEF] = len << 4;
+	((unsigned int *)saved_key)[14*MMX_COEF + (index&(MMX_COEF-1)) + (index/MMX_COEF)*16*MMX_COEF] = len << 4;
 #else
 	saved_key_length = utf8_to_utf16((UTF16*)&saved_key,
 	                                 PLAINTEXT_LENGTH + 1,
@@ -485,8 +485,8 @@ static int cmp_one(void *binary, int index)
 {
 #ifdef MMX_COEF
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 
 	if( ((ARCH_WORD_32*)binary)[0] != ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] )
 		return 0;
@@ -531,50 +531,50 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 static int get_hash_0(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xf;
 }
 static int get_hash_1(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xff;
 }
 static int get_hash_2(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xfff;
 }
 static int get_hash_3(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xffff;
 }
 static int get_hash_4(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xfffff;
 }
 static int get_hash_5(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0xffffff;
 }
 static int get_hash_6(int index)
 {
 	unsigned int x,y;
-	x = index&3;
-	y = index/4;
+	x = index&(MMX_COEF-1);
+	y = index/MMX_COEF;
 	return ((ARCH_WORD_32*)crypt_key)[x+y*MMX_COEF*4] & 0x7ffffff;
 }
 #else
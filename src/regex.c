@@ -35,10 +35,213 @@
 
 char *rexgen_alphabets[256];
 
-static void fix_state(void) {}
-static double get_progress(void) { return -1; }
-static void save_state(FILE *file) {}
-static int restore_state(FILE *file) { return 0; }
+/*
+ * Number of candidates the rexgen iterator has produced so far, counting
+ * those skipped for other nodes. The iterator is deterministic, so this is
+ * all we need to resume a session (by fast-forwarding) and to distribute
+ * the candidates across nodes.
+ */
+static unsigned long long seq, rec_seq;
+
+/* Estimated number of candidates the regex expands to, 0 if unknown */
+static double keyspace;
+static double progress = -1;
+
+static void fix_state(void)
+{
+	rec_seq = seq;
+}
+
+static double get_progress(void)
+{
+	double pct;
+
+	emms();
+
+	if (progress >= 0 || !keyspace)
+		return progress;
+
+	pct = 100.0 * rec_seq / keyspace;
+	return pct > 100 ? 100 : pct;
+}
+
+static void save_state(FILE *file)
+{
+	fprintf(file, LLu"\n", rec_seq);
+}
+
+static int restore_state(FILE *file)
+{
+	if (fscanf(file, LLu"\n", &seq) != 1)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Rough keyspace estimate for the regex syntax rexgen supports: literals,
+ * escapes, character classes, groups with alternation and the ?, {n} and
+ * {n,m} quantifiers. Unbounded quantifiers (*, + and {n,}) make the
+ * keyspace unknown.
+ */
+static int ks_unbounded;
+
+static double ks_alt(const char **p);
+
+static double ks_class(const char **p)
+{
+	const unsigned char *c = (const unsigned char *)*p + 1;
+	int negate = 0, count = 0, prev = -1;
+
+	if (*c == '^') {
+		negate = 1;
+		c++;
+	}
+	if (*c == ']') {
+		count++;
+		prev = *c++;
+	}
+	while (*c && *c != ']') {
+		if (*c == '\\' && c[1]) {
+			c++;
+			count += *c == 'd' ? 10 : *c == 'w' ? 63 : 1;
+			prev = -1;
+			c++;
+		} else if (*c == '-' && prev >= 0 && c[1] && c[1] != ']') {
+			if (c[1] > prev)
+				count += c[1] - prev;
+			prev = -1;
+			c += 2;
+		} else {
+			if ((*c & 0xc0) != 0x80)
+				count++;
+			prev = *c++;
+		}
+	}
+	*p = (const char *)(*c ? c + 1 : c);
+
+	if (negate)
+		count = count < 95 ? 95 - count : 1;
+
+	return count ? count : 1;
+}
+
+static double ks_atom(const char **p)
+{
+	double n;
+
+	switch (**p) {
+	case '(':
+		(*p)++;
+		if (**p == '?' && (*p)[1] == ':')
+			*p += 2;
+		n = ks_alt(p);
+		if (**p == ')')
+			(*p)++;
+		return n;
+
+	case '[':
+		return ks_class(p);
+
+	case '\\':
+		(*p)++;
+		if (!**p)
+			return 1;
+		switch (*(*p)++) {
+		case 'd':
+			return 10;
+		case 'w':
+			return 63;
+		case 's':
+			return 6;
+		default:
+			return 1;
+		}
+
+	case '.':
+		(*p)++;
+		return 95;
+
+	default:
+/* One character, which may be several bytes of UTF-8 */
+		(*p)++;
+		while ((**p & 0xc0) == 0x80)
+			(*p)++;
+		return 1;
+	}
+}
+
+static double ks_seq(const char **p)
+{
+	double total = 1, n, sum, pow;
+	unsigned int min, max, i;
+	int len;
+
+	while (**p && **p != '|' && **p != ')') {
+		n = ks_atom(p);
+
+		switch (**p) {
+		case '?':
+			(*p)++;
+			n += 1;
+			break;
+
+		case '*':
+		case '+':
+			(*p)++;
+			ks_unbounded = 1;
+			break;
+
+		case '{':
+			if (sscanf(*p, "{%u,%u}%n", &min, &max, &len) == 2) {
+			} else if (sscanf(*p, "{%u}%n", &min, &len) == 1) {
+				max = min;
+			} else {
+				ks_unbounded = 1;
+				while (**p && *(*p)++ != '}')
+					;
+				break;
+			}
+			*p += len;
+			sum = 0;
+			pow = 1;
+			for (i = 0; i <= max; i++) {
+				if (i >= min)
+					sum += pow;
+				pow *= n;
+			}
+			n = sum;
+			break;
+		}
+
+		total *= n;
+	}
+
+	return total;
+}
+
+static double ks_alt(const char **p)
+{
+	double total = ks_seq(p);
+
+	while (**p == '|') {
+		(*p)++;
+		total += ks_seq(p);
+	}
+
+	return total;
+}
+
+static double regex_keyspace(const char *regex)
+{
+	const char *p = regex;
+	double n;
+
+	ks_unbounded = 0;
+	n = ks_alt(&p);
+
+	return ks_unbounded ? 0 : n;
+}
 
 static void rexgen_setlocale() {
 	const char* defaultLocale = "en_US.UTF8";
@@ -189,22 +392,71 @@ void do_regex_crack(struct db_main *db, const char *regex) {
 	int ignore_case = 0;
 	int randomize = 0;
 	const char* word;
+	unsigned long long skip;
+	int my_words, their_words;
 
-	if (john_main_process)
-		fprintf(stderr, "Warning: regex mode currently can't be "
-		        "resumed if aborted\n");
+	log_event("Proceeding with regex mode: %.100s", regex);
 
 	rexgen_setlocale();
+
+	seq = 0;
+	progress = -1;
+
 	status_init(&get_progress, 0);
 	rec_restore_mode(restore_state);
 	rec_init(db, save_state);
 	crk_init(db, fix_state, NULL);
+
+	if ((keyspace = regex_keyspace(regex)))
+		log_event("- Estimated keyspace: %.0f candidates", keyspace);
+	else
+		log_event("- Keyspace is unbounded, progress won't be reported");
+
 	iter = c_regex_iterator_cb(regex, ignore_case, encoding, randomize, callback);
 	if (!iter) {
 		fprintf(stderr, "Error, invalid regex expression.  John exiting now\n");
 		exit(1);
 	}
+
+/* Restored session: fast-forward the iterator to where we left off */
+	skip = rec_seq = seq;
+	seq = 0;
+	if (skip)
+		log_event("- Skipping "LLu" candidates", skip);
+	while (seq < skip && c_iterator_next(iter))
+		seq++;
+
+	my_words = options.node_max - options.node_min + 1;
+	their_words = options.node_min - 1;
+
+	if (seq && options.node_count) {
+/* seq is right after a word we've actually used */
+		int for_node = seq % options.node_count + 1;
+		if (for_node < options.node_min ||
+		        for_node > options.node_max) {
+/* We assume that seq is at the beginning of other nodes' block */
+			their_words = options.node_count - my_words;
+		} else {
+			my_words = options.node_max - for_node + 1;
+			their_words = 0;
+		}
+	}
+
 	while (c_iterator_next(iter)) {
+		seq++;
+
+		if (options.node_count) {
+			if (their_words) {
+				their_words--;
+				continue;
+			}
+			if (--my_words == 0) {
+				my_words =
+					options.node_max - options.node_min + 1;
+				their_words = options.node_count - my_words;
+			}
+		}
+
 		c_iterator_value(iter, buffer);
 		c_simplestring_terminate(buffer);
 		word = c_simplestring_bufferaddress(buffer);
@@ -216,6 +468,10 @@ void do_regex_crack(struct db_main *db, const char *regex) {
 	}
 	c_simplestring_delete(buffer);
 	c_iterator_delete(iter);
+
+	if (!event_abort)
+		progress = 100;
+
 	crk_done();
 	rec_done(event_abort);
 }
@@ -68,8 +68,8 @@ static unsigned int omp_t = 1;
 #ifdef MMX_COEF
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*16*MMX_COEF*4 )
-#define GETOUTPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index>>(MMX_COEF>>1))*16*MMX_COEF)
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index/MMX_COEF)*16*MMX_COEF*4 )
+#define GETOUTPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + (index/MMX_COEF)*16*MMX_COEF)
 #else
 #define MIN_KEYS_PER_CRYPT		1
 #define MAX_KEYS_PER_CRYPT		1
@@ -486,7 +486,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 					cur_salt->s[i];
 
 			saved_key[GETPOS((len + i), ti)] = 0x80;
-			((unsigned int *)saved_key)[14*MMX_COEF + (ti&3) + (ti>>2)*16*MMX_COEF] = (len + i) << 3;
+			((unsigned int *)saved_key)[14*MMX_COEF + (ti&(MMX_COEF-1)) + (ti/MMX_COEF)*16*MMX_COEF] = (len + i) << 3;
 
 			// Clean rest of buffer
 			for (i = i + len + 1; i <= clean_pos[ti]; i++)
@@ -520,7 +520,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 			for (i = 0;i <= sum20; i += 4, dw += MMX_COEF)
 				*dw = destArray[i >> 2];
 
-			((unsigned int *)interm_key)[14*MMX_COEF + (ti&3) + (ti>>2)*16*MMX_COEF] = sum20 << 3;
+			((unsigned int *)interm_key)[14*MMX_COEF + (ti&(MMX_COEF-1)) + (ti/MMX_COEF)*16*MMX_COEF] = sum20 << 3;
 		}
 
 		DO_MMX_MD5(&interm_key[t*NBKEYS*64], &crypt_key[t*NBKEYS*16]);
@@ -68,10 +68,10 @@ static unsigned int omp_t = 1;
 #ifdef MMX_COEF
 #define MIN_KEYS_PER_CRYPT		NBKEYS
 #define MAX_KEYS_PER_CRYPT		NBKEYS
-#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&60)*MMX_COEF + (3-((i)&3)) + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
-#define GETWORDPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&60)*MMX_COEF + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF*4 )
-#define GETSTARTPOS(index)		( (index&(MMX_COEF-1))*4 + (index>>(MMX_COEF>>1))*SHA_BUF_SIZ*MMX_COEF*4 )
-#define GETOUTPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index>>(MMX_COEF>>1))*20*MMX_COEF ) //for endianity conversion
+#define GETPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&60)*MMX_COEF + (3-((i)&3)) + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF*4 ) //for endianity conversion
+#define GETWORDPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&60)*MMX_COEF + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF*4 )
+#define GETSTARTPOS(index)		( (index&(MMX_COEF-1))*4 + (index/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF*4 )
+#define GETOUTPOS(i, index)		( (index&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + (3-((i)&3)) + (index/MMX_COEF)*20*MMX_COEF ) //for endianity conversion
 
 #else
 #define MIN_KEYS_PER_CRYPT		1
@@ -305,7 +305,7 @@ static int cmp_one(void *binary, int index)
 #ifdef MMX_COEF
 	unsigned int x,y;
 	x = index&(MMX_COEF-1);
-	y = index>>(MMX_COEF>>1);
+	y = index/MMX_COEF;
 
 	if( (((unsigned int*)binary)[0] != ((unsigned int*)crypt_key)[x+y*MMX_COEF*5])   |
 	    (((unsigned int*)binary)[1] != ((unsigned int*)crypt_key)[x+y*MMX_COEF*5+MMX_COEF]) |
@@ -395,8 +395,8 @@ static inline unsigned int extractOffsetToMagicArray(unsigned const char *pbHash
 static inline void crypt_done(unsigned const int *source, unsigned int *dest, int index)
 {
 	unsigned int i;
-	unsigned const int *s = &source[(index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*5*MMX_COEF];
-	unsigned int *d = &dest[(index&(MMX_COEF-1)) + (index>>(MMX_COEF>>1))*5*MMX_COEF];
+	unsigned const int *s = &source[(index&(MMX_COEF-1)) + (index/MMX_COEF)*5*MMX_COEF];
+	unsigned int *d = &dest[(index&(MMX_COEF-1)) + (index/MMX_COEF)*5*MMX_COEF];
 
 	for (i = 0; i < 5; i++) {
 		*d = *s;
@@ -488,7 +488,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 
 			if (len > longest)
 				longest = len;
-			((unsigned int*)saved_key[(len+8)>>6])[15*MMX_COEF + (ti&3) + (ti>>2)*SHA_BUF_SIZ*MMX_COEF] = len << 3;
+			((unsigned int*)saved_key[(len+8)>>6])[15*MMX_COEF + (ti&(MMX_COEF-1)) + (ti/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = len << 3;
 			crypt_len[index] = len;
 		}
 
@@ -515,7 +515,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 			// If final crypt ends up to be 56-61 bytes (or so), this must be clean
 			for (i = 0; i < LIMB; i++)
 				if (keyLen[ti] < i * 64 + 55)
-					((unsigned int*)saved_key[i])[15*MMX_COEF + (ti&3) + (ti>>2)*SHA_BUF_SIZ*MMX_COEF] = 0;
+					((unsigned int*)saved_key[i])[15*MMX_COEF + (ti&(MMX_COEF-1)) + (ti/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = 0;
 
 			len = keyLen[ti];
 			lengthIntoMagicArray = extractLengthOfMagicArray(crypt_key, ti);
@@ -549,7 +549,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 			if (len > longest)
 				longest = len;
 
-			((unsigned int*)saved_key[(len+8)>>6])[15*MMX_COEF + (ti&3) + (ti>>2)*SHA_BUF_SIZ*MMX_COEF] = len << 3;
+			((unsigned int*)saved_key[(len+8)>>6])[15*MMX_COEF + (ti&(MMX_COEF-1)) + (ti/MMX_COEF)*SHA_BUF_SIZ*MMX_COEF] = len << 3;
 		}
 
 		SSESHA1body(&saved_key[0][t*SHA_BUF_SIZ*4*NBKEYS], (unsigned int*)&interm_crypt[t*20*NBKEYS], NULL, SSEi_MIXED_IN);
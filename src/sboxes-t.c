@@ -0,0 +1,393 @@
+/*
+ * Bitslice DES S-boxes making use of a 3-input lookup table operation
+ * (e.g., vpternlog with AVX-512, where each gate is one instruction).
+ *
+ * Gate counts: 29 26 28 22 27 28 26 24
+ * Average: 26.25
+ *
+ * These are Roman Rusakov's AND/OR/XOR/NOT/AND-NOT expressions from
+ * nonstd.c, with each gate folded into its consumer wherever the two
+ * together still depend on no more than 3 inputs.  The names of the
+ * remaining intermediate values are kept from nonstd.c.  The original
+ * expressions have been generated by Roman Rusakov <roman_rus at
+ * openwall.com> for use in Openwall's John the Ripper password cracker:
+ * http://www.openwall.com/john/
+ * Being mathematical formulas, they are not copyrighted and are free for
+ * reuse by anyone.
+ *
+ * vlut3(dst, a, b, c, lut) sets each bit of dst to bit number
+ * (a << 2) | (b << 1) | c of the 8-bit lut, like vpternlog does.
+ *
+ * This file is derived from nonstd.c, which is Copyright (c) 2011 by
+ * Solar Designer <solar at openwall.com>.
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted.  (This is a heavily cut-down "BSD license".)
+ */
+
+/* s1, 29 gates */
+MAYBE_INLINE static void
+s1(vtype a1, vtype a2, vtype a3, vtype a4, vtype a5, vtype a6,
+    vtype * out1, vtype * out2, vtype * out3, vtype * out4)
+{
+	vtype x5A0F5A0F, x3333FFFF, x66666666, x22226666, x25202160,
+	    x00FFFF00, x4803120C, x6A21EDF3, x4A01CC93, x5555FFFF, x7F75FFFF,
+	    x00D20096, x0AD80096, x0AD99996, x22332233, x054885C0, xD89697CC,
+	    x20, x05F77AD6, x6391D07C, xBB0747B0, x01, x4EDF9996, x2D4E49EA,
+	    x96B1B65A, x11, x52B11215, x10B0D205, x31;
+
+	vlut3(x5A0F5A0F, a4, a1, a5, 0xB4);
+	vor(x3333FFFF, a3, a6);
+	vxor(x66666666, a1, a3);
+	vand(x22226666, x3333FFFF, x66666666);
+	vlut3(x25202160, a4, x22226666, x5A0F5A0F, 0x14);
+	vxor(x00FFFF00, a5, a6);
+	vlut3(x4803120C, x5A0F5A0F, a3, x00FFFF00, 0x90);
+	vlut3(x6A21EDF3, x4803120C, a6, x22226666, 0x1E);
+	vandn(x4A01CC93, x6A21EDF3, x25202160);
+	vor(x5555FFFF, a1, a6);
+	vor(x7F75FFFF, x6A21EDF3, x5555FFFF);
+	vlut3(x00D20096, a5, a4, x22226666, 0x90);
+	vlut3(x0AD80096, x00D20096, a4, x5555FFFF, 0xB4);
+	vlut3(x0AD99996, x0AD80096, x00FFFF00, x66666666, 0xF4);
+	vlut3(x22332233, a3, a1, a5, 0xB0);
+	vlut3(x054885C0, x5A0F5A0F, x7F75FFFF, x22332233, 0x14);
+	vlut3(xD89697CC, x054885C0, x3333FFFF, x6A21EDF3, 0x87);
+	vlut3(x20, x7F75FFFF, x00D20096, a2, 0x14);
+	vlut3(*out3, *out3, x20, xD89697CC, 0x96);
+
+	vlut3(x05F77AD6, x00D20096, x00FFFF00, x054885C0, 0xF6);
+	vlut3(x6391D07C, a1, x3333FFFF, x05F77AD6, 0x96);
+	vxor(xBB0747B0, xD89697CC, x6391D07C);
+	vlut3(x01, x25202160, a2, xBB0747B0, 0x56);
+	vxor(*out1, *out1, x01);
+
+	vlut3(x4EDF9996, x0AD99996, x3333FFFF, x7F75FFFF, 0xF6);
+	vxor(x2D4E49EA, x6391D07C, x4EDF9996);
+	vlut3(x96B1B65A, x2D4E49EA, x00FFFF00, xBB0747B0, 0x1E);
+	vlut3(x11, x4A01CC93, a2, x96B1B65A, 0x56);
+	vxor(*out2, *out2, x11);
+
+	vlut3(x52B11215, a5, x5A0F5A0F, x2D4E49EA, 0x54);
+	vlut3(x10B0D205, x52B11215, x4A01CC93, x6391D07C, 0x78);
+	vlut3(x31, x10B0D205, a2, x0AD99996, 0x56);
+	vxor(*out4, *out4, x31);
+}
+
+/* s2, 26 gates */
+MAYBE_INLINE static void
+s2(vtype a1, vtype a2, vtype a3, vtype a4, vtype a5, vtype a6,
+    vtype * out1, vtype * out2, vtype * out3, vtype * out4)
+{
+	vtype x33CC33CC, x00AA00FF, x33BB33FF, x33CC0000, x11BB11BB,
+	    x00000F0F, x332200FF, xA9A8AAA5, x33CCC030, x9A646A95, x10,
+	    x118822B8, x3CC3C33C, x94E34B39, x01, x3FF3F33C, xA9DF596A,
+	    xA9DF5F6F, x962CAC53, x3DA52153, x33C0330C, x1A45324F, x21,
+	    xBBDFDD7B, xB19ACD3C, x30;
+
+	vxor(x33CC33CC, a2, a5);
+	vlut3(x00AA00FF, a5, a1, a6, 0xB0);
+	vor(x33BB33FF, a2, x00AA00FF);
+	vandn(x33CC0000, x33CC33CC, a6);
+	vlut3(x11BB11BB, a5, a1, x33CC33CC, 0x78);
+	vand(x00000F0F, a3, a6);
+	vlut3(x332200FF, x33BB33FF, x00AA00FF, x33CC0000, 0x60);
+	vlut3(xA9A8AAA5, a3, x332200FF, a1, 0x95);
+	vlut3(x33CCC030, a6, x33CC33CC, x00000F0F, 0x14);
+	vxor(x9A646A95, xA9A8AAA5, x33CCC030);
+	vlut3(x10, a4, x332200FF, x00000F0F, 0xB0);
+	vlut3(*out2, *out2, x10, x9A646A95, 0x96);
+
+	vlut3(x118822B8, x11BB11BB, a2, x33CCC030, 0xB4);
+	vlut3(x3CC3C33C, a3, a6, x33CC33CC, 0x96);
+	vlut3(x94E34B39, xA9A8AAA5, x118822B8, x3CC3C33C, 0x9A);
+	vlut3(x01, x33BB33FF, a4, x94E34B39, 0x9A);
+	vxor(*out1, *out1, x01);
+
+	vlut3(x3FF3F33C, x3CC3C33C, a2, x00000F0F, 0xF4);
+	vxor(xA9DF596A, x33BB33FF, x9A646A95);
+	vor(xA9DF5F6F, x00000F0F, xA9DF596A);
+	vxor(x962CAC53, x3FF3F33C, xA9DF5F6F);
+	vlut3(x3DA52153, x94E34B39, x332200FF, x9A646A95, 0x96);
+	vand(x33C0330C, x33CC33CC, x3FF3F33C);
+	vlut3(x1A45324F, xA9DF5F6F, x3DA52153, x33C0330C, 0x6A);
+	vlut3(x21, x1A45324F, a4, x962CAC53, 0x56);
+	vxor(*out3, *out3, x21);
+
+	vlut3(xBBDFDD7B, a6, x33CC33CC, xA9DF596A, 0xBE);
+	vlut3(xB19ACD3C, x1A45324F, x118822B8, xBBDFDD7B, 0x9A);
+	vlut3(x30, x11BB11BB, x33CC0000, a4, 0xBA);
+	vlut3(*out4, *out4, x30, xB19ACD3C, 0x96);
+}
+
+/* s3, 28 gates */
+MAYBE_INLINE static void
+s3(vtype a1, vtype a2, vtype a3, vtype a4, vtype a5, vtype a6,
+    vtype * out1, vtype * out2, vtype * out3, vtype * out4)
+{
+	vtype x0F0FF0F0, x4F4FF4F4, x00FFFF00, x4FE55EF4, x3C3CC3C3,
+	    x7373F4F4, x00FF5EFF, x3C699796, x31, x55AA55AA, x2FDFAF5F,
+	    x2FD00F5F, x55AAFFAA, x000000FF, x000000CC, x284100D8, x204000D0,
+	    x1C3CC32F, x4969967A, x11, x3F3F3F3F, x9669C396, xD6A98356, x00,
+	    xFEEDDB9E, x8D6112FC, xB25E2DC3, x21;
+
+	vxor(x0F0FF0F0, a3, a6);
+	vlut3(x4F4FF4F4, a1, a2, x0F0FF0F0, 0xBA);
+	vxor(x00FFFF00, a4, a6);
+	vlut3(x4FE55EF4, x4F4FF4F4, x00FFFF00, a1, 0xB4);
+	vxor(x3C3CC3C3, a2, x0F0FF0F0);
+	vlut3(x7373F4F4, x4F4FF4F4, x3C3CC3C3, a6, 0xB4);
+	vlut3(x00FF5EFF, a4, a6, x4FE55EF4, 0xF8);
+	vlut3(x3C699796, x3C3CC3C3, a1, x00FF5EFF, 0x78);
+	vlut3(x31, x4FE55EF4, a5, x3C699796, 0x9A);
+	vxor(*out4, *out4, x31);
+
+	vxor(x55AA55AA, a1, a4);
+	vlut3(x2FDFAF5F, a3, x7373F4F4, x55AA55AA, 0xF6);
+	vlut3(x2FD00F5F, x2FDFAF5F, x0F0FF0F0, x00FFFF00, 0x70);
+	vlut3(x55AAFFAA, x00FFFF00, a1, x55AA55AA, 0xBA);
+	vand(x000000FF, a4, a6);
+	vandn(x000000CC, x000000FF, a2);
+	vlut3(x284100D8, x3C699796, x55AAFFAA, x000000CC, 0x9A);
+	vandn(x204000D0, x284100D8, a3);
+	vlut3(x1C3CC32F, x3C3CC3C3, x000000FF, x204000D0, 0x54);
+	vxor(x4969967A, a1, x1C3CC32F);
+	vlut3(x11, x2FD00F5F, a5, x4969967A, 0x6A);
+	vxor(*out2, *out2, x11);
+
+	vor(x3F3F3F3F, a2, a3);
+	vlut3(x9669C396, x3C3CC3C3, x55AAFFAA, x55AAFFAA, 0x81);
+	vlut3(xD6A98356, x4FE55EF4, x3F3F3F3F, x9669C396, 0x9A);
+	vlut3(x00, a5, x4FE55EF4, x7373F4F4, 0xB0);
+	vlut3(*out1, *out1, x00, xD6A98356, 0x96);
+
+	vlut3(xFEEDDB9E, x9669C396, a1, x2FD00F5F, 0xF6);
+	vlut3(x8D6112FC, x3C699796, x4FE55EF4, xFEEDDB9E, 0x96);
+	vxor(xB25E2DC3, x3F3F3F3F, x8D6112FC);
+	vlut3(x21, x284100D8, a5, xB25E2DC3, 0x56);
+	vxor(*out3, *out3, x21);
+}
+
+/* s4, 22 gates */
+MAYBE_INLINE static void
+s4(vtype a1, vtype a2, vtype a3, vtype a4, vtype a5, vtype a6,
+    vtype * out1, vtype * out2, vtype * out3, vtype * out4)
+{
+	vtype x5A5A5A5A, x0F0FF0F0, x33FFCC00, x0C0030F0, x0C0CC0C0,
+	    x0CF3C03F, x52FBCA0F, x61C8F93C, x00C0C03C, x3B92A366, x30908326,
+	    x3C90B3D6, x33CC33CC, x379E5C99, x56E9861E, x01, xA91679E1, x11,
+	    x8402C833, xB35C94A6, x21, x31;
+
+	vxor(x5A5A5A5A, a1, a3);
+	vxor(x0F0FF0F0, a3, a5);
+	vlut3(x33FFCC00, a5, a2, a4, 0x1E);
+	vandn(x0C0030F0, x0F0FF0F0, x33FFCC00);
+	vandn(x0C0CC0C0, x0F0FF0F0, a2);
+	vxor(x0CF3C03F, a4, x0C0CC0C0);
+	vlut3(x52FBCA0F, x5A5A5A5A, x0CF3C03F, x0C0030F0, 0x54);
+	vxor(x61C8F93C, a2, x52FBCA0F);
+	vand(x00C0C03C, x0CF3C03F, x61C8F93C);
+	vxor(x3B92A366, x5A5A5A5A, x61C8F93C);
+	vlut3(x30908326, x3B92A366, x0F0FF0F0, x00C0C03C, 0xB0);
+	vxor(x3C90B3D6, x0C0030F0, x30908326);
+	vxor(x33CC33CC, a2, a4);
+	vlut3(x379E5C99, x3B92A366, a5, x0C0CC0C0, 0x1E);
+	vlut3(x56E9861E, x52FBCA0F, x379E5C99, x33CC33CC, 0xB4);
+	vlut3(x01, a6, x3C90B3D6, x56E9861E, 0x9A);
+	vxor(*out1, *out1, x01);
+
+	vnot(xA91679E1, x56E9861E);
+	vlut3(x11, x3C90B3D6, a6, xA91679E1, 0x9A);
+	vxor(*out2, *out2, x11);
+
+	vlut3(x8402C833, x3C90B3D6, xA91679E1, x33CC33CC, 0x14);
+	vlut3(xB35C94A6, x379E5C99, x00C0C03C, x8402C833, 0x1E);
+	vlut3(x21, x61C8F93C, a6, xB35C94A6, 0x56);
+	vxor(*out3, *out3, x21);
+
+	vlut3(x31, a6, x61C8F93C, xB35C94A6, 0x6A);
+	vxor(*out4, *out4, x31);
+}
+
+/* s5, 27 gates */
+MAYBE_INLINE static void
+s5(vtype a1, vtype a2, vtype a3, vtype a4, vtype a5, vtype a6,
+    vtype * out1, vtype * out2, vtype * out3, vtype * out4)
+{
+	vtype x77777777, x77770000, x22225555, x1F1F6F6F, x43433333,
+	    x55557777, x55167744, x5A19784B, x5A1987B4, x003B00F5, x05050707,
+	    x271C52A7, x2A2A82A0, x1FE06F90, xE97FB1FF, x21, x37DEFFB7,
+	    x349ECCB5, x0FF8EB24, x4FF9FB37, x30, x16BCEE97, x19B4E593, x00,
+	    x4448184C, x6992A63D, x11;
+
+	vor(x77777777, a1, a3);
+	vandn(x77770000, x77777777, a6);
+	vxor(x22225555, a1, x77770000);
+	vlut3(x1F1F6F6F, a4, a3, x22225555, 0xF6);
+	vlut3(x43433333, a3, x77770000, a4, 0xB4);
+	vlut3(x55557777, a1, a3, x22225555, 0xF6);
+	vlut3(x55167744, a5, x43433333, x55557777, 0x6A);
+	vxor(x5A19784B, a4, x55167744);
+	vxor(x5A1987B4, a6, x5A19784B);
+	vlut3(x003B00F5, a5, x22225555, x5A1987B4, 0xE0);
+	vand(x05050707, a4, x55557777);
+	vlut3(x271C52A7, x22225555, x003B00F5, x05050707, 0x96);
+	vlut3(x2A2A82A0, x22225555, x5A1987B4, a1, 0x54);
+	vxor(x1FE06F90, a5, x1F1F6F6F);
+	vlut3(xE97FB1FF, x1FE06F90, x43433333, x2A2A82A0, 0x6F);
+	vlut3(x21, xE97FB1FF, a2, x5A19784B, 0x9A);
+	vxor(*out3, *out3, x21);
+
+	vlut3(x37DEFFB7, x271C52A7, x2A2A82A0, x1FE06F90, 0xF6);
+	vlut3(x349ECCB5, x37DEFFB7, x43433333, x003B00F5, 0xB0);
+	vlut3(x0FF8EB24, x1FE06F90, x5A1987B4, x349ECCB5, 0x78);
+	vlut3(x4FF9FB37, x0FF8EB24, x43433333, x55557777, 0xF8);
+	vlut3(x30, x003B00F5, x4FF9FB37, a2, 0x28);
+	vlut3(*out4, *out4, x30, x271C52A7, 0x96);
+
+	vlut3(x16BCEE97, a1, x77777777, x349ECCB5, 0x96);
+	vlut3(x19B4E593, x16BCEE97, a4, x0FF8EB24, 0x78);
+	vlut3(x00, x1F1F6F6F, x349ECCB5, a2, 0xBA);
+	vlut3(*out1, *out1, x00, x19B4E593, 0x96);
+
+	vlut3(x4448184C, x1F1F6F6F, x43433333, x19B4E593, 0x14);
+	vlut3(x6992A63D, x4448184C, x22225555, x0FF8EB24, 0x96);
+	vlut3(x11, x1F1F6F6F, a2, x6992A63D, 0x6A);
+	vxor(*out2, *out2, x11);
+}
+
+/* s6, 28 gates */
+MAYBE_INLINE static void
+s6(vtype a1, vtype a2, vtype a3, vtype a4, vtype a5, vtype a6,
+    vtype * out1, vtype * out2, vtype * out3, vtype * out4)
+{
+	vtype x11115555, x22DD6699, x00220099, x00551144, x5A5A5A5A,
+	    x7B7E7A7F, x59A31CE6, x09030C06, x336622FF, x3A6522FF, x31,
+	    x484D494C, x0F0FB9BC, x0FFFB9FD, x116600F7, x1E69B94B, x1668B94B,
+	    x21, x7B7B7B7B, x64848686, x004B002D, xCCC9CDC8, x10, x11,
+	    x5A5AECE9, x0050ECA9, xC59A2D67, x01;
+
+	vlut3(x11115555, a1, a2, a6, 0xE0);
+	vlut3(x22DD6699, a2, a5, x11115555, 0x96);
+	vlut3(x00220099, a5, a6, x22DD6699, 0x90);
+	vlut3(x00551144, a1, a6, x22DD6699, 0x60);
+	vxor(x5A5A5A5A, a1, a3);
+	vlut3(x7B7E7A7F, a2, x00551144, x5A5A5A5A, 0xBE);
+	vxor(x59A31CE6, x22DD6699, x7B7E7A7F);
+	vand(x09030C06, a3, x59A31CE6);
+	vlut3(x336622FF, x00220099, a2, x00551144, 0xF6);
+	vlut3(x3A6522FF, x09030C06, a6, x336622FF, 0x9A);
+	vlut3(x31, x3A6522FF, a4, x59A31CE6, 0x6A);
+	vxor(*out4, *out4, x31);
+
+	vxor(x484D494C, a2, x7B7E7A7F);
+	vlut3(x0F0FB9BC, a3, a6, x484D494C, 0xB4);
+	vlut3(x0FFFB9FD, x0F0FB9BC, a5, x09030C06, 0xF4);
+	vlut3(x116600F7, x336622FF, a1, x59A31CE6, 0xE0);
+	vxor(x1E69B94B, x0F0FB9BC, x116600F7);
+	vlut3(x1668B94B, x1E69B94B, x09030C06, a6, 0xB0);
+	vlut3(x21, x00220099, a4, x1668B94B, 0x56);
+	vxor(*out3, *out3, x21);
+
+	vor(x7B7B7B7B, a2, x5A5A5A5A);
+	vlut3(x64848686, x11115555, x0FFFB9FD, x7B7B7B7B, 0x56);
+	vlut3(x004B002D, a5, x22DD6699, x1E69B94B, 0x90);
+	vlut3(xCCC9CDC8, x484D494C, x7B7B7B7B, x7B7B7B7B, 0x81);
+	vlut3(x10, x004B002D, xCCC9CDC8, a4, 0x14);
+	vlut3(x11, x10, x3A6522FF, x64848686, 0x96);
+	vxor(*out2, *out2, x11);
+
+	vxor(x5A5AECE9, a1, x0F0FB9BC);
+	vlut3(x0050ECA9, a6, x00551144, x5A5AECE9, 0x28);
+	vlut3(xC59A2D67, xCCC9CDC8, x09030C06, x0050ECA9, 0x96);
+	vlut3(x01, x0FFFB9FD, a4, xC59A2D67, 0x9A);
+	vxor(*out1, *out1, x01);
+}
+
+/* s7, 26 gates */
+MAYBE_INLINE static void
+s7(vtype a1, vtype a2, vtype a3, vtype a4, vtype a5, vtype a6,
+    vtype * out1, vtype * out2, vtype * out3, vtype * out4)
+{
+	vtype x3CC33CC3, x00003CC3, x0F000F00, x5A555A55, x33333C33,
+	    x0FF0F00F, x74878E78, x30, x003C003C, x333300F0, x694E5A8D,
+	    x000F0303, x33CC000F, x699C585B, x21101013, x7F979F7B, x4F9493BB,
+	    x01, x0000DBFB, x26DAC936, x26DA9867, x27DA438C, x27FFCBCD, x21,
+	    x27FF103E, x10;
+
+	vlut3(x3CC33CC3, a3, a4, a5, 0x96);
+	vand(x00003CC3, a6, x3CC33CC3);
+	vlut3(x0F000F00, a4, a5, a5, 0x10);
+	vxor(x5A555A55, a2, x0F000F00);
+	vlut3(x33333C33, a3, a6, x0F000F00, 0x78);
+	vlut3(x0FF0F00F, a6, a4, a5, 0x96);
+	vlut3(x74878E78, x5A555A55, x33333C33, x0FF0F00F, 0x56);
+	vlut3(x30, a1, x00003CC3, x5A555A55, 0x70);
+	vlut3(*out4, *out4, x30, x74878E78, 0x96);
+
+	vandn(x003C003C, a5, x3CC33CC3);
+	vxor(x333300F0, x00003CC3, x33333C33);
+	vlut3(x694E5A8D, x5A555A55, x003C003C, x333300F0, 0x56);
+	vlut3(x000F0303, a4, x00003CC3, x0FF0F00F, 0x90);
+	vxor(x33CC000F, a5, x333300F0);
+	vlut3(x699C585B, x5A555A55, x000F0303, x33CC000F, 0x9A);
+	vand(x21101013, a3, x699C585B);
+	vlut3(x7F979F7B, x0F000F00, x74878E78, x21101013, 0xFE);
+	vlut3(x4F9493BB, x7F979F7B, x3CC33CC3, x0FF0F00F, 0xB4);
+	vlut3(x01, x4F9493BB, a1, x694E5A8D, 0x9A);
+	vxor(*out1, *out1, x01);
+
+	vlut3(x0000DBFB, a6, x699C585B, x4F9493BB, 0xE0);
+	vxor(x26DAC936, x694E5A8D, x4F9493BB);
+	vlut3(x26DA9867, a2, x0000DBFB, x26DAC936, 0x6A);
+	vlut3(x27DA438C, x0000DBFB, x21101013, x26DA9867, 0x1E);
+	vlut3(x27FFCBCD, x27DA438C, a5, x26DAC936, 0xF6);
+	vlut3(x21, x27FFCBCD, a1, x699C585B, 0x6A);
+	vxor(*out3, *out3, x21);
+
+	vlut3(x27FF103E, x003C003C, x0000DBFB, x27FFCBCD, 0xF6);
+	vlut3(x10, x27FF103E, x4F9493BB, a1, 0x41);
+	vlut3(*out2, *out2, x10, x26DA9867, 0x96);
+}
+
+/* s8, 24 gates */
+MAYBE_INLINE static void
+s8(vtype a1, vtype a2, vtype a3, vtype a4, vtype a5, vtype a6,
+    vtype * out1, vtype * out2, vtype * out3, vtype * out4)
+{
+	vtype x00FFF00F, x00555005, x00515001, x77555775, x3030CFCF,
+	    x30104745, x30555745, x080A080A, xC71A40BF, xCB164CB3, x11,
+	    x9E4319E6, xF429738C, xF4296A6A, xC729695A, xF77F3F3F, x693CD926,
+	    x21, xF719A695, x03E6D56A, x30, x61008000, x62B7056B, x01;
+
+	vlut3(x00FFF00F, a4, a5, a3, 0xB4);
+	vand(x00555005, a1, x00FFF00F);
+	vlut3(x00515001, x00555005, a3, a2, 0xB0);
+	vlut3(x77555775, a1, a2, x00FFF00F, 0xF4);
+	vlut3(x3030CFCF, a5, a2, a3, 0xB4);
+	vand(x30104745, x77555775, x3030CFCF);
+	vor(x30555745, x00555005, x30104745);
+	vandn(x080A080A, a3, x77555775);
+	vlut3(xC71A40BF, x30104745, x00FFF00F, x080A080A, 0x69);
+	vlut3(xCB164CB3, a3, a2, xC71A40BF, 0x9A);
+	vlut3(x11, x00515001, a6, xCB164CB3, 0x56);
+	vxor(*out2, *out2, x11);
+
+	vxor(x9E4319E6, a1, xCB164CB3);
+	vxor(xF429738C, a2, xC71A40BF);
+	vlut3(xF4296A6A, a5, x9E4319E6, xF429738C, 0x6A);
+	vlut3(xC729695A, a2, x00FFF00F, xF4296A6A, 0x9A);
+	vlut3(xF77F3F3F, a2, x30555745, xF4296A6A, 0xF6);
+	vlut3(x693CD926, xF77F3F3F, a5, x9E4319E6, 0x96);
+	vlut3(x21, x30555745, a6, x693CD926, 0x6A);
+	vxor(*out3, *out3, x21);
+
+	vxor(xF719A695, x3030CFCF, xC729695A);
+	vlut3(x03E6D56A, xF719A695, a4, xF429738C, 0x1E);
+	vlut3(x30, a1, x03E6D56A, a6, 0x28);
+	vlut3(*out4, *out4, x30, xC729695A, 0x96);
+
+	vlut3(x61008000, x693CD926, xF719A695, a4, 0x40);
+	vlut3(x62B7056B, x61008000, x00515001, x03E6D56A, 0x96);
+	vlut3(x01, x62B7056B, a6, xC729695A, 0x56);
+	vxor(*out1, *out1, x01);
+}
@@ -48,8 +48,9 @@
 #define SALT_SIZE			BINARY_SIZE
 #define SALT_ALIGN			1
 
+/* Candidates are hashed in pairs per thread, see escrypt_kdf_x2() */
 #define MIN_KEYS_PER_CRYPT		1
-#define MAX_KEYS_PER_CRYPT		1
+#define MAX_KEYS_PER_CRYPT		2
 
 static struct fmt_tests tests[] = {
 	{"$7$C6..../....SodiumChloride$kBGj9fHznVYFQMEn/qDCfrDevf9YDtcDdKvEqHJLV8D", "pleaseletmein"},
@@ -380,14 +381,34 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 #ifdef _OPENMP
 #pragma omp parallel for default(none) private(index) shared(count, failed, local, saved_salt, buffer)
 #endif
-	for (index = 0; index < count; index++) {
+	for (index = 0; index < count; index += 2) {
 		uint8_t *hash;
-		hash = escrypt_r(&(local[index]),
-		    (const uint8_t *)(buffer[index].key),
-		    strlen(buffer[index].key),
-		    (const uint8_t *)saved_salt,
-		    (uint8_t *)&(buffer[index].out),
-		    sizeof(buffer[index].out));
+		if (index + 1 < count) {
+			const uint8_t *passwd[2] = {
+				(const uint8_t *)buffer[index].key,
+				(const uint8_t *)buffer[index + 1].key
+			};
+			const size_t passwdlen[2] = {
+				strlen(buffer[index].key),
+				strlen(buffer[index + 1].key)
+			};
+			uint8_t *out[2] = {
+				(uint8_t *)&(buffer[index].out),
+				(uint8_t *)&(buffer[index + 1].out)
+			};
+			hash = escrypt_r_x2(&(local[index >> 1]),
+			    passwd, passwdlen,
+			    (const uint8_t *)saved_salt,
+			    out, sizeof(buffer[index].out));
+			if (!hash)
+				buffer[index + 1].out[0] = 0;
+		} else
+			hash = escrypt_r(&(local[index >> 1]),
+			    (const uint8_t *)(buffer[index].key),
+			    strlen(buffer[index].key),
+			    (const uint8_t *)saved_salt,
+			    (uint8_t *)&(buffer[index].out),
+			    sizeof(buffer[index].out));
 		if (!hash) {
 			failed = 1;
 			buffer[index].out[0] = 0;
@@ -0,0 +1,191 @@
+/*
+ * Runtime selection of the sse-intrinsics.c kernels.
+ *
+ * The vector width of a build (MMX_COEF) decides the data layout of every
+ * SIMD format, so it can't change at runtime.  What can is the instruction
+ * set the kernels are compiled for: sse-intrinsics.c is built once as usual
+ * (the "base" kernels) and once more by each sse-intrinsics-*.c wrapper,
+ * for AVX, XOP or AVX-512VL at the very same width.  The first of these the
+ * CPU supports is picked from fmt_init(), and the SSE*body() entry points
+ * here just call through to it.  Before that, the base kernels are used.
+ *
+ * No copyright is claimed, and the software is hereby placed in the public
+ * domain.  In case this attempt to disclaim copyright and place the software
+ * in the public domain is deemed null and void, then the software is
+ * hereby released to the general public under the following terms:
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted.
+ */
+
+#include "arch.h"
+
+#if SIMD_DISPATCH
+#include <emmintrin.h>
+
+#include "sse-intrinsics.h"
+#include "memdbg.h"
+
+struct simd_kernels {
+	const char *name;
+	int (*usable)(void);
+#ifdef MD5_SSE_PARA
+	void (*md5crypt)(unsigned char *buf, unsigned char *salt, char *out,
+	                 int md5_type);
+	void (*md5body)(__m128i *data, ARCH_WORD_32 *out,
+	                ARCH_WORD_32 *reload_state, unsigned SSEi_flags);
+#endif
+#ifdef MD4_SSE_PARA
+	void (*md4body)(__m128i *data, ARCH_WORD_32 *out,
+	                ARCH_WORD_32 *reload_state, unsigned SSEi_flags);
+#endif
+#ifdef SHA1_SSE_PARA
+	void (*sha1body)(__m128i *data, ARCH_WORD_32 *out,
+	                 ARCH_WORD_32 *reload_state, unsigned SSEi_flags);
+#endif
+	void (*sha256body)(__m128i *data, ARCH_WORD_32 *out,
+	                   ARCH_WORD_32 *reload_state, unsigned SSEi_flags);
+	void (*sha512body)(__m128i *data, ARCH_WORD_64 *out,
+	                   ARCH_WORD_64 *reload_state, unsigned SSEi_flags);
+};
+
+#define SIMD_DECLARE(v) \
+	void SIMD_NAME(md5cryptsse, v)(unsigned char *buf, \
+		unsigned char *salt, char *out, int md5_type); \
+	void SIMD_NAME(SSEmd5body, v)(__m128i *data, ARCH_WORD_32 *out, \
+		ARCH_WORD_32 *reload_state, unsigned SSEi_flags); \
+	void SIMD_NAME(SSEmd4body, v)(__m128i *data, ARCH_WORD_32 *out, \
+		ARCH_WORD_32 *reload_state, unsigned SSEi_flags); \
+	void SIMD_NAME(SSESHA1body, v)(__m128i *data, ARCH_WORD_32 *out, \
+		ARCH_WORD_32 *reload_state, unsigned SSEi_flags); \
+	void SIMD_NAME(SSESHA256body, v)(__m128i *data, ARCH_WORD_32 *out, \
+		ARCH_WORD_32 *reload_state, unsigned SSEi_flags); \
+	void SIMD_NAME(SSESHA512body, v)(__m128i *data, ARCH_WORD_64 *out, \
+		ARCH_WORD_64 *reload_state, unsigned SSEi_flags);
+
+#ifdef MD5_SSE_PARA
+#define MD5_KERNELS(v) \
+	SIMD_NAME(md5cryptsse, v), SIMD_NAME(SSEmd5body, v),
+#else
+#define MD5_KERNELS(v)
+#endif
+#ifdef MD4_SSE_PARA
+#define MD4_KERNELS(v)			SIMD_NAME(SSEmd4body, v),
+#else
+#define MD4_KERNELS(v)
+#endif
+#ifdef SHA1_SSE_PARA
+#define SHA1_KERNELS(v)			SIMD_NAME(SSESHA1body, v),
+#else
+#define SHA1_KERNELS(v)
+#endif
+
+#define SIMD_KERNELS(name, usable, v) \
+	{ name, usable, MD5_KERNELS(v) MD4_KERNELS(v) SHA1_KERNELS(v) \
+	  SIMD_NAME(SSESHA256body, v), SIMD_NAME(SSESHA512body, v) }
+
+SIMD_DECLARE(base)
+SIMD_DECLARE(avx512vl)
+#if MMX_COEF == 4
+SIMD_DECLARE(xop)
+SIMD_DECLARE(avx)
+#endif
+
+static int cpu_avx512vl(void)
+{
+	return __builtin_cpu_supports("avx512vl");
+}
+
+#if MMX_COEF == 4
+static int cpu_xop(void)
+{
+	return __builtin_cpu_supports("xop");
+}
+
+static int cpu_avx(void)
+{
+	return __builtin_cpu_supports("avx");
+}
+#endif
+
+static int cpu_any(void)
+{
+	return 1;
+}
+
+/* Best first.  The base kernels are what the rest of John is built for. */
+static const struct simd_kernels kernels[] = {
+	SIMD_KERNELS("AVX512VL", cpu_avx512vl, avx512vl),
+#if MMX_COEF == 4
+	SIMD_KERNELS("XOP", cpu_xop, xop),
+	SIMD_KERNELS("AVX", cpu_avx, avx),
+#endif
+	SIMD_KERNELS(SSE_type, cpu_any, base)
+};
+
+static const struct simd_kernels *simd =
+	&kernels[sizeof(kernels) / sizeof(kernels[0]) - 1];
+
+void simd_dispatch_init(void)
+{
+	static int done;
+	const struct simd_kernels *k = kernels;
+
+	if (done)
+		return;
+
+	__builtin_cpu_init();
+	while (!k->usable())
+		k++;
+	simd = k;
+	done = 1;
+}
+
+const char *simd_dispatch_name(void)
+{
+	simd_dispatch_init();
+	return simd->name;
+}
+
+#ifdef MD5_SSE_PARA
+void md5cryptsse(unsigned char *buf, unsigned char *salt, char *out,
+                 int md5_type)
+{
+	simd->md5crypt(buf, salt, out, md5_type);
+}
+
+void SSEmd5body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
+                unsigned SSEi_flags)
+{
+	simd->md5body(data, out, reload_state, SSEi_flags);
+}
+#endif
+
+#ifdef MD4_SSE_PARA
+void SSEmd4body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
+                unsigned SSEi_flags)
+{
+	simd->md4body(data, out, reload_state, SSEi_flags);
+}
+#endif
+
+#ifdef SHA1_SSE_PARA
+void SSESHA1body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
+                 unsigned SSEi_flags)
+{
+	simd->sha1body(data, out, reload_state, SSEi_flags);
+}
+#endif
+
+void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
+                   unsigned SSEi_flags)
+{
+	simd->sha256body(data, out, reload_state, SSEi_flags);
+}
+
+void SSESHA512body(__m128i *data, ARCH_WORD_64 *out, ARCH_WORD_64 *reload_state,
+                   unsigned SSEi_flags)
+{
+	simd->sha512body(data, out, reload_state, SSEi_flags);
+}
+
+#endif /* SIMD_DISPATCH */
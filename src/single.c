@@ -6,6 +6,7 @@
  */
 
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "misc.h"
@@ -39,6 +40,43 @@ static struct rpp_context *rule_ctx;
 
 static int words_pair_max;
 
+/*
+ * With --single-mem, the per-salt key buffers and their dupe hash tables come
+ * from a limited pool. A salt is handed one when it first needs it. When the
+ * pool is exhausted, the least recently used buffer is flushed (processing
+ * its keys early, as a partial batch) and taken over.
+ *
+ * To keep that from happening on every salt visited, single_run_groups()
+ * goes through the salts in groups no larger than the pool, running a block
+ * of rules over one group before moving on to the next.  Successful guesses
+ * are added to a list that salts catch up on only while they hold a buffer,
+ * so that trying them doesn't hand a buffer to every other salt.
+ */
+struct single_buf {
+	struct single_buf *prev, *next; /* LRU list, most recently used first */
+	struct db_salt *salt; /* Current owner */
+	struct db_keys_hash *hash;
+	char buffer[1];
+};
+
+static struct single_buf *buf_head, *buf_tail;
+static int buf_count, buf_max, hash_size;
+static unsigned long long buf_flushes;
+
+/*
+ * Rules of the current block.  A block is at most as many rules as a salt
+ * would otherwise keep keys buffered for, and an interrupted session resumes
+ * from its start, so this doesn't make us redo more on restore than before.
+ * block_salts (the salts done with it so far) is only used for progress.
+ */
+static char **block_rules;
+static int *block_numbers;
+static int block_size, block_end, block_salts;
+static struct db_salt **group;
+static int group_size;
+static char *guess_list;
+static int guess_count, guess_alloc;
+
 static void save_state(FILE *file)
 {
 	fprintf(file, "%d\n", rec_rule);
@@ -64,20 +102,38 @@ static double get_progress(void)
 {
 	emms();
 
-	return progress ? progress :
-		(double)rule_number / (rule_count + 1) * 100.0;
+	if (progress)
+		return progress;
+
+	if (buf_max && block_end > rec_rule) {
+		double done = 1.0;
+
+		if (block_salts < single_db->salt_count)
+			done = (double)block_salts / single_db->salt_count;
+
+		return (rec_rule + (block_end - rec_rule) * done) /
+			(rule_count + 1) * 100.0;
+	}
+
+	return (double)rule_number / (rule_count + 1) * 100.0;
 }
 
-static void single_alloc_keys(struct db_keys **keys)
+static void single_alloc_keys(struct db_keys **keys, int pooled)
 {
-	int hash_size = sizeof(struct db_keys_hash) +
-		sizeof(struct db_keys_hash_entry) * (key_count - 1);
-
 	if (!*keys) {
-		*keys = mem_alloc_tiny(
-			sizeof(struct db_keys) - 1 + length * key_count,
-			MEM_ALIGN_WORD);
-		(*keys)->hash = mem_alloc_tiny(hash_size, MEM_ALIGN_WORD);
+		if (pooled) {
+			*keys = mem_alloc_tiny(sizeof(struct db_keys),
+				MEM_ALIGN_WORD);
+			(*keys)->buffer = NULL;
+			(*keys)->hash = NULL;
+		} else {
+			*keys = mem_alloc_tiny(
+				sizeof(struct db_keys) + length * key_count,
+				MEM_ALIGN_WORD);
+			(*keys)->buffer = (char *)&(*keys)[1];
+			(*keys)->hash = mem_alloc_tiny(hash_size,
+				MEM_ALIGN_WORD);
+		}
 	}
 
 	(*keys)->count = (*keys)->count_from_guesses = 0;
@@ -85,12 +141,105 @@ static void single_alloc_keys(struct db_keys **keys)
 	(*keys)->have_words = 1; /* assume yes; we'll see for real later */
 	(*keys)->rule = rule_number;
 	(*keys)->lock = 0;
-	memset((*keys)->hash, -1, hash_size);
+	(*keys)->guesses = 0;
+	if ((*keys)->hash)
+		memset((*keys)->hash, -1, hash_size);
+}
+
+static int single_process_buffer(struct db_salt *salt);
+
+static void single_unlink_buf(struct single_buf *buf)
+{
+	if (buf->prev)
+		buf->prev->next = buf->next;
+	else
+		buf_head = buf->next;
+	if (buf->next)
+		buf->next->prev = buf->prev;
+	else
+		buf_tail = buf->prev;
+}
+
+static void single_link_buf(struct single_buf *buf)
+{
+	buf->prev = NULL;
+	if ((buf->next = buf_head))
+		buf_head->prev = buf;
+	else
+		buf_tail = buf;
+	buf_head = buf;
+}
+
+/*
+ * Make sure the salt holds a key buffer, taking one from the pool (possibly
+ * by flushing another salt's buffer) if it doesn't. Returns non-zero if
+ * flushing that buffer aborted the session or cracked everything.
+ */
+static int single_get_buffer(struct db_salt *salt)
+{
+	struct db_keys *keys = salt->keys;
+	struct single_buf *buf;
+
+	if (keys->buffer) {
+		buf = (struct single_buf *)
+			(keys->buffer - offsetof(struct single_buf, buffer));
+		if (buf != buf_head) {
+			single_unlink_buf(buf);
+			single_link_buf(buf);
+		}
+		return 0;
+	}
+
+	do {
+		if (buf_count < buf_max) {
+			buf = mem_alloc(sizeof(struct single_buf) - 1 +
+			                length * key_count);
+			buf->hash = mem_alloc(hash_size);
+			buf_count++;
+			break;
+		}
+
+/* Buffers of salts currently being processed further up the stack are locked */
+		for (buf = buf_tail; buf; buf = buf->prev)
+			if (!buf->salt->keys->lock)
+				break;
+		if (!buf) {
+			buf_max++;
+			continue;
+		}
+
+		if (buf->salt->keys->count && buf->salt->list) {
+			buf_flushes++;
+			if (single_process_buffer(buf->salt))
+				return 1;
+			continue;
+		}
+
+		single_unlink_buf(buf);
+		buf->salt->keys->buffer = buf->salt->keys->ptr = NULL;
+		buf->salt->keys->hash = NULL;
+		buf->salt->keys->count = buf->salt->keys->count_from_guesses = 0;
+		break;
+/* Flushing may have added guessed keys to this salt, and thus given it one */
+	} while (!keys->buffer);
+
+	if (keys->buffer)
+		return single_get_buffer(salt);
+
+	buf->salt = salt;
+	single_link_buf(buf);
+
+	keys->buffer = keys->ptr = buf->buffer;
+	keys->hash = buf->hash;
+	memset(keys->hash, -1, hash_size);
+
+	return 0;
 }
 
 static void single_init(void)
 {
 	struct db_salt *salt;
+	size_t buf_size;
 
 	log_event("Proceeding with \"single crack\" mode");
 
@@ -115,6 +264,32 @@ static void single_init(void)
 	while (key_count > 0xffff / length + 1)
 		key_count >>= 1;
 
+	hash_size = sizeof(struct db_keys_hash) +
+		sizeof(struct db_keys_hash_entry) * (key_count - 1);
+	buf_size = length * key_count + hash_size;
+
+	buf_head = buf_tail = NULL;
+	buf_count = buf_max = 0;
+	buf_flushes = 0;
+	if (options.single_mem &&
+	    (size_t)options.single_mem << 20 <
+	    buf_size * single_db->salt_count) {
+		buf_max = ((size_t)options.single_mem << 20) / buf_size;
+		if (buf_max < 1)
+			buf_max = 1;
+		log_event("- Sharing %d key buffers among %d salts, saving %zu MB",
+			buf_max, single_db->salt_count,
+			(buf_size * (single_db->salt_count - buf_max)) >> 20);
+
+		block_size = key_count << 1;
+		block_rules = mem_alloc(block_size * sizeof(*block_rules));
+		block_numbers = mem_alloc(block_size * sizeof(*block_numbers));
+		group = mem_alloc((group_size = buf_max) * sizeof(*group));
+	}
+	block_end = block_salts = 0;
+	guess_list = NULL;
+	guess_count = guess_alloc = 0;
+
 	if (rpp_init(rule_ctx, pers_opts.activesinglerules)) {
 		log_event("! No \"%s\" mode rules found",
 		          pers_opts.activesinglerules);
@@ -137,10 +312,10 @@ static void single_init(void)
 
 	salt = single_db->salts;
 	do {
-		single_alloc_keys(&salt->keys);
+		single_alloc_keys(&salt->keys, buf_max);
 	} while ((salt = salt->next));
 
-	if (key_count > 1)
+	if (key_count > 1 && !buf_max)
 	log_event("- Allocated %d buffer%s of %d candidate passwords%s",
 		single_db->salt_count,
 		single_db->salt_count != 1 ? "s" : "",
@@ -148,7 +323,7 @@ static void single_init(void)
 		single_db->salt_count != 1 ? " each" : "");
 
 	guessed_keys = NULL;
-	single_alloc_keys(&guessed_keys);
+	single_alloc_keys(&guessed_keys, 0);
 
 	crk_init(single_db, NULL, guessed_keys);
 }
@@ -194,14 +369,15 @@ out:
 	return hash;
 }
 
-static int single_process_buffer(struct db_salt *salt);
-
 static int single_add_key(struct db_salt *salt, char *key, int is_from_guesses)
 {
 	struct db_keys *keys = salt->keys;
 	int index, new_hash, reuse_hash;
 	struct db_keys_hash_entry *entry;
 
+	if (buf_max && single_get_buffer(salt))
+		return 1;
+
 /* Check if this is a known duplicate, and reject it if so */
 	if ((index = keys->hash->hash[new_hash = single_key_hash(key)]) >= 0)
 	do {
@@ -244,11 +420,45 @@ static int single_add_key(struct db_salt *salt, char *key, int is_from_guesses)
 	return 0;
 }
 
+/*
+ * With --single-mem: give the salt the guesses it hasn't seen yet.  A flush
+ * further down may crack the salt's last hash, so check it's still wanted.
+ */
+static int single_add_guesses(struct db_salt *salt)
+{
+	struct db_keys *keys = salt->keys;
+
+	while (salt->list && keys->guesses < guess_count)
+		if (single_add_key(salt,
+		    &guess_list[length * keys->guesses++], 1))
+			return 1;
+
+	return 0;
+}
+
+static void single_append_guesses(char *buffer, int count)
+{
+	char *list;
+
+	if (guess_count + count > guess_alloc) {
+		guess_alloc = (guess_count + count) * 2;
+		list = mem_alloc(length * guess_alloc);
+		if (guess_count)
+			memcpy(list, guess_list, length * guess_count);
+		MEM_FREE(guess_list);
+		guess_list = list;
+	}
+
+	memcpy(&guess_list[length * guess_count], buffer, length * count);
+	guess_count += count;
+}
+
 static int single_process_buffer(struct db_salt *salt)
 {
 	struct db_salt *current;
 	struct db_keys *keys;
-	size_t size;
+	char *guesses, *ptr;
+	int count;
 
 	if (crk_process_salt(salt))
 		return 1;
@@ -270,25 +480,37 @@ static int single_process_buffer(struct db_salt *salt)
 	keys->ptr = keys->buffer;
 	keys->lock++;
 
-	if (guessed_keys->count) {
-		keys = mem_alloc(size = sizeof(struct db_keys) - 1 +
-			length * guessed_keys->count);
-		memcpy(keys, guessed_keys, size);
+	if (buf_max && guessed_keys->count) {
+		single_append_guesses(guessed_keys->buffer, guessed_keys->count);
+
+		current = single_db->salts;
+		do {
+			if (current == salt || !current->list ||
+			    !current->keys->buffer)
+				continue;
+
+			if (single_add_guesses(current))
+				return 1;
+		} while ((current = current->next));
+	} else
+	if ((count = guessed_keys->count)) {
+		guesses = mem_alloc(length * count);
+		memcpy(guesses, guessed_keys->buffer, length * count);
 
-		keys->ptr = keys->buffer;
+		ptr = guesses;
 		do {
 			current = single_db->salts;
 			do {
 				if (current == salt || !current->list)
 					continue;
 
-				if (single_add_key(current, keys->ptr, 1))
+				if (single_add_key(current, ptr, 1))
 					return 1;
 			} while ((current = current->next));
-			keys->ptr += length;
-		} while (--keys->count);
+			ptr += length;
+		} while (--count);
 
-		MEM_FREE(keys);
+		MEM_FREE(guesses);
 	}
 
 	keys = salt->keys;
@@ -420,14 +642,14 @@ no_own_words:
 	return 0;
 }
 
-static void single_run(void)
+/*
+ * Get the next rule that is for this node and valid for the format, or NULL
+ * when we're out of rules.  rule_number is that of the returned rule.
+ */
+static char *single_next_rule(void)
 {
 	char *prerule, *rule;
-	struct db_salt *salt;
-	int min, saved_min;
-	int have_words;
 
-	saved_min = rec_rule;
 	while ((prerule = rpp_next(rule_ctx))) {
 		if (options.node_count) {
 			int for_node = rule_number % options.node_count + 1;
@@ -455,6 +677,21 @@ static void single_run(void)
 				rule_number + 1, prerule);
 		}
 
+		return rule;
+	}
+
+	return NULL;
+}
+
+static void single_run(void)
+{
+	char *rule;
+	struct db_salt *salt;
+	int min, saved_min;
+	int have_words;
+
+	saved_min = rec_rule;
+	while ((rule = single_next_rule())) {
 		if (saved_min != rec_rule) {
 			if (options.verbosity > 2)
 			log_event("- Oldest still in use is now rule #%d",
@@ -496,6 +733,103 @@ static void single_run(void)
 	}
 }
 
+/*
+ * With --single-mem: run blocks of rules over groups of salts, so that each
+ * salt in a group holds a key buffer until the block is done.
+ */
+static int single_run_group(int count, int rules)
+{
+	struct db_salt *salt;
+	int index, rule;
+
+	for (index = 0; index < count; index++) {
+		salt = group[index];
+		if (salt->list && single_add_guesses(salt))
+			return 1;
+	}
+
+	for (rule = 0; rule < rules; rule++) {
+		rule_number = block_numbers[rule];
+
+		for (index = 0; index < count; index++) {
+			salt = group[index];
+			if (!salt->list)
+				continue;
+			if (single_process_salt(salt, block_rules[rule]))
+				return 1;
+		}
+
+		if (event_reload && single_db->salts)
+			crk_reload_pot();
+	}
+
+	for (index = 0; index < count; index++) {
+		salt = group[index];
+		if (salt->list && salt->keys->count &&
+		    single_process_buffer(salt))
+			return 1;
+	}
+
+	return 0;
+}
+
+static void single_run_groups(void)
+{
+	char *rule;
+	struct db_salt *salt;
+	int rules, count, index, have_words, done = 0;
+
+	while (!done) {
+		for (rules = 0; rules < block_size &&
+		     (rule = single_next_rule()); rules++) {
+			block_rules[rules] = mem_alloc(strlen(rule) + 1);
+			strcpy(block_rules[rules], rule);
+			block_numbers[rules] = rule_number++;
+		}
+		if (!rules)
+			break;
+		block_end = rule_number;
+		block_salts = have_words = 0;
+
+		salt = single_db->salts;
+		while (salt && !done) {
+			count = 0;
+			do {
+				if (salt->list)
+					group[count++] = salt;
+			} while ((salt = salt->next) && count < group_size);
+
+			if (single_run_group(count, rules)) {
+				done = 1;
+				break;
+			}
+
+			for (index = 0; index < count; index++)
+			if (group[index]->keys->have_words) {
+				have_words = 1;
+				break;
+			}
+
+			block_salts += count;
+		}
+
+		for (index = 0; index < rules; index++)
+			MEM_FREE(block_rules[index]);
+
+		if (done || !single_db->salts)
+			break;
+
+		rec_rule = rule_number = block_end;
+
+		if (!have_words) {
+			log_event("- No information to base%s candidate "
+				"passwords on",
+				rule_number > 1 ? " further" : "");
+			break;
+		}
+	}
+}
+
 static void single_done(void)
 {
 	struct db_salt *salt;
@@ -508,6 +842,8 @@ static void single_done(void)
 			do {
 				if (!salt->list)
 					continue;
+				if (buf_max && single_add_guesses(salt))
+					break;
 				if (salt->keys->count)
 					if (single_process_buffer(salt))
 						break;
@@ -517,6 +853,23 @@ static void single_done(void)
 		progress = 100;
 	}
 
+	if (buf_max)
+		log_event("- Used %d shared key buffers, flushed early " LLu " time%s",
+			buf_count, buf_flushes, buf_flushes != 1 ? "s" : "");
+
+	while (buf_head) {
+		struct single_buf *next = buf_head->next;
+
+		MEM_FREE(buf_head->hash);
+		MEM_FREE(buf_head);
+		buf_head = next;
+	}
+	buf_tail = NULL;
+	MEM_FREE(block_rules);
+	MEM_FREE(block_numbers);
+	MEM_FREE(group);
+	MEM_FREE(guess_list);
+
 	rec_done(event_abort || (status.pass && single_db->salts));
 }
 
@@ -527,7 +880,10 @@ void do_single_crack(struct db_main *db)
 	single_db = db;
 	rule_ctx = &ctx;
 	single_init();
-	single_run();
+	if (buf_max)
+		single_run_groups();
+	else
+		single_run();
 	single_done();
 	rule_ctx = NULL; /* Just for good measure */
 }
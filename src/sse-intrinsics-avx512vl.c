@@ -0,0 +1,19 @@
+/*
+ * sse-intrinsics.c built for AVX-512VL: the build's 128- or 256-bit vectors,
+ * with the native rotates and ternary logic of AVX-512.  See simd-dispatch.c.
+ *
+ * No copyright is claimed, and the software is hereby placed in the public
+ * domain.  In case this attempt to disclaim copyright and place the software
+ * in the public domain is deemed null and void, then the software is
+ * hereby released to the general public under the following terms:
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted.
+ */
+
+#include "arch.h"
+
+#if SIMD_DISPATCH
+#pragma GCC target("avx512vl")
+#define SIMD_VARIANT			avx512vl
+#include "sse-intrinsics.c"
+#endif
@@ -30,6 +30,7 @@ typedef enum {
 	SSEi_2BUF_INPUT_FIRST_BLK=(0x40|0x80),  // input array 2x in size.  This is the first block, so we MUST rotate element 14/15 if in flat mode.
 	SSEi_4BUF_INPUT=0x100,        // input array is 4x in size (This is seen in the dynamic type, for sha256. We have 256 byte input buffers there).
 	SSEi_4BUF_INPUT_FIRST_BLK=(0x100|0x200),  // input array 4x in size.  This is the first block, so we MUST rotate element 14/15 if in flat mode.
+	SSEi_REVERSE_STEPS=0x400,     // MD4/MD5 only: stop after the last step writing 'a', and do no final add. Output 'a' is then the digest's first word minus its IV, b/c/d are mid-round state (the format finishes those in cmp_one). ONLY valid if not doing reload.
 
 	// this are specific to SHA2 hashes. Can be the same bit, since only 1 will be used (i.e. it is not valid to do SSE_CRYPT_SHA224|SSE_CRYPT_SHA224 and expect both to be loaded)
 	// WARNING, SHA224 requires a FULL SHA256 width output buffer, and SHA384 requires a full SHA512 width output buffer.  This is to allow proper reloading and doing multi-limb crypts.
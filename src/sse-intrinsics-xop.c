@@ -0,0 +1,19 @@
+/*
+ * sse-intrinsics.c built for XOP (AMD Bulldozer family): 128-bit vectors
+ * with native rotates and vpcmov.  See simd-dispatch.c.
+ *
+ * No copyright is claimed, and the software is hereby placed in the public
+ * domain.  In case this attempt to disclaim copyright and place the software
+ * in the public domain is deemed null and void, then the software is
+ * hereby released to the general public under the following terms:
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted.
+ */
+
+#include "arch.h"
+
+#if SIMD_DISPATCH && MMX_COEF == 4
+#pragma GCC target("xop")
+#define SIMD_VARIANT			xop
+#include "sse-intrinsics.c"
+#endif
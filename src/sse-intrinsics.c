@@ -43,7 +43,7 @@
 #include "arch.h"
 #include <string.h>
 #include <emmintrin.h>
-#ifdef __XOP__
+#if defined(__XOP__) || defined(__AVX2__)
 #include <x86intrin.h>
 #elif defined __SSE4_1__
 #include <smmintrin.h>
@@ -61,6 +61,23 @@
 
 #include "memdbg.h"
 
+/*
+ * In SIMD_DISPATCH builds this file is also compiled for newer instruction
+ * sets by the sse-intrinsics-*.c wrappers.  Each build gets its own suffix
+ * on the entry points, and simd-dispatch.c provides the real ones.
+ */
+#if SIMD_DISPATCH
+#ifndef SIMD_VARIANT
+#define SIMD_VARIANT			base
+#endif
+#define md5cryptsse			SIMD_NAME(md5cryptsse, SIMD_VARIANT)
+#define SSEmd5body			SIMD_NAME(SSEmd5body, SIMD_VARIANT)
+#define SSEmd4body			SIMD_NAME(SSEmd4body, SIMD_VARIANT)
+#define SSESHA1body			SIMD_NAME(SSESHA1body, SIMD_VARIANT)
+#define SSESHA256body			SIMD_NAME(SSESHA256body, SIMD_VARIANT)
+#define SSESHA512body			SIMD_NAME(SSESHA512body, SIMD_VARIANT)
+#endif
+
 #if defined (_MSC_VER) && !defined (_M_X64)
 /* These are slow, but the F'n 32 bit compiler will not build these intrinsics.
    Only the 64-bit (Win64) MSVC compiler has these as intrinsics. These slow
@@ -180,6 +197,156 @@ _inline __m128i _mm_set1_epi64x(long long a)
 #endif
 #define GATHER64(x,y,z)		{x = _mm_set_epi64x (y[1][z], y[0][z]);}
 
+/*
+ * All of the code below works on vtype vectors of MMX_COEF 32-bit lanes
+ * (or MMX_COEF/2 64-bit lanes for SHA-512) through these v* wrappers, so
+ * it builds for 128-bit SSE/XOP, 256-bit AVX2 or 512-bit AVX-512 from the
+ * same source.  AVX-512VL (only seen here in SIMD_DISPATCH builds) brings
+ * native rotates and ternary logic to the narrower vectors as well.
+ */
+#if MMX_COEF == 16
+typedef __m512i vtype;
+
+#define vadd_epi32		_mm512_add_epi32
+#define vand			_mm512_and_si512
+#define vandnot			_mm512_andnot_si512
+#define vor			_mm512_or_si512
+#define vxor			_mm512_xor_si512
+#define vload(m)		_mm512_load_si512((void *)(m))
+#define vstore(m, x)		_mm512_store_si512((void *)(m), (x))
+#define vset1_epi32		_mm512_set1_epi32
+#define vcmov(y, z, x)		_mm512_ternarylogic_epi32((x), (y), (z), 0xCA)
+#define vroti_epi32(a, s)	((s) < 0 ?	\
+	_mm512_ror_epi32((a), -(s)) : _mm512_rol_epi32((a), (s)))
+#define vroti16_epi32		vroti_epi32
+#define vswap32(n)		\
+	(n = _mm512_shuffle_epi8(n, _mm512_broadcast_i32x4(	\
+		_mm_set_epi32(0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203))))
+#define vadd_epi64		_mm512_add_epi64
+#define vsrli_epi32		_mm512_srli_epi32
+#define vsrli_epi64		_mm512_srli_epi64
+#define vset1_epi64x		_mm512_set1_epi64
+#define vroti_epi64(a, s)	((s) < 0 ?	\
+	_mm512_ror_epi64((a), -(s)) : _mm512_rol_epi64((a), (s)))
+#define vswap64(n)		\
+	(n = _mm512_shuffle_epi8(n, _mm512_broadcast_i32x4(	\
+		_mm_set_epi64x(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL))))
+#define vxor3(a, b, c)		_mm512_ternarylogic_epi32((a), (b), (c), 0x96)
+#define vmaj(x, y, z)		_mm512_ternarylogic_epi32((x), (y), (z), 0xE8)
+#define VGATHER_INDEX(s)	_mm512_mullo_epi32(_mm512_set1_epi32(s), \
+	_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+#define vgather_epi32(x, y, z, idx)	\
+	(x = _mm512_i32gather_epi32(idx, (void *)&(y)[z], 4))
+
+#elif MMX_COEF == 8
+typedef __m256i vtype;
+
+#define vadd_epi32		_mm256_add_epi32
+#define vand			_mm256_and_si256
+#define vandnot			_mm256_andnot_si256
+#define vor			_mm256_or_si256
+#define vxor			_mm256_xor_si256
+#define vload(m)		_mm256_load_si256((void *)(m))
+#define vstore(m, x)		_mm256_store_si256((void *)(m), (x))
+#define vset1_epi32		_mm256_set1_epi32
+#ifdef __AVX512VL__
+#define vcmov(y, z, x)		_mm256_ternarylogic_epi32((x), (y), (z), 0xCA)
+#define vroti_epi32(a, s)	((s) < 0 ?	\
+	_mm256_ror_epi32((a), -(s)) : _mm256_rol_epi32((a), (s)))
+#define vroti16_epi32		vroti_epi32
+#else
+#define vcmov(y, z, x)		\
+	(_mm256_xor_si256(z, _mm256_and_si256(x, _mm256_xor_si256(y, z))))
+#define vslli_epi32a(a, s)	\
+	((s) == 1 ? _mm256_add_epi32((a), (a)) : _mm256_slli_epi32((a), (s)))
+#define vroti_epi32(a, s)	((s) < 0 ?	\
+	_mm256_or_si256(_mm256_srli_epi32((a), -(s)),	\
+	                vslli_epi32a((a), 32 + (s))) :	\
+	_mm256_or_si256(vslli_epi32a((a), (s)),	\
+	                _mm256_srli_epi32((a), 32 - (s))))
+#define vroti16_epi32(a, s)	\
+	(_mm256_shuffle_epi8((a), _mm256_broadcastsi128_si256(	\
+		_mm_set_epi32(0x0d0c0f0e, 0x09080b0a, 0x05040706, 0x01000302))))
+#endif
+#define vswap32(n)		\
+	(n = _mm256_shuffle_epi8(n, _mm256_broadcastsi128_si256(	\
+		_mm_set_epi32(0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203))))
+#define vadd_epi64		_mm256_add_epi64
+#define vsrli_epi32		_mm256_srli_epi32
+#define vsrli_epi64		_mm256_srli_epi64
+#define vset1_epi64x		_mm256_set1_epi64x
+#ifdef __AVX512VL__
+#define vroti_epi64(a, s)	((s) < 0 ?	\
+	_mm256_ror_epi64((a), -(s)) : _mm256_rol_epi64((a), (s)))
+#define vxor3(a, b, c)		_mm256_ternarylogic_epi32((a), (b), (c), 0x96)
+#define vmaj(x, y, z)		_mm256_ternarylogic_epi32((x), (y), (z), 0xE8)
+#else
+#define vroti_epi64(a, s)	((s) < 0 ?	\
+	_mm256_or_si256(_mm256_srli_epi64((a), -(s)),	\
+	                _mm256_slli_epi64((a), 64 + (s))) :	\
+	_mm256_or_si256(_mm256_slli_epi64((a), (s)),	\
+	                _mm256_srli_epi64((a), 64 - (s))))
+#endif
+#define vswap64(n)		\
+	(n = _mm256_shuffle_epi8(n, _mm256_broadcastsi128_si256(	\
+		_mm_set_epi64x(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL))))
+#define VGATHER_INDEX(s)	\
+	_mm256_set_epi32(7 * (s), 6 * (s), 5 * (s), 4 * (s),	\
+	                 3 * (s), 2 * (s), (s), 0)
+#define vgather_epi32(x, y, z, idx)	\
+	(x = _mm256_i32gather_epi32((void *)&(y)[z], idx, 4))
+
+#else
+typedef __m128i vtype;
+
+#define vadd_epi32		_mm_add_epi32
+#define vand			_mm_and_si128
+#define vandnot			_mm_andnot_si128
+#define vor			_mm_or_si128
+#define vxor			_mm_xor_si128
+#define vload(m)		_mm_load_si128((void *)(m))
+#define vstore(m, x)		_mm_store_si128((void *)(m), (x))
+#define vset1_epi32		_mm_set1_epi32
+#ifdef __AVX512VL__
+#define vcmov(y, z, x)		_mm_ternarylogic_epi32((x), (y), (z), 0xCA)
+#define vroti_epi32(a, s)	((s) < 0 ?	\
+	_mm_ror_epi32((a), -(s)) : _mm_rol_epi32((a), (s)))
+#define vroti16_epi32		vroti_epi32
+#define vroti_epi64(a, s)	((s) < 0 ?	\
+	_mm_ror_epi64((a), -(s)) : _mm_rol_epi64((a), (s)))
+#define vxor3(a, b, c)		_mm_ternarylogic_epi32((a), (b), (c), 0x96)
+#define vmaj(x, y, z)		_mm_ternarylogic_epi32((x), (y), (z), 0xE8)
+#else
+#define vcmov			_mm_cmov_si128
+#define vroti_epi32		_mm_roti_epi32
+#define vroti16_epi32		_mm_roti16_epi32
+#define vroti_epi64		_mm_roti_epi64
+#endif
+#define vswap32			SWAP_ENDIAN
+#define vadd_epi64		_mm_add_epi64
+#define vsrli_epi32		_mm_srli_epi32
+#define vsrli_epi64		_mm_srli_epi64
+#define vset1_epi64x		_mm_set1_epi64x
+#define vswap64			SWAP_ENDIAN64
+#endif
+
+#ifndef vxor3
+#define vxor3(a, b, c)		vxor((a), vxor((b), (c)))
+#define vmaj(x, y, z)		vcmov((x), (y), vxor((z), (y)))
+#endif
+
+#ifdef __SSE4_1__
+#if MMX_COEF == 4
+#define VGATHER_4x		GATHER_4x
+#define VGATHER_2x		GATHER_2x
+#define VGATHER			GATHER
+#else
+#define VGATHER_4x(x, y, z)	vgather_epi32(x, y, z, VGATHER_INDEX(64))
+#define VGATHER_2x(x, y, z)	vgather_epi32(x, y, z, VGATHER_INDEX(32))
+#define VGATHER(x, y, z)	vgather_epi32(x, y, z, VGATHER_INDEX(16))
+#endif
+#endif
+
 
 #ifndef MMX_COEF
 #define MMX_COEF 4
@@ -190,66 +357,66 @@ _inline __m128i _mm_set1_epi64x(long long a)
 #define MD5_PARA_DO(x)	for((x)=0;(x)<MD5_SSE_PARA;(x)++)
 
 #define MD5_F(x,y,z) \
-	MD5_PARA_DO(i) tmp[i] = _mm_cmov_si128((y[i]),(z[i]),(x[i]));
+	MD5_PARA_DO(i) tmp[i] = vcmov((y[i]),(z[i]),(x[i]));
 
 #define MD5_G(x,y,z) \
-	MD5_PARA_DO(i) tmp[i] = _mm_cmov_si128((x[i]),(y[i]),(z[i]));
+	MD5_PARA_DO(i) tmp[i] = vcmov((x[i]),(y[i]),(z[i]));
 
 #define MD5_H(x,y,z) \
-	MD5_PARA_DO(i) tmp[i] = _mm_xor_si128((y[i]),(z[i])); \
-	MD5_PARA_DO(i) tmp[i] = _mm_xor_si128((tmp[i]),(x[i]));
+	MD5_PARA_DO(i) tmp[i] = vxor((y[i]),(z[i])); \
+	MD5_PARA_DO(i) tmp[i] = vxor((tmp[i]),(x[i]));
 
 #define MD5_I(x,y,z) \
-	MD5_PARA_DO(i) tmp[i] = _mm_andnot_si128((z[i]), mask); \
-	MD5_PARA_DO(i) tmp[i] = _mm_or_si128((tmp[i]),(x[i])); \
-	MD5_PARA_DO(i) tmp[i] = _mm_xor_si128((tmp[i]),(y[i]));
+	MD5_PARA_DO(i) tmp[i] = vandnot((z[i]), mask); \
+	MD5_PARA_DO(i) tmp[i] = vor((tmp[i]),(x[i])); \
+	MD5_PARA_DO(i) tmp[i] = vxor((tmp[i]),(y[i]));
 
 #define MD5_STEP(f, a, b, c, d, x, t, s) \
-	MD5_PARA_DO(i) a[i] = _mm_add_epi32( a[i], _mm_set_epi32(t,t,t,t) ); \
+	MD5_PARA_DO(i) a[i] = vadd_epi32( a[i], vset1_epi32(t) ); \
 	f((b),(c),(d)) \
-	MD5_PARA_DO(i) a[i] = _mm_add_epi32( a[i], tmp[i] ); \
-	MD5_PARA_DO(i) a[i] = _mm_add_epi32( a[i], data[i*16+x] ); \
-	MD5_PARA_DO(i) a[i] = _mm_roti_epi32( a[i], (s) ); \
-	MD5_PARA_DO(i) a[i] = _mm_add_epi32( a[i], b[i] );
+	MD5_PARA_DO(i) a[i] = vadd_epi32( a[i], tmp[i] ); \
+	MD5_PARA_DO(i) a[i] = vadd_epi32( a[i], data[i*16+x] ); \
+	MD5_PARA_DO(i) a[i] = vroti_epi32( a[i], (s) ); \
+	MD5_PARA_DO(i) a[i] = vadd_epi32( a[i], b[i] );
 
 #define MD5_STEP_r16(f, a, b, c, d, x, t, s) \
-	MD5_PARA_DO(i) a[i] = _mm_add_epi32( a[i], _mm_set_epi32(t,t,t,t) ); \
+	MD5_PARA_DO(i) a[i] = vadd_epi32( a[i], vset1_epi32(t) ); \
 	f((b),(c),(d)) \
-	MD5_PARA_DO(i) a[i] = _mm_add_epi32( a[i], tmp[i] ); \
-	MD5_PARA_DO(i) a[i] = _mm_add_epi32( a[i], data[i*16+x] ); \
-	MD5_PARA_DO(i) a[i] = _mm_roti16_epi32( a[i], (s) ); \
-	MD5_PARA_DO(i) a[i] = _mm_add_epi32( a[i], b[i] );
+	MD5_PARA_DO(i) a[i] = vadd_epi32( a[i], tmp[i] ); \
+	MD5_PARA_DO(i) a[i] = vadd_epi32( a[i], data[i*16+x] ); \
+	MD5_PARA_DO(i) a[i] = vroti16_epi32( a[i], (s) ); \
+	MD5_PARA_DO(i) a[i] = vadd_epi32( a[i], b[i] );
 
 void SSEmd5body(__m128i* _data, unsigned int * out, ARCH_WORD_32 *reload_state, unsigned SSEi_flags)
 {
-	__m128i w[16*MD5_SSE_PARA];
-	__m128i a[MD5_SSE_PARA];
-	__m128i b[MD5_SSE_PARA];
-	__m128i c[MD5_SSE_PARA];
-	__m128i d[MD5_SSE_PARA];
-	__m128i tmp[MD5_SSE_PARA];
-	__m128i mask;
+	vtype w[16*MD5_SSE_PARA];
+	vtype a[MD5_SSE_PARA];
+	vtype b[MD5_SSE_PARA];
+	vtype c[MD5_SSE_PARA];
+	vtype d[MD5_SSE_PARA];
+	vtype tmp[MD5_SSE_PARA];
+	vtype mask;
 	unsigned int i;
-	__m128i *data;
+	vtype *data;
 
-	mask = _mm_set1_epi32(0Xffffffff);
+	mask = vset1_epi32(0Xffffffff);
 
 	if(SSEi_flags & SSEi_FLAT_IN) {
 		// Move _data to __data, mixing it MMX_COEF wise.
 #ifdef __SSE4_1__
 		unsigned k;
-		__m128i *W = w;
+		vtype *W = w;
 		ARCH_WORD_32 *saved_key = (ARCH_WORD_32 *)_data;
 		MD5_PARA_DO(k)
 		{
 			if (SSEi_flags & SSEi_4BUF_INPUT) {
-				for (i=0; i < 16; ++i) { GATHER_4x (W[i], saved_key, i); }
+				for (i=0; i < 16; ++i) { VGATHER_4x (W[i], saved_key, i); }
 				saved_key += (MMX_COEF<<6);
 			} else if (SSEi_flags & SSEi_2BUF_INPUT) {
-				for (i=0; i < 16; ++i) { GATHER_2x (W[i], saved_key, i); }
+				for (i=0; i < 16; ++i) { VGATHER_2x (W[i], saved_key, i); }
 				saved_key += (MMX_COEF<<5);
 			} else {
-				for (i=0; i < 16; ++i) { GATHER (W[i], saved_key, i); }
+				for (i=0; i < 16; ++i) { VGATHER (W[i], saved_key, i); }
 				saved_key += (MMX_COEF<<4);
 			}
 			W += 16;
@@ -257,7 +424,7 @@ void SSEmd5body(__m128i* _data, unsigned int * out, ARCH_WORD_32 *reload_state,
 #else
 		unsigned j, k;
 		ARCH_WORD_32 *p = (ARCH_WORD_32 *)w;
-		__m128i *W = w;
+		vtype *W = w;
 		ARCH_WORD_32 *saved_key = (ARCH_WORD_32 *)_data;
 		MD5_PARA_DO(k)
 		{
@@ -283,16 +450,16 @@ void SSEmd5body(__m128i* _data, unsigned int * out, ARCH_WORD_32 *reload_state,
 		// now set our data pointer to point to this 'mixed' data.
 		data = w;
 	} else
-		data = _data;
+		data = (vtype*)_data;
 
 	if((SSEi_flags & SSEi_RELOAD)==0)
 	{
 		MD5_PARA_DO(i)
 		{
-			a[i] = _mm_set1_epi32(0x67452301);
-			b[i] = _mm_set1_epi32(0xefcdab89);
-			c[i] = _mm_set1_epi32(0x98badcfe);
-			d[i] = _mm_set1_epi32(0x10325476);
+			a[i] = vset1_epi32(0x67452301);
+			b[i] = vset1_epi32(0xefcdab89);
+			c[i] = vset1_epi32(0x98badcfe);
+			d[i] = vset1_epi32(0x10325476);
 		}
 	}
 	else
@@ -301,20 +468,20 @@ void SSEmd5body(__m128i* _data, unsigned int * out, ARCH_WORD_32 *reload_state,
 		{
 			MD5_PARA_DO(i)
 			{
-				a[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+0]);
-				b[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+4]);
-				c[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+8]);
-				d[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+12]);
+				a[i] = vload(&reload_state[i*16*MMX_COEF+0]);
+				b[i] = vload(&reload_state[i*16*MMX_COEF+MMX_COEF]);
+				c[i] = vload(&reload_state[i*16*MMX_COEF+2*MMX_COEF]);
+				d[i] = vload(&reload_state[i*16*MMX_COEF+3*MMX_COEF]);
 			}
 		}
 		else
 		{
 			MD5_PARA_DO(i)
 			{
-				a[i] = _mm_load_si128((__m128i *)&reload_state[i*16+0]);
-				b[i] = _mm_load_si128((__m128i *)&reload_state[i*16+4]);
-				c[i] = _mm_load_si128((__m128i *)&reload_state[i*16+8]);
-				d[i] = _mm_load_si128((__m128i *)&reload_state[i*16+12]);
+				a[i] = vload(&reload_state[i*4*MMX_COEF+0]);
+				b[i] = vload(&reload_state[i*4*MMX_COEF+MMX_COEF]);
+				c[i] = vload(&reload_state[i*4*MMX_COEF+2*MMX_COEF]);
+				d[i] = vload(&reload_state[i*4*MMX_COEF+3*MMX_COEF]);
 			}
 		}
 	}
@@ -387,40 +554,42 @@ void SSEmd5body(__m128i* _data, unsigned int * out, ARCH_WORD_32 *reload_state,
 		MD5_STEP(MD5_I, c, d, a, b, 6, 0xa3014314, 15)
 		MD5_STEP(MD5_I, b, c, d, a, 13, 0x4e0811a1, 21)
 		MD5_STEP(MD5_I, a, b, c, d, 4, 0xf7537e82, 6)
+		if (!(SSEi_flags & SSEi_REVERSE_STEPS)) {
 		MD5_STEP(MD5_I, d, a, b, c, 11, 0xbd3af235, 10)
 		MD5_STEP(MD5_I, c, d, a, b, 2, 0x2ad7d2bb, 15)
 		MD5_STEP(MD5_I, b, c, d, a, 9, 0xeb86d391, 21)
+		}
 
-	if((SSEi_flags & SSEi_RELOAD)==0)
+	if((SSEi_flags & (SSEi_RELOAD|SSEi_REVERSE_STEPS))==0)
 	{
 		MD5_PARA_DO(i)
 		{
-			a[i] = _mm_add_epi32(a[i], _mm_set1_epi32(0x67452301));
-			b[i] = _mm_add_epi32(b[i], _mm_set1_epi32(0xefcdab89));
-			c[i] = _mm_add_epi32(c[i], _mm_set1_epi32(0x98badcfe));
-			d[i] = _mm_add_epi32(d[i], _mm_set1_epi32(0x10325476));
+			a[i] = vadd_epi32(a[i], vset1_epi32(0x67452301));
+			b[i] = vadd_epi32(b[i], vset1_epi32(0xefcdab89));
+			c[i] = vadd_epi32(c[i], vset1_epi32(0x98badcfe));
+			d[i] = vadd_epi32(d[i], vset1_epi32(0x10325476));
 		}
 	}
-	else
+	else if (SSEi_flags & SSEi_RELOAD)
 	{
 		if ((SSEi_flags & SSEi_RELOAD_INP_FMT)==SSEi_RELOAD_INP_FMT)
 		{
 			MD5_PARA_DO(i)
 			{
-				a[i] = _mm_add_epi32(a[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+0]));
-				b[i] = _mm_add_epi32(b[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+4]));
-				c[i] = _mm_add_epi32(c[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+8]));
-				d[i] = _mm_add_epi32(d[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+12]));
+				a[i] = vadd_epi32(a[i], vload(&reload_state[i*16*MMX_COEF+0]));
+				b[i] = vadd_epi32(b[i], vload(&reload_state[i*16*MMX_COEF+MMX_COEF]));
+				c[i] = vadd_epi32(c[i], vload(&reload_state[i*16*MMX_COEF+2*MMX_COEF]));
+				d[i] = vadd_epi32(d[i], vload(&reload_state[i*16*MMX_COEF+3*MMX_COEF]));
 			}
 		}
 		else
 		{
 			MD5_PARA_DO(i)
 			{
-				a[i] = _mm_add_epi32(a[i], _mm_load_si128((__m128i *)&reload_state[i*16+0]));
-				b[i] = _mm_add_epi32(b[i], _mm_load_si128((__m128i *)&reload_state[i*16+4]));
-				c[i] = _mm_add_epi32(c[i], _mm_load_si128((__m128i *)&reload_state[i*16+8]));
-				d[i] = _mm_add_epi32(d[i], _mm_load_si128((__m128i *)&reload_state[i*16+12]));
+				a[i] = vadd_epi32(a[i], vload(&reload_state[i*4*MMX_COEF+0]));
+				b[i] = vadd_epi32(b[i], vload(&reload_state[i*4*MMX_COEF+MMX_COEF]));
+				c[i] = vadd_epi32(c[i], vload(&reload_state[i*4*MMX_COEF+2*MMX_COEF]));
+				d[i] = vadd_epi32(d[i], vload(&reload_state[i*4*MMX_COEF+3*MMX_COEF]));
 			}
 		}
 	}
@@ -428,32 +597,32 @@ void SSEmd5body(__m128i* _data, unsigned int * out, ARCH_WORD_32 *reload_state,
 	{
 		MD5_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*16*4+0], a[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+4], b[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+8], c[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+12], d[i]);
+			vstore(&out[i*16*MMX_COEF+0], a[i]);
+			vstore(&out[i*16*MMX_COEF+MMX_COEF], b[i]);
+			vstore(&out[i*16*MMX_COEF+2*MMX_COEF], c[i]);
+			vstore(&out[i*16*MMX_COEF+3*MMX_COEF], d[i]);
 		}
 	}
 	else
 	{
 		MD5_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*16+0], a[i]);
-			_mm_store_si128((__m128i *)&out[i*16+4], b[i]);
-			_mm_store_si128((__m128i *)&out[i*16+8], c[i]);
-			_mm_store_si128((__m128i *)&out[i*16+12], d[i]);
+			vstore(&out[i*4*MMX_COEF+0], a[i]);
+			vstore(&out[i*4*MMX_COEF+MMX_COEF], b[i]);
+			vstore(&out[i*4*MMX_COEF+2*MMX_COEF], c[i]);
+			vstore(&out[i*4*MMX_COEF+3*MMX_COEF], d[i]);
 		}
 	}
 }
 
-#define GETPOS(i, index)                ( (index&3)*4 + (i& (0xffffffff-3) )*MMX_COEF + ((i)&3) )
+#define GETPOS(i, index)                ( (index&(MMX_COEF-1))*4 + (i& (0xffffffff-3) )*MMX_COEF + ((i)&3) )
 
 static MAYBE_INLINE void mmxput(void * buf, unsigned int index, unsigned int bid, unsigned int offset, unsigned char * src, unsigned int len)
 {
 	unsigned char * nbuf;
 	unsigned int i;
 
-	nbuf = ((unsigned char*)buf) + (index>>2)*64*MMX_COEF + bid*64*MD5_SSE_NUM_KEYS;
+	nbuf = ((unsigned char*)buf) + (index/MMX_COEF)*64*MMX_COEF + bid*64*MD5_SSE_NUM_KEYS;
 	for(i=0;i<len;i++)
 		nbuf[ GETPOS((offset+i), index) ] = src[i];
 
@@ -466,7 +635,7 @@ static MAYBE_INLINE void mmxput2(void * buf, unsigned int bid, void * src)
 
 	nbuf = ((unsigned char*)buf) + bid*64*MD5_SSE_NUM_KEYS;
 	MD5_PARA_DO(i)
-		memcpy( nbuf+i*64*MMX_COEF, ((unsigned char*)src)+i*64, 64);
+		memcpy( nbuf+i*64*MMX_COEF, ((unsigned char*)src)+i*16*MMX_COEF, 16*MMX_COEF);
 }
 
 static MAYBE_INLINE void mmxput3(void * buf, unsigned int bid, unsigned int * offset, int mult, int saltlen, void * src)
@@ -487,20 +656,20 @@ static MAYBE_INLINE void mmxput3(void * buf, unsigned int bid, unsigned int * of
 			if(dec)
 			{
 				noffd = noff & (~3);
-				((unsigned int *)(nbuf+noffd*4))[i] &= (0xffffffff>>(32-dec));
-				((unsigned int *)(nbuf+noffd*4))[i] |= (((unsigned int *)src)[i+j*16+0] << dec);
-				((unsigned int *)(nbuf+noffd*4))[i+4] = (((unsigned int *)src)[i+j*16+4] << dec) | (((unsigned int *)src)[i+j*16+0] >> (32-dec));
-				((unsigned int *)(nbuf+noffd*4))[i+8] = (((unsigned int *)src)[i+j*16+8] << dec) | (((unsigned int *)src)[i+j*16+4] >> (32-dec));
-				((unsigned int *)(nbuf+noffd*4))[i+12] = (((unsigned int *)src)[i+j*16+12] << dec) | (((unsigned int *)src)[i+j*16+8] >> (32-dec));
-				((unsigned int *)(nbuf+noffd*4))[i+16] &= (0xffffffff<<dec);
-				((unsigned int *)(nbuf+noffd*4))[i+16] |= (((unsigned int *)src)[i+j*16+12] >> (32-dec));
+				((unsigned int *)(nbuf+noffd*MMX_COEF))[i] &= (0xffffffff>>(32-dec));
+				((unsigned int *)(nbuf+noffd*MMX_COEF))[i] |= (((unsigned int *)src)[i+j*4*MMX_COEF+0] << dec);
+				((unsigned int *)(nbuf+noffd*MMX_COEF))[i+MMX_COEF] = (((unsigned int *)src)[i+j*4*MMX_COEF+MMX_COEF] << dec) | (((unsigned int *)src)[i+j*4*MMX_COEF+0] >> (32-dec));
+				((unsigned int *)(nbuf+noffd*MMX_COEF))[i+2*MMX_COEF] = (((unsigned int *)src)[i+j*4*MMX_COEF+2*MMX_COEF] << dec) | (((unsigned int *)src)[i+j*4*MMX_COEF+MMX_COEF] >> (32-dec));
+				((unsigned int *)(nbuf+noffd*MMX_COEF))[i+3*MMX_COEF] = (((unsigned int *)src)[i+j*4*MMX_COEF+3*MMX_COEF] << dec) | (((unsigned int *)src)[i+j*4*MMX_COEF+2*MMX_COEF] >> (32-dec));
+				((unsigned int *)(nbuf+noffd*MMX_COEF))[i+4*MMX_COEF] &= (0xffffffff<<dec);
+				((unsigned int *)(nbuf+noffd*MMX_COEF))[i+4*MMX_COEF] |= (((unsigned int *)src)[i+j*4*MMX_COEF+3*MMX_COEF] >> (32-dec));
 			}
 			else
 			{
-				((unsigned int *)(nbuf+noff*4))[i] = ((unsigned int *)src)[i+j*16+0];
-				((unsigned int *)(nbuf+noff*4))[i+4] = ((unsigned int *)src)[i+j*16+4];
-				((unsigned int *)(nbuf+noff*4))[i+8] = ((unsigned int *)src)[i+j*16+8];
-				((unsigned int *)(nbuf+noff*4))[i+12] = ((unsigned int *)src)[i+j*16+12];
+				((unsigned int *)(nbuf+noff*MMX_COEF))[i] = ((unsigned int *)src)[i+j*4*MMX_COEF+0];
+				((unsigned int *)(nbuf+noff*MMX_COEF))[i+MMX_COEF] = ((unsigned int *)src)[i+j*4*MMX_COEF+MMX_COEF];
+				((unsigned int *)(nbuf+noff*MMX_COEF))[i+2*MMX_COEF] = ((unsigned int *)src)[i+j*4*MMX_COEF+2*MMX_COEF];
+				((unsigned int *)(nbuf+noff*MMX_COEF))[i+3*MMX_COEF] = ((unsigned int *)src)[i+j*4*MMX_COEF+3*MMX_COEF];
 			}
 		}
 	}
@@ -596,8 +765,8 @@ void md5cryptsse(unsigned char pwd[MD5_SSE_NUM_KEYS][16], unsigned char * salt,
 	unsigned int i,j;
 	MD5_CTX ctx;
 	MD5_CTX tctx;
-	JTR_ALIGN(16) unsigned char buffers[8][64*MD5_SSE_NUM_KEYS];
-	JTR_ALIGN(16) unsigned int F[4*MD5_SSE_NUM_KEYS];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned char buffers[8][64*MD5_SSE_NUM_KEYS];
+	JTR_ALIGN(MEM_ALIGN_SIMD) unsigned int F[4*MD5_SSE_NUM_KEYS];
 
 	memset(F,0,sizeof(F));
 	memset(buffers, 0, sizeof(buffers));
@@ -638,14 +807,14 @@ void md5cryptsse(unsigned char pwd[MD5_SSE_NUM_KEYS][16], unsigned char * salt,
 		mmxput(buffers, i, 7, length_i+saltlen, pwd[i], length_i);
 		mmxput(buffers, i, 7, saltlen+2*length_i+16, (unsigned char *)"\x80", 1);
 
-		bt = (unsigned int *) &buffers[0]; bt[14*MMX_COEF + (i&3) + (i>>2)*64] = (length_i+16)<<3;
-		bt = (unsigned int *) &buffers[1]; bt[14*MMX_COEF + (i&3) + (i>>2)*64] = (length_i+16)<<3;
-		bt = (unsigned int *) &buffers[2]; bt[14*MMX_COEF + (i&3) + (i>>2)*64] = (length_i*2+16)<<3;
-		bt = (unsigned int *) &buffers[3]; bt[14*MMX_COEF + (i&3) + (i>>2)*64] = (length_i*2+16)<<3;
-		bt = (unsigned int *) &buffers[4]; bt[14*MMX_COEF + (i&3) + (i>>2)*64] = (length_i+saltlen+16)<<3;
-		bt = (unsigned int *) &buffers[5]; bt[14*MMX_COEF + (i&3) + (i>>2)*64] = (length_i+saltlen+16)<<3;
-		bt = (unsigned int *) &buffers[6]; bt[14*MMX_COEF + (i&3) + (i>>2)*64] = (length_i*2+saltlen+16)<<3;
-		bt = (unsigned int *) &buffers[7]; bt[14*MMX_COEF + (i&3) + (i>>2)*64] = (length_i*2+saltlen+16)<<3;
+		bt = (unsigned int *) &buffers[0]; bt[14*MMX_COEF + (i&(MMX_COEF-1)) + (i/MMX_COEF)*16*MMX_COEF] = (length_i+16)<<3;
+		bt = (unsigned int *) &buffers[1]; bt[14*MMX_COEF + (i&(MMX_COEF-1)) + (i/MMX_COEF)*16*MMX_COEF] = (length_i+16)<<3;
+		bt = (unsigned int *) &buffers[2]; bt[14*MMX_COEF + (i&(MMX_COEF-1)) + (i/MMX_COEF)*16*MMX_COEF] = (length_i*2+16)<<3;
+		bt = (unsigned int *) &buffers[3]; bt[14*MMX_COEF + (i&(MMX_COEF-1)) + (i/MMX_COEF)*16*MMX_COEF] = (length_i*2+16)<<3;
+		bt = (unsigned int *) &buffers[4]; bt[14*MMX_COEF + (i&(MMX_COEF-1)) + (i/MMX_COEF)*16*MMX_COEF] = (length_i+saltlen+16)<<3;
+		bt = (unsigned int *) &buffers[5]; bt[14*MMX_COEF + (i&(MMX_COEF-1)) + (i/MMX_COEF)*16*MMX_COEF] = (length_i+saltlen+16)<<3;
+		bt = (unsigned int *) &buffers[6]; bt[14*MMX_COEF + (i&(MMX_COEF-1)) + (i/MMX_COEF)*16*MMX_COEF] = (length_i*2+saltlen+16)<<3;
+		bt = (unsigned int *) &buffers[7]; bt[14*MMX_COEF + (i&(MMX_COEF-1)) + (i/MMX_COEF)*16*MMX_COEF] = (length_i*2+saltlen+16)<<3;
 
 		MD5_Init(&ctx);
 		MD5_Update(&ctx, pwd[i], length_i);
@@ -668,10 +837,10 @@ void md5cryptsse(unsigned char pwd[MD5_SSE_NUM_KEYS][16], unsigned char * salt,
 			else
 				MD5_Update(&ctx, pwd[i], 1);
 		MD5_Final((unsigned char *)tf, &ctx);
-		F[(i>>2)*16 + (i&3)] = tf[0];
-		F[(i>>2)*16 + (i&3) + 4] = tf[1];
-		F[(i>>2)*16 + (i&3) + 8] = tf[2];
-		F[(i>>2)*16 + (i&3) + 12] = tf[3];
+		F[(i/MMX_COEF)*4*MMX_COEF + (i&(MMX_COEF-1))] = tf[0];
+		F[(i/MMX_COEF)*4*MMX_COEF + (i&(MMX_COEF-1)) + MMX_COEF] = tf[1];
+		F[(i/MMX_COEF)*4*MMX_COEF + (i&(MMX_COEF-1)) + 2*MMX_COEF] = tf[2];
+		F[(i/MMX_COEF)*4*MMX_COEF + (i&(MMX_COEF-1)) + 3*MMX_COEF] = tf[3];
 	}
 	dispatch(buffers, F, length, saltlen);
 	memcpy(out, F, MD5_SSE_NUM_KEYS*16);
@@ -683,54 +852,54 @@ void md5cryptsse(unsigned char pwd[MD5_SSE_NUM_KEYS][16], unsigned char * salt,
 #define MD4_PARA_DO(x)	for((x)=0;(x)<MD4_SSE_PARA;(x)++)
 
 #define MD4_F(x,y,z) \
-	MD4_PARA_DO(i) tmp[i] = _mm_cmov_si128((y[i]),(z[i]),(x[i]));
+	MD4_PARA_DO(i) tmp[i] = vcmov((y[i]),(z[i]),(x[i]));
 
 #define MD4_G(x,y,z) \
-	MD4_PARA_DO(i) tmp[i] = _mm_or_si128((y[i]),(z[i])); \
-	MD4_PARA_DO(i) tmp2[i] = _mm_and_si128((y[i]),(z[i])); \
-	MD4_PARA_DO(i) tmp[i] = _mm_and_si128((tmp[i]),(x[i])); \
-	MD4_PARA_DO(i) tmp[i] = _mm_or_si128((tmp[i]), (tmp2[i]) );
+	MD4_PARA_DO(i) tmp[i] = vor((y[i]),(z[i])); \
+	MD4_PARA_DO(i) tmp2[i] = vand((y[i]),(z[i])); \
+	MD4_PARA_DO(i) tmp[i] = vand((tmp[i]),(x[i])); \
+	MD4_PARA_DO(i) tmp[i] = vor((tmp[i]), (tmp2[i]) );
 
 #define MD4_H(x,y,z) \
-	MD4_PARA_DO(i) tmp[i] = _mm_xor_si128((y[i]),(z[i])); \
-	MD4_PARA_DO(i) tmp[i] = _mm_xor_si128((tmp[i]),(x[i]));
+	MD4_PARA_DO(i) tmp[i] = vxor((y[i]),(z[i])); \
+	MD4_PARA_DO(i) tmp[i] = vxor((tmp[i]),(x[i]));
 
 #define MD4_STEP(f, a, b, c, d, x, t, s) \
-	MD4_PARA_DO(i) a[i] = _mm_add_epi32( a[i], t ); \
+	MD4_PARA_DO(i) a[i] = vadd_epi32( a[i], t ); \
 	f((b),(c),(d)) \
-	MD4_PARA_DO(i) a[i] = _mm_add_epi32( a[i], tmp[i] ); \
-	MD4_PARA_DO(i) a[i] = _mm_add_epi32( a[i], data[i*16+x] ); \
-	MD4_PARA_DO(i) a[i] = _mm_roti_epi32( a[i], (s) );
+	MD4_PARA_DO(i) a[i] = vadd_epi32( a[i], tmp[i] ); \
+	MD4_PARA_DO(i) a[i] = vadd_epi32( a[i], data[i*16+x] ); \
+	MD4_PARA_DO(i) a[i] = vroti_epi32( a[i], (s) );
 
 void SSEmd4body(__m128i* _data, unsigned int * out, ARCH_WORD_32 *reload_state, unsigned SSEi_flags)
 {
-	__m128i w[16*MD4_SSE_PARA];
-	__m128i a[MD4_SSE_PARA];
-	__m128i b[MD4_SSE_PARA];
-	__m128i c[MD4_SSE_PARA];
-	__m128i d[MD4_SSE_PARA];
-	__m128i tmp[MD4_SSE_PARA];
-	__m128i tmp2[MD4_SSE_PARA];
-	__m128i	cst;
+	vtype w[16*MD4_SSE_PARA];
+	vtype a[MD4_SSE_PARA];
+	vtype b[MD4_SSE_PARA];
+	vtype c[MD4_SSE_PARA];
+	vtype d[MD4_SSE_PARA];
+	vtype tmp[MD4_SSE_PARA];
+	vtype tmp2[MD4_SSE_PARA];
+	vtype	cst;
 	unsigned int i;
-	__m128i *data;
+	vtype *data;
 
 if(SSEi_flags & SSEi_FLAT_IN) {
 		// Move _data to __data, mixing it MMX_COEF wise.
 #ifdef __SSE4_1__
 		unsigned k;
-		__m128i *W = w;
+		vtype *W = w;
 		ARCH_WORD_32 *saved_key = (ARCH_WORD_32 *)_data;
 		MD4_PARA_DO(k)
 		{
 			if (SSEi_flags & SSEi_4BUF_INPUT) {
-				for (i=0; i < 16; ++i) { GATHER_4x (W[i], saved_key, i); }
+				for (i=0; i < 16; ++i) { VGATHER_4x (W[i], saved_key, i); }
 				saved_key += (MMX_COEF<<6);
 			} else if (SSEi_flags & SSEi_2BUF_INPUT) {
-				for (i=0; i < 16; ++i) { GATHER_2x (W[i], saved_key, i); }
+				for (i=0; i < 16; ++i) { VGATHER_2x (W[i], saved_key, i); }
 				saved_key += (MMX_COEF<<5);
 			} else {
-				for (i=0; i < 16; ++i) { GATHER (W[i], saved_key, i); }
+				for (i=0; i < 16; ++i) { VGATHER (W[i], saved_key, i); }
 				saved_key += (MMX_COEF<<4);
 			}
 			W += 16;
@@ -738,7 +907,7 @@ if(SSEi_flags & SSEi_FLAT_IN) {
 #else
 		unsigned j, k;
 		ARCH_WORD_32 *p = (ARCH_WORD_32 *)w;
-		__m128i *W = w;
+		vtype *W = w;
 		ARCH_WORD_32 *saved_key = (ARCH_WORD_32 *)_data;
 		MD4_PARA_DO(k)
 		{
@@ -764,16 +933,16 @@ if(SSEi_flags & SSEi_FLAT_IN) {
 		// now set our data pointer to point to this 'mixed' data.
 		data = w;
 	} else
-		data = _data;
+		data = (vtype*)_data;
 
 	if((SSEi_flags & SSEi_RELOAD)==0)
 	{
 		MD4_PARA_DO(i)
 		{
-			a[i] = _mm_set1_epi32(0x67452301);
-			b[i] = _mm_set1_epi32(0xefcdab89);
-			c[i] = _mm_set1_epi32(0x98badcfe);
-			d[i] = _mm_set1_epi32(0x10325476);
+			a[i] = vset1_epi32(0x67452301);
+			b[i] = vset1_epi32(0xefcdab89);
+			c[i] = vset1_epi32(0x98badcfe);
+			d[i] = vset1_epi32(0x10325476);
 		}
 	}
 	else
@@ -782,27 +951,27 @@ if(SSEi_flags & SSEi_FLAT_IN) {
 		{
 			MD4_PARA_DO(i)
 			{
-				a[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+0]);
-				b[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+4]);
-				c[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+8]);
-				d[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+12]);
+				a[i] = vload(&reload_state[i*16*MMX_COEF+0]);
+				b[i] = vload(&reload_state[i*16*MMX_COEF+MMX_COEF]);
+				c[i] = vload(&reload_state[i*16*MMX_COEF+2*MMX_COEF]);
+				d[i] = vload(&reload_state[i*16*MMX_COEF+3*MMX_COEF]);
 			}
 		}
 		else
 		{
 			MD4_PARA_DO(i)
 			{
-				a[i] = _mm_load_si128((__m128i *)&reload_state[i*16+0]);
-				b[i] = _mm_load_si128((__m128i *)&reload_state[i*16+4]);
-				c[i] = _mm_load_si128((__m128i *)&reload_state[i*16+8]);
-				d[i] = _mm_load_si128((__m128i *)&reload_state[i*16+12]);
+				a[i] = vload(&reload_state[i*4*MMX_COEF+0]);
+				b[i] = vload(&reload_state[i*4*MMX_COEF+MMX_COEF]);
+				c[i] = vload(&reload_state[i*4*MMX_COEF+2*MMX_COEF]);
+				d[i] = vload(&reload_state[i*4*MMX_COEF+3*MMX_COEF]);
 			}
 		}
 	}
 
 
 /* Round 1 */
-		cst = _mm_set_epi32(0,0,0,0);
+		cst = vset1_epi32(0);
 		MD4_STEP(MD4_F, a, b, c, d, 0, cst, 3)
 		MD4_STEP(MD4_F, d, a, b, c, 1, cst, 7)
 		MD4_STEP(MD4_F, c, d, a, b, 2, cst, 11)
@@ -821,7 +990,7 @@ if(SSEi_flags & SSEi_FLAT_IN) {
 		MD4_STEP(MD4_F, b, c, d, a, 15, cst, 19)
 
 /* Round 2 */
-		cst = _mm_set_epi32(0x5A827999L,0x5A827999L,0x5A827999L,0x5A827999L);
+		cst = vset1_epi32(0x5A827999L);
 		MD4_STEP(MD4_G, a, b, c, d, 0, cst, 3)
 		MD4_STEP(MD4_G, d, a, b, c, 4, cst, 5)
 		MD4_STEP(MD4_G, c, d, a, b, 8, cst, 9)
@@ -840,7 +1009,7 @@ if(SSEi_flags & SSEi_FLAT_IN) {
 		MD4_STEP(MD4_G, b, c, d, a, 15, cst, 13)
 
 /* Round 3 */
-		cst = _mm_set_epi32(0x6ED9EBA1L,0x6ED9EBA1L,0x6ED9EBA1L,0x6ED9EBA1L);
+		cst = vset1_epi32(0x6ED9EBA1L);
 		MD4_STEP(MD4_H, a, b, c, d, 0, cst, 3)
 		MD4_STEP(MD4_H, d, a, b, c, 8, cst, 9)
 		MD4_STEP(MD4_H, c, d, a, b, 4, cst, 11)
@@ -854,41 +1023,43 @@ if(SSEi_flags & SSEi_FLAT_IN) {
 		MD4_STEP(MD4_H, c, d, a, b, 5, cst, 11)
 		MD4_STEP(MD4_H, b, c, d, a, 13, cst, 15)
 		MD4_STEP(MD4_H, a, b, c, d, 3, cst, 3)
+		if (!(SSEi_flags & SSEi_REVERSE_STEPS)) {
 		MD4_STEP(MD4_H, d, a, b, c, 11, cst, 9)
 		MD4_STEP(MD4_H, c, d, a, b, 7, cst, 11)
 		MD4_STEP(MD4_H, b, c, d, a, 15, cst, 15)
+		}
 
 
-	if((SSEi_flags & SSEi_RELOAD)==0)
+	if((SSEi_flags & (SSEi_RELOAD|SSEi_REVERSE_STEPS))==0)
 	{
 		MD4_PARA_DO(i)
 		{
-			a[i] = _mm_add_epi32(a[i], _mm_set1_epi32(0x67452301));
-			b[i] = _mm_add_epi32(b[i], _mm_set1_epi32(0xefcdab89));
-			c[i] = _mm_add_epi32(c[i], _mm_set1_epi32(0x98badcfe));
-			d[i] = _mm_add_epi32(d[i], _mm_set1_epi32(0x10325476));
+			a[i] = vadd_epi32(a[i], vset1_epi32(0x67452301));
+			b[i] = vadd_epi32(b[i], vset1_epi32(0xefcdab89));
+			c[i] = vadd_epi32(c[i], vset1_epi32(0x98badcfe));
+			d[i] = vadd_epi32(d[i], vset1_epi32(0x10325476));
 		}
 	}
-	else
+	else if (SSEi_flags & SSEi_RELOAD)
 	{
 		if ((SSEi_flags & SSEi_RELOAD_INP_FMT)==SSEi_RELOAD_INP_FMT)
 		{
 			MD4_PARA_DO(i)
 			{
-				a[i] = _mm_add_epi32(a[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+0]));
-				b[i] = _mm_add_epi32(b[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+4]));
-				c[i] = _mm_add_epi32(c[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+8]));
-				d[i] = _mm_add_epi32(d[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+12]));
+				a[i] = vadd_epi32(a[i], vload(&reload_state[i*16*MMX_COEF+0]));
+				b[i] = vadd_epi32(b[i], vload(&reload_state[i*16*MMX_COEF+MMX_COEF]));
+				c[i] = vadd_epi32(c[i], vload(&reload_state[i*16*MMX_COEF+2*MMX_COEF]));
+				d[i] = vadd_epi32(d[i], vload(&reload_state[i*16*MMX_COEF+3*MMX_COEF]));
 			}
 		}
 		else
 		{
 			MD4_PARA_DO(i)
 			{
-				a[i] = _mm_add_epi32(a[i], _mm_load_si128((__m128i *)&reload_state[i*16+0]));
-				b[i] = _mm_add_epi32(b[i], _mm_load_si128((__m128i *)&reload_state[i*16+4]));
-				c[i] = _mm_add_epi32(c[i], _mm_load_si128((__m128i *)&reload_state[i*16+8]));
-				d[i] = _mm_add_epi32(d[i], _mm_load_si128((__m128i *)&reload_state[i*16+12]));
+				a[i] = vadd_epi32(a[i], vload(&reload_state[i*4*MMX_COEF+0]));
+				b[i] = vadd_epi32(b[i], vload(&reload_state[i*4*MMX_COEF+MMX_COEF]));
+				c[i] = vadd_epi32(c[i], vload(&reload_state[i*4*MMX_COEF+2*MMX_COEF]));
+				d[i] = vadd_epi32(d[i], vload(&reload_state[i*4*MMX_COEF+3*MMX_COEF]));
 			}
 		}
 	}
@@ -896,20 +1067,20 @@ if(SSEi_flags & SSEi_FLAT_IN) {
 	{
 		MD4_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*16*4+0], a[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+4], b[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+8], c[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+12], d[i]);
+			vstore(&out[i*16*MMX_COEF+0], a[i]);
+			vstore(&out[i*16*MMX_COEF+MMX_COEF], b[i]);
+			vstore(&out[i*16*MMX_COEF+2*MMX_COEF], c[i]);
+			vstore(&out[i*16*MMX_COEF+3*MMX_COEF], d[i]);
 		}
 	}
 	else
 	{
 		MD4_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*16+0], a[i]);
-			_mm_store_si128((__m128i *)&out[i*16+4], b[i]);
-			_mm_store_si128((__m128i *)&out[i*16+8], c[i]);
-			_mm_store_si128((__m128i *)&out[i*16+12], d[i]);
+			vstore(&out[i*4*MMX_COEF+0], a[i]);
+			vstore(&out[i*4*MMX_COEF+MMX_COEF], b[i]);
+			vstore(&out[i*4*MMX_COEF+2*MMX_COEF], c[i]);
+			vstore(&out[i*4*MMX_COEF+3*MMX_COEF], d[i]);
 		}
 	}
 }
@@ -921,23 +1092,23 @@ if(SSEi_flags & SSEi_FLAT_IN) {
 #define SHA1_PARA_DO(x)		for((x)=0;(x)<SHA1_SSE_PARA;(x)++)
 
 #define SHA1_F(x,y,z) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_cmov_si128((y[i]),(z[i]),(x[i]));
+	SHA1_PARA_DO(i) tmp[i] = vcmov((y[i]),(z[i]),(x[i]));
 
 #define SHA1_G(x,y,z) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128((y[i]),(z[i])); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128((tmp[i]),(x[i]));
+	SHA1_PARA_DO(i) tmp[i] = vxor((y[i]),(z[i])); \
+	SHA1_PARA_DO(i) tmp[i] = vxor((tmp[i]),(x[i]));
 
 #ifdef __XOP__
 #define SHA1_H(x,y,z) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_cmov_si128((x[i]),(y[i]),(z[i])); \
-	SHA1_PARA_DO(i) tmp2[i] = _mm_andnot_si128((x[i]),(y[i])); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128((tmp[i]),(tmp2[i]));
+	SHA1_PARA_DO(i) tmp[i] = vcmov((x[i]),(y[i]),(z[i])); \
+	SHA1_PARA_DO(i) tmp2[i] = vandnot((x[i]),(y[i])); \
+	SHA1_PARA_DO(i) tmp[i] = vxor((tmp[i]),(tmp2[i]));
 #else
 #define SHA1_H(x,y,z) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_and_si128((x[i]),(y[i])); \
-	SHA1_PARA_DO(i) tmp2[i] = _mm_or_si128((x[i]),(y[i])); \
-	SHA1_PARA_DO(i) tmp2[i] = _mm_and_si128((tmp2[i]),(z[i])); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_or_si128((tmp[i]),(tmp2[i]));
+	SHA1_PARA_DO(i) tmp[i] = vand((x[i]),(y[i])); \
+	SHA1_PARA_DO(i) tmp2[i] = vor((x[i]),(y[i])); \
+	SHA1_PARA_DO(i) tmp2[i] = vand((tmp2[i]),(z[i])); \
+	SHA1_PARA_DO(i) tmp[i] = vor((tmp[i]),(tmp2[i]));
 #endif
 
 #define SHA1_I(x,y,z) SHA1_G(x,y,z)
@@ -947,30 +1118,31 @@ if(SSEi_flags & SSEi_FLAT_IN) {
 // Bartavelle's original code, using 80x4 words of buffer
 
 #define SHA1_EXPAND(t) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( data[i*80+t-3], data[i*80+t-8] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], data[i*80+t-14] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], data[i*80+t-16] ); \
-	SHA1_PARA_DO(i) data[i*80+t] = _mm_roti_epi32(tmp[i], 1);
+	SHA1_PARA_DO(i) tmp[i] = vxor( data[i*80+t-3], data[i*80+t-8] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], data[i*80+t-14] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], data[i*80+t-16] ); \
+	SHA1_PARA_DO(i) data[i*80+t] = vroti_epi32(tmp[i], 1);
 
 #define SHA1_ROUND(a,b,c,d,e,F,t) \
 	F(b,c,d) \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_roti_epi32(a[i], 5); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], cst ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], data[i*80+t] ); \
-	SHA1_PARA_DO(i) b[i] = _mm_roti_epi32(b[i], 30);
-
-void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, unsigned int SSEi_flags)
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) tmp[i] = vroti_epi32(a[i], 5); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], cst ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], data[i*80+t] ); \
+	SHA1_PARA_DO(i) b[i] = vroti_epi32(b[i], 30);
+
+void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, unsigned int SSEi_flags)
 {
-	__m128i a[SHA1_SSE_PARA];
-	__m128i b[SHA1_SSE_PARA];
-	__m128i c[SHA1_SSE_PARA];
-	__m128i d[SHA1_SSE_PARA];
-	__m128i e[SHA1_SSE_PARA];
-	__m128i tmp[SHA1_SSE_PARA];
-	__m128i tmp2[SHA1_SSE_PARA];
-	__m128i	cst;
+	vtype *data = (vtype*)_data;
+	vtype a[SHA1_SSE_PARA];
+	vtype b[SHA1_SSE_PARA];
+	vtype c[SHA1_SSE_PARA];
+	vtype d[SHA1_SSE_PARA];
+	vtype e[SHA1_SSE_PARA];
+	vtype tmp[SHA1_SSE_PARA];
+	vtype tmp2[SHA1_SSE_PARA];
+	vtype	cst;
 	unsigned int i,j;
 
 	for(j=16;j<80;j++)
@@ -982,11 +1154,11 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 	{
 		SHA1_PARA_DO(i)
 		{
-			a[i] = _mm_set1_epi32(0x67452301);
-			b[i] = _mm_set1_epi32(0xefcdab89);
-			c[i] = _mm_set1_epi32(0x98badcfe);
-			d[i] = _mm_set1_epi32(0x10325476);
-			e[i] = _mm_set1_epi32(0xC3D2E1F0);
+			a[i] = vset1_epi32(0x67452301);
+			b[i] = vset1_epi32(0xefcdab89);
+			c[i] = vset1_epi32(0x98badcfe);
+			d[i] = vset1_epi32(0x10325476);
+			e[i] = vset1_epi32(0xC3D2E1F0);
 		}
 	}
 	else
@@ -995,27 +1167,27 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 		{
 			SHA1_PARA_DO(i)
 			{
-				a[i] = _mm_load_si128((__m128i *)&reload_state[i*80*4+0]);
-				b[i] = _mm_load_si128((__m128i *)&reload_state[i*80*4+4]);
-				c[i] = _mm_load_si128((__m128i *)&reload_state[i*80*4+8]);
-				d[i] = _mm_load_si128((__m128i *)&reload_state[i*80*4+12]);
-				e[i] = _mm_load_si128((__m128i *)&reload_state[i*80*4+16]);
+				a[i] = vload(&reload_state[i*80*MMX_COEF+0]);
+				b[i] = vload(&reload_state[i*80*MMX_COEF+MMX_COEF]);
+				c[i] = vload(&reload_state[i*80*MMX_COEF+2*MMX_COEF]);
+				d[i] = vload(&reload_state[i*80*MMX_COEF+3*MMX_COEF]);
+				e[i] = vload(&reload_state[i*80*MMX_COEF+4*MMX_COEF]);
 			}
 		}
 		else
 		{
 			SHA1_PARA_DO(i)
 			{
-				a[i] = _mm_load_si128((__m128i *)&reload_state[i*20+0]);
-				b[i] = _mm_load_si128((__m128i *)&reload_state[i*20+4]);
-				c[i] = _mm_load_si128((__m128i *)&reload_state[i*20+8]);
-				d[i] = _mm_load_si128((__m128i *)&reload_state[i*20+12]);
-				e[i] = _mm_load_si128((__m128i *)&reload_state[i*20+16]);
+				a[i] = vload(&reload_state[i*5*MMX_COEF+0]);
+				b[i] = vload(&reload_state[i*5*MMX_COEF+MMX_COEF]);
+				c[i] = vload(&reload_state[i*5*MMX_COEF+2*MMX_COEF]);
+				d[i] = vload(&reload_state[i*5*MMX_COEF+3*MMX_COEF]);
+				e[i] = vload(&reload_state[i*5*MMX_COEF+4*MMX_COEF]);
 			}
 		}
 	}
 
-	cst = _mm_set1_epi32(0x5A827999);
+	cst = vset1_epi32(0x5A827999);
 	SHA1_ROUND( a, b, c, d, e, SHA1_F,  0 );
 	SHA1_ROUND( e, a, b, c, d, SHA1_F,  1 );
 	SHA1_ROUND( d, e, a, b, c, SHA1_F,  2 );
@@ -1037,7 +1209,7 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 	SHA1_ROUND( c, d, e, a, b, SHA1_F, 18 );
 	SHA1_ROUND( b, c, d, e, a, SHA1_F, 19 );
 
-	cst = _mm_set1_epi32(0x6ED9EBA1);
+	cst = vset1_epi32(0x6ED9EBA1);
 	SHA1_ROUND( a, b, c, d, e, SHA1_G, 20 );
 	SHA1_ROUND( e, a, b, c, d, SHA1_G, 21 );
 	SHA1_ROUND( d, e, a, b, c, SHA1_G, 22 );
@@ -1059,7 +1231,7 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 	SHA1_ROUND( c, d, e, a, b, SHA1_G, 38 );
 	SHA1_ROUND( b, c, d, e, a, SHA1_G, 39 );
 
-	cst = _mm_set1_epi32(0x8F1BBCDC);
+	cst = vset1_epi32(0x8F1BBCDC);
 	SHA1_ROUND( a, b, c, d, e, SHA1_H, 40 );
 	SHA1_ROUND( e, a, b, c, d, SHA1_H, 41 );
 	SHA1_ROUND( d, e, a, b, c, SHA1_H, 42 );
@@ -1081,7 +1253,7 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 	SHA1_ROUND( c, d, e, a, b, SHA1_H, 58 );
 	SHA1_ROUND( b, c, d, e, a, SHA1_H, 59 );
 
-	cst = _mm_set1_epi32(0xCA62C1D6);
+	cst = vset1_epi32(0xCA62C1D6);
 	SHA1_ROUND( a, b, c, d, e, SHA1_I, 60 );
 	SHA1_ROUND( e, a, b, c, d, SHA1_I, 61 );
 	SHA1_ROUND( d, e, a, b, c, SHA1_I, 62 );
@@ -1107,11 +1279,11 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 	{
 		SHA1_PARA_DO(i)
 		{
-			a[i] = _mm_add_epi32(a[i], _mm_set1_epi32(0x67452301));
-			b[i] = _mm_add_epi32(b[i], _mm_set1_epi32(0xefcdab89));
-			c[i] = _mm_add_epi32(c[i], _mm_set1_epi32(0x98badcfe));
-			d[i] = _mm_add_epi32(d[i], _mm_set1_epi32(0x10325476));
-			e[i] = _mm_add_epi32(e[i], _mm_set1_epi32(0xC3D2E1F0));
+			a[i] = vadd_epi32(a[i], vset1_epi32(0x67452301));
+			b[i] = vadd_epi32(b[i], vset1_epi32(0xefcdab89));
+			c[i] = vadd_epi32(c[i], vset1_epi32(0x98badcfe));
+			d[i] = vadd_epi32(d[i], vset1_epi32(0x10325476));
+			e[i] = vadd_epi32(e[i], vset1_epi32(0xC3D2E1F0));
 		}
 	}
 	else
@@ -1120,22 +1292,22 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 		{
 			SHA1_PARA_DO(i)
 			{
-				a[i] = _mm_add_epi32(a[i], _mm_load_si128((__m128i *)&reload_state[i*80*4+0]));
-				b[i] = _mm_add_epi32(b[i], _mm_load_si128((__m128i *)&reload_state[i*80*4+4]));
-				c[i] = _mm_add_epi32(c[i], _mm_load_si128((__m128i *)&reload_state[i*80*4+8]));
-				d[i] = _mm_add_epi32(d[i], _mm_load_si128((__m128i *)&reload_state[i*80*4+12]));
-				e[i] = _mm_add_epi32(e[i], _mm_load_si128((__m128i *)&reload_state[i*80*4+16]));
+				a[i] = vadd_epi32(a[i], vload(&reload_state[i*80*MMX_COEF+0]));
+				b[i] = vadd_epi32(b[i], vload(&reload_state[i*80*MMX_COEF+MMX_COEF]));
+				c[i] = vadd_epi32(c[i], vload(&reload_state[i*80*MMX_COEF+2*MMX_COEF]));
+				d[i] = vadd_epi32(d[i], vload(&reload_state[i*80*MMX_COEF+3*MMX_COEF]));
+				e[i] = vadd_epi32(e[i], vload(&reload_state[i*80*MMX_COEF+4*MMX_COEF]));
 			}
 		}
 		else
 		{
 			SHA1_PARA_DO(i)
 			{
-				a[i] = _mm_add_epi32(a[i], _mm_load_si128((__m128i *)&reload_state[i*20+0]));
-				b[i] = _mm_add_epi32(b[i], _mm_load_si128((__m128i *)&reload_state[i*20+4]));
-				c[i] = _mm_add_epi32(c[i], _mm_load_si128((__m128i *)&reload_state[i*20+8]));
-				d[i] = _mm_add_epi32(d[i], _mm_load_si128((__m128i *)&reload_state[i*20+12]));
-				e[i] = _mm_add_epi32(e[i], _mm_load_si128((__m128i *)&reload_state[i*20+16]));
+				a[i] = vadd_epi32(a[i], vload(&reload_state[i*5*MMX_COEF+0]));
+				b[i] = vadd_epi32(b[i], vload(&reload_state[i*5*MMX_COEF+MMX_COEF]));
+				c[i] = vadd_epi32(c[i], vload(&reload_state[i*5*MMX_COEF+2*MMX_COEF]));
+				d[i] = vadd_epi32(d[i], vload(&reload_state[i*5*MMX_COEF+3*MMX_COEF]));
+				e[i] = vadd_epi32(e[i], vload(&reload_state[i*5*MMX_COEF+4*MMX_COEF]));
 			}
 		}
 	}
@@ -1143,22 +1315,22 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 	{
 		SHA1_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*80*4+0], a[i]);
-			_mm_store_si128((__m128i *)&out[i*80*4+4], b[i]);
-			_mm_store_si128((__m128i *)&out[i*80*4+8], c[i]);
-			_mm_store_si128((__m128i *)&out[i*80*4+12], d[i]);
-			_mm_store_si128((__m128i *)&out[i*80*4+16], e[i]);
+			vstore(&out[i*80*MMX_COEF+0], a[i]);
+			vstore(&out[i*80*MMX_COEF+MMX_COEF], b[i]);
+			vstore(&out[i*80*MMX_COEF+2*MMX_COEF], c[i]);
+			vstore(&out[i*80*MMX_COEF+3*MMX_COEF], d[i]);
+			vstore(&out[i*80*MMX_COEF+4*MMX_COEF], e[i]);
 		}
 	}
 	else
 	{
 		SHA1_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*20+0], a[i]);
-			_mm_store_si128((__m128i *)&out[i*20+4], b[i]);
-			_mm_store_si128((__m128i *)&out[i*20+8], c[i]);
-			_mm_store_si128((__m128i *)&out[i*20+12], d[i]);
-			_mm_store_si128((__m128i *)&out[i*20+16], e[i]);
+			vstore(&out[i*5*MMX_COEF+0], a[i]);
+			vstore(&out[i*5*MMX_COEF+MMX_COEF], b[i]);
+			vstore(&out[i*5*MMX_COEF+2*MMX_COEF], c[i]);
+			vstore(&out[i*5*MMX_COEF+3*MMX_COEF], d[i]);
+			vstore(&out[i*5*MMX_COEF+4*MMX_COEF], e[i]);
 		}
 	}
 }
@@ -1167,137 +1339,137 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 // JimF's code, using 16x4 words of buffer just like MD4/5
 
 #define SHA1_EXPAND2a(t) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( data[i*16+t-3], data[i*16+t-8] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], data[i*16+t-14] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], data[i*16+t-16] ); \
-	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = _mm_roti_epi32(tmp[i], 1);
+	SHA1_PARA_DO(i) tmp[i] = vxor( data[i*16+t-3], data[i*16+t-8] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], data[i*16+t-14] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], data[i*16+t-16] ); \
+	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = vroti_epi32(tmp[i], 1);
 #define SHA1_EXPAND2b(t) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmpR[i*16+((t-3)&0xF)], data[i*16+t-8] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], data[i*16+t-14] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], data[i*16+t-16] ); \
-	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = _mm_roti_epi32(tmp[i], 1);
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmpR[i*16+((t-3)&0xF)], data[i*16+t-8] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], data[i*16+t-14] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], data[i*16+t-16] ); \
+	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = vroti_epi32(tmp[i], 1);
 #define SHA1_EXPAND2c(t) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmpR[i*16+((t-3)&0xF)], tmpR[i*16+((t-8)&0xF)] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], data[i*16+t-14] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], data[i*16+t-16] ); \
-	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = _mm_roti_epi32(tmp[i], 1);
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmpR[i*16+((t-3)&0xF)], tmpR[i*16+((t-8)&0xF)] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], data[i*16+t-14] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], data[i*16+t-16] ); \
+	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = vroti_epi32(tmp[i], 1);
 #define SHA1_EXPAND2d(t) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmpR[i*16+((t-3)&0xF)], tmpR[i*16+((t-8)&0xF)] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], tmpR[i*16+((t-14)&0xF)] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], data[i*16+t-16] ); \
-	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = _mm_roti_epi32(tmp[i], 1);
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmpR[i*16+((t-3)&0xF)], tmpR[i*16+((t-8)&0xF)] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], tmpR[i*16+((t-14)&0xF)] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], data[i*16+t-16] ); \
+	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = vroti_epi32(tmp[i], 1);
 #define SHA1_EXPAND2(t) \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmpR[i*16+((t-3)&0xF)], tmpR[i*16+((t-8)&0xF)] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], tmpR[i*16+((t-14)&0xF)] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_xor_si128( tmp[i], tmpR[i*16+((t-16)&0xF)] ); \
-	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = _mm_roti_epi32(tmp[i], 1);
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmpR[i*16+((t-3)&0xF)], tmpR[i*16+((t-8)&0xF)] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], tmpR[i*16+((t-14)&0xF)] ); \
+	SHA1_PARA_DO(i) tmp[i] = vxor( tmp[i], tmpR[i*16+((t-16)&0xF)] ); \
+	SHA1_PARA_DO(i) tmpR[i*16+((t)&0xF)] = vroti_epi32(tmp[i], 1);
 
 #define SHA1_ROUND2a(a,b,c,d,e,F,t) \
 	SHA1_EXPAND2a(t+16) \
 	F(b,c,d) \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_roti_epi32(a[i], 5); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], cst ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], data[i*16+t] ); \
-	SHA1_PARA_DO(i) b[i] = _mm_roti_epi32(b[i], 30);
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) tmp[i] = vroti_epi32(a[i], 5); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], cst ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], data[i*16+t] ); \
+	SHA1_PARA_DO(i) b[i] = vroti_epi32(b[i], 30);
 #define SHA1_ROUND2b(a,b,c,d,e,F,t) \
 	SHA1_EXPAND2b(t+16) \
 	F(b,c,d) \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_roti_epi32(a[i], 5); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], cst ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], data[i*16+t] ); \
-	SHA1_PARA_DO(i) b[i] = _mm_roti_epi32(b[i], 30);
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) tmp[i] = vroti_epi32(a[i], 5); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], cst ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], data[i*16+t] ); \
+	SHA1_PARA_DO(i) b[i] = vroti_epi32(b[i], 30);
 #define SHA1_ROUND2c(a,b,c,d,e,F,t) \
 	SHA1_EXPAND2c(t+16) \
 	F(b,c,d) \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_roti_epi32(a[i], 5); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], cst ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], data[i*16+t] ); \
-	SHA1_PARA_DO(i) b[i] = _mm_roti_epi32(b[i], 30);
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) tmp[i] = vroti_epi32(a[i], 5); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], cst ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], data[i*16+t] ); \
+	SHA1_PARA_DO(i) b[i] = vroti_epi32(b[i], 30);
 #define SHA1_ROUND2d(a,b,c,d,e,F,t) \
 	SHA1_EXPAND2d(t+16) \
 	F(b,c,d) \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_roti_epi32(a[i], 5); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], cst ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], data[i*16+t] ); \
-	SHA1_PARA_DO(i) b[i] = _mm_roti_epi32(b[i], 30);
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) tmp[i] = vroti_epi32(a[i], 5); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], cst ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], data[i*16+t] ); \
+	SHA1_PARA_DO(i) b[i] = vroti_epi32(b[i], 30);
 #define SHA1_ROUND2(a,b,c,d,e,F,t) \
 	SHA1_PARA_DO(i) tmp3[i] = tmpR[i*16+(t&0xF)]; \
 	SHA1_EXPAND2(t+16) \
 	F(b,c,d) \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_roti_epi32(a[i], 5); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], cst ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp3[i] ); \
-	SHA1_PARA_DO(i) b[i] = _mm_roti_epi32(b[i], 30);
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) tmp[i] = vroti_epi32(a[i], 5); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], cst ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp3[i] ); \
+	SHA1_PARA_DO(i) b[i] = vroti_epi32(b[i], 30);
 #define SHA1_ROUND2x(a,b,c,d,e,F,t) \
 	F(b,c,d) \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) tmp[i] = _mm_roti_epi32(a[i], 5); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmp[i] ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], cst ); \
-	SHA1_PARA_DO(i) e[i] = _mm_add_epi32( e[i], tmpR[i*16+(t&0xF)] ); \
-	SHA1_PARA_DO(i) b[i] = _mm_roti_epi32(b[i], 30);
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) tmp[i] = vroti_epi32(a[i], 5); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmp[i] ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], cst ); \
+	SHA1_PARA_DO(i) e[i] = vadd_epi32( e[i], tmpR[i*16+(t&0xF)] ); \
+	SHA1_PARA_DO(i) b[i] = vroti_epi32(b[i], 30);
 
 void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, unsigned SSEi_flags)
 {
-	__m128i w[16*SHA1_SSE_PARA];
-	__m128i a[SHA1_SSE_PARA];
-	__m128i b[SHA1_SSE_PARA];
-	__m128i c[SHA1_SSE_PARA];
-	__m128i d[SHA1_SSE_PARA];
-	__m128i e[SHA1_SSE_PARA];
-	__m128i tmp[SHA1_SSE_PARA];
-	__m128i tmp2[SHA1_SSE_PARA];
-	__m128i tmp3[SHA1_SSE_PARA];
-	__m128i tmpR[SHA1_SSE_PARA*16];
-	__m128i	cst;
+	vtype w[16*SHA1_SSE_PARA];
+	vtype a[SHA1_SSE_PARA];
+	vtype b[SHA1_SSE_PARA];
+	vtype c[SHA1_SSE_PARA];
+	vtype d[SHA1_SSE_PARA];
+	vtype e[SHA1_SSE_PARA];
+	vtype tmp[SHA1_SSE_PARA];
+	vtype tmp2[SHA1_SSE_PARA];
+	vtype tmp3[SHA1_SSE_PARA];
+	vtype tmpR[SHA1_SSE_PARA*16];
+	vtype	cst;
 	unsigned int i;
-	__m128i *data;
+	vtype *data;
 
 	if(SSEi_flags & SSEi_FLAT_IN) {
 		// Move _data to __data, mixing it MMX_COEF wise.
 #ifdef __SSE4_1__
 		unsigned k;
-		__m128i *W = w;
+		vtype *W = w;
 		ARCH_WORD_32 *saved_key = (ARCH_WORD_32 *)_data;
 		SHA1_PARA_DO(k)
 		{
 			if (SSEi_flags & SSEi_4BUF_INPUT) {
-				for (i=0; i < 14; ++i) { GATHER_4x (W[i], saved_key, i); SWAP_ENDIAN (W[i]); }
-				GATHER_4x (W[14], saved_key, 14);
-				GATHER_4x (W[15], saved_key, 15);
+				for (i=0; i < 14; ++i) { VGATHER_4x (W[i], saved_key, i); vswap32 (W[i]); }
+				VGATHER_4x (W[14], saved_key, 14);
+				VGATHER_4x (W[15], saved_key, 15);
 				saved_key += (MMX_COEF<<6);
 			} else if (SSEi_flags & SSEi_2BUF_INPUT) {
-				for (i=0; i < 14; ++i) { GATHER_2x (W[i], saved_key, i); SWAP_ENDIAN (W[i]); }
-				GATHER_2x (W[14], saved_key, 14);
-				GATHER_2x (W[15], saved_key, 15);
+				for (i=0; i < 14; ++i) { VGATHER_2x (W[i], saved_key, i); vswap32 (W[i]); }
+				VGATHER_2x (W[14], saved_key, 14);
+				VGATHER_2x (W[15], saved_key, 15);
 				saved_key += (MMX_COEF<<5);
 			} else {
-				for (i=0; i < 14; ++i) { GATHER (W[i], saved_key, i); SWAP_ENDIAN (W[i]); }
-				GATHER (W[14], saved_key, 14);
-				GATHER (W[15], saved_key, 15);
+				for (i=0; i < 14; ++i) { VGATHER (W[i], saved_key, i); vswap32 (W[i]); }
+				VGATHER (W[14], saved_key, 14);
+				VGATHER (W[15], saved_key, 15);
 				saved_key += (MMX_COEF<<4);
 			}
 			if ( ((SSEi_flags & SSEi_2BUF_INPUT_FIRST_BLK) == SSEi_2BUF_INPUT_FIRST_BLK) ||
 				 ((SSEi_flags & SSEi_4BUF_INPUT_FIRST_BLK) == SSEi_4BUF_INPUT_FIRST_BLK)) {
-				SWAP_ENDIAN (W[14]);
-				SWAP_ENDIAN (W[15]);
+				vswap32 (W[14]);
+				vswap32 (W[15]);
 			}
 			W += 16;
 		}
 #else
 		unsigned j, k;
 		ARCH_WORD_32 *p = (ARCH_WORD_32 *)w;
-		__m128i *W = w;
+		vtype *W = w;
 		ARCH_WORD_32 *saved_key = (ARCH_WORD_32 *)_data;
 		SHA1_PARA_DO(k)
 		{
@@ -1318,11 +1490,11 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 				saved_key += (MMX_COEF<<4);
 			}
 			for (i=0; i < 14; i++)
-				SWAP_ENDIAN (W[i]);
+				vswap32 (W[i]);
 			if ( ((SSEi_flags & SSEi_2BUF_INPUT_FIRST_BLK) == SSEi_2BUF_INPUT_FIRST_BLK) ||
 				 ((SSEi_flags & SSEi_4BUF_INPUT_FIRST_BLK) == SSEi_4BUF_INPUT_FIRST_BLK)) {
-				SWAP_ENDIAN (W[14]);
-				SWAP_ENDIAN (W[15]);
+				vswap32 (W[14]);
+				vswap32 (W[15]);
 			}
 			W += 16;
 		}
@@ -1331,17 +1503,17 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 		// now set our data pointer to point to this 'mixed' data.
 		data = w;
 	} else
-		data = _data;
+		data = (vtype*)_data;
 
 	if((SSEi_flags & SSEi_RELOAD)==0)
 	{
 		SHA1_PARA_DO(i)
 		{
-			a[i] = _mm_set1_epi32(0x67452301);
-			b[i] = _mm_set1_epi32(0xefcdab89);
-			c[i] = _mm_set1_epi32(0x98badcfe);
-			d[i] = _mm_set1_epi32(0x10325476);
-			e[i] = _mm_set1_epi32(0xC3D2E1F0);
+			a[i] = vset1_epi32(0x67452301);
+			b[i] = vset1_epi32(0xefcdab89);
+			c[i] = vset1_epi32(0x98badcfe);
+			d[i] = vset1_epi32(0x10325476);
+			e[i] = vset1_epi32(0xC3D2E1F0);
 		}
 	}
 	else
@@ -1350,27 +1522,27 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 		{
 			SHA1_PARA_DO(i)
 			{
-				a[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+0]);
-				b[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+4]);
-				c[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+8]);
-				d[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+12]);
-				e[i] = _mm_load_si128((__m128i *)&reload_state[i*16*4+16]);
+				a[i] = vload(&reload_state[i*16*MMX_COEF+0]);
+				b[i] = vload(&reload_state[i*16*MMX_COEF+MMX_COEF]);
+				c[i] = vload(&reload_state[i*16*MMX_COEF+2*MMX_COEF]);
+				d[i] = vload(&reload_state[i*16*MMX_COEF+3*MMX_COEF]);
+				e[i] = vload(&reload_state[i*16*MMX_COEF+4*MMX_COEF]);
 			}
 		}
 		else
 		{
 			SHA1_PARA_DO(i)
 			{
-				a[i] = _mm_load_si128((__m128i *)&reload_state[i*20+0]);
-				b[i] = _mm_load_si128((__m128i *)&reload_state[i*20+4]);
-				c[i] = _mm_load_si128((__m128i *)&reload_state[i*20+8]);
-				d[i] = _mm_load_si128((__m128i *)&reload_state[i*20+12]);
-				e[i] = _mm_load_si128((__m128i *)&reload_state[i*20+16]);
+				a[i] = vload(&reload_state[i*5*MMX_COEF+0]);
+				b[i] = vload(&reload_state[i*5*MMX_COEF+MMX_COEF]);
+				c[i] = vload(&reload_state[i*5*MMX_COEF+2*MMX_COEF]);
+				d[i] = vload(&reload_state[i*5*MMX_COEF+3*MMX_COEF]);
+				e[i] = vload(&reload_state[i*5*MMX_COEF+4*MMX_COEF]);
 			}
 		}
 	}
 
-	cst = _mm_set1_epi32(0x5A827999);
+	cst = vset1_epi32(0x5A827999);
 	SHA1_ROUND2a( a, b, c, d, e, SHA1_F,  0 );
 	SHA1_ROUND2a( e, a, b, c, d, SHA1_F,  1 );
 	SHA1_ROUND2a( d, e, a, b, c, SHA1_F,  2 );
@@ -1392,7 +1564,7 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 	SHA1_ROUND2( c, d, e, a, b, SHA1_F, 18 );
 	SHA1_ROUND2( b, c, d, e, a, SHA1_F, 19 );
 
-	cst = _mm_set1_epi32(0x6ED9EBA1);
+	cst = vset1_epi32(0x6ED9EBA1);
 	SHA1_ROUND2( a, b, c, d, e, SHA1_G, 20 );
 	SHA1_ROUND2( e, a, b, c, d, SHA1_G, 21 );
 	SHA1_ROUND2( d, e, a, b, c, SHA1_G, 22 );
@@ -1414,7 +1586,7 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 	SHA1_ROUND2( c, d, e, a, b, SHA1_G, 38 );
 	SHA1_ROUND2( b, c, d, e, a, SHA1_G, 39 );
 
-	cst = _mm_set1_epi32(0x8F1BBCDC);
+	cst = vset1_epi32(0x8F1BBCDC);
 	SHA1_ROUND2( a, b, c, d, e, SHA1_H, 40 );
 	SHA1_ROUND2( e, a, b, c, d, SHA1_H, 41 );
 	SHA1_ROUND2( d, e, a, b, c, SHA1_H, 42 );
@@ -1436,7 +1608,7 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 	SHA1_ROUND2( c, d, e, a, b, SHA1_H, 58 );
 	SHA1_ROUND2( b, c, d, e, a, SHA1_H, 59 );
 
-	cst = _mm_set1_epi32(0xCA62C1D6);
+	cst = vset1_epi32(0xCA62C1D6);
 	SHA1_ROUND2( a, b, c, d, e, SHA1_I, 60 );
 	SHA1_ROUND2( e, a, b, c, d, SHA1_I, 61 );
 	SHA1_ROUND2( d, e, a, b, c, SHA1_I, 62 );
@@ -1462,11 +1634,11 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 	{
 		SHA1_PARA_DO(i)
 		{
-			a[i] = _mm_add_epi32(a[i], _mm_set1_epi32(0x67452301));
-			b[i] = _mm_add_epi32(b[i], _mm_set1_epi32(0xefcdab89));
-			c[i] = _mm_add_epi32(c[i], _mm_set1_epi32(0x98badcfe));
-			d[i] = _mm_add_epi32(d[i], _mm_set1_epi32(0x10325476));
-			e[i] = _mm_add_epi32(e[i], _mm_set1_epi32(0xC3D2E1F0));
+			a[i] = vadd_epi32(a[i], vset1_epi32(0x67452301));
+			b[i] = vadd_epi32(b[i], vset1_epi32(0xefcdab89));
+			c[i] = vadd_epi32(c[i], vset1_epi32(0x98badcfe));
+			d[i] = vadd_epi32(d[i], vset1_epi32(0x10325476));
+			e[i] = vadd_epi32(e[i], vset1_epi32(0xC3D2E1F0));
 		}
 	}
 	else
@@ -1475,22 +1647,22 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 		{
 			SHA1_PARA_DO(i)
 			{
-				a[i] = _mm_add_epi32(a[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+0]));
-				b[i] = _mm_add_epi32(b[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+4]));
-				c[i] = _mm_add_epi32(c[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+8]));
-				d[i] = _mm_add_epi32(d[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+12]));
-				e[i] = _mm_add_epi32(e[i], _mm_load_si128((__m128i *)&reload_state[i*16*4+16]));
+				a[i] = vadd_epi32(a[i], vload(&reload_state[i*16*MMX_COEF+0]));
+				b[i] = vadd_epi32(b[i], vload(&reload_state[i*16*MMX_COEF+MMX_COEF]));
+				c[i] = vadd_epi32(c[i], vload(&reload_state[i*16*MMX_COEF+2*MMX_COEF]));
+				d[i] = vadd_epi32(d[i], vload(&reload_state[i*16*MMX_COEF+3*MMX_COEF]));
+				e[i] = vadd_epi32(e[i], vload(&reload_state[i*16*MMX_COEF+4*MMX_COEF]));
 			}
 		}
 		else
 		{
 			SHA1_PARA_DO(i)
 			{
-				a[i] = _mm_add_epi32(a[i], _mm_load_si128((__m128i *)&reload_state[i*20+0]));
-				b[i] = _mm_add_epi32(b[i], _mm_load_si128((__m128i *)&reload_state[i*20+4]));
-				c[i] = _mm_add_epi32(c[i], _mm_load_si128((__m128i *)&reload_state[i*20+8]));
-				d[i] = _mm_add_epi32(d[i], _mm_load_si128((__m128i *)&reload_state[i*20+12]));
-				e[i] = _mm_add_epi32(e[i], _mm_load_si128((__m128i *)&reload_state[i*20+16]));
+				a[i] = vadd_epi32(a[i], vload(&reload_state[i*5*MMX_COEF+0]));
+				b[i] = vadd_epi32(b[i], vload(&reload_state[i*5*MMX_COEF+MMX_COEF]));
+				c[i] = vadd_epi32(c[i], vload(&reload_state[i*5*MMX_COEF+2*MMX_COEF]));
+				d[i] = vadd_epi32(d[i], vload(&reload_state[i*5*MMX_COEF+3*MMX_COEF]));
+				e[i] = vadd_epi32(e[i], vload(&reload_state[i*5*MMX_COEF+4*MMX_COEF]));
 			}
 		}
 	}
@@ -1498,22 +1670,22 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 	{
 		SHA1_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*16*4+0], a[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+4], b[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+8], c[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+12], d[i]);
-			_mm_store_si128((__m128i *)&out[i*16*4+16], e[i]);
+			vstore(&out[i*16*MMX_COEF+0], a[i]);
+			vstore(&out[i*16*MMX_COEF+MMX_COEF], b[i]);
+			vstore(&out[i*16*MMX_COEF+2*MMX_COEF], c[i]);
+			vstore(&out[i*16*MMX_COEF+3*MMX_COEF], d[i]);
+			vstore(&out[i*16*MMX_COEF+4*MMX_COEF], e[i]);
 		}
 	}
 	else
 	{
 		SHA1_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*20+0], a[i]);
-			_mm_store_si128((__m128i *)&out[i*20+4], b[i]);
-			_mm_store_si128((__m128i *)&out[i*20+8], c[i]);
-			_mm_store_si128((__m128i *)&out[i*20+12], d[i]);
-			_mm_store_si128((__m128i *)&out[i*20+16], e[i]);
+			vstore(&out[i*5*MMX_COEF+0], a[i]);
+			vstore(&out[i*5*MMX_COEF+MMX_COEF], b[i]);
+			vstore(&out[i*5*MMX_COEF+2*MMX_COEF], c[i]);
+			vstore(&out[i*5*MMX_COEF+3*MMX_COEF], d[i]);
+			vstore(&out[i*5*MMX_COEF+4*MMX_COEF], e[i]);
 		}
 	}
 }
@@ -1521,82 +1693,46 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 #endif /* SHA1_SSE_PARA */
 
 
-#define S0(x)                           \
-(                                       \
-    _mm_xor_si128 (                     \
-        _mm_roti_epi32 (x, -22),        \
-        _mm_xor_si128 (                 \
-            _mm_roti_epi32 (x,  -2),    \
-            _mm_roti_epi32 (x, -13)     \
-        )                               \
-    )                                   \
-)
-
-#define S1(x)                           \
-(                                       \
-    _mm_xor_si128 (                     \
-        _mm_roti_epi32 (x, -25),        \
-        _mm_xor_si128 (                 \
-            _mm_roti_epi32 (x,  -6),    \
-            _mm_roti_epi32 (x, -11)     \
-        )                               \
-    )                                   \
-)
-
-#define s0(x)                           \
-(                                       \
-    _mm_xor_si128 (                     \
-        _mm_srli_epi32 (x, 3),          \
-        _mm_xor_si128 (                 \
-            _mm_roti_epi32 (x,  -7),    \
-            _mm_roti_epi32 (x, -18)     \
-        )                               \
-    )                                   \
-)
-
-#define s1(x)                           \
-(                                       \
-    _mm_xor_si128 (                     \
-        _mm_srli_epi32 (x, 10),         \
-        _mm_xor_si128 (                 \
-            _mm_roti_epi32 (x, -17),    \
-            _mm_roti_epi32 (x, -19)     \
-        )                               \
-    )                                   \
-)
-
-#define Maj(x,y,z) _mm_cmov_si128 (x, y, _mm_xor_si128 (z, y))
-
-#define Ch(x,y,z) _mm_cmov_si128 (y, z, x)
+#define S0(x) vxor3(vroti_epi32(x, -22), vroti_epi32(x,  -2), vroti_epi32(x, -13))
+
+#define S1(x) vxor3(vroti_epi32(x, -25), vroti_epi32(x,  -6), vroti_epi32(x, -11))
+
+#define s0(x) vxor3(vsrli_epi32(x, 3), vroti_epi32(x,  -7), vroti_epi32(x, -18))
+
+#define s1(x) vxor3(vsrli_epi32(x, 10), vroti_epi32(x, -17), vroti_epi32(x, -19))
+
+#define Maj(x,y,z) vmaj(x, y, z)
+
+#define Ch(x,y,z) vcmov(y, z, x)
 
 #undef R
 #define R(x,x1,x2,x3)                         \
 {                                             \
-    tmp1 = _mm_add_epi32 (s1(w[x1]), w[x2]);  \
-    tmp1 = _mm_add_epi32 (w[x],  tmp1);       \
-    w[x] = _mm_add_epi32 (s0(w[x3]), tmp1);   \
+    tmp1 = vadd_epi32 (s1(w[x1]), w[x2]);     \
+    tmp1 = vadd_epi32 (w[x],  tmp1);          \
+    w[x] = vadd_epi32 (s0(w[x3]), tmp1);      \
 }
 
 #define SHA256_STEP0(a,b,c,d,e,f,g,h,x,K)            \
 {                                                    \
-    tmp1 = _mm_add_epi32 (h,    S1(e));              \
-    tmp1 = _mm_add_epi32 (tmp1, Ch(e,f,g));          \
-    tmp1 = _mm_add_epi32 (tmp1, _mm_set1_epi32(K));  \
-    tmp1 = _mm_add_epi32 (tmp1, w[x]);               \
-    tmp2 = _mm_add_epi32 (S0(a),Maj(a,b,c));         \
-    d    = _mm_add_epi32 (tmp1, d);                  \
-    h    = _mm_add_epi32 (tmp1, tmp2);               \
+    tmp1 = vadd_epi32 (h,    S1(e));                 \
+    tmp1 = vadd_epi32 (tmp1, Ch(e,f,g));             \
+    tmp1 = vadd_epi32 (tmp1, vset1_epi32(K));        \
+    tmp1 = vadd_epi32 (tmp1, w[x]);                  \
+    tmp2 = vadd_epi32 (S0(a),Maj(a,b,c));            \
+    d    = vadd_epi32 (tmp1, d);                     \
+    h    = vadd_epi32 (tmp1, tmp2);                  \
 }
 #define SHA256_STEP_R(a,b,c,d,e,f,g,h, x,x1,x2,x3, K)\
 {                                                    \
-	R(x,x1,x2,x3);								     \
-    tmp1 = _mm_add_epi32 (h,    S1(e));              \
-    tmp1 = _mm_add_epi32 (tmp1, Ch(e,f,g));          \
-    tmp1 = _mm_add_epi32 (tmp1, _mm_set1_epi32(K));  \
-    tmp1 = _mm_add_epi32 (tmp1, w[x]);				 \
-    tmp2 = _mm_add_epi32 (S0(a),Maj(a,b,c));         \
-    d    = _mm_add_epi32 (tmp1, d);                  \
-    h    = _mm_add_epi32 (tmp1, tmp2);               \
+    R(x,x1,x2,x3);                                   \
+    tmp1 = vadd_epi32 (h,    S1(e));                 \
+    tmp1 = vadd_epi32 (tmp1, Ch(e,f,g));             \
+    tmp1 = vadd_epi32 (tmp1, vset1_epi32(K));        \
+    tmp1 = vadd_epi32 (tmp1, w[x]);                  \
+    tmp2 = vadd_epi32 (S0(a),Maj(a,b,c));            \
+    d    = vadd_epi32 (tmp1, d);                     \
+    h    = vadd_epi32 (tmp1, tmp2);                  \
 }
 
 // this macro was used to create the new macros for the smaller w[16] array.
@@ -1621,13 +1757,13 @@ void SSESHA1body(__m128i* _data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 #if defined (MMX_COEF_SHA256)
 void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, unsigned SSEi_flags)
 {
-	__m128i a, b, c, d, e, f, g, h;
+	vtype a, b, c, d, e, f, g, h;
 	union {
-		__m128i w[16];
-		ARCH_WORD_32 p[16*sizeof(__m128i)/sizeof(ARCH_WORD_32)];
+		vtype w[16];
+		ARCH_WORD_32 p[16*sizeof(vtype)/sizeof(ARCH_WORD_32)];
 
 	}_w;
-	__m128i tmp1, tmp2, *w=_w.w;
+	vtype tmp1, tmp2, *w=_w.w;
 	ARCH_WORD_32 *saved_key=0;
 
 	int i;
@@ -1636,22 +1772,22 @@ void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 #ifdef __SSE4_1__
 		saved_key = (ARCH_WORD_32 *)data;
 		if (SSEi_flags & SSEi_4BUF_INPUT) {
-			for (i=0; i < 14; ++i) { GATHER_4x (w[i], saved_key, i); SWAP_ENDIAN (w[i]); }
-			GATHER_4x (w[14], saved_key, 14);
-			GATHER_4x (w[15], saved_key, 15);
+			for (i=0; i < 14; ++i) { VGATHER_4x (w[i], saved_key, i); vswap32 (w[i]); }
+			VGATHER_4x (w[14], saved_key, 14);
+			VGATHER_4x (w[15], saved_key, 15);
 		} else if (SSEi_flags & SSEi_2BUF_INPUT) {
-			for (i=0; i < 14; ++i) { GATHER_2x (w[i], saved_key, i); SWAP_ENDIAN (w[i]); }
-			GATHER_2x (w[14], saved_key, 14);
-			GATHER_2x (w[15], saved_key, 15);
+			for (i=0; i < 14; ++i) { VGATHER_2x (w[i], saved_key, i); vswap32 (w[i]); }
+			VGATHER_2x (w[14], saved_key, 14);
+			VGATHER_2x (w[15], saved_key, 15);
 		} else {
-			for (i=0; i < 14; ++i) { GATHER (w[i], saved_key, i); SWAP_ENDIAN (w[i]); }
-			GATHER (w[14], saved_key, 14);
-			GATHER (w[15], saved_key, 15);
+			for (i=0; i < 14; ++i) { VGATHER (w[i], saved_key, i); vswap32 (w[i]); }
+			VGATHER (w[14], saved_key, 14);
+			VGATHER (w[15], saved_key, 15);
 		}
 		if ( ((SSEi_flags & SSEi_2BUF_INPUT_FIRST_BLK) == SSEi_2BUF_INPUT_FIRST_BLK) ||
 			 ((SSEi_flags & SSEi_4BUF_INPUT_FIRST_BLK) == SSEi_4BUF_INPUT_FIRST_BLK)) {
-			SWAP_ENDIAN (w[14]);
-			SWAP_ENDIAN (w[15]);
+			vswap32 (w[14]);
+			vswap32 (w[15]);
 		}
 #else
 		int j;
@@ -1671,15 +1807,15 @@ void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 					*p++ = saved_key[(i<<4)+j];
 		}
 		for (i=0; i < 14; i++)
-			SWAP_ENDIAN (w[i]);
+			vswap32 (w[i]);
 		if ( ((SSEi_flags & SSEi_2BUF_INPUT_FIRST_BLK) == SSEi_2BUF_INPUT_FIRST_BLK) ||
 			 ((SSEi_flags & SSEi_4BUF_INPUT_FIRST_BLK) == SSEi_4BUF_INPUT_FIRST_BLK)) {
-			SWAP_ENDIAN (w[14]);
-			SWAP_ENDIAN (w[15]);
+			vswap32 (w[14]);
+			vswap32 (w[15]);
 		}
 #endif
 	} else
-		memcpy(w, data, 16*sizeof(__m128i));
+		memcpy(w, data, 16*sizeof(vtype));
 
 //	dump_stuff_shammx(w, 64, 0);
 
@@ -1688,48 +1824,48 @@ void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 		if ((SSEi_flags & SSEi_RELOAD_INP_FMT)==SSEi_RELOAD_INP_FMT)
 		{
 			i=0; // later if we do PARA, i will be used in the PARA_FOR loop
-			a = _mm_load_si128((__m128i *)&reload_state[i*16*4+0]);
-			b = _mm_load_si128((__m128i *)&reload_state[i*16*4+4]);
-			c = _mm_load_si128((__m128i *)&reload_state[i*16*4+8]);
-			d = _mm_load_si128((__m128i *)&reload_state[i*16*4+12]);
-			e = _mm_load_si128((__m128i *)&reload_state[i*16*4+16]);
-			f = _mm_load_si128((__m128i *)&reload_state[i*16*4+20]);
-			g = _mm_load_si128((__m128i *)&reload_state[i*16*4+24]);
-			h = _mm_load_si128((__m128i *)&reload_state[i*16*4+28]);
+			a = vload(&reload_state[i*16*MMX_COEF_SHA256+0]);
+			b = vload(&reload_state[i*16*MMX_COEF_SHA256+MMX_COEF_SHA256]);
+			c = vload(&reload_state[i*16*MMX_COEF_SHA256+2*MMX_COEF_SHA256]);
+			d = vload(&reload_state[i*16*MMX_COEF_SHA256+3*MMX_COEF_SHA256]);
+			e = vload(&reload_state[i*16*MMX_COEF_SHA256+4*MMX_COEF_SHA256]);
+			f = vload(&reload_state[i*16*MMX_COEF_SHA256+5*MMX_COEF_SHA256]);
+			g = vload(&reload_state[i*16*MMX_COEF_SHA256+6*MMX_COEF_SHA256]);
+			h = vload(&reload_state[i*16*MMX_COEF_SHA256+7*MMX_COEF_SHA256]);
 		}
 		else
 		{
 			i=0;
-			a = _mm_load_si128((__m128i *)&reload_state[i*32+0]);
-			b = _mm_load_si128((__m128i *)&reload_state[i*32+4]);
-			c = _mm_load_si128((__m128i *)&reload_state[i*32+8]);
-			d = _mm_load_si128((__m128i *)&reload_state[i*32+12]);
-			e = _mm_load_si128((__m128i *)&reload_state[i*32+16]);
-			f = _mm_load_si128((__m128i *)&reload_state[i*32+20]);
-			g = _mm_load_si128((__m128i *)&reload_state[i*32+24]);
-			h = _mm_load_si128((__m128i *)&reload_state[i*32+28]);
+			a = vload(&reload_state[i*8*MMX_COEF_SHA256+0]);
+			b = vload(&reload_state[i*8*MMX_COEF_SHA256+MMX_COEF_SHA256]);
+			c = vload(&reload_state[i*8*MMX_COEF_SHA256+2*MMX_COEF_SHA256]);
+			d = vload(&reload_state[i*8*MMX_COEF_SHA256+3*MMX_COEF_SHA256]);
+			e = vload(&reload_state[i*8*MMX_COEF_SHA256+4*MMX_COEF_SHA256]);
+			f = vload(&reload_state[i*8*MMX_COEF_SHA256+5*MMX_COEF_SHA256]);
+			g = vload(&reload_state[i*8*MMX_COEF_SHA256+6*MMX_COEF_SHA256]);
+			h = vload(&reload_state[i*8*MMX_COEF_SHA256+7*MMX_COEF_SHA256]);
 		}
 	} else {
 		if (SSEi_flags & SSEi_CRYPT_SHA224) {
 			/* SHA-224 IV */
-			a = _mm_set1_epi32 (0xc1059ed8);
-			b = _mm_set1_epi32 (0x367cd507);
-			c = _mm_set1_epi32 (0x3070dd17);
-			d = _mm_set1_epi32 (0xf70e5939);
-			e = _mm_set1_epi32 (0xffc00b31);
-			f = _mm_set1_epi32 (0x68581511);
-			g = _mm_set1_epi32 (0x64f98fa7);
-			h = _mm_set1_epi32 (0xbefa4fa4);
+			a = vset1_epi32 (0xc1059ed8);
+			b = vset1_epi32 (0x367cd507);
+			c = vset1_epi32 (0x3070dd17);
+			d = vset1_epi32 (0xf70e5939);
+			e = vset1_epi32 (0xffc00b31);
+			f = vset1_epi32 (0x68581511);
+			g = vset1_epi32 (0x64f98fa7);
+			h = vset1_epi32 (0xbefa4fa4);
 		} else {
 			// SHA-256 IV */
-			a = _mm_set1_epi32 (0x6a09e667);
-			b = _mm_set1_epi32 (0xbb67ae85);
-			c = _mm_set1_epi32 (0x3c6ef372);
-			d = _mm_set1_epi32 (0xa54ff53a);
-			e = _mm_set1_epi32 (0x510e527f);
-			f = _mm_set1_epi32 (0x9b05688c);
-			g = _mm_set1_epi32 (0x1f83d9ab);
-			h = _mm_set1_epi32 (0x5be0cd19);
+			a = vset1_epi32 (0x6a09e667);
+			b = vset1_epi32 (0xbb67ae85);
+			c = vset1_epi32 (0x3c6ef372);
+			d = vset1_epi32 (0xa54ff53a);
+			e = vset1_epi32 (0x510e527f);
+			f = vset1_epi32 (0x9b05688c);
+			g = vset1_epi32 (0x1f83d9ab);
+			h = vset1_epi32 (0x5be0cd19);
 		}
 	}
 	SHA256_STEP0(a, b, c, d, e, f, g, h,  0, 0x428a2f98);
@@ -1804,48 +1940,48 @@ void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 		if ((SSEi_flags & SSEi_RELOAD_INP_FMT)==SSEi_RELOAD_INP_FMT)
 		{
 			i=0; // later if we do PARA, i will be used in the PARA_FOR loop
-			a = _mm_add_epi32(a,_mm_load_si128((__m128i *)&reload_state[i*16*2+0]));
-			b = _mm_add_epi32(b,_mm_load_si128((__m128i *)&reload_state[i*16*2+4]));
-			c = _mm_add_epi32(c,_mm_load_si128((__m128i *)&reload_state[i*16*2+8]));
-			d = _mm_add_epi32(d,_mm_load_si128((__m128i *)&reload_state[i*16*2+12]));
-			e = _mm_add_epi32(e,_mm_load_si128((__m128i *)&reload_state[i*16*2+16]));
-			f = _mm_add_epi32(f,_mm_load_si128((__m128i *)&reload_state[i*16*2+20]));
-			g = _mm_add_epi32(g,_mm_load_si128((__m128i *)&reload_state[i*16*2+24]));
-			h = _mm_add_epi32(h,_mm_load_si128((__m128i *)&reload_state[i*16*2+28]));
+			a = vadd_epi32(a,vload(&reload_state[i*16*MMX_COEF_SHA256+0]));
+			b = vadd_epi32(b,vload(&reload_state[i*16*MMX_COEF_SHA256+MMX_COEF_SHA256]));
+			c = vadd_epi32(c,vload(&reload_state[i*16*MMX_COEF_SHA256+2*MMX_COEF_SHA256]));
+			d = vadd_epi32(d,vload(&reload_state[i*16*MMX_COEF_SHA256+3*MMX_COEF_SHA256]));
+			e = vadd_epi32(e,vload(&reload_state[i*16*MMX_COEF_SHA256+4*MMX_COEF_SHA256]));
+			f = vadd_epi32(f,vload(&reload_state[i*16*MMX_COEF_SHA256+5*MMX_COEF_SHA256]));
+			g = vadd_epi32(g,vload(&reload_state[i*16*MMX_COEF_SHA256+6*MMX_COEF_SHA256]));
+			h = vadd_epi32(h,vload(&reload_state[i*16*MMX_COEF_SHA256+7*MMX_COEF_SHA256]));
 		}
 		else
 		{
 			i=0;
-			a = _mm_add_epi32(a,_mm_load_si128((__m128i *)&reload_state[i*32+0]));
-			b = _mm_add_epi32(b,_mm_load_si128((__m128i *)&reload_state[i*32+4]));
-			c = _mm_add_epi32(c,_mm_load_si128((__m128i *)&reload_state[i*32+8]));
-			d = _mm_add_epi32(d,_mm_load_si128((__m128i *)&reload_state[i*32+12]));
-			e = _mm_add_epi32(e,_mm_load_si128((__m128i *)&reload_state[i*32+16]));
-			f = _mm_add_epi32(f,_mm_load_si128((__m128i *)&reload_state[i*32+20]));
-			g = _mm_add_epi32(g,_mm_load_si128((__m128i *)&reload_state[i*32+24]));
-			h = _mm_add_epi32(h,_mm_load_si128((__m128i *)&reload_state[i*32+28]));
+			a = vadd_epi32(a,vload(&reload_state[i*8*MMX_COEF_SHA256+0]));
+			b = vadd_epi32(b,vload(&reload_state[i*8*MMX_COEF_SHA256+MMX_COEF_SHA256]));
+			c = vadd_epi32(c,vload(&reload_state[i*8*MMX_COEF_SHA256+2*MMX_COEF_SHA256]));
+			d = vadd_epi32(d,vload(&reload_state[i*8*MMX_COEF_SHA256+3*MMX_COEF_SHA256]));
+			e = vadd_epi32(e,vload(&reload_state[i*8*MMX_COEF_SHA256+4*MMX_COEF_SHA256]));
+			f = vadd_epi32(f,vload(&reload_state[i*8*MMX_COEF_SHA256+5*MMX_COEF_SHA256]));
+			g = vadd_epi32(g,vload(&reload_state[i*8*MMX_COEF_SHA256+6*MMX_COEF_SHA256]));
+			h = vadd_epi32(h,vload(&reload_state[i*8*MMX_COEF_SHA256+7*MMX_COEF_SHA256]));
 		}
 	} else if ((SSEi_flags & SSEi_SKIP_FINAL_ADD) == 0) {
 		if (SSEi_flags & SSEi_CRYPT_SHA224) {
 			/* SHA-224 IV */
-			a = _mm_add_epi32 (a, _mm_set1_epi32 (0xc1059ed8));
-			b = _mm_add_epi32 (b, _mm_set1_epi32 (0x367cd507));
-			c = _mm_add_epi32 (c, _mm_set1_epi32 (0x3070dd17));
-			d = _mm_add_epi32 (d, _mm_set1_epi32 (0xf70e5939));
-			e = _mm_add_epi32 (e, _mm_set1_epi32 (0xffc00b31));
-			f = _mm_add_epi32 (f, _mm_set1_epi32 (0x68581511));
-			g = _mm_add_epi32 (g, _mm_set1_epi32 (0x64f98fa7));
-			h = _mm_add_epi32 (h, _mm_set1_epi32 (0xbefa4fa4));
+			a = vadd_epi32 (a, vset1_epi32 (0xc1059ed8));
+			b = vadd_epi32 (b, vset1_epi32 (0x367cd507));
+			c = vadd_epi32 (c, vset1_epi32 (0x3070dd17));
+			d = vadd_epi32 (d, vset1_epi32 (0xf70e5939));
+			e = vadd_epi32 (e, vset1_epi32 (0xffc00b31));
+			f = vadd_epi32 (f, vset1_epi32 (0x68581511));
+			g = vadd_epi32 (g, vset1_epi32 (0x64f98fa7));
+			h = vadd_epi32 (h, vset1_epi32 (0xbefa4fa4));
 		} else {
 			/* SHA-256 IV */
-			a = _mm_add_epi32 (a, _mm_set1_epi32 (0x6a09e667));
-			b = _mm_add_epi32 (b, _mm_set1_epi32 (0xbb67ae85));
-			c = _mm_add_epi32 (c, _mm_set1_epi32 (0x3c6ef372));
-			d = _mm_add_epi32 (d, _mm_set1_epi32 (0xa54ff53a));
-			e = _mm_add_epi32 (e, _mm_set1_epi32 (0x510e527f));
-			f = _mm_add_epi32 (f, _mm_set1_epi32 (0x9b05688c));
-			g = _mm_add_epi32 (g, _mm_set1_epi32 (0x1f83d9ab));
-			h = _mm_add_epi32 (h, _mm_set1_epi32 (0x5be0cd19));
+			a = vadd_epi32 (a, vset1_epi32 (0x6a09e667));
+			b = vadd_epi32 (b, vset1_epi32 (0xbb67ae85));
+			c = vadd_epi32 (c, vset1_epi32 (0x3c6ef372));
+			d = vadd_epi32 (d, vset1_epi32 (0xa54ff53a));
+			e = vadd_epi32 (e, vset1_epi32 (0x510e527f));
+			f = vadd_epi32 (f, vset1_epi32 (0x9b05688c));
+			g = vadd_epi32 (g, vset1_epi32 (0x1f83d9ab));
+			h = vadd_epi32 (h, vset1_epi32 (0x5be0cd19));
 		}
 	}
 	if (SSEi_flags & SSEi_SWAP_FINAL) {
@@ -1853,14 +1989,14 @@ void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 		 * used in a sha256_flags&SHA256_RELOAD manner, without swapping back into BE format.
 		 * NORMALLY, a format will switch binary values into BE format at start, and then
 		 * just take the 'normal' non swapped output of this function (i.e. keep it in BE) */
-		SWAP_ENDIAN (a);
-		SWAP_ENDIAN (b);
-		SWAP_ENDIAN (c);
-		SWAP_ENDIAN (d);
-		SWAP_ENDIAN (e);
-		SWAP_ENDIAN (f);
-		SWAP_ENDIAN (g);
-		SWAP_ENDIAN (h);
+		vswap32 (a);
+		vswap32 (b);
+		vswap32 (c);
+		vswap32 (d);
+		vswap32 (e);
+		vswap32 (f);
+		vswap32 (g);
+		vswap32 (h);
 	}
 	/* We store the MMX_mixed values.  This will be in proper 'mixed' format, in BE
 	 * format (i.e. correct to reload on a subsquent call), UNLESS, swapped in the prior
@@ -1870,14 +2006,14 @@ void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 		i=0;
 		//SHA512_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*16*4+0], a);
-			_mm_store_si128((__m128i *)&out[i*16*4+4], b);
-			_mm_store_si128((__m128i *)&out[i*16*4+8], c);
-			_mm_store_si128((__m128i *)&out[i*16*4+12], d);
-			_mm_store_si128((__m128i *)&out[i*16*4+16], e);
-			_mm_store_si128((__m128i *)&out[i*16*4+20], f);
-			_mm_store_si128((__m128i *)&out[i*16*4+24], g);
-			_mm_store_si128((__m128i *)&out[i*16*4+28], h);
+			vstore(&out[i*16*MMX_COEF_SHA256+0], a);
+			vstore(&out[i*16*MMX_COEF_SHA256+MMX_COEF_SHA256], b);
+			vstore(&out[i*16*MMX_COEF_SHA256+2*MMX_COEF_SHA256], c);
+			vstore(&out[i*16*MMX_COEF_SHA256+3*MMX_COEF_SHA256], d);
+			vstore(&out[i*16*MMX_COEF_SHA256+4*MMX_COEF_SHA256], e);
+			vstore(&out[i*16*MMX_COEF_SHA256+5*MMX_COEF_SHA256], f);
+			vstore(&out[i*16*MMX_COEF_SHA256+6*MMX_COEF_SHA256], g);
+			vstore(&out[i*16*MMX_COEF_SHA256+7*MMX_COEF_SHA256], h);
 		}
 	}
 	else
@@ -1885,14 +2021,14 @@ void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 		i=0;
 		//SHA512_PARA_DO(i)
 		{
-			_mm_store_si128 ((__m128i *)&(out[i*32+0]), a);
-			_mm_store_si128 ((__m128i *)&(out[i*32+4]), b);
-			_mm_store_si128 ((__m128i *)&(out[i*32+8]), c);
-			_mm_store_si128 ((__m128i *)&(out[i*32+12]), d);
-			_mm_store_si128 ((__m128i *)&(out[i*32+16]), e);
-			_mm_store_si128 ((__m128i *)&(out[i*32+20]), f);
-			_mm_store_si128 ((__m128i *)&(out[i*32+24]), g);
-			_mm_store_si128 ((__m128i *)&(out[i*32+28]), h);
+			vstore(&out[i*8*MMX_COEF_SHA256+0], a);
+			vstore(&out[i*8*MMX_COEF_SHA256+MMX_COEF_SHA256], b);
+			vstore(&out[i*8*MMX_COEF_SHA256+2*MMX_COEF_SHA256], c);
+			vstore(&out[i*8*MMX_COEF_SHA256+3*MMX_COEF_SHA256], d);
+			vstore(&out[i*8*MMX_COEF_SHA256+4*MMX_COEF_SHA256], e);
+			vstore(&out[i*8*MMX_COEF_SHA256+5*MMX_COEF_SHA256], f);
+			vstore(&out[i*8*MMX_COEF_SHA256+6*MMX_COEF_SHA256], g);
+			vstore(&out[i*8*MMX_COEF_SHA256+7*MMX_COEF_SHA256], h);
 		}
 	}
 
@@ -1902,74 +2038,38 @@ void SSESHA256body(__m128i *data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state,
 /* SHA-512 below */
 
 #undef S0
-#define S0(x)                          \
-(                                      \
-    _mm_xor_si128 (                    \
-        _mm_roti_epi64 (x, -39),       \
-        _mm_xor_si128 (                \
-            _mm_roti_epi64 (x, -28),   \
-            _mm_roti_epi64 (x, -34)    \
-        )                              \
-    )                                  \
-)
+#define S0(x) vxor3(vroti_epi64(x, -39), vroti_epi64(x, -28), vroti_epi64(x, -34))
 
 #undef S1
-#define S1(x)                          \
-(                                      \
-    _mm_xor_si128 (                    \
-        _mm_roti_epi64 (x, -41),       \
-        _mm_xor_si128 (                \
-            _mm_roti_epi64 (x, -14),   \
-            _mm_roti_epi64 (x, -18)    \
-        )                              \
-    )                                  \
-)
+#define S1(x) vxor3(vroti_epi64(x, -41), vroti_epi64(x, -14), vroti_epi64(x, -18))
 
 #undef s0
-#define s0(x)                          \
-(                                      \
-    _mm_xor_si128 (                    \
-        _mm_srli_epi64 (x, 7),         \
-        _mm_xor_si128 (                \
-            _mm_roti_epi64 (x, -1),    \
-            _mm_roti_epi64 (x, -8)     \
-        )                              \
-    )                                  \
-)
+#define s0(x) vxor3(vsrli_epi64(x, 7), vroti_epi64(x, -1), vroti_epi64(x, -8))
 
 #undef s1
-#define s1(x)                          \
-(                                      \
-    _mm_xor_si128 (                    \
-        _mm_srli_epi64 (x, 6),         \
-        _mm_xor_si128 (                \
-            _mm_roti_epi64 (x, -19),   \
-            _mm_roti_epi64 (x, -61)    \
-        )                              \
-    )                                  \
-)
+#define s1(x) vxor3(vsrli_epi64(x, 6), vroti_epi64(x, -19), vroti_epi64(x, -61))
 
-#define Maj(x,y,z) _mm_cmov_si128 (x, y, _mm_xor_si128 (z, y))
+#define Maj(x,y,z) vmaj(x, y, z)
 
-#define Ch(x,y,z)  _mm_cmov_si128 (y, z, x)
+#define Ch(x,y,z)  vcmov(y, z, x)
 
 #undef R
 #define R(t)                                         \
 {                                                    \
-    tmp1 = _mm_add_epi64 (s1(w[t -  2]), w[t - 7]);  \
-    tmp2 = _mm_add_epi64 (s0(w[t - 15]), w[t - 16]); \
-    w[t] = _mm_add_epi64 (tmp1, tmp2);               \
+    tmp1 = vadd_epi64 (s1(w[t -  2]), w[t - 7]);     \
+    tmp2 = vadd_epi64 (s0(w[t - 15]), w[t - 16]);    \
+    w[t] = vadd_epi64 (tmp1, tmp2);                  \
 }
 
 #define SHA512_STEP(a,b,c,d,e,f,g,h,x,K)             \
 {                                                    \
-    tmp1 = _mm_add_epi64 (h,    w[x]);               \
-    tmp2 = _mm_add_epi64 (S1(e),_mm_set1_epi64x(K)); \
-    tmp1 = _mm_add_epi64 (tmp1, Ch(e,f,g));          \
-    tmp1 = _mm_add_epi64 (tmp1, tmp2);               \
-    tmp2 = _mm_add_epi64 (S0(a),Maj(a,b,c));         \
-    d    = _mm_add_epi64 (tmp1, d);                  \
-    h    = _mm_add_epi64 (tmp1, tmp2);               \
+    tmp1 = vadd_epi64 (h,    w[x]);                  \
+    tmp2 = vadd_epi64 (S1(e),vset1_epi64x(K));       \
+    tmp1 = vadd_epi64 (tmp1, Ch(e,f,g));             \
+    tmp1 = vadd_epi64 (tmp1, tmp2);                  \
+    tmp2 = vadd_epi64 (S0(a),Maj(a,b,c));            \
+    d    = vadd_epi64 (tmp1, d);                     \
+    h    = vadd_epi64 (tmp1, tmp2);                  \
 }
 
 #if defined (MMX_COEF_SHA512)
@@ -1977,44 +2077,29 @@ void SSESHA512body(__m128i* data, ARCH_WORD_64 *out, ARCH_WORD_64 *reload_state,
 {
 	int i;
 
-	__m128i a, b, c, d, e, f, g, h;
-	__m128i w[80], tmp1, tmp2;
+	vtype a, b, c, d, e, f, g, h;
+	union {
+		vtype w[80];
+		ARCH_WORD_64 p[16*sizeof(vtype)/sizeof(ARCH_WORD_64)];
+	} _w;
+	vtype tmp1, tmp2, *w = _w.w;
 
 	if (SSEi_flags & SSEi_FLAT_IN) {
-
-		if (SSEi_flags & SSEi_2BUF_INPUT) {
-			ARCH_WORD_64 (*saved_key)[32] = (ARCH_WORD_64(*)[32])data;
-			for (i = 0; i < 14; i += 2) {
-				GATHER64 (tmp1, saved_key, i);
-				GATHER64 (tmp2, saved_key, i + 1);
-				SWAP_ENDIAN64 (tmp1);
-				SWAP_ENDIAN64 (tmp2);
-				w[i] = tmp1;
-				w[i + 1] = tmp2;
-			}
-			GATHER64 (tmp1, saved_key, 14);
-			GATHER64 (tmp2, saved_key, 15);
-		} else {
-			ARCH_WORD_64 (*saved_key)[16] = (ARCH_WORD_64(*)[16])data;
-			for (i = 0; i < 14; i += 2) {
-				GATHER64 (tmp1, saved_key, i);
-				GATHER64 (tmp2, saved_key, i + 1);
-				SWAP_ENDIAN64 (tmp1);
-				SWAP_ENDIAN64 (tmp2);
-				w[i] = tmp1;
-				w[i + 1] = tmp2;
-			}
-			GATHER64 (tmp1, saved_key, 14);
-			GATHER64 (tmp2, saved_key, 15);
-		}
+		ARCH_WORD_64 *saved_key = (ARCH_WORD_64 *)data;
+		ARCH_WORD_64 *p = _w.p;
+		int j, stride = (SSEi_flags & SSEi_2BUF_INPUT) ? 32 : 16;
+
+		for (j = 0; j < 16; j++)
+			for (i = 0; i < MMX_COEF_SHA512; i++)
+				*p++ = saved_key[i*stride+j];
+		for (i = 0; i < 14; i++)
+			vswap64(w[i]);
 		if ( ((SSEi_flags & SSEi_2BUF_INPUT_FIRST_BLK) == SSEi_2BUF_INPUT_FIRST_BLK)) {
-			SWAP_ENDIAN64 (tmp1);
-			SWAP_ENDIAN64 (tmp2);
+			vswap64(w[14]);
+			vswap64(w[15]);
 		}
-		w[14] = tmp1;
-		w[15] = tmp2;
 	} else
-		memcpy(w, data, 16*sizeof(__m128i));
+		memcpy(w, data, 16*sizeof(vtype));
 
 	for (i = 16; i < 80; i++)
 		R(i);
@@ -2023,48 +2108,48 @@ void SSESHA512body(__m128i* data, ARCH_WORD_64 *out, ARCH_WORD_64 *reload_state,
 		if ((SSEi_flags & SSEi_RELOAD_INP_FMT)==SSEi_RELOAD_INP_FMT)
 		{
 			i=0; // later if we do PARA, i will be used in the PARA_FOR loop
-			a = _mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+( 0/2)]);
-			b = _mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+( 4/2)]);
-			c = _mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+( 8/2)]);
-			d = _mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(12/2)]);
-			e = _mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(16/2)]);
-			f = _mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(20/2)]);
-			g = _mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(24/2)]);
-			h = _mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(28/2)]);
+			a = vload(&reload_state[i*16*MMX_COEF_SHA512+0]);
+			b = vload(&reload_state[i*16*MMX_COEF_SHA512+MMX_COEF_SHA512]);
+			c = vload(&reload_state[i*16*MMX_COEF_SHA512+2*MMX_COEF_SHA512]);
+			d = vload(&reload_state[i*16*MMX_COEF_SHA512+3*MMX_COEF_SHA512]);
+			e = vload(&reload_state[i*16*MMX_COEF_SHA512+4*MMX_COEF_SHA512]);
+			f = vload(&reload_state[i*16*MMX_COEF_SHA512+5*MMX_COEF_SHA512]);
+			g = vload(&reload_state[i*16*MMX_COEF_SHA512+6*MMX_COEF_SHA512]);
+			h = vload(&reload_state[i*16*MMX_COEF_SHA512+7*MMX_COEF_SHA512]);
 		}
 		else
 		{
 			i=0;
-			a = _mm_load_si128((__m128i *)&reload_state[i*(32/2)+( 0/2)]);
-			b = _mm_load_si128((__m128i *)&reload_state[i*(32/2)+( 4/2)]);
-			c = _mm_load_si128((__m128i *)&reload_state[i*(32/2)+( 8/2)]);
-			d = _mm_load_si128((__m128i *)&reload_state[i*(32/2)+(12/2)]);
-			e = _mm_load_si128((__m128i *)&reload_state[i*(32/2)+(16/2)]);
-			f = _mm_load_si128((__m128i *)&reload_state[i*(32/2)+(20/2)]);
-			g = _mm_load_si128((__m128i *)&reload_state[i*(32/2)+(24/2)]);
-			h = _mm_load_si128((__m128i *)&reload_state[i*(32/2)+(28/2)]);
+			a = vload(&reload_state[i*8*MMX_COEF_SHA512+0]);
+			b = vload(&reload_state[i*8*MMX_COEF_SHA512+MMX_COEF_SHA512]);
+			c = vload(&reload_state[i*8*MMX_COEF_SHA512+2*MMX_COEF_SHA512]);
+			d = vload(&reload_state[i*8*MMX_COEF_SHA512+3*MMX_COEF_SHA512]);
+			e = vload(&reload_state[i*8*MMX_COEF_SHA512+4*MMX_COEF_SHA512]);
+			f = vload(&reload_state[i*8*MMX_COEF_SHA512+5*MMX_COEF_SHA512]);
+			g = vload(&reload_state[i*8*MMX_COEF_SHA512+6*MMX_COEF_SHA512]);
+			h = vload(&reload_state[i*8*MMX_COEF_SHA512+7*MMX_COEF_SHA512]);
 		}
 	} else {
 		if (SSEi_flags & SSEi_CRYPT_SHA384) {
 			/* SHA-384 IV */
-			a = _mm_set1_epi64x (0xcbbb9d5dc1059ed8ULL);
-			b = _mm_set1_epi64x (0x629a292a367cd507ULL);
-			c = _mm_set1_epi64x (0x9159015a3070dd17ULL);
-			d = _mm_set1_epi64x (0x152fecd8f70e5939ULL);
-			e = _mm_set1_epi64x (0x67332667ffc00b31ULL);
-			f = _mm_set1_epi64x (0x8eb44a8768581511ULL);
-			g = _mm_set1_epi64x (0xdb0c2e0d64f98fa7ULL);
-			h = _mm_set1_epi64x (0x47b5481dbefa4fa4ULL);
+			a = vset1_epi64x (0xcbbb9d5dc1059ed8ULL);
+			b = vset1_epi64x (0x629a292a367cd507ULL);
+			c = vset1_epi64x (0x9159015a3070dd17ULL);
+			d = vset1_epi64x (0x152fecd8f70e5939ULL);
+			e = vset1_epi64x (0x67332667ffc00b31ULL);
+			f = vset1_epi64x (0x8eb44a8768581511ULL);
+			g = vset1_epi64x (0xdb0c2e0d64f98fa7ULL);
+			h = vset1_epi64x (0x47b5481dbefa4fa4ULL);
 		} else {
 			// SHA-512 IV */
-			a = _mm_set1_epi64x (0x6a09e667f3bcc908ULL);
-			b = _mm_set1_epi64x (0xbb67ae8584caa73bULL);
-			c = _mm_set1_epi64x (0x3c6ef372fe94f82bULL);
-			d = _mm_set1_epi64x (0xa54ff53a5f1d36f1ULL);
-			e = _mm_set1_epi64x (0x510e527fade682d1ULL);
-			f = _mm_set1_epi64x (0x9b05688c2b3e6c1fULL);
-			g = _mm_set1_epi64x (0x1f83d9abfb41bd6bULL);
-			h = _mm_set1_epi64x (0x5be0cd19137e2179ULL);
+			a = vset1_epi64x (0x6a09e667f3bcc908ULL);
+			b = vset1_epi64x (0xbb67ae8584caa73bULL);
+			c = vset1_epi64x (0x3c6ef372fe94f82bULL);
+			d = vset1_epi64x (0xa54ff53a5f1d36f1ULL);
+			e = vset1_epi64x (0x510e527fade682d1ULL);
+			f = vset1_epi64x (0x9b05688c2b3e6c1fULL);
+			g = vset1_epi64x (0x1f83d9abfb41bd6bULL);
+			h = vset1_epi64x (0x5be0cd19137e2179ULL);
 		}
 	}
 
@@ -2159,14 +2244,14 @@ void SSESHA512body(__m128i* data, ARCH_WORD_64 *out, ARCH_WORD_64 *reload_state,
 			i=0; // later if we do PARA, i will be used in the PARA_FOR loop
 			//SHA512_PARA_DO(i)
 			{
-				a = _mm_add_epi64(a,_mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+( 0/2)]));
-				b = _mm_add_epi64(b,_mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+( 4/2)]));
-				c = _mm_add_epi64(c,_mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+( 8/2)]));
-				d = _mm_add_epi64(d,_mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(12/2)]));
-				e = _mm_add_epi64(e,_mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(16/2)]));
-				f = _mm_add_epi64(f,_mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(20/2)]));
-				g = _mm_add_epi64(g,_mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(24/2)]));
-				h = _mm_add_epi64(h,_mm_load_si128((__m128i *)&reload_state[i*(16/2)*8+(28/2)]));
+				a = vadd_epi64(a,vload(&reload_state[i*16*MMX_COEF_SHA512+0]));
+				b = vadd_epi64(b,vload(&reload_state[i*16*MMX_COEF_SHA512+MMX_COEF_SHA512]));
+				c = vadd_epi64(c,vload(&reload_state[i*16*MMX_COEF_SHA512+2*MMX_COEF_SHA512]));
+				d = vadd_epi64(d,vload(&reload_state[i*16*MMX_COEF_SHA512+3*MMX_COEF_SHA512]));
+				e = vadd_epi64(e,vload(&reload_state[i*16*MMX_COEF_SHA512+4*MMX_COEF_SHA512]));
+				f = vadd_epi64(f,vload(&reload_state[i*16*MMX_COEF_SHA512+5*MMX_COEF_SHA512]));
+				g = vadd_epi64(g,vload(&reload_state[i*16*MMX_COEF_SHA512+6*MMX_COEF_SHA512]));
+				h = vadd_epi64(h,vload(&reload_state[i*16*MMX_COEF_SHA512+7*MMX_COEF_SHA512]));
 			}
 		}
 		else
@@ -2174,37 +2259,37 @@ void SSESHA512body(__m128i* data, ARCH_WORD_64 *out, ARCH_WORD_64 *reload_state,
 			i=0;
 			//SHA512_PARA_DO(i)
 			{
-				a = _mm_add_epi64(a,_mm_load_si128((__m128i *)&reload_state[i*(32/2)+( 0/2)]));
-				b = _mm_add_epi64(b,_mm_load_si128((__m128i *)&reload_state[i*(32/2)+( 4/2)]));
-				c = _mm_add_epi64(c,_mm_load_si128((__m128i *)&reload_state[i*(32/2)+( 8/2)]));
-				d = _mm_add_epi64(d,_mm_load_si128((__m128i *)&reload_state[i*(32/2)+(12/2)]));
-				e = _mm_add_epi64(e,_mm_load_si128((__m128i *)&reload_state[i*(32/2)+(16/2)]));
-				f = _mm_add_epi64(f,_mm_load_si128((__m128i *)&reload_state[i*(32/2)+(20/2)]));
-				g = _mm_add_epi64(g,_mm_load_si128((__m128i *)&reload_state[i*(32/2)+(24/2)]));
-				h = _mm_add_epi64(h,_mm_load_si128((__m128i *)&reload_state[i*(32/2)+(28/2)]));
+				a = vadd_epi64(a,vload(&reload_state[i*8*MMX_COEF_SHA512+0]));
+				b = vadd_epi64(b,vload(&reload_state[i*8*MMX_COEF_SHA512+MMX_COEF_SHA512]));
+				c = vadd_epi64(c,vload(&reload_state[i*8*MMX_COEF_SHA512+2*MMX_COEF_SHA512]));
+				d = vadd_epi64(d,vload(&reload_state[i*8*MMX_COEF_SHA512+3*MMX_COEF_SHA512]));
+				e = vadd_epi64(e,vload(&reload_state[i*8*MMX_COEF_SHA512+4*MMX_COEF_SHA512]));
+				f = vadd_epi64(f,vload(&reload_state[i*8*MMX_COEF_SHA512+5*MMX_COEF_SHA512]));
+				g = vadd_epi64(g,vload(&reload_state[i*8*MMX_COEF_SHA512+6*MMX_COEF_SHA512]));
+				h = vadd_epi64(h,vload(&reload_state[i*8*MMX_COEF_SHA512+7*MMX_COEF_SHA512]));
 				}
 		}
 	} else if ((SSEi_flags & SSEi_SKIP_FINAL_ADD) == 0) {
 		if (SSEi_flags & SSEi_CRYPT_SHA384) {
 			/* SHA-384 IV */
-			a = _mm_add_epi64 (a, _mm_set1_epi64x (0xcbbb9d5dc1059ed8ULL));
-			b = _mm_add_epi64 (b, _mm_set1_epi64x (0x629a292a367cd507ULL));
-			c = _mm_add_epi64 (c, _mm_set1_epi64x (0x9159015a3070dd17ULL));
-			d = _mm_add_epi64 (d, _mm_set1_epi64x (0x152fecd8f70e5939ULL));
-			e = _mm_add_epi64 (e, _mm_set1_epi64x (0x67332667ffc00b31ULL));
-			f = _mm_add_epi64 (f, _mm_set1_epi64x (0x8eb44a8768581511ULL));
-			g = _mm_add_epi64 (g, _mm_set1_epi64x (0xdb0c2e0d64f98fa7ULL));
-			h = _mm_add_epi64 (h, _mm_set1_epi64x (0x47b5481dbefa4fa4ULL));
+			a = vadd_epi64 (a, vset1_epi64x (0xcbbb9d5dc1059ed8ULL));
+			b = vadd_epi64 (b, vset1_epi64x (0x629a292a367cd507ULL));
+			c = vadd_epi64 (c, vset1_epi64x (0x9159015a3070dd17ULL));
+			d = vadd_epi64 (d, vset1_epi64x (0x152fecd8f70e5939ULL));
+			e = vadd_epi64 (e, vset1_epi64x (0x67332667ffc00b31ULL));
+			f = vadd_epi64 (f, vset1_epi64x (0x8eb44a8768581511ULL));
+			g = vadd_epi64 (g, vset1_epi64x (0xdb0c2e0d64f98fa7ULL));
+			h = vadd_epi64 (h, vset1_epi64x (0x47b5481dbefa4fa4ULL));
 		} else {
 			/* SHA-512 IV */
-			a = _mm_add_epi64 (a, _mm_set1_epi64x (0x6a09e667f3bcc908ULL));
-			b = _mm_add_epi64 (b, _mm_set1_epi64x (0xbb67ae8584caa73bULL));
-			c = _mm_add_epi64 (c, _mm_set1_epi64x (0x3c6ef372fe94f82bULL));
-			d = _mm_add_epi64 (d, _mm_set1_epi64x (0xa54ff53a5f1d36f1ULL));
-			e = _mm_add_epi64 (e, _mm_set1_epi64x (0x510e527fade682d1ULL));
-			f = _mm_add_epi64 (f, _mm_set1_epi64x (0x9b05688c2b3e6c1fULL));
-			g = _mm_add_epi64 (g, _mm_set1_epi64x (0x1f83d9abfb41bd6bULL));
-			h = _mm_add_epi64 (h, _mm_set1_epi64x (0x5be0cd19137e2179ULL));
+			a = vadd_epi64 (a, vset1_epi64x (0x6a09e667f3bcc908ULL));
+			b = vadd_epi64 (b, vset1_epi64x (0xbb67ae8584caa73bULL));
+			c = vadd_epi64 (c, vset1_epi64x (0x3c6ef372fe94f82bULL));
+			d = vadd_epi64 (d, vset1_epi64x (0xa54ff53a5f1d36f1ULL));
+			e = vadd_epi64 (e, vset1_epi64x (0x510e527fade682d1ULL));
+			f = vadd_epi64 (f, vset1_epi64x (0x9b05688c2b3e6c1fULL));
+			g = vadd_epi64 (g, vset1_epi64x (0x1f83d9abfb41bd6bULL));
+			h = vadd_epi64 (h, vset1_epi64x (0x5be0cd19137e2179ULL));
 		}
 	}
 
@@ -2213,14 +2298,14 @@ void SSESHA512body(__m128i* data, ARCH_WORD_64 *out, ARCH_WORD_64 *reload_state,
 		 * used in a sha512_flags&SHA512_RELOAD manner, without swapping back into BE format.
 		 * NORMALLY, a format will switch binary values into BE format at start, and then
 		 * just take the 'normal' non swapped output of this function (i.e. keep it in BE) */
-		SWAP_ENDIAN64(a);
-		SWAP_ENDIAN64(b);
-		SWAP_ENDIAN64(c);
-		SWAP_ENDIAN64(d);
-		SWAP_ENDIAN64(e);
-		SWAP_ENDIAN64(f);
-		SWAP_ENDIAN64(g);
-		SWAP_ENDIAN64(h);
+		vswap64(a);
+		vswap64(b);
+		vswap64(c);
+		vswap64(d);
+		vswap64(e);
+		vswap64(f);
+		vswap64(g);
+		vswap64(h);
 	}
 
 	/* We store the MMX_mixed values.  This will be in proper 'mixed' format, in BE
@@ -2231,14 +2316,14 @@ void SSESHA512body(__m128i* data, ARCH_WORD_64 *out, ARCH_WORD_64 *reload_state,
 		i=0;
 		//SHA512_PARA_DO(i)
 		{
-			_mm_store_si128((__m128i *)&out[i*(16/2)*8+( 0/2)], a);
-			_mm_store_si128((__m128i *)&out[i*(16/2)*8+( 4/2)], b);
-			_mm_store_si128((__m128i *)&out[i*(16/2)*8+( 8/2)], c);
-			_mm_store_si128((__m128i *)&out[i*(16/2)*8+(12/2)], d);
-			_mm_store_si128((__m128i *)&out[i*(16/2)*8+(16/2)], e);
-			_mm_store_si128((__m128i *)&out[i*(16/2)*8+(20/2)], f);
-			_mm_store_si128((__m128i *)&out[i*(16/2)*8+(24/2)], g);
-			_mm_store_si128((__m128i *)&out[i*(16/2)*8+(28/2)], h);
+			vstore(&out[i*16*MMX_COEF_SHA512+0], a);
+			vstore(&out[i*16*MMX_COEF_SHA512+MMX_COEF_SHA512], b);
+			vstore(&out[i*16*MMX_COEF_SHA512+2*MMX_COEF_SHA512], c);
+			vstore(&out[i*16*MMX_COEF_SHA512+3*MMX_COEF_SHA512], d);
+			vstore(&out[i*16*MMX_COEF_SHA512+4*MMX_COEF_SHA512], e);
+			vstore(&out[i*16*MMX_COEF_SHA512+5*MMX_COEF_SHA512], f);
+			vstore(&out[i*16*MMX_COEF_SHA512+6*MMX_COEF_SHA512], g);
+			vstore(&out[i*16*MMX_COEF_SHA512+7*MMX_COEF_SHA512], h);
 		}
 	}
 	else
@@ -2246,14 +2331,14 @@ void SSESHA512body(__m128i* data, ARCH_WORD_64 *out, ARCH_WORD_64 *reload_state,
 		i=0;
 		//SHA512_PARA_DO(i)
 		{
-			_mm_store_si128 ((__m128i *)&(out[i*(32/2)+( 0/2)]), a);
-			_mm_store_si128 ((__m128i *)&(out[i*(32/2)+( 4/2)]), b);
-			_mm_store_si128 ((__m128i *)&(out[i*(32/2)+( 8/2)]), c);
-			_mm_store_si128 ((__m128i *)&(out[i*(32/2)+(12/2)]), d);
-			_mm_store_si128 ((__m128i *)&(out[i*(32/2)+(16/2)]), e);
-			_mm_store_si128 ((__m128i *)&(out[i*(32/2)+(20/2)]), f);
-			_mm_store_si128 ((__m128i *)&(out[i*(32/2)+(24/2)]), g);
-			_mm_store_si128 ((__m128i *)&(out[i*(32/2)+(28/2)]), h);
+			vstore(&out[i*8*MMX_COEF_SHA512+0], a);
+			vstore(&out[i*8*MMX_COEF_SHA512+MMX_COEF_SHA512], b);
+			vstore(&out[i*8*MMX_COEF_SHA512+2*MMX_COEF_SHA512], c);
+			vstore(&out[i*8*MMX_COEF_SHA512+3*MMX_COEF_SHA512], d);
+			vstore(&out[i*8*MMX_COEF_SHA512+4*MMX_COEF_SHA512], e);
+			vstore(&out[i*8*MMX_COEF_SHA512+5*MMX_COEF_SHA512], f);
+			vstore(&out[i*8*MMX_COEF_SHA512+6*MMX_COEF_SHA512], g);
+			vstore(&out[i*8*MMX_COEF_SHA512+7*MMX_COEF_SHA512], h);
 		}
 	}
 
@@ -25,7 +25,13 @@
 #define STRINGIZE2(s) #s
 #define STRINGIZE(s) STRINGIZE2(s)
 
-#if defined(__XOP__)
+#if MMX_COEF == 16
+#undef SSE_type
+#define SSE_type			"AVX512BW"
+#elif MMX_COEF == 8
+#undef SSE_type
+#define SSE_type			"AVX2"
+#elif defined(__XOP__)
 #undef SSE_type
 #define SSE_type			"XOP"
 #elif defined(__AVX__)
@@ -42,11 +48,20 @@
 #define SSE_type			"SSE2"
 #endif
 
+/* Vector width used by all of the SSE*body() functions */
+#if MMX_COEF == 16
+#define SIMD_WIDTH_STR			"512/512 "
+#elif MMX_COEF == 8
+#define SIMD_WIDTH_STR			"256/256 "
+#else
+#define SIMD_WIDTH_STR			"128/128 "
+#endif
+
 #ifdef MD5_SSE_PARA
 void md5cryptsse(unsigned char * buf, unsigned char * salt, char * out, int md5_type);
 void SSEmd5body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, unsigned SSEi_flags);
 #define MD5_SSE_type			SSE_type
-#define MD5_ALGORITHM_NAME		"128/128 " MD5_SSE_type " " MD5_N_STR
+#define MD5_ALGORITHM_NAME		SIMD_WIDTH_STR MD5_SSE_type " " MD5_N_STR
 #else
 #define MD5_SSE_type			"1x"
 #define MD5_ALGORITHM_NAME		"32/" ARCH_BITS_STR
@@ -56,7 +71,7 @@ void SSEmd5body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, un
 //void SSEmd4body(__m128i* data, unsigned int * out, int init);
 void SSEmd4body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, unsigned SSEi_flags);
 #define MD4_SSE_type			SSE_type
-#define MD4_ALGORITHM_NAME		"128/128 " MD4_SSE_type " " MD4_N_STR
+#define MD4_ALGORITHM_NAME		SIMD_WIDTH_STR MD4_SSE_type " " MD4_N_STR
 #else
 #define MD4_SSE_type			"1x"
 #define MD4_ALGORITHM_NAME		"32/" ARCH_BITS_STR
@@ -65,7 +80,7 @@ void SSEmd4body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, un
 #ifdef SHA1_SSE_PARA
 void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, unsigned SSEi_flags);
 #define SHA1_SSE_type			SSE_type
-#define SHA1_ALGORITHM_NAME		"128/128 " SHA1_SSE_type " " SHA1_N_STR
+#define SHA1_ALGORITHM_NAME		SIMD_WIDTH_STR SHA1_SSE_type " " SHA1_N_STR
 #else
 #define SHA1_SSE_type			"1x"
 #define SHA1_ALGORITHM_NAME		"32/" ARCH_BITS_STR
@@ -73,7 +88,11 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 
 // code for SHA256 and SHA512 (from rawSHA256_ng_fmt.c and rawSHA512_ng_fmt.c)
 
-#if defined __XOP__
+#if MMX_COEF == 16
+#define SIMD_TYPE                 "AVX512BW"
+#elif MMX_COEF == 8
+#define SIMD_TYPE                 "AVX2"
+#elif defined __XOP__
 #define SIMD_TYPE                 "XOP"
 #elif defined __SSE4_1__
 #define SIMD_TYPE                 "SSE4.1"
@@ -84,23 +103,29 @@ void SSESHA1body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, u
 #endif
 
 // we use the 'outter' MMX_COEF wrapper, as the flag for SHA256/SHA512.  FIX_ME!!
-#if MMX_COEF==4
+#if MMX_COEF
 
 #ifdef MMX_COEF_SHA256
-#define SHA256_ALGORITHM_NAME	"128/128 " SIMD_TYPE " " STRINGIZE(MMX_COEF_SHA256)"x"
+#define SHA256_ALGORITHM_NAME	SIMD_WIDTH_STR SIMD_TYPE " " STRINGIZE(MMX_COEF_SHA256)"x"
 void SSESHA256body(__m128i* data, ARCH_WORD_32 *out, ARCH_WORD_32 *reload_state, unsigned SSEi_flags);
 #define SHA256_BUF_SIZ 16
 #define SHA256_SSE_PARA 1
 #endif
 
 #ifdef MMX_COEF_SHA512
-#define SHA512_ALGORITHM_NAME	"128/128 " SIMD_TYPE " " STRINGIZE(MMX_COEF_SHA512)"x"
+#define SHA512_ALGORITHM_NAME	SIMD_WIDTH_STR SIMD_TYPE " " STRINGIZE(MMX_COEF_SHA512)"x"
 void SSESHA512body(__m128i* data, ARCH_WORD_64 *out, ARCH_WORD_64 *reload_state, unsigned SSEi_flags);
 // ????  (16 long longs).
 #define SHA512_BUF_SIZ 16
 #define SHA512_SSE_PARA 1
 #endif
 
+#if SIMD_DISPATCH
+/* Picks the best build of the kernels above for this CPU (simd-dispatch.c) */
+void simd_dispatch_init(void);
+const char *simd_dispatch_name(void);
+#endif
+
 #endif
 
 #endif // __JTR_SSE_INTRINSICS_H__
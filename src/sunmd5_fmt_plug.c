@@ -154,20 +154,20 @@ static struct fmt_tests tests[] = {
 #define MIN_DROP_BACK 1
 #endif
 //#define GETPOS(i, index)		    ( ((index)&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) )
-//#define PARAGETPOS(i, index)		( ((index)&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + ((index)>>(MMX_COEF>>1))*MMX_COEF*64 )
+//#define PARAGETPOS(i, index)		( ((index)&(MMX_COEF-1))*4 + ((i)&(0xffffffff-3))*MMX_COEF + ((i)&3) + ((index)/MMX_COEF)*MMX_COEF*64 )
 // these next 2 defines are same as above, but faster (on my gcc). Speed went fro 282 to 292, about 3.5% improvement.  Shifts vs mults.
-#define GETPOS(i, index)		    ( (((index)&(MMX_COEF-1))<<2) + (((i)&(0xffffffff-3))<<(MMX_COEF>>1)) + ((i)&3) )
-#define PARAGETPOS(i, index)		( (((index)&(MMX_COEF-1))<<2) + (((i)&(0xffffffff-3))<<(MMX_COEF>>1)) + ((i)&3) + ((((index)>>(MMX_COEF>>1))<<(MMX_COEF>>1))<<6) )
+#define GETPOS(i, index)		    ( (((index)&(MMX_COEF-1))<<2) + (((i)&(0xffffffff-3))*MMX_COEF) + ((i)&3) )
+#define PARAGETPOS(i, index)		( (((index)&(MMX_COEF-1))<<2) + (((i)&(0xffffffff-3))*MMX_COEF) + ((i)&3) + ((((index)/MMX_COEF)*MMX_COEF)<<6) )
 /* GETPOS0 can be 'faster' if we already have a pointer to the first DWORD in this block.  Thus we can do a GETPOS(0,idx), and then multiple GETPOS0(x) and sometimes be faster */
-#define GETPOS0(i)					(                               (((i)&(0xffffffff-3))<<(MMX_COEF>>1)) + ((i)&3) )
+#define GETPOS0(i)					(                               (((i)&(0xffffffff-3))*MMX_COEF) + ((i)&3) )
 /* output buffer for para is only 16 bytes per COEF, vs 64, so it's fewer bytes to jumbo to the next PARA start */
-#define PARAGETOUTPOS(i, index)		( (((index)&(MMX_COEF-1))<<2) + (((i)&(0xffffffff-3))<<(MMX_COEF>>1)) + ((i)&3) + ((((index)>>(MMX_COEF>>1))<<(MMX_COEF>>1))<<4) )
+#define PARAGETOUTPOS(i, index)		( (((index)&(MMX_COEF-1))<<2) + (((i)&(0xffffffff-3))*MMX_COEF) + ((i)&3) + ((((index)/MMX_COEF)*MMX_COEF)<<4) )
 
 #if defined (_DEBUG)
 // for VC debugging
-JTR_ALIGN(16) static unsigned char input_buf[BLK_CNT*MD5_CBLOCK];
-JTR_ALIGN(16) static unsigned char out_buf[BLK_CNT*MD5_DIGEST_LENGTH];
-JTR_ALIGN(16) static unsigned char input_buf_big[25][BLK_CNT*MD5_CBLOCK];
+JTR_ALIGN(MEM_ALIGN_SIMD) static unsigned char input_buf[BLK_CNT*MD5_CBLOCK];
+JTR_ALIGN(MEM_ALIGN_SIMD) static unsigned char out_buf[BLK_CNT*MD5_DIGEST_LENGTH];
+JTR_ALIGN(MEM_ALIGN_SIMD) static unsigned char input_buf_big[25][BLK_CNT*MD5_CBLOCK];
 /*  Now these are allocated in init()
 unsigned char input_buf[BLK_CNT*MD5_CBLOCK]         __attribute__ ((aligned(16)));
 unsigned char input_buf_big[25][BLK_CNT*MD5_CBLOCK] __attribute__ ((aligned(16)));
@@ -669,11 +669,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 				cpo[GETPOS0(k+16)] = roundascii[k];
 			}
 			cpo[GETPOS0(k+16)] = 0x80;
-#if COEF==4
-			((ARCH_WORD_32*)cpo)[56]=((16+roundasciilen)<<3);
-#else
-			((ARCH_WORD_32*)cpo)[28]=((16+roundasciilen)<<3);
-#endif
+			((ARCH_WORD_32*)cpo)[14*COEF]=((16+roundasciilen)<<3);
 		}
 		/* now do the 'loop' for the small 1-limb blocks. */
 		zs = zs0 = zb = zb0 = 0;
@@ -770,11 +766,7 @@ static int crypt_all(int *pcount, struct db_salt *salt)
 					cpo24[3] = 0x80;
 					break;
 			}
-#if COEF==4
-			((ARCH_WORD_32*)cpo24)[56]=((16+constant_phrase_size+roundasciilen)<<3);
-#else
-			((ARCH_WORD_32*)cpo24)[28]=((16+constant_phrase_size+roundasciilen)<<3);
-#endif
+			((ARCH_WORD_32*)cpo24)[14*COEF]=((16+constant_phrase_size+roundasciilen)<<3);
 		}
 		for (i = 0; i < nbig-MIN_DROP_BACK; i += BLK_CNT) {
 			for (j = 0; j < BLK_CNT && zb < nbig; ++j) {
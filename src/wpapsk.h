@@ -456,6 +456,12 @@ static int cmp_exact(char *source, int count)
 	return 1;
 }
 
+/*
+ * The essid is the first field of the salt, so this sorts handshakes of
+ * the same network next to each other.  crypt_all() then computes the PMK
+ * once per set of keys (see last_ssid) and only redoes the cheap PTK/MIC
+ * for the other handshakes.
+ */
 static int salt_compare(const void *x, const void *y)
 {
 	return strncmp((const char*)x, (const char*)y, 36);
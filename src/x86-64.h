@@ -88,8 +88,19 @@
 #define CPU_FALLBACK_BINARY_DEFAULT
 #endif
 #define DES_BS_ASM			0
-#if 0
+#if defined(__AVX512F__)
+/* 512-bit as 1x512, with vpternlog for the S-boxes */
+#define DES_BS_VECTOR			8
+#undef DES_BS
+#define DES_BS				4
+#define DES_BS_ALGORITHM_NAME		"DES 512/512 AVX512F"
+#elif defined(__AVX2__)
+/* 256-bit as 1x256, integer ops */
+#define DES_BS_VECTOR			4
+#define DES_BS_ALGORITHM_NAME		"DES 256/256 AVX2"
+#elif 0
 /* 512-bit as 2x256 */
+#define DES_BS_NO_AVX512
 #define DES_BS_VECTOR			8
 #if defined(JOHN_XOP) && defined(__GNUC__)
 /* Require gcc for 256-bit XOP because of __builtin_ia32_vpcmov_v8sf256() */
@@ -200,6 +211,26 @@
 #endif
 #endif
 
+#if CPU_DETECT && defined(__AVX2__)
+#define CPU_REQ_AVX2
+#undef CPU_NAME
+#define CPU_NAME			"AVX2"
+#ifdef CPU_FALLBACK_BINARY_DEFAULT
+#undef CPU_FALLBACK_BINARY
+#define CPU_FALLBACK_BINARY		"john-non-avx2"
+#endif
+#endif
+
+#if CPU_DETECT && DES_BS == 4
+#define CPU_REQ_AVX512F
+#undef CPU_NAME
+#define CPU_NAME			"AVX512F"
+#ifdef CPU_FALLBACK_BINARY_DEFAULT
+#undef CPU_FALLBACK_BINARY
+#define CPU_FALLBACK_BINARY		"john-non-avx512"
+#endif
+#endif
+
 #define MD5_ASM				0
 #define MD5_X2				1
 #define MD5_IMM				1
@@ -212,6 +243,46 @@
 
 #ifdef __SSE2__
 
+/*
+ * MMX_COEF is the number of 32-bit lanes in the vectors used by the MD4, MD5
+ * and SHA-1 SIMD code (sse-intrinsics.c).  The interleaving factors below
+ * are tuned per vector width.
+ */
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#define MMX_COEF			16
+#define MMX_TYPE			" AVX512BW"
+#ifndef MD5_SSE_PARA
+#define MD5_SSE_PARA			2
+#define MD5_N_STR			"32x"
+#endif
+#ifndef MD4_SSE_PARA
+#define MD4_SSE_PARA			2
+#define MD4_N_STR			"32x"
+#endif
+#ifndef SHA1_SSE_PARA
+#define SHA1_SSE_PARA			1
+#define SHA1_N_STR			"16x"
+#endif
+#elif defined(__AVX2__)
+#define MMX_COEF			8
+#define MMX_TYPE			" AVX2"
+#ifndef MD5_SSE_PARA
+#define MD5_SSE_PARA			3
+#define MD5_N_STR			"24x"
+#endif
+#ifndef MD4_SSE_PARA
+#define MD4_SSE_PARA			3
+#define MD4_N_STR			"24x"
+#endif
+#ifndef SHA1_SSE_PARA
+#define SHA1_SSE_PARA			1
+#define SHA1_N_STR			"8x"
+#endif
+#else
+#define MMX_COEF			4
+#define MMX_TYPE			" SSE2"
+#endif
+
 #ifndef MD5_SSE_PARA
 #if defined(__INTEL_COMPILER) || defined(USING_ICC_S_FILE)
 #define MD5_SSE_PARA			3
@@ -311,13 +382,37 @@
 #endif
 #endif
 
-#define MMX_TYPE			" SSE2"
-#define MMX_COEF			4
-
 #define NT_X86_64
 
-#define MMX_COEF_SHA256 4
-#define MMX_COEF_SHA512 2
+/* SHA-256 uses the same 32-bit lanes as above, SHA-512 half as many 64-bit ones */
+#if MMX_COEF == 16
+#define MMX_COEF_SHA256			16
+#define MMX_COEF_SHA512			8
+#elif MMX_COEF == 8
+#define MMX_COEF_SHA256			8
+#define MMX_COEF_SHA512			4
+#else
+#define MMX_COEF_SHA256			4
+#define MMX_COEF_SHA512			2
+#endif
+
+/*
+ * Runtime dispatch of the sse-intrinsics.c kernels (see simd-dispatch.c):
+ * they're additionally built for newer instruction sets, and the best one
+ * the CPU supports is picked at startup.  The vector width, and so every
+ * data layout, is still what this build was compiled for.  Needs gcc 6+
+ * for the target pragma and __builtin_cpu_supports(); -DSIMD_DISPATCH=0
+ * turns it off.
+ */
+#if !defined(SIMD_DISPATCH) && MMX_COEF < 16 && defined(__GNUC__) && \
+	!defined(__clang__) && !defined(__INTEL_COMPILER) && \
+	!defined(USING_ICC_S_FILE) && GCC_VERSION >= 60000
+#define SIMD_DISPATCH			1
+#endif
+#if SIMD_DISPATCH
+#define SIMD_NAME2(f, v)		f ## _ ## v
+#define SIMD_NAME(f, v)			SIMD_NAME2(f, v)
+#endif
 
 #endif /* __SSE2__ */
 